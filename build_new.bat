@@ -52,11 +52,36 @@ if "%1"=="no-speech" (
     set "STEAMAUDIO_INC="
     set "STEAMAUDIO_LIB="
     echo Disabling Steam Audio support...
+) else if "%1"=="bench" (
+    set "BUILD_BENCH=1"
+) else if "%1"=="check" (
+    set "BUILD_CHECK=1"
 )
 shift
 goto :parse_args
 :done_args
 
+REM "bench" builds and runs the position store micro-benchmark instead of FastPlay
+if defined BUILD_BENCH (
+    echo Building database benchmark...
+    cl /nologo /W3 /O2 /MT /EHsc /I"include" src\database_bench.cpp src\sqlite3.c /Fe:database_bench.exe
+    if errorlevel 1 goto :error
+    del /q *.obj 2>nul
+    database_bench.exe
+    goto :end
+)
+
+REM "check" builds and runs the limiter check instead of FastPlay
+if defined BUILD_CHECK (
+    echo Building limiter check...
+    cl /nologo /W3 /O2 /MT /EHsc /I"include\fastplay" src\limiter_check.cpp src\limiter.cpp /Fe:limiter_check.exe
+    if errorlevel 1 goto :error
+    del /q *.obj 2>nul
+    limiter_check.exe
+    if errorlevel 1 goto :error
+    goto :end
+)
+
 REM Read version from version.h
 set "APP_VERSION="
 for /f "tokens=3 delims= " %%v in ('findstr /C:"#define APP_VERSION " include\fastplay\version.h') do set "APP_VERSION=%%~v"
@@ -77,7 +102,7 @@ set "SOURCES=src\main.cpp src\globals.cpp src\utils.cpp src\player.cpp"
 set "SOURCES=%SOURCES% src\settings.cpp src\hotkeys.cpp src\tray.cpp"
 set "SOURCES=%SOURCES% src\accessibility.cpp src\ui.cpp src\effects.cpp"
 set "SOURCES=%SOURCES% src\database.cpp src\sqlite3.c"
-set "SOURCES=%SOURCES% src\tempo_processor.cpp src\youtube.cpp src\center_cancel.cpp src\convolution.cpp src\download_manager.cpp src\updater.cpp src\spatial_audio.cpp"
+set "SOURCES=%SOURCES% src\tempo_processor.cpp src\youtube.cpp src\center_cancel.cpp src\convolution.cpp src\download_manager.cpp src\updater.cpp src\spatial_audio.cpp src\resampler.cpp src\output_mixer.cpp src\crossfade.cpp src\url_open.cpp src\file_cache.cpp src\seek_table.cpp src\library.cpp src\loudness.cpp src\live_leveler.cpp src\limiter.cpp src\playlist.cpp src\config_store.cpp src\fingerprint.cpp src\playlist_search.cpp src\folder_scan.cpp"
 
 REM Add Speedy source if enabled
 if defined SPEEDY_SRC set "SOURCES=%SOURCES% %SPEEDY_SRC%"
@@ -87,12 +112,12 @@ rc /nologo FastPlay.rc
 if errorlevel 1 goto :error
 
 REM Compile and link
-cl /nologo /W3 /O2 /MT /EHsc /DUNICODE /D_UNICODE /DNOMINMAX %COMMIT_FLAG% %SPEECH_FLAG% %SPEEDY_FLAG% %SIGNALSMITH_FLAG% %STEAMAUDIO_FLAG% ^
+cl /nologo /W3 /O2 /MT /EHsc /DUNICODE /D_UNICODE /DNOMINMAX /DSQLITE_ENABLE_FTS5 %COMMIT_FLAG% %SPEECH_FLAG% %SPEEDY_FLAG% %SIGNALSMITH_FLAG% %STEAMAUDIO_FLAG% ^
    /I"." /I"include" /I"include\fastplay" %SPEEDY_INC% %SIGNALSMITH_INC% %STEAMAUDIO_INC% ^
    %SOURCES% FastPlay.res ^
    /Fe:FastPlay.exe ^
-   /link /LIBPATH:"lib" /DELAYLOAD:bass.dll /DELAYLOAD:bass_fx.dll /DELAYLOAD:bass_aac.dll /DELAYLOAD:bassmidi.dll /DELAYLOAD:bassenc.dll /DELAYLOAD:bassenc_mp3.dll /DELAYLOAD:bassenc_ogg.dll /DELAYLOAD:bassenc_flac.dll ^
-   bass.lib bass_fx.lib bass_aac.lib bassmidi.lib bassenc.lib bassenc_mp3.lib bassenc_ogg.lib bassenc_flac.lib %SPEECH_LIBS% user32.lib comctl32.lib comdlg32.lib shell32.lib shlwapi.lib advapi32.lib ole32.lib delayimp.lib
+   /link /LIBPATH:"lib" /DELAYLOAD:bass.dll /DELAYLOAD:bass_fx.dll /DELAYLOAD:bass_aac.dll /DELAYLOAD:bassmidi.dll /DELAYLOAD:bassenc.dll /DELAYLOAD:bassenc_mp3.dll /DELAYLOAD:bassenc_ogg.dll /DELAYLOAD:bassenc_flac.dll /DELAYLOAD:bassmix.dll /DELAYLOAD:bassloud.dll ^
+   bass.lib bass_fx.lib bass_aac.lib bassmidi.lib bassenc.lib bassenc_mp3.lib bassenc_ogg.lib bassenc_flac.lib bassmix.lib bassloud.lib %SPEECH_LIBS% user32.lib comctl32.lib comdlg32.lib shell32.lib shlwapi.lib advapi32.lib ole32.lib delayimp.lib
 
 if errorlevel 1 goto :error
 
@@ -58,6 +58,7 @@ copy /y "lib\bassenc_mp3.dll" "dist_temp\lib\" 2>&1
 copy /y "lib\bassenc_ogg.dll" "dist_temp\lib\" 2>&1
 copy /y "lib\bassenc_flac.dll" "dist_temp\lib\" 2>&1
 copy /y "lib\bassmix.dll" "dist_temp\lib\" 2>&1
+copy /y "lib\bassloud.dll" "dist_temp\lib\" 2>&1
 copy /y "lib\phonon.dll" "dist_temp\lib\" 2>&1
 
 REM Create zip using PowerShell
@@ -0,0 +1,34 @@
+#pragma once
+#ifndef FASTPLAY_CONFIG_STORE_H
+#define FASTPLAY_CONFIG_STORE_H
+
+#include <windows.h>
+#include <string>
+
+// Settings store
+// FastPlay.ini is parsed once into memory and every read is served from
+// there. Writes change the copy and the file is written back in one go a
+// moment after the last change (or at once by FlushConfig), to a temporary
+// file that then replaces the INI, so a crash never leaves it half written.
+//
+// The functions behave like the GetPrivateProfile*/WritePrivateProfile* calls
+// they replace: sections and keys are case-insensitive, and a string value in
+// quotes is returned without them.
+
+void LoadConfig(const std::wstring& path);
+bool FlushConfig();  // Write pending changes now; false if the write failed
+
+int ConfigGetInt(const wchar_t* section, const wchar_t* key, int defaultVal);
+float ConfigGetFloat(const wchar_t* section, const wchar_t* key, float defaultVal);  // defaultVal if missing or empty
+DWORD ConfigGetString(const wchar_t* section, const wchar_t* key, const wchar_t* defaultVal,
+                      wchar_t* buf, DWORD size);
+std::wstring ConfigGetString(const wchar_t* section, const wchar_t* key, const wchar_t* defaultVal);
+
+// value nullptr removes the key; key nullptr removes the whole section
+void ConfigWriteString(const wchar_t* section, const wchar_t* key, const wchar_t* value);
+void ConfigClearSection(const wchar_t* section);  // Remove every key in it
+
+// Delay between the last change and the write
+constexpr UINT CONFIG_FLUSH_DELAY = 1000;
+
+#endif // FASTPLAY_CONFIG_STORE_H
@@ -0,0 +1,57 @@
+#pragma once
+#ifndef FASTPLAY_CROSSFADE_H
+#define FASTPLAY_CROSSFADE_H
+
+#include <windows.h>
+#include <cstddef>
+#include <cstdint>
+#include "bass.h"
+
+// Crossfade curves (gain of the incoming track over the fade; the outgoing
+// track gets the complementary curve)
+enum class CrossfadeCurve {
+    Linear,      // Straight line - a slight dip in the middle
+    EqualPower,  // Sine/cosine - constant loudness for unrelated material
+    SCurve,      // Smoothstep - gentle start and end
+    COUNT
+};
+
+const char* GetCrossfadeCurveName(CrossfadeCurve curve);
+
+// Blend 'incoming' into 'outgoing' in place over 'frames' interleaved frames.
+// x0 is the fade progress (0..1) at the first frame and dx the step per frame;
+// progress past 1 plays the incoming alone. inGain scales the incoming track
+// (ReplayGain difference between the two tracks).
+void BlendCrossfade(float* outgoing, const float* incoming, size_t frames, int chans,
+                    double x0, double dx, CrossfadeCurve curve, float inGain);
+
+// Scan part of a file for audible material (above the smart-crossfade
+// threshold). Returns false if nothing audible was found in [from, to);
+// otherwise first/last are the times in seconds of the first and last
+// audible frame.
+bool FindAudibleRange(const wchar_t* path, double from, double to, double* first, double* last);
+
+// Crossfade engine
+// Runs as a DSP on the outgoing track's decode stream, so it is pulled by the
+// output mixer: every block it reads the same number of frames from the
+// incoming track and blends them in. When the outgoing track ends, the
+// incoming one has advanced exactly as far as was heard and continues from
+// there as a normal mixer source.
+
+// Both streams must be float decode streams with the same rate and channel
+// count. fadeStart and fadeFrames are in outgoing frames from now.
+bool ArmCrossfade(HSTREAM outgoing, HSTREAM incoming, int64_t fadeStart, int64_t fadeFrames,
+                  CrossfadeCurve curve, float inGain);
+
+// Stop blending and detach from the outgoing stream (the incoming is untouched)
+void CancelCrossfade();
+
+// Take the incoming stream so it can be added to the mixer. Returns it only
+// once (to whichever of the join sync or a manual track change asks first),
+// and 0 when nothing is armed. Safe to call from a mixtime sync.
+HSTREAM TakeCrossfadeIncoming();
+
+// Whether the stream pair can be crossfaded
+bool CanCrossfade(HSTREAM outgoing, HSTREAM incoming);
+
+#endif // FASTPLAY_CROSSFADE_H
@@ -42,7 +42,8 @@ struct SongHistoryEntry {
     int64_t timestamp;  // Unix timestamp when captured
 };
 
-// Podcast episode structure (not stored in DB - fetched from RSS)
+// Podcast episode structure (fetched from RSS; the last fetch of each
+// subscribed feed is kept for searching)
 struct PodcastEpisode {
     std::wstring title;
     std::wstring description;
@@ -52,6 +53,25 @@ struct PodcastEpisode {
     std::wstring guid;
 };
 
+// Search result kinds
+enum class SearchKind {
+    Song = 0,      // Song history entry
+    Bookmark = 1,
+    Station = 2,   // Radio favorite
+    Episode = 3    // Podcast episode
+};
+
+// Search result
+struct SearchResult {
+    SearchKind kind;
+    int id;
+    std::wstring title;
+    std::wstring detail;   // Bookmark path, station URL or podcast name
+    std::wstring target;   // What to open: bookmarked file, station or episode URL
+    double position;       // Bookmark position in seconds
+    int64_t timestamp;     // Song history capture time
+};
+
 // Schedule action type
 enum class ScheduleAction {
     Playback = 0,
@@ -99,6 +119,54 @@ struct ScheduledEvent {
     std::wstring displayName;   // For display in list
 };
 
+// Media library track (an audio file under a library folder)
+struct LibraryTrack {
+    int64_t id = 0;
+    std::wstring path;
+    int64_t fileSize = 0;
+    int64_t modified = 0;       // Last write time (FILETIME ticks)
+    std::wstring title;
+    std::wstring artist;
+    std::wstring album;
+    std::wstring albumArtist;   // Album grouping: the album artist, else the track artist
+    std::wstring genre;
+    int year = 0;
+    int trackNumber = 0;
+    double duration = 0.0;      // Seconds (0 if the file couldn't be opened)
+    std::wstring codec;
+    int sampleRate = 0;
+    int channels = 0;
+    int bitrate = 0;            // kbps
+    bool hasTrackGain = false;  // ReplayGain (dB and linear peak)
+    float trackGain = 0.0f;
+    float trackPeak = 0.0f;
+    bool hasAlbumGain = false;
+    float albumGain = 0.0f;
+    float albumPeak = 0.0f;
+};
+
+// Media library artist / album with their track counts
+struct LibraryArtist {
+    int64_t id;
+    std::wstring name;
+    int trackCount;
+};
+
+struct LibraryAlbum {
+    int64_t id;
+    std::wstring title;
+    std::wstring artist;
+    int year;
+    int trackCount;
+};
+
+// Size and modification time of a library file as last scanned
+struct LibraryFileStamp {
+    std::wstring path;
+    int64_t fileSize;
+    int64_t modified;
+};
+
 // Initialize database (call once at startup)
 bool InitDatabase();
 
@@ -108,6 +176,8 @@ void CloseDatabase();
 // File position operations
 void SaveFilePositionDB(const std::wstring& filePath, double position);
 double LoadFilePositionDB(const std::wstring& filePath);
+uint64_t GetPositionBytesWrittenDB();  // WAL bytes file positions have taken this session
+void RelinkMovedFileDB(const std::wstring& filePath);  // Adopt positions and bookmarks of this file from where it was
 
 // Bookmark operations
 int AddBookmark(const std::wstring& filePath, double position);
@@ -155,8 +225,77 @@ std::vector<ScheduledEvent> GetAllScheduledEvents();
 std::vector<ScheduledEvent> GetPendingScheduledEvents();
 
 // Song history operations (captured from stream metadata)
-void AddSongHistoryEntry(const std::wstring& title);
-std::vector<SongHistoryEntry> GetSongHistory();
+void AddSongHistoryEntry(const std::wstring& title, int limit);  // Keeps the newest limit entries
+std::vector<SongHistoryEntry> GetSongHistory();  // Newest 1000
 void ClearSongHistory();
 
+// Podcast episodes of a subscribed feed as just fetched (replaces the last fetch)
+void SavePodcastEpisodesDB(const std::wstring& feedUrl, const std::wstring& feedTitle,
+                           const std::vector<PodcastEpisode>& episodes);
+
+// Search song history, bookmarks, radio favorites and podcast episodes. Every
+// word of the query must match the start of a word in the entry, ignoring
+// case and accents. Songs come newest first, the rest best match first, up
+// to limitPerKind of each.
+std::vector<SearchResult> SearchDB(const std::wstring& query, int limitPerKind);
+
+// URL open hints (the UrlOpenStrategy that last worked for a host, -1 if none)
+void SaveUrlOpenStrategyDB(const std::wstring& host, int strategy);
+int LoadUrlOpenStrategyDB(const std::wstring& host);
+
+// Station loudness (short-term loudness in LUFS the live stream leveler
+// settled on for a station URL; false if none)
+void SaveStationLoudnessDB(const std::wstring& url, float loudness);
+bool LoadStationLoudnessDB(const std::wstring& url, float& loudness);
+
+// Saved playlist (the playlist at exit, by position)
+int GetPlaylistCountDB();
+std::wstring GetPlaylistEntryDB(int position);
+std::vector<std::wstring> LoadPlaylistDB();
+// Replace removeCount entries from start with paths, moving the entries after
+// them along, in one transaction. Returns false (and changes nothing) on error.
+bool ReplacePlaylistRangeDB(int start, int removeCount, const std::vector<std::wstring>& paths);
+
+// Seek tables (BASS scan info of a file, keyed by path, size and modification time)
+void SaveSeekTableDB(const std::wstring& filePath, int64_t fileSize, int64_t modified,
+                     const std::vector<unsigned char>& scanInfo);
+bool LoadSeekTableDB(const std::wstring& filePath, int64_t fileSize, int64_t modified,
+                     std::vector<unsigned char>& scanInfo);
+
+// Media library folders (the roots the library scanner walks)
+bool AddLibraryFolderDB(const std::wstring& folder);
+bool RemoveLibraryFolderDB(const std::wstring& folder);  // Also drops its tracks
+std::vector<std::wstring> GetLibraryFoldersDB();
+
+// Media library queries (instant on large libraries: all indexed)
+int GetLibraryTrackCount();
+bool GetLibraryTrack(const std::wstring& filePath, LibraryTrack& track);
+std::vector<LibraryArtist> GetLibraryArtists();
+std::vector<LibraryAlbum> GetLibraryAlbums(int64_t artistId);  // artistId 0: all albums
+std::vector<LibraryTrack> GetLibraryAlbumTracks(int64_t albumId);  // In track order
+std::vector<LibraryTrack> GetLibraryArtistTracks(int64_t artistId);
+std::vector<LibraryTrack> SearchLibraryTracks(const std::wstring& text, int limit);
+// Title, artist and album of each path, space separated ("" for one not in the library)
+std::vector<std::wstring> GetLibraryTagTextDB(const std::vector<std::wstring>& paths);
+
+// Media library updates (used by the scanner; safe from any thread - they go
+// through a connection of their own so a long scan never blocks UI queries)
+std::vector<LibraryFileStamp> GetLibraryFolderStampsDB(const std::wstring& folder);
+std::vector<std::wstring> GetLibrarySubfoldersDB(const std::wstring& root);  // Root included
+void SaveLibraryTracksDB(const std::vector<LibraryTrack>& tracks);
+void RemoveLibraryTracksDB(const std::vector<std::wstring>& filePaths);
+void RemoveLibraryFolderTracksDB(const std::wstring& folder);  // One folder, not its subfolders
+void PruneLibraryDB();  // Drop artists and albums no track refers to any more
+
+// Loudness analysis (EBU R128 integrated loudness in LUFS and linear true peak,
+// keyed by path, size and modification time). A file that couldn't be measured
+// is stored without values so it isn't analyzed again.
+void SaveLoudnessDB(const std::wstring& filePath, int64_t fileSize, int64_t modified,
+                    bool measured, float integrated, float truePeak);
+bool LoadLoudnessDB(const std::wstring& filePath, int64_t fileSize, int64_t modified,
+                    float& integrated, float& truePeak);  // True if measured
+// For the analyzer's threads (through the scanner connection)
+bool IsLoudnessStoredDB(const std::wstring& filePath, int64_t fileSize, int64_t modified);
+std::vector<LibraryFileStamp> GetUnanalyzedLibraryTracksDB(int limit);  // Untagged tracks only
+
 #endif // FASTPLAY_DATABASE_H
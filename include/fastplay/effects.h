@@ -19,12 +19,16 @@ bool IsStreamEffectEnabled(int effectIndex);
 void ToggleDSPEffect(DSPEffectType type);
 void EnableDSPEffect(DSPEffectType type, bool enable);
 bool IsDSPEffectEnabled(DSPEffectType type);
-void ApplyDSPEffects();  // Call after stream creation
-void RemoveDSPEffects(); // Call before stream destruction
+void ApplyDSPEffects();  // Call after output mixer creation (effects persist across tracks)
+void RemoveDSPEffects(); // Call before output mixer destruction
 
 // Reverb algorithm selection (0=Off, 1=Freeverb, 2=DX8, 3=I3DL2)
 void SetReverbAlgorithm(int algorithm);
 
+// Surround downmix: fill per-channel gains (BASS channel order) that fold an
+// N-channel frame down to stereo. Returns false for mono/stereo (nothing to fold).
+bool GetDownmixGains(int chans, float* gainL, float* gainR);
+
 // Parameter getters
 float GetParamValue(ParamId id);
 const char* GetParamName(ParamId id);
@@ -0,0 +1,36 @@
+#pragma once
+#ifndef FASTPLAY_FILE_CACHE_H
+#define FASTPLAY_FILE_CACHE_H
+
+#include <windows.h>
+#include <string>
+#include <vector>
+#include <cstddef>
+#include "bass.h"
+
+// Read-ahead file cache
+// Decoders read from memory that a background thread keeps filled ahead of
+// them, so a brief stall on a network share doesn't turn into a dropout. The
+// window is sized for readAheadSeconds of CD-quality PCM (compressed files get
+// proportionally more time); files that fit in it are read whole. A seek
+// outside the window re-targets the reader at once.
+
+// Open a file as a decode stream through the cache (flags as for
+// BASS_StreamCreateFileUser). Returns 0 if the file or the stream couldn't be
+// opened this way; the caller should then open it directly, which also
+// reports the proper error.
+HSTREAM CreateCachedFileStream(const wchar_t* path, DWORD flags, int readAheadSeconds);
+
+// Predictive prefetch
+// A background thread reads the start (one read-ahead window) and the last
+// 256 KB (end tags, an MP4 index) of upcoming files into memory, so opening them
+// later through CreateCachedFileStream() doesn't wait on the file system.
+// paths is in play order; earlier entries are fetched first, entries that drop
+// off the list are released, and the total stays within budgetBytes. An empty
+// list releases everything.
+void SetPrefetchList(const std::vector<std::wstring>& paths, int readAheadSeconds, size_t budgetBytes);
+
+// Stop the prefetch thread and release everything (call at shutdown)
+void ShutdownPrefetch();
+
+#endif // FASTPLAY_FILE_CACHE_H
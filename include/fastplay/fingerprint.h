@@ -0,0 +1,22 @@
+#pragma once
+#ifndef FASTPLAY_FINGERPRINT_H
+#define FASTPLAY_FINGERPRINT_H
+
+#include <string>
+#include <cstdint>
+
+// Content fingerprints
+// A file's size and a hash of its first and last 64 KB identify it whatever
+// it is called and wherever it is, without reading the whole file, so saved
+// positions and bookmarks can follow a file that is renamed, moved or
+// downloaded again. Results are cached per path while the file's size and
+// modification time stay the same. Safe to call from any thread.
+
+struct FileFingerprint {
+    int64_t size;
+    uint64_t hash;
+};
+
+bool GetFileFingerprint(const std::wstring& path, FileFingerprint& fingerprint);  // false if it can't be read
+
+#endif // FASTPLAY_FINGERPRINT_H
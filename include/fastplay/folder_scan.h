@@ -0,0 +1,31 @@
+#pragma once
+#ifndef FASTPLAY_FOLDER_SCAN_H
+#define FASTPLAY_FOLDER_SCAN_H
+
+#include <string>
+#include <vector>
+
+// Folder listing
+// Lists the audio files in folders in natural order: letters ignoring case
+// and runs of digits by value, so "Track 2" comes before "Track 10", and a
+// folder's own files before those of its subfolders. Subfolders are listed by
+// several threads at once, each working through a queue of its own and taking
+// from the others' when it runs dry, which pays off most on network shares
+// where every listing is a round trip.
+//
+// Listings are cached and reused while the folder's last write time stays
+// the same (it changes when an entry directly in it is added, removed or
+// renamed), so opening the same folder again reads one set of attributes per
+// folder instead of listing it.
+
+// Append the audio files in folder and its subfolders (to a depth of 32,
+// skipping junctions and links)
+void AddAudioFilesFromFolder(const std::wstring& folder, std::vector<std::wstring>& files);
+
+// The audio files directly in folder (full paths)
+std::vector<std::wstring> GetFolderAudioFiles(const std::wstring& folder);
+
+// Natural order of two names or paths (path separators sort first)
+bool NaturalLess(const std::wstring& a, const std::wstring& b);
+
+#endif // FASTPLAY_FOLDER_SCAN_H
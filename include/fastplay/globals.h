@@ -5,9 +5,11 @@
 #include <windows.h>
 #include <vector>
 #include <string>
+#include <atomic>
 #include "bass.h"
 #include "bassenc.h"
 #include "types.h"
+#include "playlist.h"
 
 // Forward declarations
 template<typename T> class CycleList;
@@ -42,6 +44,7 @@ HWND GetMessageBoxOwner();
 extern HSTREAM g_stream;      // Source stream
 extern HSTREAM g_fxStream;    // Tempo stream (wraps g_stream for pitch/tempo)
 extern HSTREAM g_sourceStream; // Original decode stream (for bitrate queries, not freed separately)
+extern HSTREAM g_outputStream; // Persistent mixer that plays g_fxStream (effects attach here)
 extern HSYNC g_endSync;
 extern HSYNC g_metaSync;      // Sync for stream metadata changes
 extern float g_volume;
@@ -53,7 +56,8 @@ extern bool g_disableBatchDelay; // Skip batch delay when opening files from exp
 extern int g_replayGainMode;        // 0 = Off, 1 = Track, 2 = Album (album falls back to track)
 extern float g_replayGainPreamp;    // Extra gain in dB applied on top of the tag value
 extern bool g_replayGainPreventClip; // Reduce gain using the peak tag to avoid clipping
-extern float g_replayGainScale;     // Computed linear multiplier for the current track (1.0 = no change)
+extern std::atomic<float> g_replayGainScale;  // Computed linear multiplier for the current track (1.0 = no change);
+                                             // switched by the mixer thread at a gapless join
 
 // Effect state (for BASS_FX)
 extern float g_tempo;
@@ -64,7 +68,7 @@ extern bool g_isLiveStream;   // True if current stream is non-seekable (live st
 extern int g_currentBitrate;  // Cached bitrate of current file (kbps)
 
 // Playlist
-extern std::vector<std::wstring> g_playlist;
+extern Playlist g_playlist;
 extern int g_currentTrack;
 
 // Loading guards
@@ -78,6 +82,8 @@ extern int g_rewindOnPauseMs;
 extern bool g_allowAmplify;
 extern bool g_rememberState;
 extern int g_rememberPosMinutes;
+extern int g_checkpointSeconds;  // Save the place in a long file this often while it plays (0 = off)
+extern int g_songHistoryLimit;   // Song history entries kept
 extern bool g_bringToFront;
 extern bool g_minimizeToTray;
 extern bool g_loadFolder;
@@ -93,7 +99,7 @@ extern bool g_trayIconVisible;
 
 // File batching
 extern std::vector<std::wstring> g_pendingFiles;
-extern DWORD g_startupTime;
+extern ULONGLONG g_startupTime;  // GetTickCount64() when the window was created
 
 // Recent files
 extern std::vector<std::wstring> g_recentFiles;
@@ -146,6 +152,17 @@ extern const int g_updatePeriodCount;
 // Tempo/pitch algorithm setting
 extern int g_tempoAlgorithm;   // 0=SoundTouch, 1=Speedy, 2=Signalsmith
 
+// Resampler for Rate and device rate conversion
+extern int g_resamplerQuality; // 0=BASS built-in, 1=Low, 2=Medium, 3=High
+
+// Read-ahead cache for local and network files
+extern int g_readAheadSeconds; // Window in seconds (0 = read files directly)
+extern int g_prefetchTracks;   // Upcoming tracks in play order to prefetch (0 = off)
+extern int g_prefetchMemoryMB; // Memory budget for prefetched tracks
+
+// Media library
+extern int g_libraryScanThreads; // Files read at once by the library scanner (0 = automatic)
+
 // SoundTouch settings
 extern bool g_stAntiAliasFilter;   // Enable anti-alias filter (default true)
 extern int g_stAAFilterLength;     // AA filter length 8-128 (default 32)
@@ -162,10 +179,14 @@ extern bool g_speedyNonlinear;     // Enable nonlinear speedup (default true, re
 // Signalsmith Stretch settings
 extern int g_ssPreset;             // 0=Default, 1=Cheaper
 extern int g_ssTonalityLimit;      // Tonality limit in Hz (0=auto)
+extern int g_ssThreads;            // Worker threads for multichannel stretching (0=auto)
 
 // Reverb algorithm (0=Off, 1=Freeverb, 2=DX8, 3=I3DL2)
 extern int g_reverbAlgorithm;
 
+// Fold surround (more than 2 channel) sources down to stereo before tempo and effects
+extern bool g_downmixStereo;
+
 // Convolution reverb settings
 extern std::wstring g_convolutionIRPath;  // Path to impulse response WAV file
 
@@ -203,6 +224,10 @@ extern bool g_speechEffect;             // Speak effect value when adjusted
 // Shuffle and auto-advance
 extern bool g_shuffle;                  // Shuffle playback order
 extern bool g_autoAdvance;              // Auto-play next track when current ends (default true)
+extern bool g_gapless;                  // Pre-roll the next track and join it without a gap (default true)
+extern int g_crossfadeMs;               // Crossfade length between tracks in ms (0 = off)
+extern int g_crossfadeCurve;            // CrossfadeCurve: 0 = linear, 1 = equal power, 2 = S-curve
+extern bool g_crossfadeSmart;           // Fade over audible material only (skip edge silence)
 extern int g_repeatMode;                // 0 = off, 1 = repeat one, 2 = repeat all
 
 // Chapter support
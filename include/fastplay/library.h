@@ -0,0 +1,33 @@
+#pragma once
+#ifndef FASTPLAY_LIBRARY_H
+#define FASTPLAY_LIBRARY_H
+
+#include <string>
+
+// Media library
+// Audio files under the library folders are indexed in the database (tags,
+// duration, codec, ReplayGain; see the library queries in database.h) so the
+// playlist and search can find them without touching the disk. A background
+// scan walks the folders on one thread and reads new or changed files (by
+// size and modification time) on a few others, so a rescan of an unchanged
+// library costs one directory listing per folder. Files waiting to be read
+// and tracks waiting to be saved are capped, so memory stays flat however
+// large the library is.
+
+// Add a folder to the library and scan it in the background. A folder already
+// covered by a library folder isn't added again. Returns true if it was added.
+bool AddLibraryFolder(const std::wstring& folder);
+
+// Remove a folder (and its tracks) from the library
+bool RemoveLibraryFolder(const std::wstring& folder);
+
+// Rescan the library folders in the background. A request while a scan is
+// running makes that scan go round once more.
+void StartLibraryScan();
+
+// Stop a running scan (call before BASS_Free and before closing the database)
+void StopLibraryScan();
+
+bool IsLibraryScanRunning();
+
+#endif // FASTPLAY_LIBRARY_H
@@ -0,0 +1,61 @@
+#pragma once
+#ifndef FASTPLAY_LIMITER_H
+#define FASTPLAY_LIMITER_H
+
+#include <vector>
+#include <cstdint>
+
+// Lookahead true-peak limiter
+// Peaks are detected on a 4x oversampled copy of the signal (ITU-R BS.1770
+// style interpolation), so the peaks a DAC reconstructs between samples are
+// caught as well. The audio is delayed by the lookahead, and the gain is
+// brought down smoothly across it, so it is fully down by the time a peak
+// plays and recovers over the release time afterwards.
+
+class TruePeakLimiter {
+public:
+    TruePeakLimiter();
+
+    // ceiling is linear (1.0 = full scale); lookahead and release in seconds
+    void Init(int sampleRate, int chans, float ceiling, double lookahead, double release);
+    void Reset();
+
+    bool IsInitialized() const { return m_chans > 0; }
+    bool Matches(int sampleRate, int chans) const { return m_sampleRate == sampleRate && m_chans == chans; }
+
+    // Limit interleaved float frames in place (output is delayed by GetLatency() frames)
+    void Process(float* samples, int frames);
+    int GetLatency() const { return m_delayFrames; }
+
+private:
+    float DetectPeak(const float* frame);
+
+    int m_sampleRate;
+    int m_chans;
+    float m_ceiling;
+    int m_lookahead;
+
+    // Interpolation: per tap, the coefficients of the four phases
+    std::vector<float> m_coef;
+    std::vector<float> m_history;  // Per channel, the recent samples twice over
+    int m_historyPos;
+
+    // Audio delay
+    std::vector<float> m_delay;
+    int m_delayFrames;
+    int m_delayPos;
+
+    // Gain: sliding minimum of the needed gain, release, then smoothing across the lookahead
+    std::vector<float> m_minValue;
+    std::vector<int64_t> m_minFrame;
+    int m_minHead;
+    int m_minCount;
+    int64_t m_frame;
+    float m_release;
+    float m_releaseAlpha;
+    std::vector<float> m_box;
+    int m_boxPos;
+    double m_boxSum;
+};
+
+#endif // FASTPLAY_LIMITER_H
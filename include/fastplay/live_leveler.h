@@ -0,0 +1,27 @@
+#pragma once
+#ifndef FASTPLAY_LIVE_LEVELER_H
+#define FASTPLAY_LIVE_LEVELER_H
+
+#include <windows.h>
+#include <string>
+#include "bass.h"
+
+// Live stream leveler
+// Internet radio has no ReplayGain, so while ReplayGain is on a live stream is
+// leveled as it plays: a DSP on the stream measures its short-term loudness
+// (EBU R128: K-weighted, 3-second window), rides the gain slowly toward the
+// ReplayGain reference plus preamp, and a lookahead limiter catches the peaks
+// a boost would push over. The loudness learned for a station is remembered,
+// so the next time it is tuned in it starts at the right level.
+
+// Level a newly opened live stream (a float decode channel). station keys what
+// is learned about it (the URL as the user opened it).
+void StartLiveLeveler(HSTREAM stream, const std::wstring& station);
+
+// Stop leveling and remember the station's loudness (call before freeing the stream)
+void StopLiveLeveler();
+
+// Follow a change of the ReplayGain options (on/off, preamp)
+void RefreshLiveLeveler();
+
+#endif // FASTPLAY_LIVE_LEVELER_H
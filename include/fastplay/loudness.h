@@ -0,0 +1,36 @@
+#pragma once
+#ifndef FASTPLAY_LOUDNESS_H
+#define FASTPLAY_LOUDNESS_H
+
+#include <string>
+#include <vector>
+
+// Loudness analysis
+// Files without ReplayGain tags are measured in the background (EBU R128
+// integrated loudness and true peak, through BASSloud) and the results stored
+// in the database, so ReplayGain can level them too. Upcoming playlist tracks
+// go first, then the library's untagged tracks. Files are decoded faster than
+// realtime on all but one core, at low priority, and the work pauses while
+// playback needs the CPU.
+
+// Reference level the stored loudness is normalized to (ReplayGain 2.0)
+const float LOUDNESS_REFERENCE_LUFS = -18.0f;
+
+// Start the analyzer threads (call once BASS and the database are up)
+void StartLoudnessAnalysis();
+
+// Stop the analyzer (call before BASS_Free and before closing the database)
+void StopLoudnessAnalysis();
+
+// Analyze these files ahead of the library backlog, in order. Replaces the
+// previous list; files already analyzed are skipped.
+void SetLoudnessPriorityList(const std::vector<std::wstring>& paths);
+
+// Hold the analyzer back (a track is loading, or the mixer is busy)
+void SetLoudnessAnalysisPaused(bool paused);
+
+// Stored result for a file as it is now: ReplayGain-style gain in dB and the
+// linear true peak. Returns false if the file hasn't been measured.
+bool GetAnalyzedGain(const std::wstring& path, float& gainDb, float& truePeak);
+
+#endif // FASTPLAY_LOUDNESS_H
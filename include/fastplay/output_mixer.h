@@ -0,0 +1,37 @@
+#pragma once
+#ifndef FASTPLAY_OUTPUT_MIXER_H
+#define FASTPLAY_OUTPUT_MIXER_H
+
+#include <windows.h>
+#include "bass.h"
+
+// Persistent output stage
+// A bassmix mixer (g_outputStream) is the only channel that actually plays.
+// Each track's chain (source -> tempo processor -> resampler) is a decode stream
+// added to it as a source, so transport, effects and recording all target the
+// mixer and a queued next track continues sample-accurately when the current ends.
+
+// Create the mixer for a channel count, rebuilding it if the count differs.
+// The effect chain is attached once per mixer and left alone on track changes;
+// a rebuild moves it across and stops any recording on the old mixer.
+bool EnsureOutputMixer(DWORD chans);
+void FreeOutputMixer();
+DWORD GetOutputChannels();
+
+// Make source the only thing playing (a manual track change)
+bool AttachToOutput(HSTREAM source);
+
+// Queue source to start exactly when the current sources end (gapless join).
+// Also used from a mixtime END sync to continue a crossfaded track.
+bool QueueOnOutput(HSTREAM source);
+
+// Remove a source from the mixer (does not free it)
+void DetachFromOutput(HSTREAM source);
+
+// Playback buffer of the mixer in seconds (0 = render on demand)
+void SetOutputBuffer(float seconds);
+
+// Drop already-mixed audio so a seek or track change is heard immediately
+void FlushOutput();
+
+#endif // FASTPLAY_OUTPUT_MIXER_H
@@ -34,6 +34,9 @@ bool SeekToNextChapter();
 bool SeekToPrevChapter();
 int GetCurrentChapterIndex();
 
+// Rate (through the built-in resampler when active, else BASS_ATTRIB_FREQ)
+void ApplyPlaybackRate();
+
 // Volume
 void SetVolume(float vol);
 void ToggleMute();
@@ -42,9 +45,19 @@ void RefreshReplayGain();  // Recompute and re-apply ReplayGain for the current
 // Track navigation
 void NextTrack(bool autoPlay = true);
 void PrevTrack();
-void PlayTrack(int index, bool autoPlay = true);
+void PlayTrack(int index, bool autoPlay = true);  // Local files open in the background
+void OnTrackLoaded();        // WM_TRACK_LOADED: swap in a track opened in the background
+bool IsTrackLoadPending();   // A background load has been requested and not yet swapped in
+void OnSeekTableReady();     // WM_SEEK_TABLE_READY: apply a freshly scanned seek table to the current track
 void ToggleRepeatMode();
 void ResetShuffleOrder();  // Discard the current shuffle order (fresh shuffle on next advance)
+void UpdateGaplessPreroll();  // Periodic: open the next track ahead of time for a gapless join
+void OnPrerollLoaded();       // WM_PREROLL_LOADED: queue the next track the loader opened ahead of time
+void UpdatePrefetch();        // Periodic: read the start of the next few tracks into memory
+void UpdateLoudnessAnalysis();  // Periodic: feed and pace the background loudness analyzer
+void UpdatePositionCheckpoint();  // Periodic: save the place in a long file every g_checkpointSeconds
+double GetCheckpointBytesPerHour();  // Database bytes position saves have written per hour running
+void LogCheckpointWriteRate();       // Debug output: what position saves wrote this session
 
 // Track end callback
 void CALLBACK OnTrackEnd(HSYNC handle, DWORD channel, DWORD data, void* user);
@@ -78,6 +91,29 @@ int GetCurrentBitrate();  // Returns current stream bitrate in kbps, or 0 if una
 void SpeakTagDuration();
 void SpeakTagFilename();
 
+// A stream's tags, parsed from whichever tag block holds each field (ID3v1
+// fallbacks applied). Display fields are already converted for the UI and speech.
+struct StreamTags {
+    HSTREAM stream = 0;
+    std::wstring streamTitle;  // "Artist - Title" from stream metadata (internet radio)
+    std::wstring station;
+    std::wstring title;
+    std::wstring artist;
+    std::wstring album;
+    std::wstring albumArtist;
+    std::wstring year;
+    std::wstring track;
+    std::wstring genre;
+    std::wstring comment;
+    std::string trackGain;     // ReplayGain values as tagged ("-6.48 dB")
+    std::string trackPeak;
+    std::string albumGain;
+    std::string albumPeak;
+};
+
+// Read a stream's tags (any thread; the stream isn't touched otherwise)
+void ReadStreamTags(HSTREAM stream, StreamTags& tags);
+
 // Tag retrieval functions (return tag text for display)
 std::wstring GetTagTitle();
 std::wstring GetTagArtist();
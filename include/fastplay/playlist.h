@@ -0,0 +1,117 @@
+#pragma once
+#ifndef FASTPLAY_PLAYLIST_H
+#define FASTPLAY_PLAYLIST_H
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <random>
+#include <cstdint>
+
+// Playlist model
+// Entries are kept in a balanced tree ordered by position (an implicit
+// treap), so looking up, inserting, removing or moving an entry is O(log n)
+// however long the playlist is. Each entry stores its file name and an index
+// into a table of folders, so a folder of thousands of tracks stores its path
+// once. Entries have IDs that stay valid across edits, and the shuffle order
+// is part of the model: it follows inserts and removals, and finding an
+// entry's place in it is O(1).
+//
+// size(), empty(), clear(), push_back(), insert(), erase() and operator[]
+// behave as they did on the std::vector<std::wstring> this replaces; indexing
+// returns the full path by value.
+
+typedef uint32_t PlaylistEntryId;  // 0 = no entry
+
+class Playlist {
+public:
+    Playlist();
+
+    size_t size() const { return static_cast<size_t>(NodeSize(m_root)); }
+    bool empty() const { return m_root < 0; }
+    void clear();
+
+    std::wstring operator[](size_t index) const;  // Full path
+    const std::wstring& GetName(size_t index) const;  // After the last slash (what lists show)
+    const std::wstring& GetFolder(size_t index) const;  // Up to and including the last slash
+
+    void push_back(const std::wstring& path);
+    void insert(size_t index, const std::wstring& path);
+    void append(const std::vector<std::wstring>& paths);
+    void erase(size_t index);
+    void move(size_t from, size_t to);  // The entry keeps its ID
+    Playlist& operator=(const std::vector<std::wstring>& paths);
+
+    PlaylistEntryId GetId(int index) const;  // 0 if out of range
+    int IndexOf(PlaylistEntryId id) const;   // -1 if removed
+    std::vector<PlaylistEntryId> GetIds() const;  // In playlist order
+
+    // IDs count up from GetFirstId() in the order entries were added, and
+    // clear() moves GetFirstId() past all of them, so whoever watches the
+    // playlist can pick up additions since it last looked from the IDs alone
+    PlaylistEntryId GetFirstId() const { return m_idBase + 1; }
+    PlaylistEntryId GetNextId() const { return m_idBase + static_cast<PlaylistEntryId>(m_nodes.size()) + 1; }
+    bool Contains(PlaylistEntryId id) const;  // False once removed
+    const std::wstring& GetNameById(PlaylistEntryId id) const;  // Empty once removed
+    std::wstring GetPathById(PlaylistEntryId id) const;
+
+    // Bumped by every change to the entries or their order
+    uint64_t GetRevision() const { return m_revision; }
+
+    // Shuffle order: a permutation walked by a cursor (the current track's
+    // place in it). New entries land at a random place after the cursor;
+    // removed ones leave the order without disturbing what has played.
+    // Fresh order. firstIndex (if valid) goes first with the cursor on it;
+    // otherwise the cursor is before the start and notFirstIndex (if valid)
+    // isn't first, so a new cycle doesn't repeat the track just played.
+    void Shuffle(int firstIndex, int notFirstIndex = -1);
+    void ClearShuffle();
+    bool HasShuffle() const { return !m_shuffle.empty(); }
+    int GetShuffleLength() const { return static_cast<int>(m_shuffle.size()); }
+    int GetShuffleCursor() const { return m_shuffleCursor; }
+    void SetShuffleCursor(int pos) { m_shuffleCursor = pos; }
+    int GetShufflePos(int index) const;   // -1 if not in the order
+    int GetShuffledIndex(int pos) const;  // Playlist index at a place in the order, -1 if none
+
+private:
+    struct Node {
+        int left = -1, right = -1, parent = -1;
+        uint32_t priority = 0;
+        int size = 1;
+        int shufflePos = -1;
+        uint32_t folder = 0;
+        std::wstring name;
+        bool alive = false;
+    };
+
+    int NodeSize(int node) const { return node < 0 ? 0 : m_nodes[node].size; }
+    void Update(int node);
+    void Split(int node, int count, int& left, int& right);
+    int Merge(int left, int right);
+    int NodeAt(size_t index) const;
+    int IndexOfNode(int node) const;
+    int BuildTree(int first, int count);  // Over new nodes first..first+count-1, in order
+
+    int NewNode(const std::wstring& path);
+    void FreeNode(int node);  // Its slot (and so its ID) isn't reused until clear()
+    uint32_t InternFolder(const std::wstring& folder);
+
+    void AddToShuffle(int node);
+    void RemoveFromShuffle(int node);
+    void MoveShuffleEntry(int from, int to);
+    void SwapShuffleEntries(int a, int b);
+
+    std::vector<Node> m_nodes;  // Indexed by ID - m_idBase - 1
+    int m_root;
+    PlaylistEntryId m_idBase;  // IDs from before the last clear() never match again
+    std::mt19937 m_random;
+    uint64_t m_revision;
+
+    std::vector<std::wstring> m_folders;
+    std::unordered_map<std::wstring, uint32_t> m_folderIndex;
+
+    std::vector<int> m_shuffle;  // Nodes in shuffle order
+    int m_shuffleCursor;
+};
+
+#endif // FASTPLAY_PLAYLIST_H
@@ -0,0 +1,60 @@
+#pragma once
+#ifndef FASTPLAY_PLAYLIST_SEARCH_H
+#define FASTPLAY_PLAYLIST_SEARCH_H
+
+#include "playlist.h"
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+
+// Playlist search
+// A trigram index over each entry's name and, for files in the media library,
+// its title, artist and album. A query only reads the lists of entries that
+// hold every three-letter run of its words and checks those, so it stays in
+// the low milliseconds on playlists of hundreds of thousands of entries.
+//
+// The index follows the playlist by entry ID: each query first indexes the
+// entries added since the last one, removed entries are passed over when a
+// query meets them (and the index is rebuilt once they outnumber the rest),
+// and moves change nothing. A clear() starts it afresh.
+
+class PlaylistSearch {
+public:
+    PlaylistSearch();
+
+    // Playlist indexes of the entries containing every word of query (ignoring
+    // case), best first: names starting with a word, then a word in the name
+    // starting with it, then anywhere in the name, then only in the tags; in
+    // playlist order within each. At most limit of them; matchCount (if given)
+    // gets how many there were in all.
+    std::vector<int> Find(const Playlist& playlist, const std::wstring& query, size_t limit,
+                          size_t* matchCount = nullptr);
+
+private:
+    void Reset(PlaylistEntryId firstId);
+    void Sync(const Playlist& playlist);
+    void AddEntries(const Playlist& playlist, PlaylistEntryId first, PlaylistEntryId end);
+    std::vector<uint32_t> Candidates(const std::vector<std::wstring>& words) const;
+    int Rank(uint32_t slot, const std::vector<std::wstring>& words) const;  // -1 if a word is missing
+    void UpdateSlotIndexes(const Playlist& playlist);
+
+    PlaylistEntryId m_firstId;  // The playlist's first ID when last looked at
+    PlaylistEntryId m_nextId;   // The first ID not looked at yet
+
+    // Indexed entries by slot, in the order added (so by ID)
+    std::vector<PlaylistEntryId> m_ids;
+    std::vector<std::wstring> m_texts;   // Lowercased name, then a newline and the tags
+    std::vector<uint32_t> m_nameLengths;
+    std::vector<uint32_t> m_slotById;  // By ID - m_firstId
+
+    // Playlist index of each slot (-1 once removed) as of a playlist revision,
+    // for queries matching too many entries to look each one up
+    std::vector<int> m_slotIndexes;
+    uint64_t m_slotIndexesRevision;
+    bool m_slotIndexesValid;
+
+    std::unordered_map<uint64_t, std::vector<uint32_t>> m_trigrams;  // -> slots holding it, ascending
+};
+
+#endif // FASTPLAY_PLAYLIST_SEARCH_H
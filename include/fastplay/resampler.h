@@ -0,0 +1,78 @@
+#pragma once
+#ifndef FASTPLAY_RESAMPLER_H
+#define FASTPLAY_RESAMPLER_H
+
+#include <cstddef>
+#include <vector>
+#include "bass.h"
+
+// Resampler quality tiers (used for the Rate control and device rate conversion)
+enum class ResamplerQuality {
+    Native,     // BASS_ATTRIB_FREQ - BASS's own interpolation, no extra stage
+    Low,        // 8-tap sinc, nearest phase - cheap enough for older laptops
+    Medium,     // 24-tap sinc, interpolated phases
+    High,       // 64-tap sinc, interpolated phases - cleanest at extreme rates
+    COUNT
+};
+
+const char* GetResamplerQualityName(ResamplerQuality quality);
+
+// Polyphase windowed-sinc resampler
+// Keeps a planar history per channel and uses SSE for the filter inner loop
+class PolyphaseResampler {
+public:
+    PolyphaseResampler();
+
+    // Initialize for a channel count and quality tier (Native is treated as Low)
+    bool Init(int channels, ResamplerQuality quality);
+    void Reset();
+
+    // Ratio of input frames consumed per output frame
+    // (source rate * speed / output rate)
+    void SetRatio(double ratio);
+    double GetRatio() const { return m_ratio; }
+
+    // Append interleaved input frames
+    void Push(const float* input, size_t frames);
+
+    // Mark the end of input: pads the history so the tail can be drained
+    void Flush();
+
+    // Produce up to maxFrames interleaved output frames, returns frames written.
+    // Returns fewer than requested when more input is needed.
+    size_t Pull(float* output, size_t maxFrames);
+
+    int GetChannels() const { return m_channels; }
+    bool IsInitialized() const { return m_initialized; }
+
+private:
+    void BuildTable(double cutoff);
+    void Compact();
+
+    bool m_initialized;
+    ResamplerQuality m_quality;
+    int m_channels;
+    int m_taps;         // Filter length (even)
+    int m_paddedTaps;   // Filter length rounded up to a multiple of 4 for SSE
+    int m_phases;       // Number of fractional positions in the table
+    double m_kaiserBeta;
+    double m_cutoff;    // Cutoff the table was built for (fraction of Nyquist)
+    double m_ratio;
+    double m_pos;       // Position of the next output frame in the history
+
+    // Filter table: (m_phases + 1) rows of m_paddedTaps coefficients
+    std::vector<float> m_table;
+
+    // Planar input history per channel
+    std::vector<std::vector<float>> m_history;
+};
+
+// Decode stream that pulls from another decode stream (the tempo processor
+// output), applies the Rate multiplier and converts to the output device rate.
+// Freeing the returned stream also frees the wrapped stream.
+HSTREAM CreateResampledStream(HSTREAM decodeStream, ResamplerQuality quality, float rate);
+bool IsResampledStream(HSTREAM stream);
+void SetResampledStreamRate(HSTREAM stream, float rate);
+void ResetResampledStream(HSTREAM stream);  // Drop buffered audio after a seek
+
+#endif // FASTPLAY_RESAMPLER_H
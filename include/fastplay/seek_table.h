@@ -0,0 +1,25 @@
+#pragma once
+#ifndef FASTPLAY_SEEK_TABLE_H
+#define FASTPLAY_SEEK_TABLE_H
+
+#include <windows.h>
+#include <string>
+#include "bass.h"
+
+// Exact seeking in long MPEG files
+// Unless a file is prescanned, BASS seeks in VBR MP3s by estimate (or a
+// 100-point Xing table), which can land seconds off in a long audiobook.
+// Scanning at open time would stall the load, so long MPEG files are scanned
+// once in the background; the resulting seek info (BASS_ATTRIB_SCANINFO) is
+// stored in the database and applied whenever the file is opened again.
+
+// Apply the stored seek table to a newly opened file stream. Without one, a
+// file worth scanning is queued for the background scanner, which posts
+// WM_SEEK_TABLE_READY to the main window when it has stored a table.
+// Returns true if a table was applied.
+bool ApplySeekTable(HSTREAM source, const std::wstring& path);
+
+// Stop the scanner and drop queued scans (call before BASS_Free)
+void StopSeekScanner();
+
+#endif // FASTPLAY_SEEK_TABLE_H
@@ -16,10 +16,12 @@ void LoadDSPSettings();  // Call after InitEffects()
 // Playback state persistence
 void SavePlaybackState();
 void LoadPlaybackState();
+void RestoreSavedPlaylist();  // Rest of the playlist LoadPlaybackState started
 
 // Per-file position tracking
 void SaveFilePosition(const std::wstring& filePath);
 double LoadFilePosition(const std::wstring& filePath);
+double LoadFilePosition(const std::wstring& filePath, double length);
 
 // Seek amount cycling
 void CycleSeekAmount(int direction);
@@ -23,8 +23,10 @@ public:
     virtual ~TempoProcessor() = default;
 
     // Initialize the processor for a given source stream
-    // Returns the playback stream (may be same as source or a wrapper)
-    virtual HSTREAM Initialize(HSTREAM sourceStream, float sampleRate) = 0;
+    // Returns the playback stream (may be same as source or a wrapper).
+    // flags are extra BASS flags for that stream - pass BASS_STREAM_DECODE when
+    // another stage (the resampler, the output mixer) pulls from it.
+    virtual HSTREAM Initialize(HSTREAM sourceStream, float sampleRate, DWORD flags) = 0;
 
     // Clean up resources
     virtual void Shutdown() = 0;
@@ -70,4 +72,8 @@ void InitTempoProcessor();
 void FreeTempoProcessor();
 TempoProcessor* GetTempoProcessor();
 
+// Replace the global instance with one the caller created (takes ownership and
+// frees the previous one) - used when a pre-rolled track becomes current
+void AdoptTempoProcessor(TempoProcessor* processor);
+
 #endif // FASTPLAY_TEMPO_PROCESSOR_H
@@ -7,6 +7,10 @@
 #include <vector>
 #include "database.h"
 
+// Check if a file extension (".mp3") is a supported audio format
+bool IsSupportedAudioExt(const std::wstring& ext);
+bool IsSupportedAudioExt(const wchar_t* ext);
+
 // Playlist file handling
 bool IsPlaylistFile(const std::wstring& path);
 std::vector<std::wstring> ParsePlaylist(const std::wstring& playlistPath);
@@ -39,6 +43,7 @@ void ShowSaveEffectPresetDialog();
 void ShowOptionsDialog();
 void ShowBookmarksDialog();
 void ShowSongHistoryDialog();
+void ShowSearchDialog();
 void ShowRadioDialog();
 void AddCurrentStreamToFavorites();
 void ShowSchedulerDialog();
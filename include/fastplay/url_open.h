@@ -0,0 +1,36 @@
+#pragma once
+#ifndef FASTPLAY_URL_OPEN_H
+#define FASTPLAY_URL_OPEN_H
+
+#include <windows.h>
+#include <string>
+#include "bass.h"
+
+// Ways of opening a network stream, in order of preference: AAC first (handles
+// raw AAC/M4A better), then generic; non-BLOCK (seekable, for podcasts) before
+// BLOCK (needed by some live streams). Stored in the database - don't reorder.
+enum class UrlOpenStrategy {
+    AacSeekable,
+    GenericSeekable,
+    AacBlock,
+    GenericBlock,
+    COUNT
+};
+
+// Open a URL as a float decode stream with status, trying every strategy at
+// once. The most preferred strategy that succeeds wins (a less preferred one
+// that connects first waits a moment for it); the others are freed as they
+// finish. With a valid 'preferred' strategy (the one that worked last time for
+// this host) it gets a head start and the others only launch if it stalls.
+// Returns 0 on failure with the BASS error code in *error.
+HSTREAM OpenUrlStream(const std::string& urlUtf8, int preferred, int* winner, int* error);
+
+// Stop the racers earlier opens left behind (call before BASS_Free). Ones still
+// waiting out a head start give up; ones connecting are waited for, as BASS
+// can't abort a connect.
+void StopUrlOpens();
+
+// Lower-cased host name of a URL (key for the remembered strategy)
+std::wstring GetUrlHost(const std::wstring& url);
+
+#endif // FASTPLAY_URL_OPEN_H
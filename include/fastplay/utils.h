@@ -3,6 +3,7 @@
 #define FASTPLAY_UTILS_H
 
 #include <string>
+#include <cstdint>
 
 // String conversion
 std::string WideToUtf8(const std::wstring& wide);
@@ -11,6 +12,10 @@ std::wstring Utf8ToWide(const std::string& utf8);
 // Extract filename from path
 std::wstring GetFileName(const std::wstring& path);
 
+// Size and last write time (FILETIME ticks) of a file, which stored
+// per-file results (seek tables, loudness) must match to stay valid
+bool GetFileIdentity(const std::wstring& path, int64_t& size, int64_t& modified);
+
 // Format time as M:SS or H:MM:SS
 std::wstring FormatTime(double seconds);
 
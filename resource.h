@@ -15,6 +15,7 @@
 #define IDD_PLAYLIST        930
 #define IDC_PLAYLIST_LIST   931
 #define IDC_PLAYLIST_SAVE   932
+#define IDC_PLAYLIST_FILTER 933
 
 // URL dialog
 #define IDD_URL             650
@@ -56,6 +57,10 @@
 #define WM_ADDFILE          (WM_USER + 2)
 #define WM_META_CHANGED     (WM_USER + 3)
 #define WM_PLAYLIST_TRACK_CHANGED (WM_USER + 4)
+#define WM_TRACK_LOADED     (WM_USER + 5)
+#define WM_SEEK_TABLE_READY (WM_USER + 6)
+#define WM_PLAYLIST_RESTORE (WM_USER + 7)
+#define WM_PREROLL_LOADED   (WM_USER + 8)
 
 // Playback tab controls
 #define IDC_BRING_TO_FRONT  531
@@ -160,6 +165,7 @@
 #define IDC_DSP_STEREOWIDTH 564
 #define IDC_DSP_CENTERCANCEL 565
 #define IDC_DSP_SPATIAL     566
+#define IDC_DSP_DOWNMIX     567
 
 // Advanced tab controls
 #define IDC_BUFFER_SIZE     570
@@ -171,6 +177,9 @@
 #define IDC_LEGACY_VOLUME   576
 #define IDC_DISABLE_BATCH   577
 #define IDC_RESET_LIST_ORDER 578
+#define IDC_RESAMPLER_QUALITY 579
+#define IDC_READ_AHEAD      590
+#define IDC_READ_AHEAD_LABEL 591
 
 // SoundTouch settings (tab 7)
 #define IDC_ST_AA_FILTER        580
@@ -296,6 +305,7 @@
 // Scheduler timer
 #define IDT_SCHEDULER       402
 #define IDT_SCHED_DURATION  403
+#define IDT_CONFIG_FLUSH    404
 
 // Chapter seeking
 #define IDC_CHAPTER_SEEK    900
@@ -310,6 +320,12 @@
 #define IDC_REPLAYGAIN_PREAMP 907
 #define IDC_REPLAYGAIN_PREAMP_LABEL 908
 #define IDC_REPLAYGAIN_CLIP   909
+#define IDC_GAPLESS           912
+#define IDC_CROSSFADE         913
+#define IDC_CROSSFADE_LABEL   914
+#define IDC_CROSSFADE_CURVE   917
+#define IDC_CROSSFADE_CURVE_LABEL 918
+#define IDC_CROSSFADE_SMART   919
 
 // Tag view dialog
 #define IDD_TAG_VIEW        910
@@ -384,6 +400,12 @@
 #define IDC_HISTORY_COPY        993
 #define IDC_HISTORY_CLEAR       994
 
+// Search dialog
+#define IDM_FILE_SEARCH         1000
+#define IDD_SEARCH              1001
+#define IDC_SEARCH_EDIT         1002
+#define IDC_SEARCH_RESULTS      1003
+
 
 #define IDOK                1
 #define IDCANCEL            2
@@ -0,0 +1,292 @@
+#include "config_store.h"
+#include "globals.h"
+#include "resource.h"
+#include <vector>
+#include <unordered_map>
+#include <mutex>
+#include <cwctype>
+#include <cstdio>
+#include <cstdlib>
+
+struct ConfigEntry {
+    std::wstring key;    // Empty for a comment line, kept as it was in value
+    std::wstring value;
+};
+
+struct ConfigSection {
+    std::wstring name;
+    std::vector<ConfigEntry> entries;
+    std::unordered_map<std::wstring, size_t> index;  // Folded key -> entry
+};
+
+static std::mutex g_configMutex;
+static std::wstring g_configFile;
+static std::vector<ConfigSection> g_sections;  // In file order
+static std::unordered_map<std::wstring, size_t> g_sectionIndex;  // Folded name -> section
+static bool g_configDirty = false;
+
+// Case-insensitive lookups go through a lowercased copy of the name
+static std::wstring Fold(const wchar_t* s) {
+    std::wstring folded(s);
+    for (auto& c : folded) c = static_cast<wchar_t>(towlower(c));
+    return folded;
+}
+
+static std::wstring Trim(const std::wstring& s) {
+    size_t start = s.find_first_not_of(L" \t");
+    if (start == std::wstring::npos) return std::wstring();
+    size_t end = s.find_last_not_of(L" \t");
+    return s.substr(start, end - start + 1);
+}
+
+static void RebuildSectionIndex() {
+    g_sectionIndex.clear();
+    for (size_t i = 0; i < g_sections.size(); i++) {
+        g_sectionIndex.emplace(Fold(g_sections[i].name.c_str()), i);
+    }
+}
+
+static void RebuildKeyIndex(ConfigSection& section) {
+    section.index.clear();
+    for (size_t i = 0; i < section.entries.size(); i++) {
+        if (!section.entries[i].key.empty()) {
+            section.index.emplace(Fold(section.entries[i].key.c_str()), i);
+        }
+    }
+}
+
+static ConfigSection* FindSection(const wchar_t* name) {
+    auto found = g_sectionIndex.find(Fold(name));
+    return found == g_sectionIndex.end() ? nullptr : &g_sections[found->second];
+}
+
+static ConfigSection& AddSection(const wchar_t* name) {
+    ConfigSection* existing = FindSection(name);
+    if (existing) return *existing;
+    ConfigSection section;
+    section.name = name;
+    g_sections.push_back(std::move(section));
+    g_sectionIndex.emplace(Fold(name), g_sections.size() - 1);
+    return g_sections.back();
+}
+
+static const std::wstring* FindValue(const wchar_t* section, const wchar_t* key) {
+    ConfigSection* s = FindSection(section);
+    if (!s) return nullptr;
+    auto found = s->index.find(Fold(key));
+    return found == s->index.end() ? nullptr : &s->entries[found->second].value;
+}
+
+// The INI is UTF-16 with a BOM as written by the profile API on a Unicode
+// file; older ones may be UTF-8 or in the ANSI code page
+static std::wstring DecodeConfigText(const std::string& bytes) {
+    if (bytes.size() >= 2 && static_cast<unsigned char>(bytes[0]) == 0xFF &&
+        static_cast<unsigned char>(bytes[1]) == 0xFE) {
+        return std::wstring(reinterpret_cast<const wchar_t*>(bytes.data() + 2), (bytes.size() - 2) / sizeof(wchar_t));
+    }
+
+    const char* text = bytes.data();
+    int length = static_cast<int>(bytes.size());
+    if (length >= 3 && static_cast<unsigned char>(text[0]) == 0xEF &&
+        static_cast<unsigned char>(text[1]) == 0xBB && static_cast<unsigned char>(text[2]) == 0xBF) {
+        text += 3;
+        length -= 3;
+    }
+    if (length == 0) return std::wstring();
+
+    UINT codePage = CP_UTF8;
+    int wideLength = MultiByteToWideChar(CP_UTF8, MB_ERR_INVALID_CHARS, text, length, nullptr, 0);
+    if (wideLength == 0) {
+        codePage = CP_ACP;
+        wideLength = MultiByteToWideChar(CP_ACP, 0, text, length, nullptr, 0);
+    }
+    std::wstring wide(wideLength, L'\0');
+    MultiByteToWideChar(codePage, 0, text, length, &wide[0], wideLength);
+    return wide;
+}
+
+static void ParseConfig(const std::wstring& text) {
+    g_sections.clear();
+    g_sectionIndex.clear();
+
+    ConfigSection* current = nullptr;
+    size_t pos = 0;
+    while (pos < text.size()) {
+        size_t end = text.find_first_of(L"\r\n", pos);
+        if (end == std::wstring::npos) end = text.size();
+        std::wstring line = Trim(text.substr(pos, end - pos));
+        pos = end + 1;
+        if (end < text.size() && text[end] == L'\r' && pos < text.size() && text[pos] == L'\n') pos++;
+
+        if (line.empty()) continue;
+        if (line[0] == L'[') {
+            size_t close = line.find(L']');
+            std::wstring name = Trim(line.substr(1, close == std::wstring::npos ? std::wstring::npos : close - 1));
+            current = &AddSection(name.c_str());
+            continue;
+        }
+        if (!current) continue;  // Lines before the first section are ignored, as by the profile API
+
+        ConfigEntry entry;
+        size_t equals = line.find(L'=');
+        if (line[0] == L';' || equals == std::wstring::npos) {
+            entry.value = line;
+        } else {
+            entry.key = Trim(line.substr(0, equals));
+            entry.value = Trim(line.substr(equals + 1));
+            if (entry.key.empty()) continue;
+            auto found = current->index.find(Fold(entry.key.c_str()));
+            if (found != current->index.end()) continue;  // First one wins
+            current->index.emplace(Fold(entry.key.c_str()), current->entries.size());
+        }
+        current->entries.push_back(std::move(entry));
+    }
+}
+
+void LoadConfig(const std::wstring& path) {
+    std::string bytes;
+    FILE* f = _wfopen(path.c_str(), L"rb");
+    if (f) {
+        char chunk[16384];
+        size_t read;
+        while ((read = fread(chunk, 1, sizeof(chunk), f)) > 0) {
+            bytes.append(chunk, read);
+        }
+        fclose(f);
+    }
+
+    std::lock_guard<std::mutex> lock(g_configMutex);
+    g_configFile = path;
+    ParseConfig(DecodeConfigText(bytes));
+    g_configDirty = false;
+}
+
+// Mark the store changed and (re)start the countdown to writing it
+static void ConfigChanged() {
+    g_configDirty = true;
+    if (g_hwnd) {
+        SetTimer(g_hwnd, IDT_CONFIG_FLUSH, CONFIG_FLUSH_DELAY, nullptr);
+    }
+}
+
+bool FlushConfig() {
+    std::wstring text;
+    std::wstring path;
+    {
+        std::lock_guard<std::mutex> lock(g_configMutex);
+        if (!g_configDirty || g_configFile.empty()) return true;
+
+        text.push_back(L'\xFEFF');
+        for (const auto& section : g_sections) {
+            if (text.size() > 1) text += L"\r\n";  // Blank line between sections
+            text += L"[" + section.name + L"]\r\n";
+            for (const auto& entry : section.entries) {
+                if (entry.key.empty()) {
+                    text += entry.value + L"\r\n";
+                } else {
+                    text += entry.key + L"=" + entry.value + L"\r\n";
+                }
+            }
+        }
+        path = g_configFile;
+        g_configDirty = false;
+    }
+
+    // Write beside the INI and swap it in, so the old file stays whole until the new one is
+    std::wstring tempPath = path + L".tmp";
+    FILE* f = _wfopen(tempPath.c_str(), L"wb");
+    bool ok = false;
+    if (f) {
+        size_t bytes = text.size() * sizeof(wchar_t);
+        ok = fwrite(text.data(), 1, bytes, f) == bytes;
+        ok = (fflush(f) == 0) && ok;
+        fclose(f);
+    }
+    ok = ok && MoveFileExW(tempPath.c_str(), path.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH);
+    if (!ok) {
+        DeleteFileW(tempPath.c_str());
+        std::lock_guard<std::mutex> lock(g_configMutex);
+        g_configDirty = true;  // Try again with the next save
+    }
+    return ok;
+}
+
+int ConfigGetInt(const wchar_t* section, const wchar_t* key, int defaultVal) {
+    std::lock_guard<std::mutex> lock(g_configMutex);
+    const std::wstring* value = FindValue(section, key);
+    if (!value) return defaultVal;
+    return static_cast<int>(wcstol(value->c_str(), nullptr, 10));
+}
+
+float ConfigGetFloat(const wchar_t* section, const wchar_t* key, float defaultVal) {
+    std::lock_guard<std::mutex> lock(g_configMutex);
+    const std::wstring* value = FindValue(section, key);
+    if (!value || value->empty()) return defaultVal;
+    return static_cast<float>(_wtof(value->c_str()));
+}
+
+std::wstring ConfigGetString(const wchar_t* section, const wchar_t* key, const wchar_t* defaultVal) {
+    std::lock_guard<std::mutex> lock(g_configMutex);
+    const std::wstring* value = FindValue(section, key);
+    if (!value) return defaultVal ? defaultVal : L"";
+    if (value->size() >= 2 && value->front() == L'"' && value->back() == L'"') {
+        return value->substr(1, value->size() - 2);
+    }
+    return *value;
+}
+
+DWORD ConfigGetString(const wchar_t* section, const wchar_t* key, const wchar_t* defaultVal,
+                      wchar_t* buf, DWORD size) {
+    if (!buf || size == 0) return 0;
+    std::wstring value = ConfigGetString(section, key, defaultVal);
+    DWORD length = static_cast<DWORD>(value.size());
+    if (length > size - 1) length = size - 1;
+    wmemcpy(buf, value.c_str(), length);
+    buf[length] = L'\0';
+    return length;
+}
+
+void ConfigWriteString(const wchar_t* section, const wchar_t* key, const wchar_t* value) {
+    std::lock_guard<std::mutex> lock(g_configMutex);
+
+    if (!key) {
+        auto found = g_sectionIndex.find(Fold(section));
+        if (found == g_sectionIndex.end()) return;
+        g_sections.erase(g_sections.begin() + found->second);
+        RebuildSectionIndex();
+        ConfigChanged();
+        return;
+    }
+
+    if (!value) {
+        ConfigSection* s = FindSection(section);
+        if (!s) return;
+        auto found = s->index.find(Fold(key));
+        if (found == s->index.end()) return;
+        s->entries.erase(s->entries.begin() + found->second);
+        RebuildKeyIndex(*s);
+        ConfigChanged();
+        return;
+    }
+
+    ConfigSection& s = AddSection(section);
+    std::wstring folded = Fold(key);
+    auto found = s.index.find(folded);
+    if (found != s.index.end()) {
+        if (s.entries[found->second].value == value) return;
+        s.entries[found->second].value = value;
+    } else {
+        s.index.emplace(folded, s.entries.size());
+        s.entries.push_back(ConfigEntry{key, value});
+    }
+    ConfigChanged();
+}
+
+void ConfigClearSection(const wchar_t* section) {
+    std::lock_guard<std::mutex> lock(g_configMutex);
+    ConfigSection* s = FindSection(section);
+    if (!s || s->entries.empty()) return;
+    s->entries.clear();
+    s->index.clear();
+    ConfigChanged();
+}
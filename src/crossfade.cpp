@@ -0,0 +1,325 @@
+#include "crossfade.h"
+#include <cmath>
+#include <cstring>
+#include <mutex>
+#include <vector>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE__)
+#include <xmmintrin.h>
+#define CROSSFADE_SSE
+#endif
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+// Curve gains are evaluated every this many frames and interpolated linearly
+// in between, so the per-sample work is a multiply-add regardless of curve
+static const size_t CURVE_SEGMENT_FRAMES = 64;
+
+// Smart crossfade treats anything quieter than this as silence (about -48 dBFS)
+static const float SILENCE_LEVEL = 0.004f;
+
+const char* GetCrossfadeCurveName(CrossfadeCurve curve) {
+    switch (curve) {
+        case CrossfadeCurve::Linear: return "Linear";
+        case CrossfadeCurve::EqualPower: return "Equal power";
+        case CrossfadeCurve::SCurve: return "S-curve";
+        default: return "";
+    }
+}
+
+// Gains of the outgoing and incoming track at fade progress x (0..1)
+static void CurveGains(CrossfadeCurve curve, double x, float* gainOut, float* gainIn) {
+    if (x <= 0.0) { *gainOut = 1.0f; *gainIn = 0.0f; return; }
+    if (x >= 1.0) { *gainOut = 0.0f; *gainIn = 1.0f; return; }
+    switch (curve) {
+        case CrossfadeCurve::EqualPower:
+            *gainOut = static_cast<float>(cos(x * M_PI * 0.5));
+            *gainIn = static_cast<float>(sin(x * M_PI * 0.5));
+            break;
+        case CrossfadeCurve::SCurve: {
+            double s = x * x * (3.0 - 2.0 * x);
+            *gainOut = static_cast<float>(1.0 - s);
+            *gainIn = static_cast<float>(s);
+            break;
+        }
+        default:
+            *gainOut = static_cast<float>(1.0 - x);
+            *gainIn = static_cast<float>(x);
+            break;
+    }
+}
+
+// out = out * gainOut + in * gainIn, with both gains ramping linearly per frame
+static void BlendSegment(float* out, const float* in, size_t frames, int chans,
+                         float gainOut, float stepOut, float gainIn, float stepIn) {
+    size_t f = 0;
+#ifdef CROSSFADE_SSE
+    if (chans == 1 || chans == 2) {
+        // Four samples per vector: four mono frames or two stereo frames
+        size_t framesPerVec = 4 / chans;
+        float laneOut[4], laneIn[4];
+        for (int lane = 0; lane < 4; lane++) {
+            float frameOffset = static_cast<float>(lane / chans);
+            laneOut[lane] = gainOut + stepOut * frameOffset;
+            laneIn[lane] = gainIn + stepIn * frameOffset;
+        }
+        __m128 vOut = _mm_loadu_ps(laneOut);
+        __m128 vIn = _mm_loadu_ps(laneIn);
+        __m128 vStepOut = _mm_set1_ps(stepOut * framesPerVec);
+        __m128 vStepIn = _mm_set1_ps(stepIn * framesPerVec);
+        for (; f + framesPerVec <= frames; f += framesPerVec) {
+            float* o = out + f * chans;
+            const float* i = in + f * chans;
+            __m128 mixed = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(o), vOut), _mm_mul_ps(_mm_loadu_ps(i), vIn));
+            _mm_storeu_ps(o, mixed);
+            vOut = _mm_add_ps(vOut, vStepOut);
+            vIn = _mm_add_ps(vIn, vStepIn);
+        }
+    } else {
+        // Surround: one gain per frame, broadcast across the channels
+        for (; f < frames; f++) {
+            float go = gainOut + stepOut * f;
+            float gi = gainIn + stepIn * f;
+            __m128 vOut = _mm_set1_ps(go);
+            __m128 vIn = _mm_set1_ps(gi);
+            float* o = out + f * chans;
+            const float* i = in + f * chans;
+            int c = 0;
+            for (; c + 4 <= chans; c += 4) {
+                _mm_storeu_ps(o + c, _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(o + c), vOut),
+                                                _mm_mul_ps(_mm_loadu_ps(i + c), vIn)));
+            }
+            for (; c < chans; c++) {
+                o[c] = o[c] * go + i[c] * gi;
+            }
+        }
+    }
+#endif
+    // Scalar path (and the frames left over from the packed mono/stereo loop)
+    for (; f < frames; f++) {
+        float go = gainOut + stepOut * f;
+        float gi = gainIn + stepIn * f;
+        float* o = out + f * chans;
+        const float* i = in + f * chans;
+        for (int c = 0; c < chans; c++) {
+            o[c] = o[c] * go + i[c] * gi;
+        }
+    }
+}
+
+void BlendCrossfade(float* outgoing, const float* incoming, size_t frames, int chans,
+                    double x0, double dx, CrossfadeCurve curve, float inGain) {
+    if (!outgoing || !incoming || chans <= 0) return;
+
+    size_t f = 0;
+    while (f < frames) {
+        double x = x0 + dx * f;
+        size_t n = frames - f;
+        float startOut, startIn, endOut, endIn;
+        CurveGains(curve, x, &startOut, &startIn);
+        if (x >= 1.0) {
+            // Past the fade: the incoming track alone for the rest of the block
+            endOut = startOut;
+            endIn = startIn;
+        } else {
+            if (n > CURVE_SEGMENT_FRAMES) n = CURVE_SEGMENT_FRAMES;
+            // End a segment where the fade does, so the ramp doesn't cut the corner
+            if (dx > 0.0) {
+                double toEnd = ceil((1.0 - x) / dx);
+                if (toEnd >= 1.0 && toEnd < static_cast<double>(n)) n = static_cast<size_t>(toEnd);
+            }
+            CurveGains(curve, x0 + dx * (f + n), &endOut, &endIn);
+        }
+        float stepOut = (endOut - startOut) / n;
+        float stepIn = (endIn - startIn) / n;
+        BlendSegment(outgoing + f * chans, incoming + f * chans, n, chans,
+                     startOut, stepOut, startIn * inGain, stepIn * inGain);
+        f += n;
+    }
+}
+
+bool FindAudibleRange(const wchar_t* path, double from, double to, double* first, double* last) {
+    if (!path || to <= from) return false;
+
+    HSTREAM stream = BASS_StreamCreateFile(FALSE, path, 0, 0, BASS_UNICODE | BASS_STREAM_DECODE | BASS_SAMPLE_FLOAT);
+    if (!stream) return false;
+
+    BASS_CHANNELINFO info;
+    if (!BASS_ChannelGetInfo(stream, &info) || info.chans == 0 || info.freq == 0) {
+        BASS_StreamFree(stream);
+        return false;
+    }
+    if (from > 0) {
+        BASS_ChannelSetPosition(stream, BASS_ChannelSeconds2Bytes(stream, from), BASS_POS_BYTE);
+    }
+    QWORD startByte = BASS_ChannelGetPosition(stream, BASS_POS_BYTE);
+    double start = (startByte == static_cast<QWORD>(-1)) ? from : BASS_ChannelBytes2Seconds(stream, startByte);
+
+    const int chans = static_cast<int>(info.chans);
+    const int64_t endFrame = static_cast<int64_t>((to - start) * info.freq);
+    int64_t frame = 0;
+    int64_t firstFrame = -1;
+    int64_t lastFrame = -1;
+
+    // ~50 ms blocks
+    std::vector<float> block((info.freq / 20 + 1) * chans);
+    while (frame < endFrame) {
+        DWORD got = BASS_ChannelGetData(stream, block.data(), static_cast<DWORD>(block.size() * sizeof(float)));
+        if (got == static_cast<DWORD>(-1) || got == 0) break;
+        int64_t frames = got / (sizeof(float) * chans);
+        if (frame + frames > endFrame) frames = endFrame - frame;
+        for (int64_t i = 0; i < frames; i++) {
+            const float* s = block.data() + i * chans;
+            for (int c = 0; c < chans; c++) {
+                if (fabsf(s[c]) > SILENCE_LEVEL) {
+                    if (firstFrame < 0) firstFrame = frame + i;
+                    lastFrame = frame + i;
+                    break;
+                }
+            }
+        }
+        frame += frames;
+    }
+    BASS_StreamFree(stream);
+
+    if (firstFrame < 0) return false;
+    if (first) *first = start + static_cast<double>(firstFrame) / info.freq;
+    if (last) *last = start + static_cast<double>(lastFrame + 1) / info.freq;
+    return true;
+}
+
+// ============================================================================
+// Crossfade engine
+// ============================================================================
+
+struct CrossfadeState {
+    std::mutex mutex;               // Guards everything below (DSP vs UI thread)
+    HSTREAM outgoing = 0;
+    HSTREAM incoming = 0;           // 0 once handed to the mixer (or not armed)
+    HDSP dsp = 0;
+    int chans = 2;
+    int64_t framesSeen = 0;         // Outgoing frames processed since arming
+    int64_t fadeStart = 0;
+    int64_t fadeFrames = 1;
+    CrossfadeCurve curve = CrossfadeCurve::EqualPower;
+    float inGain = 1.0f;
+    bool incomingEnded = false;
+    std::vector<float> scratch;     // Incoming audio for the current block
+};
+static CrossfadeState g_crossfade;
+
+// DSP on the outgoing stream: from fadeStart on, pull the incoming track in step
+// with the outgoing one and blend the two
+static void CALLBACK CrossfadeDSPProc(HDSP handle, DWORD channel, void* buffer, DWORD length, void* user) {
+    CrossfadeState& cf = g_crossfade;
+    std::lock_guard<std::mutex> lock(cf.mutex);
+    if (!cf.incoming || !buffer) return;
+
+    const int chans = cf.chans;
+    int64_t frames = length / (sizeof(float) * chans);
+    int64_t begin = cf.framesSeen;
+    cf.framesSeen += frames;
+    if (cf.framesSeen <= cf.fadeStart) return;
+
+    int64_t skip = (cf.fadeStart > begin) ? cf.fadeStart - begin : 0;
+    int64_t n = frames - skip;
+    size_t samples = static_cast<size_t>(n * chans);
+    if (cf.scratch.size() < samples) {
+        cf.scratch.resize(samples);  // Only if the mixer asks for more than Arm allowed for
+    }
+
+    // Decode the same number of frames from the incoming track
+    DWORD wanted = static_cast<DWORD>(samples * sizeof(float));
+    DWORD got = 0;
+    while (!cf.incomingEnded && got < wanted) {
+        DWORD r = BASS_ChannelGetData(cf.incoming, reinterpret_cast<BYTE*>(cf.scratch.data()) + got, wanted - got);
+        if (r == static_cast<DWORD>(-1) || r == 0) {
+            if (BASS_ChannelIsActive(cf.incoming) == BASS_ACTIVE_STOPPED) cf.incomingEnded = true;
+            break;
+        }
+        got += r;
+    }
+    if (got < wanted) {
+        memset(reinterpret_cast<BYTE*>(cf.scratch.data()) + got, 0, wanted - got);
+    }
+
+    double x0 = static_cast<double>(begin + skip - cf.fadeStart) / cf.fadeFrames;
+    BlendCrossfade(static_cast<float*>(buffer) + skip * chans, cf.scratch.data(), static_cast<size_t>(n), chans,
+                   x0, 1.0 / cf.fadeFrames, cf.curve, cf.inGain);
+}
+
+bool CanCrossfade(HSTREAM outgoing, HSTREAM incoming) {
+    if (!outgoing || !incoming) return false;
+    BASS_CHANNELINFO outInfo, inInfo;
+    if (!BASS_ChannelGetInfo(outgoing, &outInfo) || !BASS_ChannelGetInfo(incoming, &inInfo)) return false;
+    if (!(outInfo.flags & BASS_SAMPLE_FLOAT) || !(inInfo.flags & BASS_SAMPLE_FLOAT)) return false;
+    if (outInfo.chans != inInfo.chans) return false;
+
+    // The blend is sample-for-sample, so both must run at the same rate
+    // (after any Rate change applied through the frequency attribute)
+    float outFreq = 0.0f, inFreq = 0.0f;
+    BASS_ChannelGetAttribute(outgoing, BASS_ATTRIB_FREQ, &outFreq);
+    BASS_ChannelGetAttribute(incoming, BASS_ATTRIB_FREQ, &inFreq);
+    return outFreq > 0.0f && fabsf(outFreq - inFreq) < 0.5f;
+}
+
+bool ArmCrossfade(HSTREAM outgoing, HSTREAM incoming, int64_t fadeStart, int64_t fadeFrames,
+                  CrossfadeCurve curve, float inGain) {
+    CancelCrossfade();
+    if (!CanCrossfade(outgoing, incoming) || fadeFrames <= 0) return false;
+
+    BASS_CHANNELINFO info;
+    BASS_ChannelGetInfo(outgoing, &info);
+    {
+        std::lock_guard<std::mutex> lock(g_crossfade.mutex);
+        g_crossfade.outgoing = outgoing;
+        g_crossfade.incoming = incoming;
+        g_crossfade.chans = static_cast<int>(info.chans);
+        g_crossfade.framesSeen = 0;
+        g_crossfade.fadeStart = fadeStart > 0 ? fadeStart : 0;
+        g_crossfade.fadeFrames = fadeFrames;
+        g_crossfade.curve = curve;
+        g_crossfade.inGain = inGain;
+        g_crossfade.incomingEnded = false;
+        // A second of audio covers any mixer block, so the DSP never allocates
+        size_t samples = static_cast<size_t>(info.freq) * info.chans;
+        if (g_crossfade.scratch.size() < samples) g_crossfade.scratch.resize(samples);
+    }
+
+    // Lowest priority: blend after anything else on the outgoing stream
+    HDSP dsp = BASS_ChannelSetDSP(outgoing, CrossfadeDSPProc, nullptr, -1000);
+    std::lock_guard<std::mutex> lock(g_crossfade.mutex);
+    if (!dsp) {
+        g_crossfade.outgoing = 0;
+        g_crossfade.incoming = 0;
+        return false;
+    }
+    g_crossfade.dsp = dsp;
+    return true;
+}
+
+void CancelCrossfade() {
+    HSTREAM outgoing;
+    HDSP dsp;
+    {
+        std::lock_guard<std::mutex> lock(g_crossfade.mutex);
+        outgoing = g_crossfade.outgoing;
+        dsp = g_crossfade.dsp;
+        g_crossfade.outgoing = 0;
+        g_crossfade.incoming = 0;
+        g_crossfade.dsp = 0;
+    }
+    // Outside the lock: removing a DSP waits for a running callback to finish
+    if (outgoing && dsp) {
+        BASS_ChannelRemoveDSP(outgoing, dsp);
+    }
+}
+
+HSTREAM TakeCrossfadeIncoming() {
+    std::lock_guard<std::mutex> lock(g_crossfade.mutex);
+    HSTREAM incoming = g_crossfade.incoming;
+    g_crossfade.incoming = 0;  // The DSP passes the outgoing track through from here on
+    return incoming;
+}
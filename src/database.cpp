@@ -2,14 +2,562 @@
 #include "sqlite3.h"
 #include "utils.h"
 #include "updater.h"
+#include "fingerprint.h"
 #include <windows.h>
 #include <shlobj.h>
 #include <ctime>
 #include <vector>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <functional>
+#include <thread>
+#include <condition_variable>
+#include <atomic>
+#include <chrono>
+#include <cwctype>
 
 static sqlite3* g_db = nullptr;
 static std::wstring g_dbPath;
 
+// The library scanner and loudness analyzer write through their own connection
+// (WAL lets UI queries on g_db read alongside a long scan); the mutex
+// serializes their threads
+static sqlite3* g_libraryDb = nullptr;
+static std::mutex g_libraryDbMutex;
+
+// Statements run per track or per event are prepared on g_db once, on first
+// use, and kept until the database closes. A call borrows one through
+// CachedStatement, which holds the cache lock for its lifetime (g_db is read
+// from more than one thread) and resets the statement and clears its
+// bindings when it goes out of scope. It converts to sqlite3_stmt*, so it
+// binds and steps like a freshly prepared statement.
+static std::unordered_map<std::string, sqlite3_stmt*> g_statements;
+static std::recursive_mutex g_statementMutex;
+
+class CachedStatement {
+public:
+    explicit CachedStatement(const char* sql) : m_lock(g_statementMutex), m_stmt(nullptr) {
+        if (!g_db) return;
+        auto found = g_statements.find(sql);
+        if (found != g_statements.end()) {
+            m_stmt = found->second;
+            return;
+        }
+        if (sqlite3_prepare_v3(g_db, sql, -1, SQLITE_PREPARE_PERSISTENT, &m_stmt, nullptr) != SQLITE_OK) {
+            sqlite3_finalize(m_stmt);
+            m_stmt = nullptr;
+            return;
+        }
+        g_statements.emplace(sql, m_stmt);
+    }
+
+    ~CachedStatement() {
+        if (m_stmt) {
+            sqlite3_reset(m_stmt);
+            sqlite3_clear_bindings(m_stmt);
+        }
+    }
+
+    CachedStatement(const CachedStatement&) = delete;
+    CachedStatement& operator=(const CachedStatement&) = delete;
+
+    operator sqlite3_stmt*() const { return m_stmt; }
+
+private:
+    std::unique_lock<std::recursive_mutex> m_lock;
+    sqlite3_stmt* m_stmt;
+};
+
+static void FinalizeCachedStatements() {
+    std::lock_guard<std::recursive_mutex> lock(g_statementMutex);
+    for (auto& entry : g_statements) {
+        sqlite3_finalize(entry.second);
+    }
+    g_statements.clear();
+}
+
+// A transaction on g_db, so a many-row write commits once rather than once
+// per row. It holds the cache lock too, so another thread's write can't land
+// inside it. Rolled back unless committed.
+class DbTransaction {
+public:
+    DbTransaction()
+        : m_lock(g_statementMutex),
+          m_open(g_db && sqlite3_exec(g_db, "BEGIN;", nullptr, nullptr, nullptr) == SQLITE_OK) {
+    }
+
+    ~DbTransaction() {
+        if (m_open) sqlite3_exec(g_db, "ROLLBACK;", nullptr, nullptr, nullptr);
+    }
+
+    DbTransaction(const DbTransaction&) = delete;
+    DbTransaction& operator=(const DbTransaction&) = delete;
+
+    bool IsOpen() const { return m_open; }
+
+    bool Commit() {
+        if (!m_open) return false;
+        m_open = false;
+        return sqlite3_exec(g_db, "COMMIT;", nullptr, nullptr, nullptr) == SQLITE_OK;
+    }
+
+private:
+    std::unique_lock<std::recursive_mutex> m_lock;
+    bool m_open;
+};
+
+// Run one cached statement that returns no rows
+static bool ExecCached(const char* sql) {
+    CachedStatement stmt(sql);
+    return stmt && sqlite3_step(stmt) == SQLITE_DONE;
+}
+
+static std::wstring ColumnWide(sqlite3_stmt* stmt, int col) {
+    const char* text = reinterpret_cast<const char*>(sqlite3_column_text(stmt, col));
+    return text ? Utf8ToWide(text) : L"";
+}
+
+static bool IsLocalPath(const std::wstring& path) {
+    return !path.empty() && path.find(L"://") == std::wstring::npos;
+}
+
+static bool FileExists(const std::wstring& path) {
+    return GetFileAttributesW(path.c_str()) != INVALID_FILE_ATTRIBUTES;
+}
+
+// The drive ("C:\") or share ("\\server\share\") a path is on
+static std::wstring GetPathRoot(const std::wstring& path) {
+    if (path.compare(0, 2, L"\\\\") == 0) {
+        size_t server = path.find(L'\\', 2);
+        if (server == std::wstring::npos) return path;
+        size_t share = path.find(L'\\', server + 1);
+        return share == std::wstring::npos ? path + L"\\" : path.substr(0, share + 1);
+    }
+    return path.substr(0, 3);
+}
+
+// Whether the drive or share a path is on is there, so a file missing from it
+// is really gone rather than offline. Answers are kept in `roots` per root.
+static bool IsPathRootAvailable(const std::wstring& path, std::unordered_map<std::wstring, bool>& roots) {
+    std::wstring root = GetPathRoot(path);
+    auto found = roots.find(root);
+    if (found == roots.end()) found = roots.emplace(root, FileExists(root)).first;
+    return found->second;
+}
+
+// A fingerprint goes in two columns (size, then hash); NULLs if unknown
+static void BindFingerprint(sqlite3_stmt* stmt, int col, const FileFingerprint* fingerprint) {
+    if (fingerprint) {
+        sqlite3_bind_int64(stmt, col, fingerprint->size);
+        sqlite3_bind_int64(stmt, col + 1, static_cast<sqlite3_int64>(fingerprint->hash));
+    } else {
+        sqlite3_bind_null(stmt, col);
+        sqlite3_bind_null(stmt, col + 1);
+    }
+}
+
+// Every connection waits out a busy database rather than failing, and syncs
+// only when the WAL is checkpointed: a commit still survives the app
+// crashing, and a power cut can cost the last few commits but never leaves
+// the database damaged
+static void SetConnectionOptions(sqlite3* db) {
+    sqlite3_busy_timeout(db, 5000);
+    sqlite3_exec(db, "PRAGMA synchronous=NORMAL;", nullptr, nullptr, nullptr);
+}
+
+// Database writer
+// Writes nothing waits on (positions, history, hints, sort orders, schedule
+// bookkeeping) are queued and committed by a background thread on its own
+// connection, everything queued so far in one transaction, so a slow commit
+// (a WAL checkpoint, a virus scanner holding the file) never stalls the
+// window. A write with a key replaces the queued write with the same key, so
+// only the last position per file is written. Reads of queued data wait for
+// the write they depend on first, so they always see it.
+
+struct QueuedWrite {
+    std::string key;  // Empty: never replaced
+    std::function<void()> apply;
+};
+
+static sqlite3* g_writerDb = nullptr;
+static std::thread g_writerThread;
+static std::mutex g_writeMutex;
+static std::condition_variable g_writeReady;  // Something queued, or stopping
+static std::condition_variable g_writeDone;   // A batch committed
+static std::vector<QueuedWrite> g_writeQueue;
+static std::unordered_map<std::string, size_t> g_writeIndex;   // Key -> place in g_writeQueue
+static std::unordered_map<std::string, int> g_pendingKeys;     // Key -> writes queued or being committed
+static bool g_writeBatchActive = false;
+static bool g_writerStop = false;
+
+// WAL bytes committed for file positions (under g_writeMutex)
+static const char POSITION_KEY_PREFIX[] = "position:";
+static const int WAL_FRAME_HEADER = 24;
+static int g_writerPageSize = 4096;
+static uint64_t g_positionBytesWritten = 0;
+
+// The writer's statements, prepared once on its connection (writer thread only)
+static std::unordered_map<std::string, sqlite3_stmt*> g_writerStatements;
+
+static sqlite3_stmt* WriterStatement(const char* sql) {
+    sqlite3* db = g_writerDb ? g_writerDb : g_db;
+    auto found = g_writerStatements.find(sql);
+    if (found != g_writerStatements.end()) {
+        sqlite3_reset(found->second);
+        sqlite3_clear_bindings(found->second);
+        return found->second;
+    }
+    sqlite3_stmt* stmt = nullptr;
+    if (sqlite3_prepare_v3(db, sql, -1, SQLITE_PREPARE_PERSISTENT, &stmt, nullptr) != SQLITE_OK) {
+        sqlite3_finalize(stmt);
+        return nullptr;
+    }
+    g_writerStatements.emplace(sql, stmt);
+    return stmt;
+}
+
+static void DatabaseWriterThread() {
+    std::unique_lock<std::mutex> lock(g_writeMutex);
+    for (;;) {
+        g_writeReady.wait(lock, [] { return !g_writeQueue.empty() || g_writerStop; });
+        if (g_writeQueue.empty()) break;  // Stopping, and everything is written
+
+        std::vector<QueuedWrite> batch;
+        batch.swap(g_writeQueue);
+        g_writeIndex.clear();
+        g_writeBatchActive = true;
+        lock.unlock();
+
+        sqlite3_exec(g_writerDb, "BEGIN;", nullptr, nullptr, nullptr);
+        for (auto& write : batch) {
+            if (write.apply) write.apply();
+        }
+        sqlite3_exec(g_writerDb, "COMMIT;", nullptr, nullptr, nullptr);
+
+        // Pages the commit appended to the WAL, each behind a frame header
+        int pagesWritten = 0, highwater = 0;
+        sqlite3_db_status(g_writerDb, SQLITE_DBSTATUS_CACHE_WRITE, &pagesWritten, &highwater, 1);
+        uint64_t walBytes = static_cast<uint64_t>(pagesWritten) * (g_writerPageSize + WAL_FRAME_HEADER);
+
+        lock.lock();
+        size_t writes = 0, positions = 0;
+        for (const auto& write : batch) {
+            if (!write.apply) continue;
+            writes++;
+            if (write.key.compare(0, sizeof(POSITION_KEY_PREFIX) - 1, POSITION_KEY_PREFIX) == 0) positions++;
+        }
+        if (writes > 0) g_positionBytesWritten += walBytes * positions / writes;  // Their share of the batch
+
+        for (const auto& write : batch) {
+            if (write.key.empty()) continue;
+            auto pending = g_pendingKeys.find(write.key);
+            if (pending != g_pendingKeys.end() && --pending->second == 0) g_pendingKeys.erase(pending);
+        }
+        g_writeBatchActive = false;
+        g_writeDone.notify_all();
+    }
+}
+
+static void StartDatabaseWriter() {
+    if (g_writerDb || g_dbPath.empty()) return;
+    std::string dbPathUtf8 = WideToUtf8(g_dbPath);
+    if (sqlite3_open(dbPathUtf8.c_str(), &g_writerDb) != SQLITE_OK) {
+        sqlite3_close(g_writerDb);
+        g_writerDb = nullptr;
+        return;
+    }
+    SetConnectionOptions(g_writerDb);
+    sqlite3_stmt* stmt = nullptr;
+    if (sqlite3_prepare_v2(g_writerDb, "PRAGMA page_size;", -1, &stmt, nullptr) == SQLITE_OK &&
+        sqlite3_step(stmt) == SQLITE_ROW) {
+        g_writerPageSize = sqlite3_column_int(stmt, 0);
+    }
+    sqlite3_finalize(stmt);
+    g_writerStop = false;
+    g_writerThread = std::thread(DatabaseWriterThread);
+}
+
+// Commit whatever is queued and stop the writer
+static void StopDatabaseWriter() {
+    if (g_writerThread.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(g_writeMutex);
+            g_writerStop = true;
+        }
+        g_writeReady.notify_one();
+        g_writerThread.join();
+    }
+    for (auto& entry : g_writerStatements) {
+        sqlite3_finalize(entry.second);
+    }
+    g_writerStatements.clear();
+    if (g_writerDb) {
+        sqlite3_close(g_writerDb);
+        g_writerDb = nullptr;
+    }
+}
+
+static void QueueWrite(const std::string& key, std::function<void()> apply) {
+    if (!g_writerDb) {
+        // No writer: write on this thread, as before
+        std::lock_guard<std::recursive_mutex> lock(g_statementMutex);
+        apply();
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(g_writeMutex);
+        if (!key.empty()) {
+            // The new write takes the old one's place at the back of the
+            // queue, so it still lands after anything queued in between
+            auto queued = g_writeIndex.find(key);
+            if (queued != g_writeIndex.end()) {
+                g_writeQueue[queued->second].key.clear();
+                g_writeQueue[queued->second].apply = nullptr;
+                queued->second = g_writeQueue.size();
+            } else {
+                g_writeIndex.emplace(key, g_writeQueue.size());
+                g_pendingKeys[key]++;
+            }
+        }
+        g_writeQueue.push_back(QueuedWrite{key, std::move(apply)});
+    }
+    g_writeReady.notify_one();
+}
+
+// Wait until the queued write with this key (if any) has been committed
+static void WaitForQueuedWrite(const std::string& key) {
+    std::unique_lock<std::mutex> lock(g_writeMutex);
+    g_writeDone.wait(lock, [&] { return g_pendingKeys.find(key) == g_pendingKeys.end(); });
+}
+
+// Wait until everything queued so far has been committed
+static void FlushDatabaseWrites() {
+    std::unique_lock<std::mutex> lock(g_writeMutex);
+    if (!g_writerThread.joinable()) return;
+    g_writeDone.wait(lock, [] { return g_writeQueue.empty() && !g_writeBatchActive; });
+}
+
+// File record compaction
+// Positions and bookmarks carry the fingerprint of the file they were saved
+// for (see RelinkMovedFileDB). Once a session a background pass fingerprints
+// records saved before fingerprints were kept, and prunes the positions of
+// files that have been gone a while: long enough for a moved file to have
+// been opened again, and only while the drive or share they were on is there,
+// so an unplugged drive keeps its records. Bookmarks are never pruned; they
+// were made by hand and are removed the same way.
+
+// A missing file's position is kept this long after it was last saved
+static const int64_t STALE_POSITION_SECONDS = 30 * 24 * 60 * 60;
+
+// Startup is left alone this long before the pass starts
+static const int COMPACTION_DELAY_SECONDS = 30;
+
+static std::thread g_compactionThread;
+static std::mutex g_compactionMutex;
+static std::condition_variable g_compactionWake;  // Stopping
+static std::atomic<bool> g_compactionStop(false);
+
+// Records are read a batch at a time with a statement of their own, holding
+// the statement lock only while a batch is copied out, so a read on the UI
+// thread never waits long behind this lowest-priority thread
+static const int COMPACTION_BATCH_ROWS = 256;
+
+struct CompactionRecord {
+    bool bookmark;
+    std::string path;
+    int64_t lastUpdated;
+    bool fingerprinted;
+};
+
+// Read the next batch of positions or unfingerprinted bookmarks, by path,
+// after `after` (moved on to the batch's last path). False once there are none left.
+static bool ReadCompactionBatch(bool bookmarks, std::string& after, std::vector<CompactionRecord>& records) {
+    records.clear();
+    std::lock_guard<std::recursive_mutex> lock(g_statementMutex);
+    if (!g_db) return false;
+    sqlite3_stmt* stmt = nullptr;
+    if (sqlite3_prepare_v2(g_db, bookmarks
+            ? "SELECT DISTINCT path, 0, 0 FROM bookmarks WHERE content_hash IS NULL AND path > ? "
+              "ORDER BY path LIMIT ?;"
+            : "SELECT path, last_updated, content_hash IS NOT NULL FROM file_positions WHERE path > ? "
+              "ORDER BY path LIMIT ?;",
+            -1, &stmt, nullptr) != SQLITE_OK) {
+        sqlite3_finalize(stmt);
+        return false;
+    }
+    sqlite3_bind_text(stmt, 1, after.c_str(), -1, SQLITE_TRANSIENT);
+    sqlite3_bind_int(stmt, 2, COMPACTION_BATCH_ROWS);
+    while (sqlite3_step(stmt) == SQLITE_ROW) {
+        const char* path = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 0));
+        if (!path) continue;
+        records.push_back(CompactionRecord{bookmarks, path, sqlite3_column_int64(stmt, 1),
+                                           sqlite3_column_int(stmt, 2) != 0});
+    }
+    sqlite3_finalize(stmt);
+    if (records.empty()) return false;
+    after = records.back().path;
+    return true;
+}
+
+static void CompactFileRecords() {
+    SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_LOWEST);
+    {
+        std::unique_lock<std::mutex> lock(g_compactionMutex);
+        if (g_compactionWake.wait_for(lock, std::chrono::seconds(COMPACTION_DELAY_SECONDS),
+                                      [] { return g_compactionStop.load(); })) {
+            return;
+        }
+    }
+
+    int64_t staleBefore = static_cast<int64_t>(time(nullptr)) - STALE_POSITION_SECONDS;
+    std::unordered_map<std::wstring, bool> roots;  // Root -> there
+    std::vector<CompactionRecord> records;
+    for (bool bookmarks : {false, true}) {
+        std::string after;
+        while (!g_compactionStop && ReadCompactionBatch(bookmarks, after, records)) {
+            for (const auto& record : records) {
+                if (g_compactionStop) return;
+                std::wstring path = Utf8ToWide(record.path);
+                if (!IsLocalPath(path)) continue;
+                std::string pathUtf8 = record.path;
+
+                if (FileExists(path)) {
+                    FileFingerprint fingerprint;
+                    if (record.fingerprinted || !GetFileFingerprint(path, fingerprint)) continue;
+                    bool bookmark = record.bookmark;
+                    QueueWrite(std::string(), [pathUtf8, bookmark, fingerprint]() {
+                        sqlite3_stmt* stmt = WriterStatement(bookmark
+                            ? "UPDATE bookmarks SET file_size = ?, content_hash = ? WHERE path = ?;"
+                            : "UPDATE file_positions SET file_size = ?, content_hash = ? WHERE path = ?;");
+                        if (!stmt) return;
+                        BindFingerprint(stmt, 1, &fingerprint);
+                        sqlite3_bind_text(stmt, 3, pathUtf8.c_str(), -1, SQLITE_TRANSIENT);
+                        sqlite3_step(stmt);
+                    });
+                } else if (!record.bookmark && record.lastUpdated < staleBefore) {
+                    // Can't tell whether the file is still there
+                    if (!IsPathRootAvailable(path, roots)) continue;
+
+                    // Unless the position has been saved again since
+                    QueueWrite(std::string(), [pathUtf8, staleBefore]() {
+                        sqlite3_stmt* stmt = WriterStatement(
+                            "DELETE FROM file_positions WHERE path = ? AND last_updated < ?;");
+                        if (!stmt) return;
+                        sqlite3_bind_text(stmt, 1, pathUtf8.c_str(), -1, SQLITE_TRANSIENT);
+                        sqlite3_bind_int64(stmt, 2, staleBefore);
+                        sqlite3_step(stmt);
+                    });
+                }
+            }
+        }
+    }
+}
+
+static void StartFileRecordCompaction() {
+    g_compactionStop = false;
+    g_compactionThread = std::thread(CompactFileRecords);
+}
+
+static void StopFileRecordCompaction() {
+    if (!g_compactionThread.joinable()) return;
+    {
+        std::lock_guard<std::mutex> lock(g_compactionMutex);
+        g_compactionStop = true;
+    }
+    g_compactionWake.notify_one();
+    g_compactionThread.join();
+}
+
+// Full-text search
+// FTS5 tables index song history, bookmarks, radio favorites and podcast
+// episodes. Each reads its text from the table it indexes (external content)
+// and triggers on that table keep it in step, so every insert, edit or
+// delete, wherever it is made, updates the index in the same transaction.
+// Words match by prefix. A prefix with no index of its own length has the
+// lists of every word it starts merged before the first row comes back, which
+// for a common one ("artis") on a million-entry history takes tens of
+// milliseconds; indexing prefixes up to six letters (the longest most typed
+// words get to before they narrow the results) keeps every query at well
+// under one, for about 60% more index. Without FTS5 in the SQLite build
+// searches fall back to LIKE scans.
+
+struct SearchIndex {
+    const char* name;
+    const char* table;
+    const char* key;      // The table's rowid column
+    const char* columns;  // Indexed columns, comma separated
+};
+
+static const SearchIndex SEARCH_INDEXES[] = {
+    {"song_history_fts", "song_history", "id", "title"},
+    {"bookmarks_fts", "bookmarks", "id", "path"},
+    {"radio_favorites_fts", "radio_favorites", "id", "name,url"},
+    {"podcast_episodes_fts", "podcast_episodes", "rowid", "title,description,feed_title"},
+};
+
+static bool g_searchIndexed = false;
+
+// "a,b" -> "new.a, new.b"
+static std::string PrefixColumns(const char* columns, const char* prefix) {
+    std::string result = prefix;
+    for (const char* c = columns; *c; c++) {
+        if (*c == ',') {
+            result += ", ";
+            result += prefix;
+        } else {
+            result += *c;
+        }
+    }
+    return result;
+}
+
+static bool CreateSearchIndex(const SearchIndex& index) {
+    bool existed = false;
+    sqlite3_stmt* stmt = nullptr;
+    if (sqlite3_prepare_v2(g_db, "SELECT 1 FROM sqlite_master WHERE name = ?;", -1, &stmt, nullptr) == SQLITE_OK) {
+        sqlite3_bind_text(stmt, 1, index.name, -1, SQLITE_STATIC);
+        existed = sqlite3_step(stmt) == SQLITE_ROW;
+    }
+    sqlite3_finalize(stmt);
+
+    std::string name = index.name;
+    std::string table = index.table;
+    std::string columns = PrefixColumns(index.columns, "");
+    std::string newValues = "new." + std::string(index.key) + ", " + PrefixColumns(index.columns, "new.");
+    std::string oldValues = "'delete', old." + std::string(index.key) + ", " + PrefixColumns(index.columns, "old.");
+    std::string insertNew = "INSERT INTO " + name + "(rowid, " + columns + ") VALUES (" + newValues + ");";
+    std::string deleteOld = "INSERT INTO " + name + "(" + name + ", rowid, " + columns + ") VALUES (" + oldValues + ");";
+
+    std::string sql =
+        "CREATE VIRTUAL TABLE IF NOT EXISTS " + name + " USING fts5(" + columns + ", content='" + table +
+        "', content_rowid='" + index.key + "', tokenize='unicode61 remove_diacritics 2', prefix='1 2 3 4 5 6');"
+        "CREATE TRIGGER IF NOT EXISTS " + name + "_insert AFTER INSERT ON " + table + " BEGIN " + insertNew + " END;"
+        "CREATE TRIGGER IF NOT EXISTS " + name + "_delete AFTER DELETE ON " + table + " BEGIN " + deleteOld + " END;"
+        "CREATE TRIGGER IF NOT EXISTS " + name + "_update AFTER UPDATE OF " + columns + " ON " + table +
+        " BEGIN " + deleteOld + " " + insertNew + " END;";
+    if (sqlite3_exec(g_db, sql.c_str(), nullptr, nullptr, nullptr) != SQLITE_OK) return false;
+
+    // Index what the table held before the index existed
+    if (!existed) {
+        std::string rebuild = "INSERT INTO " + name + "(" + name + ") VALUES ('rebuild');";
+        sqlite3_exec(g_db, rebuild.c_str(), nullptr, nullptr, nullptr);
+    }
+    return true;
+}
+
+static bool CreateSearchIndexes() {
+    sqlite3_exec(g_db, "BEGIN;", nullptr, nullptr, nullptr);
+    for (const auto& index : SEARCH_INDEXES) {
+        if (!CreateSearchIndex(index)) {
+            sqlite3_exec(g_db, "ROLLBACK;", nullptr, nullptr, nullptr);
+            return false;
+        }
+    }
+    return sqlite3_exec(g_db, "COMMIT;", nullptr, nullptr, nullptr) == SQLITE_OK;
+}
+
 // Initialize database
 bool InitDatabase() {
     if (g_db) return true;  // Already initialized
@@ -47,8 +595,8 @@ bool InitDatabase() {
         return false;
     }
 
-    // Set busy timeout to prevent hangs (5 seconds)
-    sqlite3_busy_timeout(g_db, 5000);
+    // Set busy timeout to prevent hangs (5 seconds), and relaxed syncing
+    SetConnectionOptions(g_db);
 
     // Enable WAL mode for better concurrency
     char* errMsg = nullptr;
@@ -160,6 +708,17 @@ bool InitDatabase() {
     sqlite3_exec(g_db, "ALTER TABLE podcast_subscriptions ADD COLUMN password TEXT DEFAULT '';",
                  nullptr, nullptr, nullptr);
 
+    // Migration: Content fingerprints (size and hash of both ends), an alternate
+    // key that finds a position or bookmark again after the file has moved
+    sqlite3_exec(g_db, "ALTER TABLE file_positions ADD COLUMN file_size INTEGER;", nullptr, nullptr, nullptr);
+    sqlite3_exec(g_db, "ALTER TABLE file_positions ADD COLUMN content_hash INTEGER;", nullptr, nullptr, nullptr);
+    sqlite3_exec(g_db, "ALTER TABLE bookmarks ADD COLUMN file_size INTEGER;", nullptr, nullptr, nullptr);
+    sqlite3_exec(g_db, "ALTER TABLE bookmarks ADD COLUMN content_hash INTEGER;", nullptr, nullptr, nullptr);
+    sqlite3_exec(g_db, "CREATE INDEX IF NOT EXISTS idx_file_positions_content ON file_positions(file_size, content_hash);",
+                 nullptr, nullptr, nullptr);
+    sqlite3_exec(g_db, "CREATE INDEX IF NOT EXISTS idx_bookmarks_content ON bookmarks(file_size, content_hash);",
+                 nullptr, nullptr, nullptr);
+
     // Create song_history table (stream metadata capture)
     const char* songHistorySql =
         "CREATE TABLE IF NOT EXISTS song_history ("
@@ -169,12 +728,141 @@ bool InitDatabase() {
         ");";
     sqlite3_exec(g_db, songHistorySql, nullptr, nullptr, nullptr);
 
+    // Create url_open_hints table (which way of opening a stream worked per host)
+    const char* urlHintsSql =
+        "CREATE TABLE IF NOT EXISTS url_open_hints ("
+        "host TEXT PRIMARY KEY, "
+        "strategy INTEGER NOT NULL, "
+        "last_updated INTEGER"
+        ");";
+    sqlite3_exec(g_db, urlHintsSql, nullptr, nullptr, nullptr);
+
+    // Create seek_tables table (scanned seek info for MPEG files, valid while
+    // the file's size and modification time match)
+    const char* seekTablesSql =
+        "CREATE TABLE IF NOT EXISTS seek_tables ("
+        "path TEXT PRIMARY KEY, "
+        "file_size INTEGER NOT NULL, "
+        "modified INTEGER NOT NULL, "
+        "scan_info BLOB NOT NULL, "
+        "last_updated INTEGER"
+        ");";
+    sqlite3_exec(g_db, seekTablesSql, nullptr, nullptr, nullptr);
+
+    // Create media library tables (folders are the scan roots; a track's
+    // file_size and modified decide whether a rescan reads it again)
+    const char* librarySql =
+        "CREATE TABLE IF NOT EXISTS library_folders ("
+        "path TEXT PRIMARY KEY, "
+        "added INTEGER"
+        ");"
+        "CREATE TABLE IF NOT EXISTS library_artists ("
+        "id INTEGER PRIMARY KEY, "
+        "name TEXT NOT NULL UNIQUE"
+        ");"
+        "CREATE TABLE IF NOT EXISTS library_albums ("
+        "id INTEGER PRIMARY KEY, "
+        "artist_id INTEGER NOT NULL, "
+        "title TEXT NOT NULL, "
+        "UNIQUE (artist_id, title)"
+        ");"
+        "CREATE TABLE IF NOT EXISTS library_tracks ("
+        "id INTEGER PRIMARY KEY, "
+        "path TEXT NOT NULL UNIQUE, "
+        "folder TEXT NOT NULL, "
+        "file_size INTEGER NOT NULL, "
+        "modified INTEGER NOT NULL, "
+        "title TEXT, "
+        "artist_id INTEGER, "
+        "album_id INTEGER, "
+        "genre TEXT, "
+        "year INTEGER, "
+        "track_no INTEGER, "
+        "duration REAL, "
+        "codec TEXT, "
+        "sample_rate INTEGER, "
+        "channels INTEGER, "
+        "bitrate INTEGER, "
+        "track_gain REAL, "
+        "track_peak REAL, "
+        "album_gain REAL, "
+        "album_peak REAL, "
+        "scanned INTEGER"
+        ");"
+        "CREATE INDEX IF NOT EXISTS idx_library_tracks_folder ON library_tracks (folder);"
+        "CREATE INDEX IF NOT EXISTS idx_library_tracks_artist ON library_tracks (artist_id);"
+        "CREATE INDEX IF NOT EXISTS idx_library_tracks_album ON library_tracks (album_id, track_no);";
+    sqlite3_exec(g_db, librarySql, nullptr, nullptr, nullptr);
+
+    // Create loudness table (analysis results for files without ReplayGain
+    // tags; integrated is NULL when a file couldn't be measured)
+    const char* loudnessSql =
+        "CREATE TABLE IF NOT EXISTS loudness ("
+        "path TEXT PRIMARY KEY, "
+        "file_size INTEGER NOT NULL, "
+        "modified INTEGER NOT NULL, "
+        "integrated REAL, "
+        "true_peak REAL, "
+        "last_updated INTEGER"
+        ");";
+    sqlite3_exec(g_db, loudnessSql, nullptr, nullptr, nullptr);
+
+    // Create station_loudness table (what the live stream leveler learned per station URL)
+    const char* stationLoudnessSql =
+        "CREATE TABLE IF NOT EXISTS station_loudness ("
+        "url TEXT PRIMARY KEY, "
+        "loudness REAL NOT NULL, "
+        "last_updated INTEGER"
+        ");";
+    sqlite3_exec(g_db, stationLoudnessSql, nullptr, nullptr, nullptr);
+
+    // Create playlist_entries table (the playlist as saved at exit, by position)
+    const char* playlistSql =
+        "CREATE TABLE IF NOT EXISTS playlist_entries ("
+        "position INTEGER PRIMARY KEY, "
+        "path TEXT NOT NULL"
+        ");";
+    sqlite3_exec(g_db, playlistSql, nullptr, nullptr, nullptr);
+
+    // Create podcast_episodes table (episodes of subscribed feeds as last
+    // fetched, kept for searching; they go with their subscription)
+    const char* episodesSql =
+        "CREATE TABLE IF NOT EXISTS podcast_episodes ("
+        "feed_url TEXT NOT NULL, "
+        "feed_title TEXT, "
+        "title TEXT NOT NULL, "
+        "description TEXT, "
+        "audio_url TEXT NOT NULL, "
+        "pub_date TEXT, "
+        "fetched INTEGER NOT NULL, "
+        "UNIQUE (feed_url, audio_url)"
+        ");"
+        "CREATE TRIGGER IF NOT EXISTS podcast_subscriptions_delete AFTER DELETE ON podcast_subscriptions BEGIN "
+        "DELETE FROM podcast_episodes WHERE feed_url = old.feed_url; END;"
+        "CREATE TRIGGER IF NOT EXISTS podcast_subscriptions_feed AFTER UPDATE OF feed_url ON podcast_subscriptions BEGIN "
+        "DELETE FROM podcast_episodes WHERE feed_url = old.feed_url; END;";
+    sqlite3_exec(g_db, episodesSql, nullptr, nullptr, nullptr);
+
+    g_searchIndexed = CreateSearchIndexes();
+
+    StartDatabaseWriter();
+    StartFileRecordCompaction();
     return true;
 }
 
 // Close database
 void CloseDatabase() {
+    StopFileRecordCompaction();  // Queues writes, so goes before the writer
+    StopDatabaseWriter();
+    {
+        std::lock_guard<std::mutex> lock(g_libraryDbMutex);
+        if (g_libraryDb) {
+            sqlite3_close(g_libraryDb);
+            g_libraryDb = nullptr;
+        }
+    }
     if (g_db) {
+        FinalizeCachedStatements();
         sqlite3_close(g_db);
         g_db = nullptr;
     }
@@ -185,19 +873,23 @@ void SaveFilePositionDB(const std::wstring& filePath, double position) {
     if (!g_db) return;
 
     std::string pathUtf8 = WideToUtf8(filePath);
+    sqlite3_int64 now = static_cast<sqlite3_int64>(time(nullptr));
 
-    const char* sql =
-        "INSERT OR REPLACE INTO file_positions (path, position, last_updated) "
-        "VALUES (?, ?, ?);";
+    QueueWrite(POSITION_KEY_PREFIX + pathUtf8, [filePath, pathUtf8, position, now]() {
+        // Fingerprinting reads the file, which is why it happens here
+        FileFingerprint fingerprint;
+        bool known = IsLocalPath(filePath) && GetFileFingerprint(filePath, fingerprint);
 
-    sqlite3_stmt* stmt = nullptr;
-    if (sqlite3_prepare_v2(g_db, sql, -1, &stmt, nullptr) == SQLITE_OK) {
+        sqlite3_stmt* stmt = WriterStatement(
+            "INSERT OR REPLACE INTO file_positions (path, position, last_updated, file_size, content_hash) "
+            "VALUES (?, ?, ?, ?, ?);");
+        if (!stmt) return;
         sqlite3_bind_text(stmt, 1, pathUtf8.c_str(), -1, SQLITE_TRANSIENT);
         sqlite3_bind_double(stmt, 2, position);
-        sqlite3_bind_int64(stmt, 3, static_cast<sqlite3_int64>(time(nullptr)));
+        sqlite3_bind_int64(stmt, 3, now);
+        BindFingerprint(stmt, 4, known ? &fingerprint : nullptr);
         sqlite3_step(stmt);
-        sqlite3_finalize(stmt);
-    }
+    });
 }
 
 // Load file position from database
@@ -207,34 +899,103 @@ double LoadFilePositionDB(const std::wstring& filePath) {
     std::string pathUtf8 = WideToUtf8(filePath);
     double position = 0.0;
 
+    WaitForQueuedWrite(POSITION_KEY_PREFIX + pathUtf8);
     const char* sql = "SELECT position FROM file_positions WHERE path = ?;";
 
-    sqlite3_stmt* stmt = nullptr;
-    if (sqlite3_prepare_v2(g_db, sql, -1, &stmt, nullptr) == SQLITE_OK) {
+    CachedStatement stmt(sql);
+    if (stmt) {
         sqlite3_bind_text(stmt, 1, pathUtf8.c_str(), -1, SQLITE_TRANSIENT);
         if (sqlite3_step(stmt) == SQLITE_ROW) {
             position = sqlite3_column_double(stmt, 0);
         }
-        sqlite3_finalize(stmt);
     }
 
     return position;
 }
 
+// Opening a file: records (positions, bookmarks) of the same content under a
+// path that no longer exists move to this one. Only records of files the
+// same size are candidates, so usually nothing is read. A path on a drive or
+// share that isn't there keeps its records: that copy may still exist.
+void RelinkMovedFileDB(const std::wstring& filePath) {
+    if (!g_db || !IsLocalPath(filePath)) return;
+
+    int64_t size, modified;
+    if (!GetFileIdentity(filePath, size, modified)) return;
+    std::string pathUtf8 = WideToUtf8(filePath);
+
+    struct Orphan {
+        bool bookmark;
+        std::string path;
+        uint64_t hash;
+    };
+    std::vector<Orphan> orphans;
+    {
+        CachedStatement stmt(
+            "SELECT 0, path, content_hash FROM file_positions WHERE file_size = ?1 AND path <> ?2 "
+            "UNION ALL SELECT 1, path, content_hash FROM bookmarks WHERE file_size = ?1 AND path <> ?2;");
+        if (!stmt) return;
+        sqlite3_bind_int64(stmt, 1, size);
+        sqlite3_bind_text(stmt, 2, pathUtf8.c_str(), -1, SQLITE_TRANSIENT);
+        while (sqlite3_step(stmt) == SQLITE_ROW) {
+            const char* path = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 1));
+            if (!path) continue;
+            orphans.push_back(Orphan{sqlite3_column_int(stmt, 0) != 0, path,
+                                     static_cast<uint64_t>(sqlite3_column_int64(stmt, 2))});
+        }
+    }
+
+    std::vector<Orphan> moved;
+    std::unordered_map<std::wstring, bool> roots;  // Root -> there
+    for (auto& orphan : orphans) {
+        std::wstring path = Utf8ToWide(orphan.path);
+        if (!FileExists(path) && IsPathRootAvailable(path, roots)) moved.push_back(std::move(orphan));
+    }
+    if (moved.empty()) return;
+
+    FileFingerprint fingerprint;
+    if (!GetFileFingerprint(filePath, fingerprint)) return;
+
+    WaitForQueuedWrite(POSITION_KEY_PREFIX + pathUtf8);
+    DbTransaction transaction;
+    if (!transaction.IsOpen()) return;
+    for (const auto& orphan : moved) {
+        if (orphan.hash != fingerprint.hash) continue;
+        // A position this path already has is newer than one it had elsewhere
+        CachedStatement stmt(orphan.bookmark
+            ? "UPDATE bookmarks SET path = ? WHERE path = ?;"
+            : "UPDATE OR IGNORE file_positions SET path = ? WHERE path = ?;");
+        if (!stmt) continue;
+        sqlite3_bind_text(stmt, 1, pathUtf8.c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_bind_text(stmt, 2, orphan.path.c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_step(stmt);
+    }
+    transaction.Commit();
+}
+
+uint64_t GetPositionBytesWrittenDB() {
+    std::lock_guard<std::mutex> lock(g_writeMutex);
+    return g_positionBytesWritten;
+}
+
 // Add a bookmark, returns the bookmark ID or -1 on failure
 int AddBookmark(const std::wstring& filePath, double position) {
     if (!g_db) return -1;
 
     std::string pathUtf8 = WideToUtf8(filePath);
 
+    FileFingerprint fingerprint;
+    bool known = IsLocalPath(filePath) && GetFileFingerprint(filePath, fingerprint);
+
     const char* sql =
-        "INSERT INTO bookmarks (path, position, created) VALUES (?, ?, ?);";
+        "INSERT INTO bookmarks (path, position, created, file_size, content_hash) VALUES (?, ?, ?, ?, ?);";
 
     sqlite3_stmt* stmt = nullptr;
     if (sqlite3_prepare_v2(g_db, sql, -1, &stmt, nullptr) == SQLITE_OK) {
         sqlite3_bind_text(stmt, 1, pathUtf8.c_str(), -1, SQLITE_TRANSIENT);
         sqlite3_bind_double(stmt, 2, position);
         sqlite3_bind_int64(stmt, 3, static_cast<sqlite3_int64>(time(nullptr)));
+        BindFingerprint(stmt, 4, known ? &fingerprint : nullptr);
 
         if (sqlite3_step(stmt) == SQLITE_DONE) {
             sqlite3_finalize(stmt);
@@ -249,16 +1010,13 @@ int AddBookmark(const std::wstring& filePath, double position) {
 bool RemoveBookmark(int id) {
     if (!g_db) return false;
 
-    const char* sql = "DELETE FROM bookmarks WHERE id = ?;";
-
-    sqlite3_stmt* stmt = nullptr;
-    if (sqlite3_prepare_v2(g_db, sql, -1, &stmt, nullptr) == SQLITE_OK) {
+    QueueWrite(std::string(), [id]() {
+        sqlite3_stmt* stmt = WriterStatement("DELETE FROM bookmarks WHERE id = ?;");
+        if (!stmt) return;
         sqlite3_bind_int(stmt, 1, id);
-        int rc = sqlite3_step(stmt);
-        sqlite3_finalize(stmt);
-        return rc == SQLITE_DONE;
-    }
-    return false;
+        sqlite3_step(stmt);
+    });
+    return true;
 }
 
 // Helper to extract filename from path
@@ -290,6 +1048,7 @@ static std::wstring FormatPosition(double seconds) {
 std::vector<Bookmark> GetAllBookmarks() {
     std::vector<Bookmark> bookmarks;
     if (!g_db) return bookmarks;
+    FlushDatabaseWrites();
 
     const char* sql = "SELECT id, path, position, created FROM bookmarks ORDER BY created DESC;";
 
@@ -398,6 +1157,7 @@ bool UpdateRadioStation(int id, const std::wstring& newName, const std::wstring&
 std::vector<RadioStation> GetRadioFavorites() {
     std::vector<RadioStation> stations;
     if (!g_db) return stations;
+    FlushDatabaseWrites();
 
     const char* sql = "SELECT id, name, url, created, sort_order FROM radio_favorites "
                       "ORDER BY sort_order ASC, name COLLATE NOCASE ASC;";
@@ -429,25 +1189,31 @@ std::vector<RadioStation> GetRadioFavorites() {
 bool UpdateRadioSortOrders(const std::vector<RadioStation>& stations) {
     if (!g_db) return false;
 
-    const char* sql = "UPDATE radio_favorites SET sort_order = ? WHERE id = ?;";
-    sqlite3_stmt* stmt = nullptr;
-    if (sqlite3_prepare_v2(g_db, sql, -1, &stmt, nullptr) != SQLITE_OK) return false;
-
-    for (int i = 0; i < static_cast<int>(stations.size()); i++) {
-        sqlite3_reset(stmt);
-        sqlite3_bind_int(stmt, 1, i + 1);
-        sqlite3_bind_int(stmt, 2, stations[i].id);
-        sqlite3_step(stmt);
-    }
-    sqlite3_finalize(stmt);
+    std::vector<int> ids;
+    ids.reserve(stations.size());
+    for (const auto& station : stations) ids.push_back(station.id);
+
+    QueueWrite("radio_order", [ids]() {
+        sqlite3_stmt* stmt = WriterStatement("UPDATE radio_favorites SET sort_order = ? WHERE id = ?;");
+        if (!stmt) return;
+        for (int i = 0; i < static_cast<int>(ids.size()); i++) {
+            sqlite3_reset(stmt);
+            sqlite3_bind_int(stmt, 1, i + 1);
+            sqlite3_bind_int(stmt, 2, ids[i]);
+            sqlite3_step(stmt);
+        }
+    });
     return true;
 }
 
 // Reset radio sort order to alphabetical
 bool ResetRadioSortOrder() {
     if (!g_db) return false;
-    return sqlite3_exec(g_db, "UPDATE radio_favorites SET sort_order = 0;",
-                        nullptr, nullptr, nullptr) == SQLITE_OK;
+    QueueWrite("radio_order", []() {
+        sqlite3_stmt* stmt = WriterStatement("UPDATE radio_favorites SET sort_order = 0;");
+        if (stmt) sqlite3_step(stmt);
+    });
+    return true;
 }
 
 // Assign sequential sort_order values to the given station ids, in vector order,
@@ -457,25 +1223,22 @@ bool ResetRadioSortOrder() {
 bool AppendRadioSortOrder(const std::vector<int>& orderedIds) {
     if (!g_db || orderedIds.empty()) return false;
 
-    int base = 0;
-    sqlite3_stmt* maxStmt = nullptr;
-    if (sqlite3_prepare_v2(g_db, "SELECT COALESCE(MAX(sort_order), 0) FROM radio_favorites;",
-                           -1, &maxStmt, nullptr) == SQLITE_OK) {
-        if (sqlite3_step(maxStmt) == SQLITE_ROW) base = sqlite3_column_int(maxStmt, 0);
-        sqlite3_finalize(maxStmt);
-    }
-
-    const char* sql = "UPDATE radio_favorites SET sort_order = ? WHERE id = ?;";
-    sqlite3_stmt* stmt = nullptr;
-    if (sqlite3_prepare_v2(g_db, sql, -1, &stmt, nullptr) != SQLITE_OK) return false;
-
-    for (size_t i = 0; i < orderedIds.size(); i++) {
-        sqlite3_reset(stmt);
-        sqlite3_bind_int(stmt, 1, base + 1 + static_cast<int>(i));
-        sqlite3_bind_int(stmt, 2, orderedIds[i]);
-        sqlite3_step(stmt);
-    }
-    sqlite3_finalize(stmt);
+    // Not keyed: it numbers on from whatever order is written before it
+    QueueWrite(std::string(), [orderedIds]() {
+        int base = 0;
+        sqlite3_stmt* maxStmt = WriterStatement("SELECT COALESCE(MAX(sort_order), 0) FROM radio_favorites;");
+        if (maxStmt && sqlite3_step(maxStmt) == SQLITE_ROW) base = sqlite3_column_int(maxStmt, 0);
+        if (maxStmt) sqlite3_reset(maxStmt);
+
+        sqlite3_stmt* stmt = WriterStatement("UPDATE radio_favorites SET sort_order = ? WHERE id = ?;");
+        if (!stmt) return;
+        for (size_t i = 0; i < orderedIds.size(); i++) {
+            sqlite3_reset(stmt);
+            sqlite3_bind_int(stmt, 1, base + 1 + static_cast<int>(i));
+            sqlite3_bind_int(stmt, 2, orderedIds[i]);
+            sqlite3_step(stmt);
+        }
+    });
     return true;
 }
 
@@ -575,23 +1338,22 @@ bool UpdatePodcastSubscription(int id, const std::wstring& newName, const std::w
 bool UpdatePodcastLastUpdated(int id) {
     if (!g_db) return false;
 
-    const char* sql = "UPDATE podcast_subscriptions SET last_updated = ? WHERE id = ?;";
-
-    sqlite3_stmt* stmt = nullptr;
-    if (sqlite3_prepare_v2(g_db, sql, -1, &stmt, nullptr) == SQLITE_OK) {
-        sqlite3_bind_int64(stmt, 1, static_cast<sqlite3_int64>(time(nullptr)));
+    sqlite3_int64 now = static_cast<sqlite3_int64>(time(nullptr));
+    QueueWrite("podcast_updated:" + std::to_string(id), [id, now]() {
+        sqlite3_stmt* stmt = WriterStatement("UPDATE podcast_subscriptions SET last_updated = ? WHERE id = ?;");
+        if (!stmt) return;
+        sqlite3_bind_int64(stmt, 1, now);
         sqlite3_bind_int(stmt, 2, id);
-        int rc = sqlite3_step(stmt);
-        sqlite3_finalize(stmt);
-        return rc == SQLITE_DONE;
-    }
-    return false;
+        sqlite3_step(stmt);
+    });
+    return true;
 }
 
 // Get all podcast subscriptions
 std::vector<PodcastSubscription> GetPodcastSubscriptions() {
     std::vector<PodcastSubscription> subscriptions;
     if (!g_db) return subscriptions;
+    FlushDatabaseWrites();
 
     const char* sql = "SELECT id, name, feed_url, image_url, last_updated, sort_order, username, password "
                       "FROM podcast_subscriptions ORDER BY sort_order ASC, name COLLATE NOCASE ASC;";
@@ -632,25 +1394,31 @@ std::vector<PodcastSubscription> GetPodcastSubscriptions() {
 bool UpdatePodcastSortOrders(const std::vector<PodcastSubscription>& subs) {
     if (!g_db) return false;
 
-    const char* sql = "UPDATE podcast_subscriptions SET sort_order = ? WHERE id = ?;";
-    sqlite3_stmt* stmt = nullptr;
-    if (sqlite3_prepare_v2(g_db, sql, -1, &stmt, nullptr) != SQLITE_OK) return false;
-
-    for (int i = 0; i < static_cast<int>(subs.size()); i++) {
-        sqlite3_reset(stmt);
-        sqlite3_bind_int(stmt, 1, i + 1);
-        sqlite3_bind_int(stmt, 2, subs[i].id);
-        sqlite3_step(stmt);
-    }
-    sqlite3_finalize(stmt);
+    std::vector<int> ids;
+    ids.reserve(subs.size());
+    for (const auto& sub : subs) ids.push_back(sub.id);
+
+    QueueWrite("podcast_order", [ids]() {
+        sqlite3_stmt* stmt = WriterStatement("UPDATE podcast_subscriptions SET sort_order = ? WHERE id = ?;");
+        if (!stmt) return;
+        for (int i = 0; i < static_cast<int>(ids.size()); i++) {
+            sqlite3_reset(stmt);
+            sqlite3_bind_int(stmt, 1, i + 1);
+            sqlite3_bind_int(stmt, 2, ids[i]);
+            sqlite3_step(stmt);
+        }
+    });
     return true;
 }
 
 // Reset podcast sort order to alphabetical
 bool ResetPodcastSortOrder() {
     if (!g_db) return false;
-    return sqlite3_exec(g_db, "UPDATE podcast_subscriptions SET sort_order = 0;",
-                        nullptr, nullptr, nullptr) == SQLITE_OK;
+    QueueWrite("podcast_order", []() {
+        sqlite3_stmt* stmt = WriterStatement("UPDATE podcast_subscriptions SET sort_order = 0;");
+        if (stmt) sqlite3_step(stmt);
+    });
+    return true;
 }
 
 // Helper to format schedule time
@@ -727,6 +1495,7 @@ int AddScheduledEvent(const std::wstring& name, ScheduleAction action,
 // Remove a scheduled event
 bool RemoveScheduledEvent(int id) {
     if (!g_db) return false;
+    FlushDatabaseWrites();  // Queued bookkeeping for this event lands first
 
     const char* sql = "DELETE FROM scheduled_events WHERE id = ?;";
 
@@ -744,51 +1513,42 @@ bool RemoveScheduledEvent(int id) {
 bool UpdateScheduledEventEnabled(int id, bool enabled) {
     if (!g_db) return false;
 
-    const char* sql = "UPDATE scheduled_events SET enabled = ? WHERE id = ?;";
-
-    sqlite3_stmt* stmt = nullptr;
-    if (sqlite3_prepare_v2(g_db, sql, -1, &stmt, nullptr) == SQLITE_OK) {
+    QueueWrite("schedule_enabled:" + std::to_string(id), [id, enabled]() {
+        sqlite3_stmt* stmt = WriterStatement("UPDATE scheduled_events SET enabled = ? WHERE id = ?;");
+        if (!stmt) return;
         sqlite3_bind_int(stmt, 1, enabled ? 1 : 0);
         sqlite3_bind_int(stmt, 2, id);
-        int rc = sqlite3_step(stmt);
-        sqlite3_finalize(stmt);
-        return rc == SQLITE_DONE;
-    }
-    return false;
+        sqlite3_step(stmt);
+    });
+    return true;
 }
 
 // Update last run time
 bool UpdateScheduledEventLastRun(int id, int64_t lastRun) {
     if (!g_db) return false;
 
-    const char* sql = "UPDATE scheduled_events SET last_run = ? WHERE id = ?;";
-
-    sqlite3_stmt* stmt = nullptr;
-    if (sqlite3_prepare_v2(g_db, sql, -1, &stmt, nullptr) == SQLITE_OK) {
+    QueueWrite("schedule_last_run:" + std::to_string(id), [id, lastRun]() {
+        sqlite3_stmt* stmt = WriterStatement("UPDATE scheduled_events SET last_run = ? WHERE id = ?;");
+        if (!stmt) return;
         sqlite3_bind_int64(stmt, 1, lastRun);
         sqlite3_bind_int(stmt, 2, id);
-        int rc = sqlite3_step(stmt);
-        sqlite3_finalize(stmt);
-        return rc == SQLITE_DONE;
-    }
-    return false;
+        sqlite3_step(stmt);
+    });
+    return true;
 }
 
 // Update scheduled time (for repeating events)
 bool UpdateScheduledEventTime(int id, int64_t scheduledTime) {
     if (!g_db) return false;
 
-    const char* sql = "UPDATE scheduled_events SET scheduled_time = ? WHERE id = ?;";
-
-    sqlite3_stmt* stmt = nullptr;
-    if (sqlite3_prepare_v2(g_db, sql, -1, &stmt, nullptr) == SQLITE_OK) {
+    QueueWrite("schedule_scheduled_time:" + std::to_string(id), [id, scheduledTime]() {
+        sqlite3_stmt* stmt = WriterStatement("UPDATE scheduled_events SET scheduled_time = ? WHERE id = ?;");
+        if (!stmt) return;
         sqlite3_bind_int64(stmt, 1, scheduledTime);
         sqlite3_bind_int(stmt, 2, id);
-        int rc = sqlite3_step(stmt);
-        sqlite3_finalize(stmt);
-        return rc == SQLITE_DONE;
-    }
-    return false;
+        sqlite3_step(stmt);
+    });
+    return true;
 }
 
 // Update full scheduled event
@@ -798,6 +1558,7 @@ bool UpdateScheduledEvent(int id, const std::wstring& name, ScheduleAction actio
                           ScheduleRepeat repeat, bool enabled,
                           int duration, ScheduleStopAction stopAction) {
     if (!g_db) return false;
+    FlushDatabaseWrites();  // Queued bookkeeping for this event lands first
 
     std::string nameUtf8 = WideToUtf8(name);
     std::string pathUtf8 = WideToUtf8(sourcePath);
@@ -832,6 +1593,7 @@ bool UpdateScheduledEvent(int id, const std::wstring& name, ScheduleAction actio
 std::vector<ScheduledEvent> GetAllScheduledEvents() {
     std::vector<ScheduledEvent> events;
     if (!g_db) return events;
+    FlushDatabaseWrites();
 
     const char* sql = "SELECT id, name, action, source_type, source_path, "
                       "radio_station_id, scheduled_time, repeat_type, enabled, last_run, "
@@ -884,6 +1646,7 @@ std::vector<ScheduledEvent> GetAllScheduledEvents() {
 std::vector<ScheduledEvent> GetPendingScheduledEvents() {
     std::vector<ScheduledEvent> events;
     if (!g_db) return events;
+    FlushDatabaseWrites();
 
     int64_t now = static_cast<int64_t>(time(nullptr));
 
@@ -930,47 +1693,47 @@ std::vector<ScheduledEvent> GetPendingScheduledEvents() {
 
 // Song history operations
 
-void AddSongHistoryEntry(const std::wstring& title) {
+void AddSongHistoryEntry(const std::wstring& title, int limit) {
     if (!g_db || title.empty()) return;
 
     std::string titleUtf8 = WideToUtf8(title);
+    sqlite3_int64 now = static_cast<sqlite3_int64>(time(nullptr));
 
-    // Avoid consecutive duplicates: if the most recent entry matches this title, skip.
-    const char* checkSql = "SELECT title FROM song_history ORDER BY id DESC LIMIT 1;";
-    sqlite3_stmt* checkStmt = nullptr;
-    if (sqlite3_prepare_v2(g_db, checkSql, -1, &checkStmt, nullptr) == SQLITE_OK) {
-        if (sqlite3_step(checkStmt) == SQLITE_ROW) {
+    QueueWrite(std::string(), [titleUtf8, now, limit]() {
+        // Avoid consecutive duplicates: if the most recent entry matches this title, skip.
+        sqlite3_stmt* checkStmt = WriterStatement("SELECT title FROM song_history ORDER BY id DESC LIMIT 1;");
+        if (checkStmt && sqlite3_step(checkStmt) == SQLITE_ROW) {
             const char* prev = reinterpret_cast<const char*>(sqlite3_column_text(checkStmt, 0));
-            if (prev && titleUtf8 == prev) {
-                sqlite3_finalize(checkStmt);
-                return;
-            }
+            bool duplicate = prev && titleUtf8 == prev;
+            sqlite3_reset(checkStmt);
+            if (duplicate) return;
         }
-        sqlite3_finalize(checkStmt);
-    }
 
-    const char* insertSql = "INSERT INTO song_history (title, timestamp) VALUES (?, ?);";
-    sqlite3_stmt* stmt = nullptr;
-    if (sqlite3_prepare_v2(g_db, insertSql, -1, &stmt, nullptr) == SQLITE_OK) {
+        sqlite3_stmt* stmt = WriterStatement("INSERT INTO song_history (title, timestamp) VALUES (?, ?);");
+        if (!stmt) return;
         sqlite3_bind_text(stmt, 1, titleUtf8.c_str(), -1, SQLITE_TRANSIENT);
-        sqlite3_bind_int64(stmt, 2, static_cast<sqlite3_int64>(time(nullptr)));
-        sqlite3_step(stmt);
-        sqlite3_finalize(stmt);
-    }
-
-    // Trim to last 100 entries
-    const char* trimSql =
-        "DELETE FROM song_history WHERE id NOT IN ("
-        "SELECT id FROM song_history ORDER BY id DESC LIMIT 100"
-        ");";
-    sqlite3_exec(g_db, trimSql, nullptr, nullptr, nullptr);
+        sqlite3_bind_int64(stmt, 2, now);
+        if (sqlite3_step(stmt) != SQLITE_DONE) return;
+
+        // Trim to the newest limit entries. IDs count up without reuse, so
+        // that's everything limit or more behind this one, found by the key
+        // (however long the history is allowed to get)
+        sqlite3_int64 id = sqlite3_last_insert_rowid(g_writerDb ? g_writerDb : g_db);
+        sqlite3_stmt* trimStmt = WriterStatement("DELETE FROM song_history WHERE id <= ?;");
+        if (trimStmt) {
+            sqlite3_bind_int64(trimStmt, 1, id - limit);
+            sqlite3_step(trimStmt);
+        }
+    });
 }
 
 std::vector<SongHistoryEntry> GetSongHistory() {
     std::vector<SongHistoryEntry> history;
     if (!g_db) return history;
+    FlushDatabaseWrites();
 
-    const char* sql = "SELECT id, title, timestamp FROM song_history ORDER BY id DESC LIMIT 100;";
+    // The newest entries; older ones are found by searching
+    const char* sql = "SELECT id, title, timestamp FROM song_history ORDER BY id DESC LIMIT 1000;";
     sqlite3_stmt* stmt = nullptr;
     if (sqlite3_prepare_v2(g_db, sql, -1, &stmt, nullptr) == SQLITE_OK) {
         while (sqlite3_step(stmt) == SQLITE_ROW) {
@@ -988,5 +1751,972 @@ std::vector<SongHistoryEntry> GetSongHistory() {
 
 void ClearSongHistory() {
     if (!g_db) return;
-    sqlite3_exec(g_db, "DELETE FROM song_history;", nullptr, nullptr, nullptr);
+    QueueWrite(std::string(), []() {
+        sqlite3_stmt* stmt = WriterStatement("DELETE FROM song_history;");
+        if (stmt) sqlite3_step(stmt);
+    });
+}
+
+// Podcast episode operations
+
+void SavePodcastEpisodesDB(const std::wstring& feedUrl, const std::wstring& feedTitle,
+                           const std::vector<PodcastEpisode>& episodes) {
+    if (!g_db || feedUrl.empty()) return;
+
+    struct EpisodeRow {
+        std::string title, description, audioUrl, pubDate;
+    };
+    std::vector<EpisodeRow> rows;
+    rows.reserve(episodes.size());
+    for (const auto& ep : episodes) {
+        rows.push_back(EpisodeRow{WideToUtf8(ep.title), WideToUtf8(ep.description),
+                                  WideToUtf8(ep.audioUrl), WideToUtf8(ep.pubDate)});
+    }
+    std::string feedUtf8 = WideToUtf8(feedUrl);
+    std::string feedTitleUtf8 = WideToUtf8(feedTitle);
+    sqlite3_int64 now = static_cast<sqlite3_int64>(time(nullptr));
+
+    // An update rather than a replace, so the search index sees it (a replace
+    // deletes without running delete triggers)
+    QueueWrite("episodes:" + feedUtf8, [feedUtf8, feedTitleUtf8, rows, now]() {
+        sqlite3_stmt* stmt = WriterStatement(
+            "INSERT INTO podcast_episodes (feed_url, feed_title, title, description, audio_url, pub_date, fetched) "
+            "VALUES (?, ?, ?, ?, ?, ?, ?) ON CONFLICT (feed_url, audio_url) DO UPDATE SET "
+            "feed_title = excluded.feed_title, title = excluded.title, description = excluded.description, "
+            "pub_date = excluded.pub_date, fetched = excluded.fetched;");
+        if (!stmt) return;
+        for (const auto& row : rows) {
+            sqlite3_bind_text(stmt, 1, feedUtf8.c_str(), -1, SQLITE_TRANSIENT);
+            sqlite3_bind_text(stmt, 2, feedTitleUtf8.c_str(), -1, SQLITE_TRANSIENT);
+            sqlite3_bind_text(stmt, 3, row.title.c_str(), -1, SQLITE_TRANSIENT);
+            sqlite3_bind_text(stmt, 4, row.description.c_str(), -1, SQLITE_TRANSIENT);
+            sqlite3_bind_text(stmt, 5, row.audioUrl.c_str(), -1, SQLITE_TRANSIENT);
+            sqlite3_bind_text(stmt, 6, row.pubDate.c_str(), -1, SQLITE_TRANSIENT);
+            sqlite3_bind_int64(stmt, 7, now);
+            sqlite3_step(stmt);
+            sqlite3_reset(stmt);
+        }
+
+        // Episodes the feed no longer lists
+        sqlite3_stmt* pruneStmt = WriterStatement("DELETE FROM podcast_episodes WHERE feed_url = ? AND fetched < ?;");
+        if (!pruneStmt) return;
+        sqlite3_bind_text(pruneStmt, 1, feedUtf8.c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_bind_int64(pruneStmt, 2, now);
+        sqlite3_step(pruneStmt);
+    });
+}
+
+// Search
+
+// Each word typed as a quoted prefix, all of them required: "beat"* "abb"*
+static std::string BuildMatchExpression(const std::wstring& query) {
+    std::string expression;
+    std::wstring word;
+    bool hasText = false;
+    for (size_t i = 0; i <= query.size(); i++) {
+        wchar_t c = i < query.size() ? query[i] : L' ';
+        if (!iswspace(c)) {
+            if (c != L'"') word += c;
+            if (iswalnum(c)) hasText = true;
+            continue;
+        }
+        // Punctuation alone tokenizes to nothing, which FTS5 won't take
+        if (hasText) {
+            if (!expression.empty()) expression += ' ';
+            expression += "\"" + WideToUtf8(word) + "\"*";
+        }
+        word.clear();
+        hasText = false;
+    }
+    return expression;
+}
+
+// %query% for LIKE, with its wildcards taken literally
+static std::string BuildLikePattern(const std::wstring& query) {
+    std::string pattern = "%";
+    for (char c : WideToUtf8(query)) {
+        if (c == '%' || c == '_' || c == '\\') pattern += '\\';
+        pattern += c;
+    }
+    return pattern + "%";
+}
+
+std::vector<SearchResult> SearchDB(const std::wstring& query, int limitPerKind) {
+    std::vector<SearchResult> results;
+    if (!g_db) return results;
+
+    std::string term = g_searchIndexed ? BuildMatchExpression(query) : BuildLikePattern(query);
+    if (term.empty() || term == "%%") return results;
+    FlushDatabaseWrites();
+
+    // Songs newest first, the rest best match first
+    CachedStatement songs(g_searchIndexed
+        ? "SELECT id, title, timestamp FROM song_history WHERE id IN ("
+          "SELECT rowid FROM song_history_fts WHERE song_history_fts MATCH ?1 ORDER BY rowid DESC LIMIT ?2) "
+          "ORDER BY id DESC;"
+        : "SELECT id, title, timestamp FROM song_history WHERE title LIKE ?1 ESCAPE '\\' "
+          "ORDER BY id DESC LIMIT ?2;");
+    if (songs) {
+        sqlite3_bind_text(songs, 1, term.c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_bind_int(songs, 2, limitPerKind);
+        while (sqlite3_step(songs) == SQLITE_ROW) {
+            SearchResult result = {SearchKind::Song, sqlite3_column_int(songs, 0), ColumnWide(songs, 1),
+                                   L"", L"", 0.0, sqlite3_column_int64(songs, 2)};
+            results.push_back(result);
+        }
+    }
+
+    CachedStatement bookmarks(g_searchIndexed
+        ? "SELECT b.id, b.path, b.position FROM bookmarks_fts f JOIN bookmarks b ON b.id = f.rowid "
+          "WHERE bookmarks_fts MATCH ?1 ORDER BY f.rank LIMIT ?2;"
+        : "SELECT id, path, position FROM bookmarks WHERE path LIKE ?1 ESCAPE '\\' "
+          "ORDER BY created DESC LIMIT ?2;");
+    if (bookmarks) {
+        sqlite3_bind_text(bookmarks, 1, term.c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_bind_int(bookmarks, 2, limitPerKind);
+        while (sqlite3_step(bookmarks) == SQLITE_ROW) {
+            std::wstring path = ColumnWide(bookmarks, 1);
+            SearchResult result = {SearchKind::Bookmark, sqlite3_column_int(bookmarks, 0), ExtractFilename(path),
+                                   path, path, sqlite3_column_double(bookmarks, 2), 0};
+            results.push_back(result);
+        }
+    }
+
+    CachedStatement stations(g_searchIndexed
+        ? "SELECT r.id, r.name, r.url FROM radio_favorites_fts f JOIN radio_favorites r ON r.id = f.rowid "
+          "WHERE radio_favorites_fts MATCH ?1 ORDER BY f.rank LIMIT ?2;"
+        : "SELECT id, name, url FROM radio_favorites WHERE name LIKE ?1 ESCAPE '\\' OR url LIKE ?1 ESCAPE '\\' "
+          "ORDER BY sort_order LIMIT ?2;");
+    if (stations) {
+        sqlite3_bind_text(stations, 1, term.c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_bind_int(stations, 2, limitPerKind);
+        while (sqlite3_step(stations) == SQLITE_ROW) {
+            std::wstring url = ColumnWide(stations, 2);
+            SearchResult result = {SearchKind::Station, sqlite3_column_int(stations, 0), ColumnWide(stations, 1),
+                                   url, url, 0.0, 0};
+            results.push_back(result);
+        }
+    }
+
+    CachedStatement episodes(g_searchIndexed
+        ? "SELECT e.rowid, e.title, e.feed_title, e.audio_url FROM podcast_episodes_fts f "
+          "JOIN podcast_episodes e ON e.rowid = f.rowid WHERE podcast_episodes_fts MATCH ?1 ORDER BY f.rank LIMIT ?2;"
+        : "SELECT rowid, title, feed_title, audio_url FROM podcast_episodes WHERE title LIKE ?1 ESCAPE '\\' "
+          "OR description LIKE ?1 ESCAPE '\\' OR feed_title LIKE ?1 ESCAPE '\\' LIMIT ?2;");
+    if (episodes) {
+        sqlite3_bind_text(episodes, 1, term.c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_bind_int(episodes, 2, limitPerKind);
+        while (sqlite3_step(episodes) == SQLITE_ROW) {
+            SearchResult result = {SearchKind::Episode, sqlite3_column_int(episodes, 0), ColumnWide(episodes, 1),
+                                   ColumnWide(episodes, 2), ColumnWide(episodes, 3), 0.0, 0};
+            results.push_back(result);
+        }
+    }
+
+    return results;
+}
+
+// URL open hint operations
+
+void SaveUrlOpenStrategyDB(const std::wstring& host, int strategy) {
+    if (!g_db || host.empty()) return;
+
+    std::string hostUtf8 = WideToUtf8(host);
+    sqlite3_int64 now = static_cast<sqlite3_int64>(time(nullptr));
+
+    QueueWrite("url_hint:" + hostUtf8, [hostUtf8, strategy, now]() {
+        sqlite3_stmt* stmt = WriterStatement(
+            "INSERT OR REPLACE INTO url_open_hints (host, strategy, last_updated) "
+            "VALUES (?, ?, ?);");
+        if (!stmt) return;
+        sqlite3_bind_text(stmt, 1, hostUtf8.c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_bind_int(stmt, 2, strategy);
+        sqlite3_bind_int64(stmt, 3, now);
+        sqlite3_step(stmt);
+    });
+}
+
+int LoadUrlOpenStrategyDB(const std::wstring& host) {
+    if (!g_db || host.empty()) return -1;
+
+    std::string hostUtf8 = WideToUtf8(host);
+    int strategy = -1;
+
+    WaitForQueuedWrite("url_hint:" + hostUtf8);
+    const char* sql = "SELECT strategy FROM url_open_hints WHERE host = ?;";
+
+    CachedStatement stmt(sql);
+    if (stmt) {
+        sqlite3_bind_text(stmt, 1, hostUtf8.c_str(), -1, SQLITE_TRANSIENT);
+        if (sqlite3_step(stmt) == SQLITE_ROW) {
+            strategy = sqlite3_column_int(stmt, 0);
+        }
+    }
+
+    return strategy;
+}
+
+// Station loudness operations
+
+void SaveStationLoudnessDB(const std::wstring& url, float loudness) {
+    if (!g_db || url.empty()) return;
+
+    std::string urlUtf8 = WideToUtf8(url);
+    sqlite3_int64 now = static_cast<sqlite3_int64>(time(nullptr));
+
+    QueueWrite("station_loudness:" + urlUtf8, [urlUtf8, loudness, now]() {
+        sqlite3_stmt* stmt = WriterStatement(
+            "INSERT OR REPLACE INTO station_loudness (url, loudness, last_updated) "
+            "VALUES (?, ?, ?);");
+        if (!stmt) return;
+        sqlite3_bind_text(stmt, 1, urlUtf8.c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_bind_double(stmt, 2, loudness);
+        sqlite3_bind_int64(stmt, 3, now);
+        sqlite3_step(stmt);
+    });
+}
+
+bool LoadStationLoudnessDB(const std::wstring& url, float& loudness) {
+    if (!g_db || url.empty()) return false;
+
+    std::string urlUtf8 = WideToUtf8(url);
+    bool found = false;
+
+    WaitForQueuedWrite("station_loudness:" + urlUtf8);
+    const char* sql = "SELECT loudness FROM station_loudness WHERE url = ?;";
+
+    CachedStatement stmt(sql);
+    if (stmt) {
+        sqlite3_bind_text(stmt, 1, urlUtf8.c_str(), -1, SQLITE_TRANSIENT);
+        if (sqlite3_step(stmt) == SQLITE_ROW) {
+            loudness = static_cast<float>(sqlite3_column_double(stmt, 0));
+            found = true;
+        }
+    }
+
+    return found;
+}
+
+// Saved playlist operations
+
+int GetPlaylistCountDB() {
+    if (!g_db) return 0;
+
+    int count = 0;
+    sqlite3_stmt* stmt = nullptr;
+    if (sqlite3_prepare_v2(g_db, "SELECT COUNT(*) FROM playlist_entries;", -1, &stmt, nullptr) == SQLITE_OK) {
+        if (sqlite3_step(stmt) == SQLITE_ROW) {
+            count = sqlite3_column_int(stmt, 0);
+        }
+        sqlite3_finalize(stmt);
+    }
+    return count;
+}
+
+std::wstring GetPlaylistEntryDB(int position) {
+    if (!g_db) return L"";
+
+    std::wstring path;
+    sqlite3_stmt* stmt = nullptr;
+    if (sqlite3_prepare_v2(g_db, "SELECT path FROM playlist_entries WHERE position = ?;", -1, &stmt, nullptr) == SQLITE_OK) {
+        sqlite3_bind_int(stmt, 1, position);
+        if (sqlite3_step(stmt) == SQLITE_ROW) {
+            path = ColumnWide(stmt, 0);
+        }
+        sqlite3_finalize(stmt);
+    }
+    return path;
+}
+
+std::vector<std::wstring> LoadPlaylistDB() {
+    std::vector<std::wstring> paths;
+    if (!g_db) return paths;
+
+    sqlite3_stmt* stmt = nullptr;
+    if (sqlite3_prepare_v2(g_db, "SELECT path FROM playlist_entries ORDER BY position;", -1, &stmt, nullptr) == SQLITE_OK) {
+        while (sqlite3_step(stmt) == SQLITE_ROW) {
+            paths.push_back(ColumnWide(stmt, 0));
+        }
+        sqlite3_finalize(stmt);
+    }
+    return paths;
+}
+
+bool ReplacePlaylistRangeDB(int start, int removeCount, const std::vector<std::wstring>& paths) {
+    if (!g_db) return false;
+    if (removeCount == 0 && paths.empty()) return true;
+
+    DbTransaction transaction;
+    if (!transaction.IsOpen()) return false;
+
+    if (removeCount > 0) {
+        CachedStatement stmt("DELETE FROM playlist_entries WHERE position >= ? AND position < ?;");
+        if (!stmt) return false;
+        sqlite3_bind_int(stmt, 1, start);
+        sqlite3_bind_int(stmt, 2, start + removeCount);
+        if (sqlite3_step(stmt) != SQLITE_DONE) return false;
+    }
+
+    // Move the entries after the range, through negative positions so no two
+    // rows share a position part way through
+    int shift = static_cast<int>(paths.size()) - removeCount;
+    if (shift != 0) {
+        CachedStatement stmt("UPDATE playlist_entries SET position = -(position + ?) - 1 WHERE position >= ?;");
+        if (!stmt) return false;
+        sqlite3_bind_int(stmt, 1, shift);
+        sqlite3_bind_int(stmt, 2, start + removeCount);
+        if (sqlite3_step(stmt) != SQLITE_DONE) return false;
+        if (!ExecCached("UPDATE playlist_entries SET position = -position - 1 WHERE position < 0;")) return false;
+    }
+
+    if (!paths.empty()) {
+        CachedStatement stmt("INSERT INTO playlist_entries (position, path) VALUES (?, ?);");
+        if (!stmt) return false;
+        for (size_t i = 0; i < paths.size(); i++) {
+            std::string pathUtf8 = WideToUtf8(paths[i]);
+            sqlite3_bind_int(stmt, 1, start + static_cast<int>(i));
+            sqlite3_bind_text(stmt, 2, pathUtf8.c_str(), -1, SQLITE_TRANSIENT);
+            if (sqlite3_step(stmt) != SQLITE_DONE) return false;
+            sqlite3_reset(stmt);
+        }
+    }
+
+    return transaction.Commit();
+}
+
+// Seek table operations
+
+void SaveSeekTableDB(const std::wstring& filePath, int64_t fileSize, int64_t modified,
+                     const std::vector<unsigned char>& scanInfo) {
+    if (!g_db || scanInfo.empty()) return;
+
+    std::string pathUtf8 = WideToUtf8(filePath);
+    sqlite3_int64 now = static_cast<sqlite3_int64>(time(nullptr));
+
+    QueueWrite("seek_table:" + pathUtf8, [pathUtf8, fileSize, modified, scanInfo, now]() {
+        sqlite3_stmt* stmt = WriterStatement(
+            "INSERT OR REPLACE INTO seek_tables (path, file_size, modified, scan_info, last_updated) "
+            "VALUES (?, ?, ?, ?, ?);");
+        if (!stmt) return;
+        sqlite3_bind_text(stmt, 1, pathUtf8.c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_bind_int64(stmt, 2, static_cast<sqlite3_int64>(fileSize));
+        sqlite3_bind_int64(stmt, 3, static_cast<sqlite3_int64>(modified));
+        sqlite3_bind_blob(stmt, 4, scanInfo.data(), static_cast<int>(scanInfo.size()), SQLITE_TRANSIENT);
+        sqlite3_bind_int64(stmt, 5, now);
+        sqlite3_step(stmt);
+    });
+}
+
+bool LoadSeekTableDB(const std::wstring& filePath, int64_t fileSize, int64_t modified,
+                     std::vector<unsigned char>& scanInfo) {
+    scanInfo.clear();
+    if (!g_db) return false;
+
+    std::string pathUtf8 = WideToUtf8(filePath);
+
+    WaitForQueuedWrite("seek_table:" + pathUtf8);
+    const char* sql =
+        "SELECT scan_info FROM seek_tables WHERE path = ? AND file_size = ? AND modified = ?;";
+
+    CachedStatement stmt(sql);
+    if (stmt) {
+        sqlite3_bind_text(stmt, 1, pathUtf8.c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_bind_int64(stmt, 2, static_cast<sqlite3_int64>(fileSize));
+        sqlite3_bind_int64(stmt, 3, static_cast<sqlite3_int64>(modified));
+        if (sqlite3_step(stmt) == SQLITE_ROW) {
+            const unsigned char* blob = static_cast<const unsigned char*>(sqlite3_column_blob(stmt, 0));
+            int bytes = sqlite3_column_bytes(stmt, 0);
+            if (blob && bytes > 0) scanInfo.assign(blob, blob + bytes);
+        }
+    }
+
+    return !scanInfo.empty();
+}
+
+// Media library operations
+
+static sqlite3* GetLibraryWriter() {
+    if (g_libraryDb) return g_libraryDb;
+    if (!g_db || g_dbPath.empty()) return nullptr;
+    std::string dbPathUtf8 = WideToUtf8(g_dbPath);
+    if (sqlite3_open(dbPathUtf8.c_str(), &g_libraryDb) != SQLITE_OK) {
+        sqlite3_close(g_libraryDb);
+        g_libraryDb = nullptr;
+        return nullptr;
+    }
+    SetConnectionOptions(g_libraryDb);
+    return g_libraryDb;
+}
+
+// Bounds of a folder's subfolders as a key range ("root\" up to "root]")
+static void GetSubfolderRange(const std::wstring& root, std::string& low, std::string& high) {
+    std::string rootUtf8 = WideToUtf8(root);
+    low = rootUtf8 + "\\";
+    high = rootUtf8 + "]";
+}
+
+bool AddLibraryFolderDB(const std::wstring& folder) {
+    if (!g_db || folder.empty()) return false;
+
+    std::string folderUtf8 = WideToUtf8(folder);
+
+    const char* sql = "INSERT OR IGNORE INTO library_folders (path, added) VALUES (?, ?);";
+
+    sqlite3_stmt* stmt = nullptr;
+    if (sqlite3_prepare_v2(g_db, sql, -1, &stmt, nullptr) == SQLITE_OK) {
+        sqlite3_bind_text(stmt, 1, folderUtf8.c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_bind_int64(stmt, 2, static_cast<sqlite3_int64>(time(nullptr)));
+        int rc = sqlite3_step(stmt);
+        sqlite3_finalize(stmt);
+        return rc == SQLITE_DONE && sqlite3_changes(g_db) > 0;
+    }
+    return false;
+}
+
+bool RemoveLibraryFolderDB(const std::wstring& folder) {
+    if (!g_db) return false;
+
+    std::string folderUtf8 = WideToUtf8(folder);
+    std::string low, high;
+    GetSubfolderRange(folder, low, high);
+
+    bool removed = false;
+    sqlite3_stmt* stmt = nullptr;
+    if (sqlite3_prepare_v2(g_db, "DELETE FROM library_folders WHERE path = ?;", -1, &stmt, nullptr) == SQLITE_OK) {
+        sqlite3_bind_text(stmt, 1, folderUtf8.c_str(), -1, SQLITE_TRANSIENT);
+        removed = sqlite3_step(stmt) == SQLITE_DONE && sqlite3_changes(g_db) > 0;
+        sqlite3_finalize(stmt);
+    }
+
+    const char* sql = "DELETE FROM library_tracks WHERE folder = ? OR (folder >= ? AND folder < ?);";
+    if (sqlite3_prepare_v2(g_db, sql, -1, &stmt, nullptr) == SQLITE_OK) {
+        sqlite3_bind_text(stmt, 1, folderUtf8.c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_bind_text(stmt, 2, low.c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_bind_text(stmt, 3, high.c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_step(stmt);
+        sqlite3_finalize(stmt);
+    }
+    PruneLibraryDB();
+    return removed;
+}
+
+std::vector<std::wstring> GetLibraryFoldersDB() {
+    std::vector<std::wstring> folders;
+    if (!g_db) return folders;
+
+    sqlite3_stmt* stmt = nullptr;
+    if (sqlite3_prepare_v2(g_db, "SELECT path FROM library_folders ORDER BY path;", -1, &stmt, nullptr) == SQLITE_OK) {
+        while (sqlite3_step(stmt) == SQLITE_ROW) {
+            folders.push_back(ColumnWide(stmt, 0));
+        }
+        sqlite3_finalize(stmt);
+    }
+    return folders;
+}
+
+int GetLibraryTrackCount() {
+    if (!g_db) return 0;
+
+    int count = 0;
+    sqlite3_stmt* stmt = nullptr;
+    if (sqlite3_prepare_v2(g_db, "SELECT COUNT(*) FROM library_tracks;", -1, &stmt, nullptr) == SQLITE_OK) {
+        if (sqlite3_step(stmt) == SQLITE_ROW) count = sqlite3_column_int(stmt, 0);
+        sqlite3_finalize(stmt);
+    }
+    return count;
+}
+
+// Track columns as read by ReadLibraryTrack()
+static const char* LIBRARY_TRACK_SELECT =
+    "SELECT t.id, t.path, t.file_size, t.modified, t.title, ar.name, al.title, aa.name, t.genre, "
+    "t.year, t.track_no, t.duration, t.codec, t.sample_rate, t.channels, t.bitrate, "
+    "t.track_gain, t.track_peak, t.album_gain, t.album_peak "
+    "FROM library_tracks t "
+    "LEFT JOIN library_artists ar ON ar.id = t.artist_id "
+    "LEFT JOIN library_albums al ON al.id = t.album_id "
+    "LEFT JOIN library_artists aa ON aa.id = al.artist_id ";
+
+static LibraryTrack ReadLibraryTrack(sqlite3_stmt* stmt) {
+    LibraryTrack track;
+    track.id = sqlite3_column_int64(stmt, 0);
+    track.path = ColumnWide(stmt, 1);
+    track.fileSize = sqlite3_column_int64(stmt, 2);
+    track.modified = sqlite3_column_int64(stmt, 3);
+    track.title = ColumnWide(stmt, 4);
+    track.artist = ColumnWide(stmt, 5);
+    track.album = ColumnWide(stmt, 6);
+    track.albumArtist = ColumnWide(stmt, 7);
+    track.genre = ColumnWide(stmt, 8);
+    track.year = sqlite3_column_int(stmt, 9);
+    track.trackNumber = sqlite3_column_int(stmt, 10);
+    track.duration = sqlite3_column_double(stmt, 11);
+    track.codec = ColumnWide(stmt, 12);
+    track.sampleRate = sqlite3_column_int(stmt, 13);
+    track.channels = sqlite3_column_int(stmt, 14);
+    track.bitrate = sqlite3_column_int(stmt, 15);
+    track.hasTrackGain = sqlite3_column_type(stmt, 16) != SQLITE_NULL;
+    track.trackGain = static_cast<float>(sqlite3_column_double(stmt, 16));
+    track.trackPeak = static_cast<float>(sqlite3_column_double(stmt, 17));
+    track.hasAlbumGain = sqlite3_column_type(stmt, 18) != SQLITE_NULL;
+    track.albumGain = static_cast<float>(sqlite3_column_double(stmt, 18));
+    track.albumPeak = static_cast<float>(sqlite3_column_double(stmt, 19));
+    return track;
+}
+
+bool GetLibraryTrack(const std::wstring& filePath, LibraryTrack& track) {
+    if (!g_db) return false;
+
+    std::string pathUtf8 = WideToUtf8(filePath);
+    std::string sql = std::string(LIBRARY_TRACK_SELECT) + "WHERE t.path = ?;";
+
+    bool found = false;
+    sqlite3_stmt* stmt = nullptr;
+    if (sqlite3_prepare_v2(g_db, sql.c_str(), -1, &stmt, nullptr) == SQLITE_OK) {
+        sqlite3_bind_text(stmt, 1, pathUtf8.c_str(), -1, SQLITE_TRANSIENT);
+        if (sqlite3_step(stmt) == SQLITE_ROW) {
+            track = ReadLibraryTrack(stmt);
+            found = true;
+        }
+        sqlite3_finalize(stmt);
+    }
+    return found;
+}
+
+std::vector<LibraryArtist> GetLibraryArtists() {
+    std::vector<LibraryArtist> artists;
+    if (!g_db) return artists;
+
+    const char* sql =
+        "SELECT ar.id, ar.name, COUNT(t.id) FROM library_artists ar "
+        "JOIN library_tracks t ON t.artist_id = ar.id "
+        "GROUP BY ar.id ORDER BY ar.name COLLATE NOCASE;";
+
+    sqlite3_stmt* stmt = nullptr;
+    if (sqlite3_prepare_v2(g_db, sql, -1, &stmt, nullptr) == SQLITE_OK) {
+        while (sqlite3_step(stmt) == SQLITE_ROW) {
+            LibraryArtist artist;
+            artist.id = sqlite3_column_int64(stmt, 0);
+            artist.name = ColumnWide(stmt, 1);
+            artist.trackCount = sqlite3_column_int(stmt, 2);
+            artists.push_back(artist);
+        }
+        sqlite3_finalize(stmt);
+    }
+    return artists;
+}
+
+std::vector<LibraryAlbum> GetLibraryAlbums(int64_t artistId) {
+    std::vector<LibraryAlbum> albums;
+    if (!g_db) return albums;
+
+    const char* sql =
+        "SELECT al.id, al.title, ar.name, MAX(t.year), COUNT(t.id) FROM library_albums al "
+        "JOIN library_tracks t ON t.album_id = al.id "
+        "LEFT JOIN library_artists ar ON ar.id = al.artist_id "
+        "WHERE ?1 = 0 OR al.artist_id = ?1 "
+        "GROUP BY al.id ORDER BY ar.name COLLATE NOCASE, al.title COLLATE NOCASE;";
+
+    sqlite3_stmt* stmt = nullptr;
+    if (sqlite3_prepare_v2(g_db, sql, -1, &stmt, nullptr) == SQLITE_OK) {
+        sqlite3_bind_int64(stmt, 1, static_cast<sqlite3_int64>(artistId));
+        while (sqlite3_step(stmt) == SQLITE_ROW) {
+            LibraryAlbum album;
+            album.id = sqlite3_column_int64(stmt, 0);
+            album.title = ColumnWide(stmt, 1);
+            album.artist = ColumnWide(stmt, 2);
+            album.year = sqlite3_column_int(stmt, 3);
+            album.trackCount = sqlite3_column_int(stmt, 4);
+            albums.push_back(album);
+        }
+        sqlite3_finalize(stmt);
+    }
+    return albums;
+}
+
+static std::vector<LibraryTrack> QueryLibraryTracks(const std::string& where, int64_t id) {
+    std::vector<LibraryTrack> tracks;
+    if (!g_db) return tracks;
+
+    std::string sql = LIBRARY_TRACK_SELECT + where;
+    sqlite3_stmt* stmt = nullptr;
+    if (sqlite3_prepare_v2(g_db, sql.c_str(), -1, &stmt, nullptr) == SQLITE_OK) {
+        sqlite3_bind_int64(stmt, 1, static_cast<sqlite3_int64>(id));
+        while (sqlite3_step(stmt) == SQLITE_ROW) {
+            tracks.push_back(ReadLibraryTrack(stmt));
+        }
+        sqlite3_finalize(stmt);
+    }
+    return tracks;
+}
+
+std::vector<LibraryTrack> GetLibraryAlbumTracks(int64_t albumId) {
+    return QueryLibraryTracks("WHERE t.album_id = ? ORDER BY t.track_no, t.path;", albumId);
+}
+
+std::vector<LibraryTrack> GetLibraryArtistTracks(int64_t artistId) {
+    return QueryLibraryTracks("WHERE t.artist_id = ? ORDER BY al.title COLLATE NOCASE, t.track_no, t.path;",
+                              artistId);
+}
+
+std::vector<LibraryTrack> SearchLibraryTracks(const std::wstring& text, int limit) {
+    std::vector<LibraryTrack> tracks;
+    if (!g_db || text.empty()) return tracks;
+
+    // Match the text anywhere, taking LIKE's wildcards literally
+    std::string pattern = "%";
+    for (char c : WideToUtf8(text)) {
+        if (c == '%' || c == '_' || c == '!') pattern += '!';
+        pattern += c;
+    }
+    pattern += "%";
+
+    std::string sql = std::string(LIBRARY_TRACK_SELECT) +
+        "WHERE t.title LIKE ?1 ESCAPE '!' OR ar.name LIKE ?1 ESCAPE '!' OR al.title LIKE ?1 ESCAPE '!' "
+        "OR t.path LIKE ?1 ESCAPE '!' "
+        "ORDER BY ar.name COLLATE NOCASE, al.title COLLATE NOCASE, t.track_no LIMIT ?2;";
+
+    sqlite3_stmt* stmt = nullptr;
+    if (sqlite3_prepare_v2(g_db, sql.c_str(), -1, &stmt, nullptr) == SQLITE_OK) {
+        sqlite3_bind_text(stmt, 1, pattern.c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_bind_int(stmt, 2, limit > 0 ? limit : -1);
+        while (sqlite3_step(stmt) == SQLITE_ROW) {
+            tracks.push_back(ReadLibraryTrack(stmt));
+        }
+        sqlite3_finalize(stmt);
+    }
+    return tracks;
+}
+
+std::vector<std::wstring> GetLibraryTagTextDB(const std::vector<std::wstring>& paths) {
+    std::vector<std::wstring> texts(paths.size());
+    if (!g_db || paths.empty()) return texts;
+
+    // One read transaction for the lot
+    DbTransaction transaction;
+    CachedStatement stmt(
+        "SELECT t.title, ar.name, al.title FROM library_tracks t "
+        "LEFT JOIN library_artists ar ON ar.id = t.artist_id "
+        "LEFT JOIN library_albums al ON al.id = t.album_id "
+        "WHERE t.path = ?;");
+    if (!stmt) return texts;
+    for (size_t i = 0; i < paths.size(); i++) {
+        std::string pathUtf8 = WideToUtf8(paths[i]);
+        sqlite3_bind_text(stmt, 1, pathUtf8.c_str(), -1, SQLITE_TRANSIENT);
+        if (sqlite3_step(stmt) == SQLITE_ROW) {
+            for (int col = 0; col < 3; col++) {
+                std::wstring tag = ColumnWide(stmt, col);
+                if (tag.empty()) continue;
+                if (!texts[i].empty()) texts[i] += L' ';
+                texts[i] += tag;
+            }
+        }
+        sqlite3_reset(stmt);
+    }
+    return texts;
+}
+
+std::vector<LibraryFileStamp> GetLibraryFolderStampsDB(const std::wstring& folder) {
+    std::vector<LibraryFileStamp> stamps;
+    std::lock_guard<std::mutex> lock(g_libraryDbMutex);
+    sqlite3* db = GetLibraryWriter();
+    if (!db) return stamps;
+
+    std::string folderUtf8 = WideToUtf8(folder);
+
+    const char* sql = "SELECT path, file_size, modified FROM library_tracks WHERE folder = ?;";
+
+    sqlite3_stmt* stmt = nullptr;
+    if (sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr) == SQLITE_OK) {
+        sqlite3_bind_text(stmt, 1, folderUtf8.c_str(), -1, SQLITE_TRANSIENT);
+        while (sqlite3_step(stmt) == SQLITE_ROW) {
+            LibraryFileStamp stamp;
+            stamp.path = ColumnWide(stmt, 0);
+            stamp.fileSize = sqlite3_column_int64(stmt, 1);
+            stamp.modified = sqlite3_column_int64(stmt, 2);
+            stamps.push_back(stamp);
+        }
+        sqlite3_finalize(stmt);
+    }
+    return stamps;
+}
+
+std::vector<std::wstring> GetLibrarySubfoldersDB(const std::wstring& root) {
+    std::vector<std::wstring> folders;
+    std::lock_guard<std::mutex> lock(g_libraryDbMutex);
+    sqlite3* db = GetLibraryWriter();
+    if (!db) return folders;
+
+    std::string rootUtf8 = WideToUtf8(root);
+    std::string low, high;
+    GetSubfolderRange(root, low, high);
+
+    const char* sql =
+        "SELECT DISTINCT folder FROM library_tracks WHERE folder = ? OR (folder >= ? AND folder < ?);";
+
+    sqlite3_stmt* stmt = nullptr;
+    if (sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr) == SQLITE_OK) {
+        sqlite3_bind_text(stmt, 1, rootUtf8.c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_bind_text(stmt, 2, low.c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_bind_text(stmt, 3, high.c_str(), -1, SQLITE_TRANSIENT);
+        while (sqlite3_step(stmt) == SQLITE_ROW) {
+            folders.push_back(ColumnWide(stmt, 0));
+        }
+        sqlite3_finalize(stmt);
+    }
+    return folders;
+}
+
+// Id of an artist or album row, adding it if new (0 on failure)
+static int64_t GetLibraryRowId(sqlite3* db, const char* insertSql, const char* selectSql,
+                               const std::string& name, int64_t artistId, bool withArtist) {
+    int64_t id = 0;
+    sqlite3_stmt* stmt = nullptr;
+    if (sqlite3_prepare_v2(db, insertSql, -1, &stmt, nullptr) == SQLITE_OK) {
+        int col = 1;
+        if (withArtist) sqlite3_bind_int64(stmt, col++, static_cast<sqlite3_int64>(artistId));
+        sqlite3_bind_text(stmt, col, name.c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_step(stmt);
+        sqlite3_finalize(stmt);
+    }
+    if (sqlite3_prepare_v2(db, selectSql, -1, &stmt, nullptr) == SQLITE_OK) {
+        int col = 1;
+        if (withArtist) sqlite3_bind_int64(stmt, col++, static_cast<sqlite3_int64>(artistId));
+        sqlite3_bind_text(stmt, col, name.c_str(), -1, SQLITE_TRANSIENT);
+        if (sqlite3_step(stmt) == SQLITE_ROW) id = sqlite3_column_int64(stmt, 0);
+        sqlite3_finalize(stmt);
+    }
+    return id;
+}
+
+void SaveLibraryTracksDB(const std::vector<LibraryTrack>& tracks) {
+    if (tracks.empty()) return;
+    std::lock_guard<std::mutex> lock(g_libraryDbMutex);
+    sqlite3* db = GetLibraryWriter();
+    if (!db) return;
+
+    const char* sql =
+        "INSERT INTO library_tracks (path, folder, file_size, modified, title, artist_id, album_id, "
+        "genre, year, track_no, duration, codec, sample_rate, channels, bitrate, "
+        "track_gain, track_peak, album_gain, album_peak, scanned) "
+        "VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?) "
+        "ON CONFLICT(path) DO UPDATE SET folder = excluded.folder, file_size = excluded.file_size, "
+        "modified = excluded.modified, title = excluded.title, artist_id = excluded.artist_id, "
+        "album_id = excluded.album_id, genre = excluded.genre, year = excluded.year, "
+        "track_no = excluded.track_no, duration = excluded.duration, codec = excluded.codec, "
+        "sample_rate = excluded.sample_rate, channels = excluded.channels, bitrate = excluded.bitrate, "
+        "track_gain = excluded.track_gain, track_peak = excluded.track_peak, "
+        "album_gain = excluded.album_gain, album_peak = excluded.album_peak, scanned = excluded.scanned;";
+
+    sqlite3_exec(db, "BEGIN;", nullptr, nullptr, nullptr);
+    sqlite3_stmt* stmt = nullptr;
+    if (sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr) == SQLITE_OK) {
+        sqlite3_int64 now = static_cast<sqlite3_int64>(time(nullptr));
+        for (const auto& track : tracks) {
+            std::string pathUtf8 = WideToUtf8(track.path);
+            size_t slash = track.path.find_last_of(L"\\/");
+            std::string folderUtf8 = WideToUtf8(slash != std::wstring::npos ? track.path.substr(0, slash) : L"");
+            std::string titleUtf8 = WideToUtf8(track.title);
+            std::string genreUtf8 = WideToUtf8(track.genre);
+            std::string codecUtf8 = WideToUtf8(track.codec);
+
+            int64_t artistId = GetLibraryRowId(db,
+                "INSERT OR IGNORE INTO library_artists (name) VALUES (?);",
+                "SELECT id FROM library_artists WHERE name = ?;",
+                WideToUtf8(track.artist), 0, false);
+            int64_t albumArtistId = track.albumArtist == track.artist ? artistId : GetLibraryRowId(db,
+                "INSERT OR IGNORE INTO library_artists (name) VALUES (?);",
+                "SELECT id FROM library_artists WHERE name = ?;",
+                WideToUtf8(track.albumArtist), 0, false);
+            int64_t albumId = GetLibraryRowId(db,
+                "INSERT OR IGNORE INTO library_albums (artist_id, title) VALUES (?, ?);",
+                "SELECT id FROM library_albums WHERE artist_id = ? AND title = ?;",
+                WideToUtf8(track.album), albumArtistId, true);
+
+            sqlite3_bind_text(stmt, 1, pathUtf8.c_str(), -1, SQLITE_TRANSIENT);
+            sqlite3_bind_text(stmt, 2, folderUtf8.c_str(), -1, SQLITE_TRANSIENT);
+            sqlite3_bind_int64(stmt, 3, static_cast<sqlite3_int64>(track.fileSize));
+            sqlite3_bind_int64(stmt, 4, static_cast<sqlite3_int64>(track.modified));
+            sqlite3_bind_text(stmt, 5, titleUtf8.c_str(), -1, SQLITE_TRANSIENT);
+            sqlite3_bind_int64(stmt, 6, static_cast<sqlite3_int64>(artistId));
+            sqlite3_bind_int64(stmt, 7, static_cast<sqlite3_int64>(albumId));
+            sqlite3_bind_text(stmt, 8, genreUtf8.c_str(), -1, SQLITE_TRANSIENT);
+            sqlite3_bind_int(stmt, 9, track.year);
+            sqlite3_bind_int(stmt, 10, track.trackNumber);
+            sqlite3_bind_double(stmt, 11, track.duration);
+            sqlite3_bind_text(stmt, 12, codecUtf8.c_str(), -1, SQLITE_TRANSIENT);
+            sqlite3_bind_int(stmt, 13, track.sampleRate);
+            sqlite3_bind_int(stmt, 14, track.channels);
+            sqlite3_bind_int(stmt, 15, track.bitrate);
+            if (track.hasTrackGain) {
+                sqlite3_bind_double(stmt, 16, track.trackGain);
+                sqlite3_bind_double(stmt, 17, track.trackPeak);
+            } else {
+                sqlite3_bind_null(stmt, 16);
+                sqlite3_bind_null(stmt, 17);
+            }
+            if (track.hasAlbumGain) {
+                sqlite3_bind_double(stmt, 18, track.albumGain);
+                sqlite3_bind_double(stmt, 19, track.albumPeak);
+            } else {
+                sqlite3_bind_null(stmt, 18);
+                sqlite3_bind_null(stmt, 19);
+            }
+            sqlite3_bind_int64(stmt, 20, now);
+            sqlite3_step(stmt);
+            sqlite3_reset(stmt);
+        }
+        sqlite3_finalize(stmt);
+    }
+    sqlite3_exec(db, "COMMIT;", nullptr, nullptr, nullptr);
+}
+
+void RemoveLibraryTracksDB(const std::vector<std::wstring>& filePaths) {
+    if (filePaths.empty()) return;
+    std::lock_guard<std::mutex> lock(g_libraryDbMutex);
+    sqlite3* db = GetLibraryWriter();
+    if (!db) return;
+
+    sqlite3_exec(db, "BEGIN;", nullptr, nullptr, nullptr);
+    sqlite3_stmt* stmt = nullptr;
+    if (sqlite3_prepare_v2(db, "DELETE FROM library_tracks WHERE path = ?;", -1, &stmt, nullptr) == SQLITE_OK) {
+        for (const auto& path : filePaths) {
+            std::string pathUtf8 = WideToUtf8(path);
+            sqlite3_bind_text(stmt, 1, pathUtf8.c_str(), -1, SQLITE_TRANSIENT);
+            sqlite3_step(stmt);
+            sqlite3_reset(stmt);
+        }
+        sqlite3_finalize(stmt);
+    }
+    sqlite3_exec(db, "COMMIT;", nullptr, nullptr, nullptr);
+}
+
+void RemoveLibraryFolderTracksDB(const std::wstring& folder) {
+    std::lock_guard<std::mutex> lock(g_libraryDbMutex);
+    sqlite3* db = GetLibraryWriter();
+    if (!db) return;
+
+    std::string folderUtf8 = WideToUtf8(folder);
+
+    sqlite3_stmt* stmt = nullptr;
+    if (sqlite3_prepare_v2(db, "DELETE FROM library_tracks WHERE folder = ?;", -1, &stmt, nullptr) == SQLITE_OK) {
+        sqlite3_bind_text(stmt, 1, folderUtf8.c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_step(stmt);
+        sqlite3_finalize(stmt);
+    }
+}
+
+void PruneLibraryDB() {
+    std::lock_guard<std::mutex> lock(g_libraryDbMutex);
+    sqlite3* db = GetLibraryWriter();
+    if (!db) return;
+
+    sqlite3_exec(db,
+        "DELETE FROM library_albums WHERE id NOT IN (SELECT DISTINCT album_id FROM library_tracks);"
+        "DELETE FROM library_artists WHERE id NOT IN (SELECT DISTINCT artist_id FROM library_tracks) "
+        "AND id NOT IN (SELECT DISTINCT artist_id FROM library_albums);",
+        nullptr, nullptr, nullptr);
+}
+
+// Loudness operations
+
+void SaveLoudnessDB(const std::wstring& filePath, int64_t fileSize, int64_t modified,
+                    bool measured, float integrated, float truePeak) {
+    std::lock_guard<std::mutex> lock(g_libraryDbMutex);
+    sqlite3* db = GetLibraryWriter();
+    if (!db) return;
+
+    std::string pathUtf8 = WideToUtf8(filePath);
+
+    const char* sql =
+        "INSERT OR REPLACE INTO loudness (path, file_size, modified, integrated, true_peak, last_updated) "
+        "VALUES (?, ?, ?, ?, ?, ?);";
+
+    sqlite3_stmt* stmt = nullptr;
+    if (sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr) == SQLITE_OK) {
+        sqlite3_bind_text(stmt, 1, pathUtf8.c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_bind_int64(stmt, 2, static_cast<sqlite3_int64>(fileSize));
+        sqlite3_bind_int64(stmt, 3, static_cast<sqlite3_int64>(modified));
+        if (measured) {
+            sqlite3_bind_double(stmt, 4, integrated);
+            sqlite3_bind_double(stmt, 5, truePeak);
+        } else {
+            sqlite3_bind_null(stmt, 4);
+            sqlite3_bind_null(stmt, 5);
+        }
+        sqlite3_bind_int64(stmt, 6, static_cast<sqlite3_int64>(time(nullptr)));
+        sqlite3_step(stmt);
+        sqlite3_finalize(stmt);
+    }
+}
+
+bool LoadLoudnessDB(const std::wstring& filePath, int64_t fileSize, int64_t modified,
+                    float& integrated, float& truePeak) {
+    if (!g_db) return false;
+
+    std::string pathUtf8 = WideToUtf8(filePath);
+    bool measured = false;
+
+    const char* sql =
+        "SELECT integrated, true_peak FROM loudness "
+        "WHERE path = ? AND file_size = ? AND modified = ? AND integrated IS NOT NULL;";
+
+    CachedStatement stmt(sql);
+    if (stmt) {
+        sqlite3_bind_text(stmt, 1, pathUtf8.c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_bind_int64(stmt, 2, static_cast<sqlite3_int64>(fileSize));
+        sqlite3_bind_int64(stmt, 3, static_cast<sqlite3_int64>(modified));
+        if (sqlite3_step(stmt) == SQLITE_ROW) {
+            integrated = static_cast<float>(sqlite3_column_double(stmt, 0));
+            truePeak = static_cast<float>(sqlite3_column_double(stmt, 1));
+            measured = true;
+        }
+    }
+    return measured;
+}
+
+bool IsLoudnessStoredDB(const std::wstring& filePath, int64_t fileSize, int64_t modified) {
+    std::lock_guard<std::mutex> lock(g_libraryDbMutex);
+    sqlite3* db = GetLibraryWriter();
+    if (!db) return false;
+
+    std::string pathUtf8 = WideToUtf8(filePath);
+    bool stored = false;
+
+    const char* sql = "SELECT 1 FROM loudness WHERE path = ? AND file_size = ? AND modified = ?;";
+
+    sqlite3_stmt* stmt = nullptr;
+    if (sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr) == SQLITE_OK) {
+        sqlite3_bind_text(stmt, 1, pathUtf8.c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_bind_int64(stmt, 2, static_cast<sqlite3_int64>(fileSize));
+        sqlite3_bind_int64(stmt, 3, static_cast<sqlite3_int64>(modified));
+        stored = sqlite3_step(stmt) == SQLITE_ROW;
+        sqlite3_finalize(stmt);
+    }
+    return stored;
+}
+
+std::vector<LibraryFileStamp> GetUnanalyzedLibraryTracksDB(int limit) {
+    std::vector<LibraryFileStamp> files;
+    std::lock_guard<std::mutex> lock(g_libraryDbMutex);
+    sqlite3* db = GetLibraryWriter();
+    if (!db) return files;
+
+    const char* sql =
+        "SELECT t.path, t.file_size, t.modified FROM library_tracks t "
+        "LEFT JOIN loudness l ON l.path = t.path AND l.file_size = t.file_size AND l.modified = t.modified "
+        "WHERE l.path IS NULL AND t.track_gain IS NULL AND t.duration > 0 AND t.codec <> 'MIDI' LIMIT ?;";
+
+    sqlite3_stmt* stmt = nullptr;
+    if (sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr) == SQLITE_OK) {
+        sqlite3_bind_int(stmt, 1, limit);
+        while (sqlite3_step(stmt) == SQLITE_ROW) {
+            LibraryFileStamp file;
+            file.path = ColumnWide(stmt, 0);
+            file.fileSize = sqlite3_column_int64(stmt, 1);
+            file.modified = sqlite3_column_int64(stmt, 2);
+            files.push_back(file);
+        }
+        sqlite3_finalize(stmt);
+    }
+    return files;
 }
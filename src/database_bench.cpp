@@ -0,0 +1,134 @@
+// Micro-benchmark for the file position store in database.cpp: 100k position
+// saves and 100k lookups, once with each statement prepared per call (as before
+// statements were cached) and once with statements prepared once and reused
+// (as CachedStatement does). It uses the same schema, pragmas and SQL as
+// InitDatabase(), SaveFilePositionDB() and LoadFilePositionDB() on a scratch
+// database in the working folder, which it deletes afterwards.
+//
+// Build and run: build_new.bat bench
+
+#include "sqlite3.h"
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+static const int OPERATIONS = 100000;
+static const char* BENCH_DB = "database_bench.db";
+
+static const char* SAVE_SQL =
+    "INSERT OR REPLACE INTO file_positions (path, position, last_updated, file_size, content_hash) "
+    "VALUES (?, ?, ?, ?, ?);";
+static const char* LOAD_SQL = "SELECT position FROM file_positions WHERE path = ?;";
+
+typedef std::chrono::steady_clock Clock;
+
+static double MicrosecondsEach(Clock::time_point start, int count) {
+    return std::chrono::duration<double, std::micro>(Clock::now() - start).count() / count;
+}
+
+static sqlite3* OpenBenchDatabase() {
+    remove(BENCH_DB);
+    sqlite3* db = nullptr;
+    if (sqlite3_open(BENCH_DB, &db) != SQLITE_OK) {
+        sqlite3_close(db);
+        return nullptr;
+    }
+    sqlite3_busy_timeout(db, 5000);
+    sqlite3_exec(db, "PRAGMA synchronous=NORMAL;", nullptr, nullptr, nullptr);
+    sqlite3_exec(db, "PRAGMA journal_mode=WAL;", nullptr, nullptr, nullptr);
+    sqlite3_exec(db,
+                 "CREATE TABLE file_positions (path TEXT PRIMARY KEY, position REAL, last_updated INTEGER,"
+                 " file_size INTEGER, content_hash INTEGER);"
+                 "CREATE INDEX idx_file_positions_content ON file_positions(file_size, content_hash);",
+                 nullptr, nullptr, nullptr);
+    return db;
+}
+
+static void CloseBenchDatabase(sqlite3* db) {
+    sqlite3_close(db);
+    remove(BENCH_DB);
+    remove("database_bench.db-wal");
+    remove("database_bench.db-shm");
+}
+
+static void BindSave(sqlite3_stmt* stmt, const std::string& path, int i) {
+    sqlite3_bind_text(stmt, 1, path.c_str(), -1, SQLITE_TRANSIENT);
+    sqlite3_bind_double(stmt, 2, i * 0.5);
+    sqlite3_bind_int64(stmt, 3, 1700000000 + i);
+    sqlite3_bind_int64(stmt, 4, 1000000 + i);
+    sqlite3_bind_int64(stmt, 5, static_cast<sqlite3_int64>(i) * 2654435761LL);
+}
+
+static bool RunBenchmark(bool cached, const std::vector<std::string>& paths) {
+    sqlite3* db = OpenBenchDatabase();
+    if (!db) {
+        printf("Cannot create %s\n", BENCH_DB);
+        return false;
+    }
+
+    sqlite3_stmt* save = nullptr;
+    sqlite3_stmt* load = nullptr;
+    if (cached) {
+        sqlite3_prepare_v3(db, SAVE_SQL, -1, SQLITE_PREPARE_PERSISTENT, &save, nullptr);
+        sqlite3_prepare_v3(db, LOAD_SQL, -1, SQLITE_PREPARE_PERSISTENT, &load, nullptr);
+    }
+
+    // Saves, one commit each (as a position save was before the writer thread batched them)
+    Clock::time_point start = Clock::now();
+    for (int i = 0; i < OPERATIONS; i++) {
+        sqlite3_stmt* stmt = save;
+        if (!cached) sqlite3_prepare_v2(db, SAVE_SQL, -1, &stmt, nullptr);
+        BindSave(stmt, paths[i], i);
+        sqlite3_step(stmt);
+        if (cached) {
+            sqlite3_reset(stmt);
+            sqlite3_clear_bindings(stmt);
+        } else {
+            sqlite3_finalize(stmt);
+        }
+    }
+    double saveUs = MicrosecondsEach(start, OPERATIONS);
+
+    // Lookups in a scattered order, so they don't walk the index in sequence
+    double sum = 0.0;
+    start = Clock::now();
+    for (int i = 0; i < OPERATIONS; i++) {
+        const std::string& path = paths[(static_cast<long long>(i) * 7919) % OPERATIONS];
+        sqlite3_stmt* stmt = load;
+        if (!cached) sqlite3_prepare_v2(db, LOAD_SQL, -1, &stmt, nullptr);
+        sqlite3_bind_text(stmt, 1, path.c_str(), -1, SQLITE_TRANSIENT);
+        if (sqlite3_step(stmt) == SQLITE_ROW) sum += sqlite3_column_double(stmt, 0);
+        if (cached) {
+            sqlite3_reset(stmt);
+            sqlite3_clear_bindings(stmt);
+        } else {
+            sqlite3_finalize(stmt);
+        }
+    }
+    double loadUs = MicrosecondsEach(start, OPERATIONS);
+
+    sqlite3_finalize(save);
+    sqlite3_finalize(load);
+    CloseBenchDatabase(db);
+
+    printf("%-20s saves %7.2f us each, lookups %6.2f us each (checksum %.0f)\n",
+           cached ? "Cached statements:" : "Prepared per call:", saveUs, loadUs, sum);
+    return true;
+}
+
+int main() {
+    std::vector<std::string> paths;
+    paths.reserve(OPERATIONS);
+    for (int i = 0; i < OPERATIONS; i++) {
+        char path[96];
+        snprintf(path, sizeof(path), "D:\\Music\\Artist %03d\\Album %02d\\%02d - Track %d.mp3",
+                 i / 1000, (i / 20) % 50, i % 20 + 1, i);
+        paths.push_back(path);
+    }
+
+    printf("SQLite %s, %d position saves and lookups\n", sqlite3_libversion(), OPERATIONS);
+    if (!RunBenchmark(false, paths)) return 1;
+    if (!RunBenchmark(true, paths)) return 1;
+    return 0;
+}
@@ -4,8 +4,11 @@
 #include "resource.h"
 #include "bass_fx.h"
 #include "tempo_processor.h"
+#include "player.h"
 #include "center_cancel.h"
+#include "limiter.h"
 #include "convolution.h"
+#include "config_store.h"
 #ifdef USE_STEAM_AUDIO
 #include "spatial_audio.h"
 #endif
@@ -87,6 +90,7 @@ static HDSP g_hdspCenterCancel = 0; // Custom DSP for center cancel/extract
 static HDSP g_hdspConvolution = 0;  // Custom DSP for convolution reverb
 static HDSP g_hdspSpatialAudio = 0;  // Custom DSP for 3D audio (Steam Audio)
 static HDSP g_hdspVolume = 0;       // Custom DSP for volume (runs LAST, after encoder)
+static HDSP g_hdspDownmix = 0;      // Custom DSP for surround fold-down (runs FIRST)
 
 // DSP effect enabled states
 static bool g_dspEnabled[(int)DSPEffectType::COUNT] = {false, false, false, false, false, false, false, false};
@@ -219,15 +223,15 @@ void SetReverbAlgorithm(int algorithm) {
     if (algorithm < 0 || algorithm > 3) return;
 
     // Remove existing reverb effect if any
-    if (g_hfxReverb && g_fxStream) {
-        BASS_ChannelRemoveFX(g_fxStream, g_hfxReverb);
+    if (g_hfxReverb && g_outputStream) {
+        BASS_ChannelRemoveFX(g_outputStream, g_hfxReverb);
         g_hfxReverb = 0;
     }
 
     g_reverbAlgorithm = algorithm;
 
     // Apply new reverb if enabled and stream exists
-    if (algorithm > 0 && g_fxStream) {
+    if (algorithm > 0 && g_outputStream) {
         ApplyDSPEffects();
     }
 }
@@ -240,38 +244,38 @@ void EnableDSPEffect(DSPEffectType type, bool enable) {
     g_dspEnabled[(int)type] = enable;
 
     // If stream exists, apply/remove effect immediately
-    if (g_fxStream) {
+    if (g_outputStream) {
         if (enable && !wasEnabled) {
             ApplyDSPEffects();
         } else if (!enable && wasEnabled) {
             // Remove just this effect
             switch (type) {
                 case DSPEffectType::Reverb:
-                    if (g_hfxReverb) { BASS_ChannelRemoveFX(g_fxStream, g_hfxReverb); g_hfxReverb = 0; }
+                    if (g_hfxReverb) { BASS_ChannelRemoveFX(g_outputStream, g_hfxReverb); g_hfxReverb = 0; }
                     break;
                 case DSPEffectType::Echo:
-                    if (g_hfxEcho) { BASS_ChannelRemoveFX(g_fxStream, g_hfxEcho); g_hfxEcho = 0; }
+                    if (g_hfxEcho) { BASS_ChannelRemoveFX(g_outputStream, g_hfxEcho); g_hfxEcho = 0; }
                     break;
                 case DSPEffectType::EQ:
-                    if (g_hfxEQPreamp) { BASS_ChannelRemoveFX(g_fxStream, g_hfxEQPreamp); g_hfxEQPreamp = 0; }
-                    if (g_hfxEQBass) { BASS_ChannelRemoveFX(g_fxStream, g_hfxEQBass); g_hfxEQBass = 0; }
-                    if (g_hfxEQMid) { BASS_ChannelRemoveFX(g_fxStream, g_hfxEQMid); g_hfxEQMid = 0; }
-                    if (g_hfxEQTreble) { BASS_ChannelRemoveFX(g_fxStream, g_hfxEQTreble); g_hfxEQTreble = 0; }
+                    if (g_hfxEQPreamp) { BASS_ChannelRemoveFX(g_outputStream, g_hfxEQPreamp); g_hfxEQPreamp = 0; }
+                    if (g_hfxEQBass) { BASS_ChannelRemoveFX(g_outputStream, g_hfxEQBass); g_hfxEQBass = 0; }
+                    if (g_hfxEQMid) { BASS_ChannelRemoveFX(g_outputStream, g_hfxEQMid); g_hfxEQMid = 0; }
+                    if (g_hfxEQTreble) { BASS_ChannelRemoveFX(g_outputStream, g_hfxEQTreble); g_hfxEQTreble = 0; }
                     break;
                 case DSPEffectType::Compressor:
-                    if (g_hfxCompressor) { BASS_ChannelRemoveFX(g_fxStream, g_hfxCompressor); g_hfxCompressor = 0; }
+                    if (g_hfxCompressor) { BASS_ChannelRemoveFX(g_outputStream, g_hfxCompressor); g_hfxCompressor = 0; }
                     break;
                 case DSPEffectType::StereoWidth:
-                    if (g_hdspStereoWidth) { BASS_ChannelRemoveDSP(g_fxStream, g_hdspStereoWidth); g_hdspStereoWidth = 0; }
+                    if (g_hdspStereoWidth) { BASS_ChannelRemoveDSP(g_outputStream, g_hdspStereoWidth); g_hdspStereoWidth = 0; }
                     break;
                 case DSPEffectType::CenterCancel:
-                    if (g_hdspCenterCancel) { BASS_ChannelRemoveDSP(g_fxStream, g_hdspCenterCancel); g_hdspCenterCancel = 0; }
+                    if (g_hdspCenterCancel) { BASS_ChannelRemoveDSP(g_outputStream, g_hdspCenterCancel); g_hdspCenterCancel = 0; }
                     break;
                 case DSPEffectType::Convolution:
-                    if (g_hdspConvolution) { BASS_ChannelRemoveDSP(g_fxStream, g_hdspConvolution); g_hdspConvolution = 0; }
+                    if (g_hdspConvolution) { BASS_ChannelRemoveDSP(g_outputStream, g_hdspConvolution); g_hdspConvolution = 0; }
                     break;
                 case DSPEffectType::SpatialAudio:
-                    if (g_hdspSpatialAudio) { BASS_ChannelRemoveDSP(g_fxStream, g_hdspSpatialAudio); g_hdspSpatialAudio = 0; }
+                    if (g_hdspSpatialAudio) { BASS_ChannelRemoveDSP(g_outputStream, g_hdspSpatialAudio); g_hdspSpatialAudio = 0; }
                     break;
                 default:
                     break;
@@ -280,15 +284,151 @@ void EnableDSPEffect(DSPEffectType type, bool enable) {
     }
 }
 
-// Stereo width DSP callback - uses Mid/Side processing
+// Maximum channel count handled by the surround helpers (7.1)
+static const int MAX_DSP_CHANNELS = 8;
+
+// Fold-down gains for surround sources. Front L/R pass straight through, the
+// center goes to both sides at -3 dB, the LFE is dropped (the mains already
+// carry that content), and the remaining surrounds alternate L/R at -3 dB.
+// Gains are normalized so full-scale input on every channel can't clip.
+bool GetDownmixGains(int chans, float* gainL, float* gainR) {
+    if (chans <= 2 || chans > MAX_DSP_CHANNELS) return false;
+
+    const float k = 0.7071f;  // -3 dB
+    for (int ch = 0; ch < chans; ch++) {
+        gainL[ch] = 0.0f;
+        gainR[ch] = 0.0f;
+    }
+    gainL[0] = 1.0f;
+    gainR[1] = 1.0f;
+
+    int next = 2;
+    if (chans != 4) {
+        // Everything except quad has a center channel in slot 3
+        gainL[2] = k;
+        gainR[2] = k;
+        next = 3;
+    }
+    if (chans >= 6) next = 4;  // Skip LFE
+    for (int ch = next; ch < chans; ch++) {
+        if ((ch - next) % 2 == 0) gainL[ch] = k;
+        else gainR[ch] = k;
+    }
+
+    float sumL = 0.0f, sumR = 0.0f;
+    for (int ch = 0; ch < chans; ch++) {
+        sumL += gainL[ch];
+        sumR += gainR[ch];
+    }
+    float norm = 1.0f / (sumL > sumR ? sumL : sumR);
+    for (int ch = 0; ch < chans; ch++) {
+        gainL[ch] *= norm;
+        gainR[ch] *= norm;
+    }
+    return true;
+}
+
+// Surround downmix DSP - runs FIRST (high priority) so every later effect only
+// has to deal with the front pair. The channel count can't change inside a DSP,
+// so the fold is written into front L/R and the other channels are silenced.
+static void CALLBACK DownmixDSPProc(HDSP handle, DWORD channel, void* buffer, DWORD length, void* user) {
+    (void)handle; (void)user;
+    if (!g_downmixStereo) return;
+
+    BASS_CHANNELINFO info;
+    if (!BASS_ChannelGetInfo(channel, &info)) return;
+
+    int chans = (int)info.chans;
+    float gainL[MAX_DSP_CHANNELS], gainR[MAX_DSP_CHANNELS];
+    if (!GetDownmixGains(chans, gainL, gainR)) return;
+
+    if (info.flags & BASS_SAMPLE_FLOAT) {
+        float* samples = static_cast<float*>(buffer);
+        DWORD frameCount = length / (sizeof(float) * chans);
+        for (DWORD i = 0; i < frameCount; i++) {
+            float* frame = samples + i * chans;
+            float left = 0.0f, right = 0.0f;
+            for (int ch = 0; ch < chans; ch++) {
+                left += frame[ch] * gainL[ch];
+                right += frame[ch] * gainR[ch];
+                frame[ch] = 0.0f;
+            }
+            frame[0] = left;
+            frame[1] = right;
+        }
+    } else {
+        short* samples = static_cast<short*>(buffer);
+        DWORD frameCount = length / (sizeof(short) * chans);
+        for (DWORD i = 0; i < frameCount; i++) {
+            short* frame = samples + i * chans;
+            float left = 0.0f, right = 0.0f;
+            for (int ch = 0; ch < chans; ch++) {
+                left += frame[ch] * gainL[ch];
+                right += frame[ch] * gainR[ch];
+                frame[ch] = 0;
+            }
+            frame[0] = static_cast<short>(clamp_val(left, -32768.0f, 32767.0f));
+            frame[1] = static_cast<short>(clamp_val(right, -32768.0f, 32767.0f));
+        }
+    }
+}
+
+// Front-pair helpers for the stereo-only processors (center cancel, convolution,
+// 3D audio). Stereo float buffers are processed in place; anything else has its
+// front L/R pair copied out to float, processed, and copied back, leaving any
+// surround channels untouched.
+static thread_local std::vector<float> t_frontPair;
+
+static float* GatherFrontPair(const void* buffer, DWORD length, const BASS_CHANNELINFO& info, int& frameCount) {
+    int chans = (int)info.chans;
+    bool isFloat = (info.flags & BASS_SAMPLE_FLOAT) != 0;
+    frameCount = (int)(length / ((isFloat ? sizeof(float) : sizeof(short)) * chans));
+    t_frontPair.resize(frameCount * 2);
+    if (isFloat) {
+        const float* samples = static_cast<const float*>(buffer);
+        for (int i = 0; i < frameCount; i++) {
+            t_frontPair[i * 2] = samples[i * chans];
+            t_frontPair[i * 2 + 1] = samples[i * chans + 1];
+        }
+    } else {
+        const short* samples = static_cast<const short*>(buffer);
+        for (int i = 0; i < frameCount; i++) {
+            t_frontPair[i * 2] = samples[i * chans] / 32768.0f;
+            t_frontPair[i * 2 + 1] = samples[i * chans + 1] / 32768.0f;
+        }
+    }
+    return t_frontPair.data();
+}
+
+static void ScatterFrontPair(void* buffer, const BASS_CHANNELINFO& info, int frameCount) {
+    int chans = (int)info.chans;
+    if (info.flags & BASS_SAMPLE_FLOAT) {
+        float* samples = static_cast<float*>(buffer);
+        for (int i = 0; i < frameCount; i++) {
+            samples[i * chans] = t_frontPair[i * 2];
+            samples[i * chans + 1] = t_frontPair[i * 2 + 1];
+        }
+    } else {
+        short* samples = static_cast<short*>(buffer);
+        for (int i = 0; i < frameCount; i++) {
+            float left = clamp_val(t_frontPair[i * 2], -1.0f, 1.0f);
+            float right = clamp_val(t_frontPair[i * 2 + 1], -1.0f, 1.0f);
+            samples[i * chans] = static_cast<short>(left * 32767.0f);
+            samples[i * chans + 1] = static_cast<short>(right * 32767.0f);
+        }
+    }
+}
+
+// Stereo width DSP callback - uses Mid/Side processing on the front L/R pair
 // Width 0% = mono, 100% = normal stereo, 200% = extra wide
 static void CALLBACK StereoWidthDSPProc(HDSP handle, DWORD channel, void* buffer, DWORD length, void* user) {
     // Get channel info to check format
     BASS_CHANNELINFO info;
     if (!BASS_ChannelGetInfo(channel, &info)) return;
 
-    // Only process stereo content
-    if (info.chans != 2) return;
+    // Needs at least a front L/R pair; surround channels are left as-is
+    if (info.chans < 2) return;
+    DWORD chans = info.chans;
 
     // Get width value (0-200, where 100 is normal)
     float width = g_paramValues[(int)ParamId::StereoWidth] / 100.0f;
@@ -296,11 +436,11 @@ static void CALLBACK StereoWidthDSPProc(HDSP handle, DWORD channel, void* buffer
     // Check if float format (BASS_FX tempo streams use float)
     if (info.flags & BASS_SAMPLE_FLOAT) {
         float* samples = static_cast<float*>(buffer);
-        DWORD frameCount = length / (sizeof(float) * 2);  // 2 channels
+        DWORD frameCount = length / (sizeof(float) * chans);
 
         for (DWORD i = 0; i < frameCount; i++) {
-            float left = samples[i * 2];
-            float right = samples[i * 2 + 1];
+            float left = samples[i * chans];
+            float right = samples[i * chans + 1];
 
             // Convert to Mid/Side
             float mid = (left + right) * 0.5f;
@@ -310,17 +450,17 @@ static void CALLBACK StereoWidthDSPProc(HDSP handle, DWORD channel, void* buffer
             side *= width;
 
             // Convert back to Left/Right
-            samples[i * 2] = mid + side;
-            samples[i * 2 + 1] = mid - side;
+            samples[i * chans] = mid + side;
+            samples[i * chans + 1] = mid - side;
         }
     } else {
         // 16-bit format
         short* samples = static_cast<short*>(buffer);
-        DWORD frameCount = length / (sizeof(short) * 2);  // 2 channels
+        DWORD frameCount = length / (sizeof(short) * chans);
 
         for (DWORD i = 0; i < frameCount; i++) {
-            float left = samples[i * 2] / 32768.0f;
-            float right = samples[i * 2 + 1] / 32768.0f;
+            float left = samples[i * chans] / 32768.0f;
+            float right = samples[i * chans + 1] / 32768.0f;
 
             // Convert to Mid/Side
             float mid = (left + right) * 0.5f;
@@ -335,8 +475,8 @@ static void CALLBACK StereoWidthDSPProc(HDSP handle, DWORD channel, void* buffer
             if (outL > 1.0f) outL = 1.0f; else if (outL < -1.0f) outL = -1.0f;
             if (outR > 1.0f) outR = 1.0f; else if (outR < -1.0f) outR = -1.0f;
 
-            samples[i * 2] = static_cast<short>(outL * 32767.0f);
-            samples[i * 2 + 1] = static_cast<short>(outR * 32767.0f);
+            samples[i * chans] = static_cast<short>(outL * 32767.0f);
+            samples[i * chans + 1] = static_cast<short>(outR * 32767.0f);
         }
     }
 }
@@ -348,8 +488,8 @@ static void CALLBACK CenterCancelDSPProc(HDSP handle, DWORD channel, void* buffe
     BASS_CHANNELINFO info;
     if (!BASS_ChannelGetInfo(channel, &info)) return;
 
-    // Only process stereo content
-    if (info.chans != 2) return;
+    // Needs at least a front L/R pair
+    if (info.chans < 2) return;
 
     // Get center cancel value (-100 to +100, where 0 is no effect)
     float amount = g_paramValues[(int)ParamId::CenterCancel] / 100.0f;
@@ -365,6 +505,22 @@ static void CALLBACK CenterCancelDSPProc(HDSP handle, DWORD channel, void* buffe
     // Update the amount
     processor->SetAmount(amount);
 
+    // Surround: process the front pair only
+    if (info.chans > 2) {
+        int frameCount = 0;
+        float* pair = GatherFrontPair(buffer, length, info, frameCount);
+        int outputFrames = 0;
+
+        std::vector<float> tempOut(frameCount * 2);
+        processor->ProcessFloat(pair, frameCount, tempOut.data(), outputFrames);
+
+        for (int i = 0; i < outputFrames * 2; i++) {
+            pair[i] = tempOut[i];
+        }
+        ScatterFrontPair(buffer, info, outputFrames);
+        return;
+    }
+
     // If amount is 0, processor will passthrough
     if (info.flags & BASS_SAMPLE_FLOAT) {
         float* samples = static_cast<float*>(buffer);
@@ -399,8 +555,8 @@ static void CALLBACK ConvolutionDSPProc(HDSP handle, DWORD channel, void* buffer
     BASS_CHANNELINFO info;
     if (!BASS_ChannelGetInfo(channel, &info)) return;
 
-    // Only process stereo content
-    if (info.chans != 2) return;
+    // Needs at least a front L/R pair
+    if (info.chans < 2) return;
 
     ConvolutionReverb* conv = GetConvolutionReverb();
     if (!conv) return;
@@ -413,6 +569,15 @@ static void CALLBACK ConvolutionDSPProc(HDSP handle, DWORD channel, void* buffer
     conv->SetMix(g_paramValues[(int)ParamId::ConvolutionMix]);
     conv->SetGain(g_paramValues[(int)ParamId::ConvolutionGain]);
 
+    // Surround: process the front pair only
+    if (info.chans > 2) {
+        int frameCount = 0;
+        float* pair = GatherFrontPair(buffer, length, info, frameCount);
+        conv->Process(pair, frameCount);
+        ScatterFrontPair(buffer, info, frameCount);
+        return;
+    }
+
     // Handle both float and 16-bit formats
     if (info.flags & BASS_SAMPLE_FLOAT) {
         float* samples = static_cast<float*>(buffer);
@@ -447,7 +612,7 @@ static void SpatialAudioDSPProcInner(HDSP handle, DWORD channel, void* buffer, D
     g_spatialCrashStep = 1;  // entered callback
     BASS_CHANNELINFO info;
     if (!BASS_ChannelGetInfo(channel, &info)) return;
-    if (info.chans != 2) return;
+    if (info.chans < 2) return;
 
     g_spatialCrashStep = 2;  // got channel info
     SpatialAudio* spatial = GetSpatialAudio();
@@ -458,7 +623,13 @@ static void SpatialAudioDSPProcInner(HDSP handle, DWORD channel, void* buffer, D
     if (blend <= 0.0f) return;
 
     g_spatialCrashStep = 4;  // about to process
-    if (info.flags & BASS_SAMPLE_FLOAT) {
+    if (info.chans > 2) {
+        // Surround: render the front pair only
+        int frameCount = 0;
+        float* pair = GatherFrontPair(buffer, length, info, frameCount);
+        spatial->Process(pair, frameCount, blend);
+        ScatterFrontPair(buffer, info, frameCount);
+    } else if (info.flags & BASS_SAMPLE_FLOAT) {
         float* samples = static_cast<float*>(buffer);
         int frameCount = length / (sizeof(float) * 2);
         g_spatialCrashStep = 5;  // float path, calling Process
@@ -510,11 +681,20 @@ static void CALLBACK SpatialAudioDSPProc(HDSP handle, DWORD channel, void* buffe
 }
 #endif
 
+// Output limiter: ceiling about -1 dBTP, 5 ms lookahead, 150 ms release
+static const float OUTPUT_LIMITER_CEILING = 0.891f;
+static const double OUTPUT_LIMITER_LOOKAHEAD = 0.005;
+static const double OUTPUT_LIMITER_RELEASE = 0.15;
+
+// Only touched by the volume DSP (on the mixer thread)
+static TruePeakLimiter g_outputLimiter;
+static bool g_outputLimiterActive = false;
+
 // Volume DSP - runs LAST (very low priority) so encoder captures full volume
 // This allows recording at full volume while playback respects g_volume/g_muted
 // Only used when legacy volume mode is disabled
 static void CALLBACK VolumeDSPProc(HDSP handle, DWORD channel, void* buffer, DWORD length, void* user) {
-    (void)handle; (void)channel; (void)user;
+    (void)handle; (void)user;
 
     // Skip if using legacy volume (handled by BASS_ATTRIB_VOL instead)
     if (g_legacyVolume) return;
@@ -525,7 +705,13 @@ static void CALLBACK VolumeDSPProc(HDSP handle, DWORD channel, void* buffer, DWO
     // This makes lower volumes feel more gradual and natural, then fold in the
     // ReplayGain multiplier so loudness normalization applies in normal volume mode.
     float curvedVolume = volume * volume * g_replayGainScale;
-    if (curvedVolume == 1.0f) return; // No processing needed
+
+    // Amplified output goes through the true-peak limiter. It stays in while
+    // amplification is allowed, so turning the volume up and down doesn't
+    // move the audio by the lookahead each time.
+    bool limit = g_allowAmplify || curvedVolume > 1.0f;
+    if (!limit) g_outputLimiterActive = false;
+    if (curvedVolume == 1.0f && !limit) return; // No processing needed
 
     BASS_CHANNELINFO info;
     if (!BASS_ChannelGetInfo(channel, &info)) return;
@@ -536,11 +722,24 @@ static void CALLBACK VolumeDSPProc(HDSP handle, DWORD channel, void* buffer, DWO
         for (int i = 0; i < sampleCount; i++) {
             samples[i] *= curvedVolume;
         }
+        if (limit) {
+            if (!g_outputLimiter.Matches((int)info.freq, (int)info.chans)) {
+                g_outputLimiter.Init((int)info.freq, (int)info.chans, OUTPUT_LIMITER_CEILING,
+                                     OUTPUT_LIMITER_LOOKAHEAD, OUTPUT_LIMITER_RELEASE);
+            } else if (!g_outputLimiterActive) {
+                g_outputLimiter.Reset();  // Don't replay what was left in the delay last time
+            }
+            g_outputLimiterActive = true;
+            g_outputLimiter.Process(samples, sampleCount / (int)info.chans);
+        }
     } else {
+        // Clamp rather than wrap around when amplified
         short* samples = static_cast<short*>(buffer);
         int sampleCount = length / sizeof(short);
         for (int i = 0; i < sampleCount; i++) {
-            samples[i] = static_cast<short>(samples[i] * curvedVolume);
+            float v = samples[i] * curvedVolume;
+            v = v > 32767.0f ? 32767.0f : (v < -32768.0f ? -32768.0f : v);
+            samples[i] = static_cast<short>(v);
         }
     }
 }
@@ -554,15 +753,25 @@ bool IsDSPEffectEnabled(DSPEffectType type) {
     return g_dspEnabled[(int)type];
 }
 
-// Apply DSP effects to current stream
+// Apply DSP effects to the output stream
 void ApplyDSPEffects() {
-    if (!g_fxStream) return;
+    if (!g_outputStream) return;
+
+    // Surround downmix - high priority so it runs before every other effect.
+    // The callback checks g_downmixStereo itself, so toggling the option
+    // doesn't need the DSP to be re-attached.
+    if (g_downmixStereo && !g_hdspDownmix) {
+        BASS_CHANNELINFO info;
+        if (BASS_ChannelGetInfo(g_outputStream, &info) && info.chans > 2) {
+            g_hdspDownmix = BASS_ChannelSetDSP(g_outputStream, DownmixDSPProc, nullptr, 1000);
+        }
+    }
 
     // Reverb (based on selected algorithm)
     if (g_reverbAlgorithm > 0 && !g_hfxReverb) {
         switch (g_reverbAlgorithm) {
             case 1:  // Freeverb
-                g_hfxReverb = BASS_ChannelSetFX(g_fxStream, BASS_FX_BFX_FREEVERB, 0);
+                g_hfxReverb = BASS_ChannelSetFX(g_outputStream, BASS_FX_BFX_FREEVERB, 0);
                 if (g_hfxReverb) {
                     BASS_BFX_FREEVERB reverb;
                     reverb.fDryMix = 1.0f - (g_paramValues[(int)ParamId::ReverbMix] / 100.0f);
@@ -576,7 +785,7 @@ void ApplyDSPEffects() {
                 }
                 break;
             case 2:  // DX8 Reverb
-                g_hfxReverb = BASS_ChannelSetFX(g_fxStream, BASS_FX_DX8_REVERB, 0);
+                g_hfxReverb = BASS_ChannelSetFX(g_outputStream, BASS_FX_DX8_REVERB, 0);
                 if (g_hfxReverb) {
                     BASS_DX8_REVERB reverb;
                     reverb.fInGain = 0.0f;  // No input gain reduction
@@ -587,7 +796,7 @@ void ApplyDSPEffects() {
                 }
                 break;
             case 3:  // I3DL2 Reverb
-                g_hfxReverb = BASS_ChannelSetFX(g_fxStream, BASS_FX_DX8_I3DL2REVERB, 0);
+                g_hfxReverb = BASS_ChannelSetFX(g_outputStream, BASS_FX_DX8_I3DL2REVERB, 0);
                 if (g_hfxReverb) {
                     BASS_DX8_I3DL2REVERB reverb;
                     reverb.lRoom = static_cast<int>(g_paramValues[(int)ParamId::I3DL2Room]);
@@ -610,7 +819,7 @@ void ApplyDSPEffects() {
 
     // Echo
     if (g_dspEnabled[(int)DSPEffectType::Echo] && !g_hfxEcho) {
-        g_hfxEcho = BASS_ChannelSetFX(g_fxStream, BASS_FX_BFX_ECHO4, 0);
+        g_hfxEcho = BASS_ChannelSetFX(g_outputStream, BASS_FX_BFX_ECHO4, 0);
         if (g_hfxEcho) {
             BASS_BFX_ECHO4 echo;
             echo.fDryMix = 1.0f - (g_paramValues[(int)ParamId::EchoMix] / 100.0f);
@@ -627,7 +836,7 @@ void ApplyDSPEffects() {
     if (g_dspEnabled[(int)DSPEffectType::EQ]) {
         // Preamp (gain reduction to prevent clipping)
         if (!g_hfxEQPreamp) {
-            g_hfxEQPreamp = BASS_ChannelSetFX(g_fxStream, BASS_FX_BFX_VOLUME, 0);
+            g_hfxEQPreamp = BASS_ChannelSetFX(g_outputStream, BASS_FX_BFX_VOLUME, 0);
             if (g_hfxEQPreamp) {
                 BASS_BFX_VOLUME vol = {0};
                 vol.lChannel = BASS_BFX_CHANALL;
@@ -638,7 +847,7 @@ void ApplyDSPEffects() {
         }
         // Bass (60 Hz)
         if (!g_hfxEQBass) {
-            g_hfxEQBass = BASS_ChannelSetFX(g_fxStream, BASS_FX_BFX_PEAKEQ, 0);
+            g_hfxEQBass = BASS_ChannelSetFX(g_outputStream, BASS_FX_BFX_PEAKEQ, 0);
             if (g_hfxEQBass) {
                 BASS_BFX_PEAKEQ eq = {0};
                 eq.lBand = 0;
@@ -652,7 +861,7 @@ void ApplyDSPEffects() {
         }
         // Mid (1000 Hz)
         if (!g_hfxEQMid) {
-            g_hfxEQMid = BASS_ChannelSetFX(g_fxStream, BASS_FX_BFX_PEAKEQ, 0);
+            g_hfxEQMid = BASS_ChannelSetFX(g_outputStream, BASS_FX_BFX_PEAKEQ, 0);
             if (g_hfxEQMid) {
                 BASS_BFX_PEAKEQ eq = {0};
                 eq.lBand = 0;
@@ -666,7 +875,7 @@ void ApplyDSPEffects() {
         }
         // Treble (8000 Hz)
         if (!g_hfxEQTreble) {
-            g_hfxEQTreble = BASS_ChannelSetFX(g_fxStream, BASS_FX_BFX_PEAKEQ, 0);
+            g_hfxEQTreble = BASS_ChannelSetFX(g_outputStream, BASS_FX_BFX_PEAKEQ, 0);
             if (g_hfxEQTreble) {
                 BASS_BFX_PEAKEQ eq = {0};
                 eq.lBand = 0;
@@ -682,7 +891,7 @@ void ApplyDSPEffects() {
 
     // Compressor
     if (g_dspEnabled[(int)DSPEffectType::Compressor] && !g_hfxCompressor) {
-        g_hfxCompressor = BASS_ChannelSetFX(g_fxStream, BASS_FX_BFX_COMPRESSOR2, 0);
+        g_hfxCompressor = BASS_ChannelSetFX(g_outputStream, BASS_FX_BFX_COMPRESSOR2, 0);
         if (g_hfxCompressor) {
             BASS_BFX_COMPRESSOR2 comp = {0};
             comp.fGain = g_paramValues[(int)ParamId::CompGain];
@@ -697,12 +906,12 @@ void ApplyDSPEffects() {
 
     // Stereo Width (custom DSP)
     if (g_dspEnabled[(int)DSPEffectType::StereoWidth] && !g_hdspStereoWidth) {
-        g_hdspStereoWidth = BASS_ChannelSetDSP(g_fxStream, StereoWidthDSPProc, nullptr, 0);
+        g_hdspStereoWidth = BASS_ChannelSetDSP(g_outputStream, StereoWidthDSPProc, nullptr, 0);
     }
 
     // Center Cancel/Extract (custom DSP)
     if (g_dspEnabled[(int)DSPEffectType::CenterCancel] && !g_hdspCenterCancel) {
-        g_hdspCenterCancel = BASS_ChannelSetDSP(g_fxStream, CenterCancelDSPProc, nullptr, 0);
+        g_hdspCenterCancel = BASS_ChannelSetDSP(g_outputStream, CenterCancelDSPProc, nullptr, 0);
     }
 
     // Convolution Reverb (custom DSP)
@@ -710,11 +919,11 @@ void ApplyDSPEffects() {
         ConvolutionReverb* conv = GetConvolutionReverb();
         if (conv && conv->IsLoaded()) {
             BASS_CHANNELINFO info;
-            if (BASS_ChannelGetInfo(g_fxStream, &info)) {
+            if (BASS_ChannelGetInfo(g_outputStream, &info)) {
                 conv->Init((int)info.freq);
             }
         }
-        g_hdspConvolution = BASS_ChannelSetDSP(g_fxStream, ConvolutionDSPProc, nullptr, 0);
+        g_hdspConvolution = BASS_ChannelSetDSP(g_outputStream, ConvolutionDSPProc, nullptr, 0);
     }
 
     // 3D Audio (Steam Audio HRTF)
@@ -724,7 +933,7 @@ void ApplyDSPEffects() {
         SpatialAudio* spatial = GetSpatialAudio();
         if (spatial) {
             BASS_CHANNELINFO info;
-            if (BASS_ChannelGetInfo(g_fxStream, &info)) {
+            if (BASS_ChannelGetInfo(g_outputStream, &info)) {
                 initOk = spatial->Initialize((int)info.freq);
                 if (!initOk) {
                     const wchar_t* err = spatial->GetLastError();
@@ -736,16 +945,16 @@ void ApplyDSPEffects() {
             }
         }
         if (initOk) {
-            g_hdspSpatialAudio = BASS_ChannelSetDSP(g_fxStream, SpatialAudioDSPProc, nullptr, 0);
+            g_hdspSpatialAudio = BASS_ChannelSetDSP(g_outputStream, SpatialAudioDSPProc, nullptr, 0);
         }
     }
 #endif
 
-    // Legacy volume mode - apply volume directly to stream attribute
-    // This must be done every time a new stream is created
+    // Legacy volume mode - apply volume directly to the mixer attribute
+    // (the player re-applies it when a track's ReplayGain changes)
     if (g_legacyVolume) {
         float curvedVolume = (g_muted ? 0.0f : (g_volume * g_volume)) * g_replayGainScale;
-        BASS_ChannelSetAttribute(g_fxStream, BASS_ATTRIB_VOL, curvedVolume);
+        BASS_ChannelSetAttribute(g_outputStream, BASS_ATTRIB_VOL, curvedVolume);
     }
 
     // Volume DSP - added with very low priority so it runs LAST (after encoder)
@@ -753,24 +962,25 @@ void ApplyDSPEffects() {
     // Only used when legacy volume mode is disabled
     // Priority -2000000000 ensures it runs after encoder (priority 0)
     if (!g_legacyVolume && !g_hdspVolume) {
-        g_hdspVolume = BASS_ChannelSetDSP(g_fxStream, VolumeDSPProc, nullptr, -2000000000);
+        g_hdspVolume = BASS_ChannelSetDSP(g_outputStream, VolumeDSPProc, nullptr, -2000000000);
     }
 }
 
-// Remove all DSP effects from stream
+// Remove all DSP effects from the output stream
 void RemoveDSPEffects() {
-    if (g_hfxReverb) { if (g_fxStream) BASS_ChannelRemoveFX(g_fxStream, g_hfxReverb); g_hfxReverb = 0; }
-    if (g_hfxEcho) { if (g_fxStream) BASS_ChannelRemoveFX(g_fxStream, g_hfxEcho); g_hfxEcho = 0; }
-    if (g_hfxEQPreamp) { if (g_fxStream) BASS_ChannelRemoveFX(g_fxStream, g_hfxEQPreamp); g_hfxEQPreamp = 0; }
-    if (g_hfxEQBass) { if (g_fxStream) BASS_ChannelRemoveFX(g_fxStream, g_hfxEQBass); g_hfxEQBass = 0; }
-    if (g_hfxEQMid) { if (g_fxStream) BASS_ChannelRemoveFX(g_fxStream, g_hfxEQMid); g_hfxEQMid = 0; }
-    if (g_hfxEQTreble) { if (g_fxStream) BASS_ChannelRemoveFX(g_fxStream, g_hfxEQTreble); g_hfxEQTreble = 0; }
-    if (g_hfxCompressor) { if (g_fxStream) BASS_ChannelRemoveFX(g_fxStream, g_hfxCompressor); g_hfxCompressor = 0; }
-    if (g_hdspStereoWidth) { if (g_fxStream) BASS_ChannelRemoveDSP(g_fxStream, g_hdspStereoWidth); g_hdspStereoWidth = 0; }
-    if (g_hdspCenterCancel) { if (g_fxStream) BASS_ChannelRemoveDSP(g_fxStream, g_hdspCenterCancel); g_hdspCenterCancel = 0; }
-    if (g_hdspConvolution) { if (g_fxStream) BASS_ChannelRemoveDSP(g_fxStream, g_hdspConvolution); g_hdspConvolution = 0; }
-    if (g_hdspSpatialAudio) { if (g_fxStream) BASS_ChannelRemoveDSP(g_fxStream, g_hdspSpatialAudio); g_hdspSpatialAudio = 0; }
-    if (g_hdspVolume) { if (g_fxStream) BASS_ChannelRemoveDSP(g_fxStream, g_hdspVolume); g_hdspVolume = 0; }
+    if (g_hfxReverb) { if (g_outputStream) BASS_ChannelRemoveFX(g_outputStream, g_hfxReverb); g_hfxReverb = 0; }
+    if (g_hfxEcho) { if (g_outputStream) BASS_ChannelRemoveFX(g_outputStream, g_hfxEcho); g_hfxEcho = 0; }
+    if (g_hfxEQPreamp) { if (g_outputStream) BASS_ChannelRemoveFX(g_outputStream, g_hfxEQPreamp); g_hfxEQPreamp = 0; }
+    if (g_hfxEQBass) { if (g_outputStream) BASS_ChannelRemoveFX(g_outputStream, g_hfxEQBass); g_hfxEQBass = 0; }
+    if (g_hfxEQMid) { if (g_outputStream) BASS_ChannelRemoveFX(g_outputStream, g_hfxEQMid); g_hfxEQMid = 0; }
+    if (g_hfxEQTreble) { if (g_outputStream) BASS_ChannelRemoveFX(g_outputStream, g_hfxEQTreble); g_hfxEQTreble = 0; }
+    if (g_hfxCompressor) { if (g_outputStream) BASS_ChannelRemoveFX(g_outputStream, g_hfxCompressor); g_hfxCompressor = 0; }
+    if (g_hdspStereoWidth) { if (g_outputStream) BASS_ChannelRemoveDSP(g_outputStream, g_hdspStereoWidth); g_hdspStereoWidth = 0; }
+    if (g_hdspCenterCancel) { if (g_outputStream) BASS_ChannelRemoveDSP(g_outputStream, g_hdspCenterCancel); g_hdspCenterCancel = 0; }
+    if (g_hdspConvolution) { if (g_outputStream) BASS_ChannelRemoveDSP(g_outputStream, g_hdspConvolution); g_hdspConvolution = 0; }
+    if (g_hdspSpatialAudio) { if (g_outputStream) BASS_ChannelRemoveDSP(g_outputStream, g_hdspSpatialAudio); g_hdspSpatialAudio = 0; }
+    if (g_hdspVolume) { if (g_outputStream) BASS_ChannelRemoveDSP(g_outputStream, g_hdspVolume); g_hdspVolume = 0; }
+    if (g_hdspDownmix) { if (g_outputStream) BASS_ChannelRemoveDSP(g_outputStream, g_hdspDownmix); g_hdspDownmix = 0; }
 }
 
 // Get parameter definition
@@ -824,9 +1034,9 @@ void SetParamValue(ParamId id, float value) {
             g_volume = value;
             // In legacy mode, apply via BASS_ATTRIB_VOL
             // In normal mode, volume DSP automatically uses updated g_volume
-            if (g_legacyVolume && g_fxStream) {
+            if (g_legacyVolume && g_outputStream) {
                 float curvedVolume = (g_muted ? 0.0f : (g_volume * g_volume)) * g_replayGainScale;
-                BASS_ChannelSetAttribute(g_fxStream, BASS_ATTRIB_VOL, curvedVolume);
+                BASS_ChannelSetAttribute(g_outputStream, BASS_ATTRIB_VOL, curvedVolume);
             }
             break;
         case ParamId::Pitch:
@@ -852,8 +1062,8 @@ void SetParamValue(ParamId id, float value) {
             g_rate = value;
             // Skip applying rate to live streams (not supported)
             if (g_fxStream && !g_isLiveStream) {
-                // Use native BASS frequency attribute (changes speed and pitch together)
-                BASS_ChannelSetAttribute(g_fxStream, BASS_ATTRIB_FREQ, g_originalFreq * g_rate);
+                // Changes speed and pitch together (resampler or BASS frequency attribute)
+                ApplyPlaybackRate();
             }
             break;
         // Freeverb parameters
@@ -1274,21 +1484,14 @@ static std::wstring PresetSectionName(const std::wstring& name) {
     return L"Preset_" + name;
 }
 
-static float GetPrivateProfileFloatW_Preset(const wchar_t* section, const wchar_t* key, float defaultVal) {
-    wchar_t buf[64] = {0};
-    GetPrivateProfileStringW(section, key, L"", buf, 64, g_configPath.c_str());
-    if (buf[0] == L'\0') return defaultVal;
-    return (float)_wtof(buf);
-}
-
 std::vector<std::wstring> GetEffectPresetNames() {
     std::vector<std::wstring> names;
-    int count = GetPrivateProfileIntW(L"Presets", L"Count", 0, g_configPath.c_str());
+    int count = ConfigGetInt(L"Presets", L"Count", 0);
     for (int i = 0; i < count; i++) {
         wchar_t key[32];
         swprintf(key, 32, L"Name%d", i);
         wchar_t buf[128] = {0};
-        GetPrivateProfileStringW(L"Presets", key, L"", buf, 128, g_configPath.c_str());
+        ConfigGetString(L"Presets", key, L"", buf, 128);
         if (buf[0] != L'\0') names.push_back(buf);
     }
     return names;
@@ -1296,19 +1499,19 @@ std::vector<std::wstring> GetEffectPresetNames() {
 
 static void WritePresetNameList(const std::vector<std::wstring>& names) {
     // Clear old name entries first
-    int oldCount = GetPrivateProfileIntW(L"Presets", L"Count", 0, g_configPath.c_str());
+    int oldCount = ConfigGetInt(L"Presets", L"Count", 0);
     for (int i = 0; i < oldCount; i++) {
         wchar_t key[32];
         swprintf(key, 32, L"Name%d", i);
-        WritePrivateProfileStringW(L"Presets", key, nullptr, g_configPath.c_str());
+        ConfigWriteString(L"Presets", key, nullptr);
     }
     wchar_t buf[32];
     swprintf(buf, 32, L"%d", (int)names.size());
-    WritePrivateProfileStringW(L"Presets", L"Count", buf, g_configPath.c_str());
+    ConfigWriteString(L"Presets", L"Count", buf);
     for (size_t i = 0; i < names.size(); i++) {
         wchar_t key[32];
         swprintf(key, 32, L"Name%zu", i);
-        WritePrivateProfileStringW(L"Presets", key, names[i].c_str(), g_configPath.c_str());
+        ConfigWriteString(L"Presets", key, names[i].c_str());
     }
 }
 
@@ -1322,27 +1525,27 @@ bool SaveEffectPreset(const std::wstring& name) {
     for (int i = 0; i < 4; i++) {
         wchar_t key[32];
         swprintf(key, 32, L"StreamEnabled%d", i);
-        WritePrivateProfileStringW(section.c_str(), key, g_effectEnabled[i] ? L"1" : L"0", g_configPath.c_str());
+        ConfigWriteString(section.c_str(), key, g_effectEnabled[i] ? L"1" : L"0");
     }
 
     // Stream effect values (pitch, tempo, rate — volume intentionally excluded)
     swprintf(buf, 64, L"%.4f", g_pitch);
-    WritePrivateProfileStringW(section.c_str(), L"Pitch", buf, g_configPath.c_str());
+    ConfigWriteString(section.c_str(), L"Pitch", buf);
     swprintf(buf, 64, L"%.4f", g_tempo);
-    WritePrivateProfileStringW(section.c_str(), L"Tempo", buf, g_configPath.c_str());
+    ConfigWriteString(section.c_str(), L"Tempo", buf);
     swprintf(buf, 64, L"%.4f", g_rate);
-    WritePrivateProfileStringW(section.c_str(), L"Rate", buf, g_configPath.c_str());
+    ConfigWriteString(section.c_str(), L"Rate", buf);
 
     // Reverb algorithm
     swprintf(buf, 64, L"%d", g_reverbAlgorithm);
-    WritePrivateProfileStringW(section.c_str(), L"ReverbAlgorithm", buf, g_configPath.c_str());
+    ConfigWriteString(section.c_str(), L"ReverbAlgorithm", buf);
 
     // DSP effect enabled flags
     for (int i = 0; i < (int)DSPEffectType::COUNT; i++) {
         wchar_t key[32];
         swprintf(key, 32, L"DSPEnabled%d", i);
-        WritePrivateProfileStringW(section.c_str(), key,
-            g_dspEnabled[i] ? L"1" : L"0", g_configPath.c_str());
+        ConfigWriteString(section.c_str(), key,
+            g_dspEnabled[i] ? L"1" : L"0");
     }
 
     // All param values (DSP params plus stream effect params)
@@ -1353,7 +1556,7 @@ bool SaveEffectPreset(const std::wstring& name) {
         wchar_t key[64];
         swprintf(key, 64, L"Param%d", (int)def.id);
         swprintf(buf, 64, L"%.6f", g_paramValues[(int)def.id]);
-        WritePrivateProfileStringW(section.c_str(), key, buf, g_configPath.c_str());
+        ConfigWriteString(section.c_str(), key, buf);
     }
 
     // Add to name list if not already present
@@ -1373,28 +1576,28 @@ bool LoadEffectPreset(const std::wstring& name) {
 
     // Quick existence check
     wchar_t test[8] = {0};
-    GetPrivateProfileStringW(section.c_str(), L"Pitch", L"__MISSING__", test, 8, g_configPath.c_str());
+    ConfigGetString(section.c_str(), L"Pitch", L"__MISSING__", test, 8);
     if (wcscmp(test, L"__MISSING__") == 0) return false;
 
     // Stream effect values
     wchar_t buf[64] = {0};
-    GetPrivateProfileStringW(section.c_str(), L"Pitch", L"0", buf, 64, g_configPath.c_str());
+    ConfigGetString(section.c_str(), L"Pitch", L"0", buf, 64);
     g_pitch = (float)_wtof(buf);
-    GetPrivateProfileStringW(section.c_str(), L"Tempo", L"0", buf, 64, g_configPath.c_str());
+    ConfigGetString(section.c_str(), L"Tempo", L"0", buf, 64);
     g_tempo = (float)_wtof(buf);
-    GetPrivateProfileStringW(section.c_str(), L"Rate", L"1", buf, 64, g_configPath.c_str());
+    ConfigGetString(section.c_str(), L"Rate", L"1", buf, 64);
     g_rate = (float)_wtof(buf);
 
     // Stream effect enabled flags
     for (int i = 0; i < 4; i++) {
         wchar_t key[32];
         swprintf(key, 32, L"StreamEnabled%d", i);
-        g_effectEnabled[i] = GetPrivateProfileIntW(section.c_str(), key,
-            g_effectEnabled[i] ? 1 : 0, g_configPath.c_str()) != 0;
+        g_effectEnabled[i] = ConfigGetInt(section.c_str(), key,
+            g_effectEnabled[i] ? 1 : 0) != 0;
     }
 
     // Reverb algorithm
-    int ra = GetPrivateProfileIntW(section.c_str(), L"ReverbAlgorithm", g_reverbAlgorithm, g_configPath.c_str());
+    int ra = ConfigGetInt(section.c_str(), L"ReverbAlgorithm", g_reverbAlgorithm);
     if (ra < 0) ra = 0;
     if (ra > 3) ra = 3;
     SetReverbAlgorithm(ra);
@@ -1404,8 +1607,8 @@ bool LoadEffectPreset(const std::wstring& name) {
         if ((DSPEffectType)i == DSPEffectType::Reverb) continue;  // controlled by algorithm
         wchar_t key[32];
         swprintf(key, 32, L"DSPEnabled%d", i);
-        bool en = GetPrivateProfileIntW(section.c_str(), key,
-            g_dspEnabled[i] ? 1 : 0, g_configPath.c_str()) != 0;
+        bool en = ConfigGetInt(section.c_str(), key,
+            g_dspEnabled[i] ? 1 : 0) != 0;
         EnableDSPEffect((DSPEffectType)i, en);
     }
 
@@ -1415,7 +1618,7 @@ bool LoadEffectPreset(const std::wstring& name) {
         if (def.id == ParamId::Volume) continue;
         wchar_t key[64];
         swprintf(key, 64, L"Param%d", (int)def.id);
-        float val = GetPrivateProfileFloatW_Preset(section.c_str(), key, g_paramValues[(int)def.id]);
+        float val = ConfigGetFloat(section.c_str(), key, g_paramValues[(int)def.id]);
         SetParamValue(def.id, val);
     }
 
@@ -1426,7 +1629,7 @@ bool DeleteEffectPreset(const std::wstring& name) {
     if (name.empty()) return false;
     std::wstring section = PresetSectionName(name);
     // Wipe the preset's entire section
-    WritePrivateProfileStringW(section.c_str(), nullptr, nullptr, g_configPath.c_str());
+    ConfigWriteString(section.c_str(), nullptr, nullptr);
 
     auto names = GetEffectPresetNames();
     bool found = false;
@@ -0,0 +1,505 @@
+#include "file_cache.h"
+#include <vector>
+#include <algorithm>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <atomic>
+#include <memory>
+#include <cstdint>
+#include <cstring>
+
+// Bytes per second the window is sized for (16-bit stereo at 44.1 kHz)
+static const uint64_t WINDOW_BYTES_PER_SECOND = 176400;
+static const uint64_t MIN_WINDOW_BYTES = 1024 * 1024;
+static const uint64_t MAX_WINDOW_BYTES = 64 * 1024 * 1024;
+
+// Size of one read from the file system. Small enough that a seek isn't kept
+// waiting long behind a read-ahead already in flight.
+static const DWORD CHUNK_BYTES = 128 * 1024;
+
+// Don't bother the file system for less than this unless it's the end of the file
+static const uint64_t MIN_READ_BYTES = 16 * 1024;
+
+// Prefetch the end of a file too (ID3v1/APE tags, an MP4 index at the end)
+static const uint64_t PREFETCH_TAIL_BYTES = 256 * 1024;
+
+// Ring size for a read-ahead window of the given length
+static uint64_t WindowBytes(int readAheadSeconds) {
+    uint64_t bytes = WINDOW_BYTES_PER_SECOND * static_cast<uint64_t>(readAheadSeconds);
+    return std::max(MIN_WINDOW_BYTES, std::min(bytes, MAX_WINDOW_BYTES));
+}
+
+// Read at an offset, returns bytes read (short only at the end of the file or on error)
+static DWORD ReadFileAt(HANDLE file, uint64_t offset, char* buffer, DWORD length) {
+    DWORD total = 0;
+    while (total < length) {
+        OVERLAPPED ov = {};
+        uint64_t at = offset + total;
+        ov.Offset = static_cast<DWORD>(at);
+        ov.OffsetHigh = static_cast<DWORD>(at >> 32);
+        DWORD got = 0;
+        if (!ReadFile(file, buffer + total, length - total, &got, &ov) || got == 0) break;
+        total += got;
+    }
+    return total;
+}
+
+class ReadAheadFile {
+public:
+    ReadAheadFile(HANDLE file, uint64_t size, uint64_t capacity)
+        : m_file(file), m_size(size), m_capacity(capacity),
+          m_keepBehind(capacity / 8), m_ring(static_cast<size_t>(capacity)) {}
+
+    ~ReadAheadFile() {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stop = true;
+        }
+        m_wakeReader.notify_all();
+        m_dataReady.notify_all();
+        if (m_reader.joinable()) m_reader.join();
+        CloseHandle(m_file);
+    }
+
+    // Start with prefetched data: the file's first bytes and its last ones
+    void Seed(const std::vector<char>& head, std::vector<char> tail) {
+        size_t n = std::min(head.size(), static_cast<size_t>(m_capacity));
+        if (n) memcpy(&m_ring[0], head.data(), n);
+        m_winEnd = n;
+        m_tail = std::move(tail);
+        m_tailStart = m_size - m_tail.size();
+    }
+
+    void Start() {
+        m_reader = std::thread(&ReadAheadFile::ReaderLoop, this);
+    }
+
+    // Held by the opener and by BASS (released by the close callback)
+    std::atomic<int> refs{2};
+    std::atomic<bool> closeCalled{false};
+    void Release() {
+        if (--refs == 0) delete this;
+    }
+
+    QWORD Length() const { return m_size; }
+
+    // Decoder thread: copy from the window, waiting for the reader as needed
+    DWORD Read(void* buffer, DWORD length) {
+        char* out = static_cast<char*>(buffer);
+        DWORD total = 0;
+        std::unique_lock<std::mutex> lock(m_mutex);
+        while (total < length && !m_stop && m_readPos < m_size) {
+            if (!m_tail.empty() && m_readPos >= m_tailStart) {
+                DWORD n = static_cast<DWORD>(std::min<uint64_t>(length - total, m_size - m_readPos));
+                memcpy(out + total, &m_tail[static_cast<size_t>(m_readPos - m_tailStart)], n);
+                m_readPos += n;
+                total += n;
+                continue;
+            }
+            if (m_readPos >= m_winStart && m_readPos < m_winEnd) {
+                DWORD n = static_cast<DWORD>(std::min<uint64_t>(length - total, m_winEnd - m_readPos));
+                CopyOut(m_readPos, out + total, n);
+                m_readPos += n;
+                total += n;
+                m_wakeReader.notify_one();  // Room may have opened up
+                continue;
+            }
+
+            // Just past the window: the reader is heading there anyway
+            bool ahead = !m_fetchPending && m_readPos >= m_winEnd && m_readPos - m_winEnd <= CHUNK_BYTES;
+            if (!ahead && !(m_fetchPending && m_fetchPos == m_readPos)) {
+                RequestFetch(m_readPos);
+            }
+            if (m_failed && !m_fetchPending) break;  // Read error: hand over what we have
+            m_dataReady.wait(lock);
+        }
+        return total;
+    }
+
+    BOOL Seek(QWORD offset) {
+        if (offset > m_size) return FALSE;
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_readPos = offset;
+        // Fetch at once rather than on the next read
+        bool inTail = !m_tail.empty() && offset >= m_tailStart;
+        if (!inTail && (offset < m_winStart || offset > m_winEnd + CHUNK_BYTES)) {
+            RequestFetch(offset);
+        }
+        return TRUE;
+    }
+
+private:
+    // Caller holds the lock
+    void RequestFetch(uint64_t pos) {
+        m_fetchPos = pos;
+        m_fetchPending = true;
+        m_generation++;
+        m_wakeReader.notify_one();
+    }
+
+    // How much the reader may read next (caller holds the lock)
+    uint64_t Fillable() const {
+        if (m_winEnd >= m_size) return 0;
+        uint64_t room = m_capacity - (m_winEnd - m_winStart);
+        // Data well behind the decoder can be dropped to make room
+        uint64_t keepFrom = (m_readPos > m_keepBehind) ? m_readPos - m_keepBehind : 0;
+        if (keepFrom > m_winStart) room += std::min(keepFrom, m_winEnd) - m_winStart;
+        uint64_t want = std::min<uint64_t>(std::min<uint64_t>(room, CHUNK_BYTES), m_size - m_winEnd);
+        if (want < MIN_READ_BYTES && m_winEnd + want < m_size) return 0;
+        return want;
+    }
+
+    void CopyOut(uint64_t pos, char* out, size_t n) const {
+        size_t at = static_cast<size_t>(pos % m_capacity);
+        size_t first = std::min(n, static_cast<size_t>(m_capacity) - at);
+        memcpy(out, &m_ring[at], first);
+        if (first < n) memcpy(out + first, &m_ring[0], n - first);
+    }
+
+    // Append to the window, dropping its oldest data if needed (caller holds the lock)
+    void Store(const char* data, size_t n) {
+        if (m_winEnd - m_winStart + n > m_capacity) {
+            m_winStart = m_winEnd + n - m_capacity;
+        }
+        size_t at = static_cast<size_t>(m_winEnd % m_capacity);
+        size_t first = std::min(n, static_cast<size_t>(m_capacity) - at);
+        memcpy(&m_ring[at], data, first);
+        if (first < n) memcpy(&m_ring[0], data + first, n - first);
+        m_winEnd += n;
+    }
+
+    void ReaderLoop() {
+        std::vector<char> chunk(CHUNK_BYTES);
+        std::unique_lock<std::mutex> lock(m_mutex);
+        while (!m_stop) {
+            if (m_fetchPending) {
+                m_winStart = m_winEnd = m_fetchPos;
+                m_fetchPending = false;
+                m_failed = false;
+            }
+            uint64_t want = Fillable();
+            if (want == 0) {
+                m_wakeReader.wait(lock);
+                continue;
+            }
+
+            uint64_t offset = m_winEnd;
+            unsigned generation = m_generation;
+            lock.unlock();
+            DWORD got = ReadFileAt(m_file, offset, chunk.data(), static_cast<DWORD>(want));
+            lock.lock();
+
+            if (generation != m_generation) continue;  // A seek re-targeted the window
+            if (got == 0) {
+                m_failed = true;
+                m_dataReady.notify_all();
+                m_wakeReader.wait(lock, [this] { return m_stop || m_fetchPending; });
+                continue;
+            }
+            Store(chunk.data(), got);
+            m_dataReady.notify_all();
+        }
+    }
+
+    HANDLE m_file;
+    const uint64_t m_size;
+    const uint64_t m_capacity;
+    const uint64_t m_keepBehind;  // Kept behind the decoder for short backward seeks
+    std::vector<char> m_ring;
+    std::vector<char> m_tail;  // Prefetched end of the file (read-only once started)
+    uint64_t m_tailStart = 0;
+
+    std::mutex m_mutex;
+    std::condition_variable m_wakeReader;
+    std::condition_variable m_dataReady;
+    std::thread m_reader;
+
+    uint64_t m_winStart = 0;  // File range held in the ring
+    uint64_t m_winEnd = 0;
+    uint64_t m_readPos = 0;   // Decoder position
+    uint64_t m_fetchPos = 0;
+    bool m_fetchPending = false;
+    unsigned m_generation = 0;
+    bool m_failed = false;
+    bool m_stop = false;
+};
+
+static void CALLBACK CacheClose(void* user) {
+    ReadAheadFile* file = static_cast<ReadAheadFile*>(user);
+    file->closeCalled = true;
+    file->Release();
+}
+
+static QWORD CALLBACK CacheLength(void* user) {
+    return static_cast<ReadAheadFile*>(user)->Length();
+}
+
+static DWORD CALLBACK CacheRead(void* buffer, DWORD length, void* user) {
+    return static_cast<ReadAheadFile*>(user)->Read(buffer, length);
+}
+
+static BOOL CALLBACK CacheSeek(QWORD offset, void* user) {
+    return static_cast<ReadAheadFile*>(user)->Seek(offset);
+}
+
+static const BASS_FILEPROCS g_cacheProcs = {CacheClose, CacheLength, CacheRead, CacheSeek};
+
+// ============================================================================
+// Predictive prefetch
+// ============================================================================
+
+// The start and end of an upcoming file, with the file kept open so the
+// eventual open doesn't wait on the network either
+struct PrefetchedFile {
+    std::wstring path;
+    HANDLE file = INVALID_HANDLE_VALUE;
+    uint64_t size = 0;
+    FILETIME writeTime = {};
+    std::vector<char> head;  // From offset 0
+    std::vector<char> tail;  // The last bytes of the file
+
+    ~PrefetchedFile() {
+        if (file != INVALID_HANDLE_VALUE) CloseHandle(file);
+    }
+    size_t Bytes() const { return head.size() + tail.size(); }
+};
+
+static std::mutex g_prefetchMutex;
+static std::condition_variable g_prefetchWake;
+static std::thread g_prefetchThread;
+static bool g_prefetchShutdown = false;
+static std::vector<std::wstring> g_prefetchWanted;   // Play order
+static std::vector<std::wstring> g_prefetchFailed;   // Not retried while still wanted
+static std::vector<std::shared_ptr<PrefetchedFile>> g_prefetched;
+static uint64_t g_prefetchHeadBytes = 0;
+static size_t g_prefetchBudget = 0;
+static std::atomic<unsigned> g_prefetchGeneration(0);  // Bumped when the list changes
+
+static bool SamePath(const std::wstring& a, const std::wstring& b) {
+    return _wcsicmp(a.c_str(), b.c_str()) == 0;
+}
+
+// Position in the wanted list, -1 if not wanted (caller holds the lock)
+static int WantedRank(const std::wstring& path) {
+    for (size_t i = 0; i < g_prefetchWanted.size(); i++) {
+        if (SamePath(g_prefetchWanted[i], path)) return static_cast<int>(i);
+    }
+    return -1;
+}
+
+static bool IsPrefetchedOrFailed(const std::wstring& path) {
+    for (const auto& entry : g_prefetched) {
+        if (SamePath(entry->path, path)) return true;
+    }
+    for (const auto& failed : g_prefetchFailed) {
+        if (SamePath(failed, path)) return true;
+    }
+    return false;
+}
+
+// Read the start and end of a file. Returns nullptr on failure, or with
+// 'aborted' set if the file stopped being wanted meanwhile.
+static std::shared_ptr<PrefetchedFile> FetchFile(const std::wstring& path, uint64_t headBytes,
+                                                 size_t allowance, bool& aborted) {
+    aborted = false;
+    auto entry = std::make_shared<PrefetchedFile>();
+    entry->path = path;
+    entry->file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                              nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (entry->file == INVALID_HANDLE_VALUE) return nullptr;
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(entry->file, &size) || size.QuadPart <= 0 ||
+        !GetFileTime(entry->file, nullptr, nullptr, &entry->writeTime)) {
+        return nullptr;
+    }
+    entry->size = static_cast<uint64_t>(size.QuadPart);
+
+    uint64_t head = std::min(entry->size, headBytes);
+    uint64_t tail = std::min(entry->size - head, PREFETCH_TAIL_BYTES);
+    if (head + tail > allowance) {
+        tail = std::min<uint64_t>(tail, allowance / 4);
+        head = allowance - tail;
+    }
+    entry->head.resize(static_cast<size_t>(head));
+    entry->tail.resize(static_cast<size_t>(tail));
+
+    // Read in chunks, giving up as soon as the file drops off the list
+    unsigned generation = g_prefetchGeneration;
+    auto stillWanted = [&]() {
+        if (g_prefetchGeneration == generation) return true;
+        std::lock_guard<std::mutex> lock(g_prefetchMutex);
+        generation = g_prefetchGeneration;
+        return !g_prefetchShutdown && WantedRank(path) >= 0;
+    };
+    for (uint64_t done = 0; done < head; done += CHUNK_BYTES) {
+        if (!stillWanted()) {
+            aborted = true;
+            return nullptr;
+        }
+        DWORD n = static_cast<DWORD>(std::min<uint64_t>(CHUNK_BYTES, head - done));
+        if (ReadFileAt(entry->file, done, &entry->head[static_cast<size_t>(done)], n) != n) return nullptr;
+    }
+    if (tail > 0 &&
+        ReadFileAt(entry->file, entry->size - tail, entry->tail.data(), static_cast<DWORD>(tail)) != tail) {
+        return nullptr;
+    }
+    return entry;
+}
+
+static void PrefetchThread() {
+    // Upcoming tracks matter less than the one playing
+    SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_BELOW_NORMAL);
+
+    std::unique_lock<std::mutex> lock(g_prefetchMutex);
+    while (!g_prefetchShutdown) {
+        // Next wanted file that isn't in memory yet
+        std::wstring path;
+        int rank = -1;
+        for (size_t i = 0; i < g_prefetchWanted.size(); i++) {
+            if (!IsPrefetchedOrFailed(g_prefetchWanted[i])) {
+                path = g_prefetchWanted[i];
+                rank = static_cast<int>(i);
+                break;
+            }
+        }
+
+        // Make room by dropping files that play later than this one
+        size_t used = 0;
+        for (const auto& entry : g_prefetched) used += entry->Bytes();
+        while (!path.empty() && used + MIN_READ_BYTES > g_prefetchBudget) {
+            auto latest = g_prefetched.end();
+            for (auto it = g_prefetched.begin(); it != g_prefetched.end(); ++it) {
+                int r = WantedRank((*it)->path);
+                if (r > rank && (latest == g_prefetched.end() || r > WantedRank((*latest)->path))) latest = it;
+            }
+            if (latest == g_prefetched.end()) break;
+            used -= (*latest)->Bytes();
+            g_prefetched.erase(latest);
+        }
+
+        if (path.empty() || used + MIN_READ_BYTES > g_prefetchBudget) {
+            g_prefetchWake.wait(lock);
+            continue;
+        }
+
+        uint64_t headBytes = g_prefetchHeadBytes;
+        size_t allowance = g_prefetchBudget - used;
+        lock.unlock();
+        bool aborted = false;
+        std::shared_ptr<PrefetchedFile> entry = FetchFile(path, headBytes, allowance, aborted);
+        lock.lock();
+
+        if (WantedRank(path) < 0 || IsPrefetchedOrFailed(path)) continue;  // List changed meanwhile
+        if (entry) {
+            g_prefetched.push_back(entry);
+        } else if (!aborted) {
+            g_prefetchFailed.push_back(path);
+        }
+    }
+}
+
+void SetPrefetchList(const std::vector<std::wstring>& paths, int readAheadSeconds, size_t budgetBytes) {
+    std::vector<std::shared_ptr<PrefetchedFile>> released;  // Closed outside the lock
+    {
+        std::lock_guard<std::mutex> lock(g_prefetchMutex);
+        g_prefetchWanted = paths;
+        g_prefetchHeadBytes = WindowBytes(readAheadSeconds);
+        g_prefetchBudget = budgetBytes;
+        g_prefetchGeneration++;
+
+        for (auto it = g_prefetched.begin(); it != g_prefetched.end();) {
+            if (WantedRank((*it)->path) < 0) {
+                released.push_back(*it);
+                it = g_prefetched.erase(it);
+            } else {
+                ++it;
+            }
+        }
+        g_prefetchFailed.erase(std::remove_if(g_prefetchFailed.begin(), g_prefetchFailed.end(),
+                                              [](const std::wstring& p) { return WantedRank(p) < 0; }),
+                               g_prefetchFailed.end());
+
+        if (!paths.empty() && !g_prefetchThread.joinable() && !g_prefetchShutdown) {
+            g_prefetchThread = std::thread(PrefetchThread);
+        }
+    }
+    g_prefetchWake.notify_all();
+}
+
+void ShutdownPrefetch() {
+    std::vector<std::shared_ptr<PrefetchedFile>> released;
+    {
+        std::lock_guard<std::mutex> lock(g_prefetchMutex);
+        g_prefetchShutdown = true;
+        g_prefetchGeneration++;
+        g_prefetchWanted.clear();
+        released.swap(g_prefetched);
+    }
+    g_prefetchWake.notify_all();
+    if (g_prefetchThread.joinable()) g_prefetchThread.join();
+}
+
+// Claim a prefetched file (it won't be fetched again while it stays listed)
+static std::shared_ptr<PrefetchedFile> TakePrefetched(const wchar_t* path) {
+    std::lock_guard<std::mutex> lock(g_prefetchMutex);
+    for (auto it = g_prefetched.begin(); it != g_prefetched.end(); ++it) {
+        if (SamePath((*it)->path, path)) {
+            std::shared_ptr<PrefetchedFile> entry = *it;
+            g_prefetched.erase(it);
+            int rank = WantedRank(entry->path);
+            if (rank >= 0) g_prefetchWanted.erase(g_prefetchWanted.begin() + rank);
+            return entry;
+        }
+    }
+    return nullptr;
+}
+
+HSTREAM CreateCachedFileStream(const wchar_t* path, DWORD flags, int readAheadSeconds) {
+    if (readAheadSeconds <= 0) return 0;
+
+    // Prefer the prefetched handle and data, if the file hasn't changed since
+    std::shared_ptr<PrefetchedFile> prefetched = TakePrefetched(path);
+    HANDLE file = INVALID_HANDLE_VALUE;
+    uint64_t fileSize = 0;
+    if (prefetched) {
+        LARGE_INTEGER size;
+        FILETIME writeTime;
+        if (GetFileSizeEx(prefetched->file, &size) && static_cast<uint64_t>(size.QuadPart) == prefetched->size &&
+            GetFileTime(prefetched->file, nullptr, nullptr, &writeTime) &&
+            CompareFileTime(&writeTime, &prefetched->writeTime) == 0) {
+            file = prefetched->file;
+            prefetched->file = INVALID_HANDLE_VALUE;  // The cache owns it now
+            fileSize = prefetched->size;
+        } else {
+            prefetched.reset();
+        }
+    }
+
+    if (file == INVALID_HANDLE_VALUE) {
+        file = CreateFileW(path, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                           nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if (file == INVALID_HANDLE_VALUE) return 0;
+        LARGE_INTEGER size;
+        if (!GetFileSizeEx(file, &size) || size.QuadPart <= 0) {
+            CloseHandle(file);
+            return 0;
+        }
+        fileSize = static_cast<uint64_t>(size.QuadPart);
+    }
+
+    uint64_t capacity = WindowBytes(readAheadSeconds);
+    if (prefetched) capacity = std::max<uint64_t>(capacity, prefetched->head.size());
+    capacity = std::min(capacity, fileSize);  // Small files are read whole
+
+    ReadAheadFile* cache = new ReadAheadFile(file, fileSize, capacity);
+    if (prefetched) cache->Seed(prefetched->head, std::move(prefetched->tail));
+    cache->Start();
+
+    HSTREAM stream = BASS_StreamCreateFileUser(STREAMFILE_NOBUFFER, flags, &g_cacheProcs, cache);
+    if (!stream && !cache->closeCalled) {
+        cache->Release();  // BASS never took its reference
+    }
+    cache->Release();
+    return stream;
+}
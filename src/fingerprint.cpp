@@ -0,0 +1,163 @@
+#include "fingerprint.h"
+#include "utils.h"
+#include <windows.h>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+#include <cstring>
+
+// Bytes hashed at each end of the file
+static const int64_t FINGERPRINT_CHUNK = 64 * 1024;
+
+// Fingerprints kept for files seen recently
+static const size_t FINGERPRINT_CACHE_SIZE = 256;
+
+// XXH64: four independent 64-bit lanes over each 32-byte stripe, so the
+// multiplies of one stripe overlap instead of waiting on each other
+static const uint64_t PRIME1 = 11400714785074694791ULL;
+static const uint64_t PRIME2 = 14029467366897019727ULL;
+static const uint64_t PRIME3 = 1609587929392839161ULL;
+static const uint64_t PRIME4 = 9650029242287828579ULL;
+static const uint64_t PRIME5 = 2870177450012600261ULL;
+
+static inline uint64_t Rotl64(uint64_t x, int r) {
+    return (x << r) | (x >> (64 - r));
+}
+
+static inline uint64_t Read64(const uint8_t* p) {
+    uint64_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static inline uint32_t Read32(const uint8_t* p) {
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static inline uint64_t Round(uint64_t acc, uint64_t input) {
+    acc += input * PRIME2;
+    acc = Rotl64(acc, 31);
+    return acc * PRIME1;
+}
+
+static inline uint64_t MergeRound(uint64_t acc, uint64_t val) {
+    acc ^= Round(0, val);
+    return acc * PRIME1 + PRIME4;
+}
+
+static uint64_t Hash64(const uint8_t* data, size_t length, uint64_t seed) {
+    const uint8_t* p = data;
+    const uint8_t* end = data + length;
+    uint64_t h;
+
+    if (length >= 32) {
+        const uint8_t* limit = end - 32;
+        uint64_t v1 = seed + PRIME1 + PRIME2;
+        uint64_t v2 = seed + PRIME2;
+        uint64_t v3 = seed;
+        uint64_t v4 = seed - PRIME1;
+        do {
+            v1 = Round(v1, Read64(p));
+            v2 = Round(v2, Read64(p + 8));
+            v3 = Round(v3, Read64(p + 16));
+            v4 = Round(v4, Read64(p + 24));
+            p += 32;
+        } while (p <= limit);
+        h = Rotl64(v1, 1) + Rotl64(v2, 7) + Rotl64(v3, 12) + Rotl64(v4, 18);
+        h = MergeRound(h, v1);
+        h = MergeRound(h, v2);
+        h = MergeRound(h, v3);
+        h = MergeRound(h, v4);
+    } else {
+        h = seed + PRIME5;
+    }
+    h += static_cast<uint64_t>(length);
+
+    while (p + 8 <= end) {
+        h ^= Round(0, Read64(p));
+        h = Rotl64(h, 27) * PRIME1 + PRIME4;
+        p += 8;
+    }
+    if (p + 4 <= end) {
+        h ^= static_cast<uint64_t>(Read32(p)) * PRIME1;
+        h = Rotl64(h, 23) * PRIME2 + PRIME3;
+        p += 4;
+    }
+    while (p < end) {
+        h ^= (*p) * PRIME5;
+        h = Rotl64(h, 11) * PRIME1;
+        p++;
+    }
+
+    h ^= h >> 33;
+    h *= PRIME2;
+    h ^= h >> 29;
+    h *= PRIME3;
+    h ^= h >> 32;
+    return h;
+}
+
+static bool ReadAt(HANDLE file, int64_t offset, uint8_t* buffer, DWORD length) {
+    LARGE_INTEGER pos;
+    pos.QuadPart = offset;
+    if (!SetFilePointerEx(file, pos, nullptr, FILE_BEGIN)) return false;
+    DWORD read = 0;
+    return ReadFile(file, buffer, length, &read, nullptr) && read == length;
+}
+
+// Hash the first and last FINGERPRINT_CHUNK bytes (the whole file if it is
+// no longer than both)
+static bool ComputeFingerprint(const std::wstring& path, int64_t size, uint64_t& hash) {
+    HANDLE file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                              nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) return false;
+
+    int64_t head = size < FINGERPRINT_CHUNK ? size : FINGERPRINT_CHUNK;
+    int64_t tailStart = size - FINGERPRINT_CHUNK > head ? size - FINGERPRINT_CHUNK : head;
+    std::vector<uint8_t> buffer(static_cast<size_t>(head + (size - tailStart)));
+
+    bool ok = ReadAt(file, 0, buffer.data(), static_cast<DWORD>(head));
+    if (ok && size > tailStart) {
+        ok = ReadAt(file, tailStart, buffer.data() + head, static_cast<DWORD>(size - tailStart));
+    }
+    CloseHandle(file);
+    if (!ok) return false;
+
+    hash = Hash64(buffer.data(), buffer.size(), 0);
+    return true;
+}
+
+struct CachedFingerprint {
+    int64_t modified;
+    FileFingerprint fingerprint;
+};
+
+static std::mutex g_fingerprintMutex;
+static std::unordered_map<std::wstring, CachedFingerprint> g_fingerprints;
+
+bool GetFileFingerprint(const std::wstring& path, FileFingerprint& fingerprint) {
+    int64_t size, modified;
+    if (!GetFileIdentity(path, size, modified)) return false;
+
+    {
+        std::lock_guard<std::mutex> lock(g_fingerprintMutex);
+        auto found = g_fingerprints.find(path);
+        if (found != g_fingerprints.end() && found->second.modified == modified &&
+            found->second.fingerprint.size == size) {
+            fingerprint = found->second.fingerprint;
+            return true;
+        }
+    }
+
+    uint64_t hash;
+    if (!ComputeFingerprint(path, size, hash)) return false;
+    fingerprint.size = size;
+    fingerprint.hash = hash;
+
+    std::lock_guard<std::mutex> lock(g_fingerprintMutex);
+    if (g_fingerprints.size() >= FINGERPRINT_CACHE_SIZE) g_fingerprints.clear();
+    g_fingerprints[path] = CachedFingerprint{modified, fingerprint};
+    return true;
+}
@@ -0,0 +1,350 @@
+#include "folder_scan.h"
+#include "ui.h"
+#include <windows.h>
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <cwctype>
+
+// Same limit as the library scan
+static const int MAX_FOLDER_DEPTH = 32;
+
+// Folders waiting in one thread's queue before it lists further ones itself
+static const size_t FOLDER_QUEUE_SIZE = 256;
+
+// Threads listing folders at once (the calling thread is one of them)
+static const unsigned MAX_FOLDER_THREADS = 8;
+
+// Names held by the listing cache before it starts afresh
+static const size_t LISTING_CACHE_NAMES = 250000;
+
+// A listing taken less than this long (100 ns units) after the folder last
+// changed is not reused, as a change within the same tick of a coarse file
+// system clock (2 seconds on FAT) would leave the time the same
+static const int64_t LISTING_SETTLE_TIME = 3 * 10000000LL;
+
+struct FolderListing {
+    int64_t modified;                  // The folder's last write time when listed
+    bool settled;                      // Listed well after that, so reusable
+    std::vector<std::wstring> files;   // Audio files, natural order
+    std::vector<std::wstring> folders; // Subfolders, natural order
+};
+typedef std::shared_ptr<const FolderListing> FolderListingPtr;
+
+static std::mutex g_listingMutex;
+static std::unordered_map<std::wstring, FolderListingPtr> g_listings;  // By lowercased path
+static size_t g_listingNames = 0;
+
+static inline wchar_t FoldChar(wchar_t c) {
+    // Separators before anything else, so "Disc 1\" comes before "Disc 1 (Bonus)\"
+    if (c == L'\\' || c == L'/') return 1;
+    if (c < 0x80) return (c >= L'A' && c <= L'Z') ? static_cast<wchar_t>(c + (L'a' - L'A')) : c;
+    return static_cast<wchar_t>(towlower(c));
+}
+
+static inline bool IsDigit(wchar_t c) {
+    return c >= L'0' && c <= L'9';
+}
+
+// <0, 0 or >0 as a comes before, with or after b: letters ignoring case, runs
+// of digits by value (then fewer leading zeros first), ties by exact text
+static int CompareNatural(const wchar_t* a, const wchar_t* b) {
+    const wchar_t* startA = a;
+    const wchar_t* startB = b;
+    int zeros = 0;
+    while (*a && *b) {
+        if (IsDigit(*a) && IsDigit(*b)) {
+            const wchar_t* runA = a;
+            const wchar_t* runB = b;
+            while (*runA == L'0') runA++;
+            while (*runB == L'0') runB++;
+            const wchar_t* endA = runA;
+            const wchar_t* endB = runB;
+            while (IsDigit(*endA)) endA++;
+            while (IsDigit(*endB)) endB++;
+
+            // Longer without leading zeros is larger; same length compares digit by digit
+            if (endA - runA != endB - runB) return (endA - runA) < (endB - runB) ? -1 : 1;
+            for (; runA < endA; runA++, runB++) {
+                if (*runA != *runB) return *runA < *runB ? -1 : 1;
+            }
+            if (zeros == 0 && (endA - a) != (endB - b)) zeros = (endA - a) < (endB - b) ? -1 : 1;
+            a = endA;
+            b = endB;
+            continue;
+        }
+        wchar_t ca = FoldChar(*a);
+        wchar_t cb = FoldChar(*b);
+        if (ca != cb) return ca < cb ? -1 : 1;
+        a++;
+        b++;
+    }
+    if (*a || *b) return *a ? 1 : -1;
+    if (zeros != 0) return zeros;
+    return wcscmp(startA, startB);
+}
+
+bool NaturalLess(const std::wstring& a, const std::wstring& b) {
+    return CompareNatural(a.c_str(), b.c_str()) < 0;
+}
+
+static std::wstring JoinPath(const std::wstring& folder, const std::wstring& name) {
+    if (!folder.empty() && (folder.back() == L'\\' || folder.back() == L'/')) return folder + name;
+    return folder + L"\\" + name;
+}
+
+static std::wstring FoldPath(const std::wstring& path) {
+    std::wstring folded(path);
+    for (auto& c : folded) {
+        if (c == L'/') c = L'\\';
+        else c = static_cast<wchar_t>(towlower(c));
+    }
+    while (folded.size() > 1 && folded.back() == L'\\') folded.pop_back();
+    return folded;
+}
+
+static bool GetFolderModified(const std::wstring& folder, int64_t& modified) {
+    WIN32_FILE_ATTRIBUTE_DATA data;
+    if (!GetFileAttributesExW(folder.c_str(), GetFileExInfoStandard, &data)) return false;
+    if (!(data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)) return false;
+    modified = (static_cast<int64_t>(data.ftLastWriteTime.dwHighDateTime) << 32) |
+               data.ftLastWriteTime.dwLowDateTime;
+    return true;
+}
+
+static FolderListingPtr ReadListing(const std::wstring& folder, int64_t modified) {
+    WIN32_FIND_DATAW fd;
+    HANDLE hFind = FindFirstFileExW(JoinPath(folder, L"*").c_str(), FindExInfoBasic, &fd,
+                                    FindExSearchNameMatch, nullptr, FIND_FIRST_EX_LARGE_FETCH);
+    if (hFind == INVALID_HANDLE_VALUE) return nullptr;
+
+    FILETIME now;
+    GetSystemTimeAsFileTime(&now);
+    int64_t listed = (static_cast<int64_t>(now.dwHighDateTime) << 32) | now.dwLowDateTime;
+
+    std::shared_ptr<FolderListing> listing = std::make_shared<FolderListing>();
+    listing->modified = modified;
+    listing->settled = listed - modified >= LISTING_SETTLE_TIME;
+    do {
+        if (wcscmp(fd.cFileName, L".") == 0 || wcscmp(fd.cFileName, L"..") == 0) continue;
+
+        // Skip reparse points (junctions, symlinks) to avoid infinite loops
+        if (fd.dwFileAttributes & FILE_ATTRIBUTE_REPARSE_POINT) continue;
+
+        if (fd.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) {
+            listing->folders.push_back(fd.cFileName);
+            continue;
+        }
+        const wchar_t* dot = wcsrchr(fd.cFileName, L'.');
+        if (dot && IsSupportedAudioExt(dot)) listing->files.push_back(fd.cFileName);
+    } while (FindNextFileW(hFind, &fd));
+    FindClose(hFind);
+
+    std::sort(listing->files.begin(), listing->files.end(), NaturalLess);
+    std::sort(listing->folders.begin(), listing->folders.end(), NaturalLess);
+    return listing;
+}
+
+// The folder's listing, from the cache if it hasn't changed since
+static FolderListingPtr GetListing(const std::wstring& folder) {
+    int64_t modified;
+    if (!GetFolderModified(folder, modified)) return nullptr;
+
+    std::wstring key = FoldPath(folder);
+    {
+        std::lock_guard<std::mutex> lock(g_listingMutex);
+        auto found = g_listings.find(key);
+        if (found != g_listings.end() && found->second->settled && found->second->modified == modified) {
+            return found->second;
+        }
+    }
+
+    FolderListingPtr listing = ReadListing(folder, modified);
+    if (!listing) return nullptr;
+
+    size_t names = listing->files.size() + listing->folders.size();
+    std::lock_guard<std::mutex> lock(g_listingMutex);
+    auto found = g_listings.find(key);
+    if (found != g_listings.end()) {
+        g_listingNames -= found->second->files.size() + found->second->folders.size();
+        g_listings.erase(found);
+    }
+    if (g_listingNames + names > LISTING_CACHE_NAMES) {
+        g_listings.clear();
+        g_listingNames = 0;
+    }
+    if (names <= LISTING_CACHE_NAMES) {
+        g_listings[key] = listing;
+        g_listingNames += names;
+    }
+    return listing;
+}
+
+struct FolderTask {
+    std::wstring path;
+    int depth;
+};
+
+// One thread's folders still to list; it takes the newest, others take the oldest
+struct FolderQueue {
+    std::mutex mutex;
+    std::deque<FolderTask> tasks;
+};
+
+class FolderWalker {
+public:
+    explicit FolderWalker(unsigned threads) : m_queues(threads), m_pending(0), m_queued(0), m_idle(0) {
+        for (auto& queue : m_queues) queue.reset(new FolderQueue());
+    }
+
+    // List root's subfolders, root's own listing already in hand
+    void Run(const std::wstring& root, const FolderListingPtr& listing) {
+        m_listings[root] = listing;
+
+        // Root counts as pending until its subfolders are queued, so the
+        // other threads don't finish before there is anything to take
+        m_pending = 1;
+        std::vector<std::thread> threads;
+        for (unsigned i = 1; i < m_queues.size(); i++) threads.emplace_back(&FolderWalker::Work, this, i);
+        for (const auto& name : listing->folders) Push(0, FolderTask{JoinPath(root, name), 1});
+        Finish();
+        Work(0);
+        for (auto& thread : threads) thread.join();
+    }
+
+    FolderListingPtr Listing(const std::wstring& path) const {
+        auto found = m_listings.find(path);
+        return found != m_listings.end() ? found->second : nullptr;
+    }
+
+private:
+    // Queue a folder, or list it here and now if this thread's queue is full
+    void Push(unsigned self, FolderTask task) {
+        FolderQueue& queue = *m_queues[self];
+        bool queued = false;
+        {
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            if (queue.tasks.size() < FOLDER_QUEUE_SIZE) {
+                m_pending++;
+                m_queued++;
+                queue.tasks.push_back(std::move(task));
+                queued = true;
+            }
+        }
+        if (!queued) {
+            List(self, task);
+        } else if (m_idle > 0) {
+            std::lock_guard<std::mutex> lock(m_idleMutex);
+            m_wake.notify_one();
+        }
+    }
+
+    bool Take(unsigned self, FolderTask& task) {
+        {
+            FolderQueue& queue = *m_queues[self];
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            if (!queue.tasks.empty()) {
+                task = std::move(queue.tasks.back());
+                queue.tasks.pop_back();
+                m_queued--;
+                return true;
+            }
+        }
+        for (size_t i = 1; i < m_queues.size(); i++) {
+            FolderQueue& queue = *m_queues[(self + i) % m_queues.size()];
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            if (!queue.tasks.empty()) {
+                task = std::move(queue.tasks.front());
+                queue.tasks.pop_front();
+                m_queued--;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void List(unsigned self, const FolderTask& task) {
+        FolderListingPtr listing = GetListing(task.path);
+        if (!listing) return;
+        {
+            std::lock_guard<std::mutex> lock(m_listingsMutex);
+            m_listings[task.path] = listing;
+        }
+        if (task.depth >= MAX_FOLDER_DEPTH) return;
+        for (const auto& name : listing->folders) Push(self, FolderTask{JoinPath(task.path, name), task.depth + 1});
+    }
+
+    // One queued folder done; wake everyone if it was the last
+    void Finish() {
+        if (--m_pending == 0) {
+            std::lock_guard<std::mutex> lock(m_idleMutex);
+            m_wake.notify_all();
+        }
+    }
+
+    void Work(unsigned self) {
+        for (;;) {
+            FolderTask task;
+            if (Take(self, task)) {
+                List(self, task);
+                Finish();
+                continue;
+            }
+
+            // Nothing to take: wait for more, or finish once every folder is listed
+            std::unique_lock<std::mutex> lock(m_idleMutex);
+            m_idle++;
+            m_wake.wait(lock, [this] { return m_queued > 0 || m_pending == 0; });
+            m_idle--;
+            if (m_queued == 0 && m_pending == 0) return;
+        }
+    }
+
+    std::vector<std::unique_ptr<FolderQueue>> m_queues;
+    std::atomic<int> m_pending;  // Queued or being listed
+    std::atomic<int> m_queued;
+    std::atomic<int> m_idle;     // Threads waiting for work
+    std::mutex m_idleMutex;
+    std::condition_variable m_wake;
+
+    std::mutex m_listingsMutex;
+    std::unordered_map<std::wstring, FolderListingPtr> m_listings;  // By path as walked
+};
+
+// Files of the folder, then of each subfolder in turn
+static void CollectFiles(const FolderWalker& walker, const std::wstring& folder, std::vector<std::wstring>& files) {
+    FolderListingPtr listing = walker.Listing(folder);
+    if (!listing) return;
+    for (const auto& name : listing->files) files.push_back(JoinPath(folder, name));
+    for (const auto& name : listing->folders) CollectFiles(walker, JoinPath(folder, name), files);
+}
+
+void AddAudioFilesFromFolder(const std::wstring& folder, std::vector<std::wstring>& files) {
+    FolderListingPtr listing = GetListing(folder);
+    if (!listing) return;
+    if (listing->folders.empty()) {
+        for (const auto& name : listing->files) files.push_back(JoinPath(folder, name));
+        return;
+    }
+
+    unsigned threads = std::thread::hardware_concurrency();
+    threads = std::max(2u, std::min(threads, MAX_FOLDER_THREADS));
+    FolderWalker walker(threads);
+    walker.Run(folder, listing);
+    CollectFiles(walker, folder, files);
+}
+
+std::vector<std::wstring> GetFolderAudioFiles(const std::wstring& folder) {
+    std::vector<std::wstring> files;
+    FolderListingPtr listing = GetListing(folder);
+    if (!listing) return files;
+    files.reserve(listing->files.size());
+    for (const auto& name : listing->files) files.push_back(JoinPath(folder, name));
+    return files;
+}
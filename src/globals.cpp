@@ -20,6 +20,7 @@ HWND GetMessageBoxOwner() {
 HSTREAM g_stream = 0;      // Source stream
 HSTREAM g_fxStream = 0;    // Tempo stream (wraps g_stream for pitch/tempo)
 HSTREAM g_sourceStream = 0; // Original decode stream (for bitrate queries)
+HSTREAM g_outputStream = 0; // Persistent output mixer
 HSYNC g_endSync = 0;
 HSYNC g_metaSync = 0;      // Sync for stream metadata changes
 float g_volume = 1.0f;
@@ -31,7 +32,7 @@ bool g_disableBatchDelay = false; // Skip batch delay when opening files from ex
 int g_replayGainMode = 0;          // Off by default (opt-in)
 float g_replayGainPreamp = 0.0f;
 bool g_replayGainPreventClip = true;
-float g_replayGainScale = 1.0f;    // No change until a track with tags is loaded
+std::atomic<float> g_replayGainScale(1.0f);  // No change until a track with tags is loaded
 
 // Effect state
 float g_tempo = 0.0f;
@@ -42,7 +43,7 @@ bool g_isLiveStream = false;      // True if current stream is non-seekable
 int g_currentBitrate = 0;         // Cached bitrate of current file (kbps)
 
 // Playlist
-std::vector<std::wstring> g_playlist;
+Playlist g_playlist;
 int g_currentTrack = -1;
 
 // Loading guards
@@ -56,6 +57,8 @@ int g_rewindOnPauseMs = 0;
 bool g_allowAmplify = false;
 bool g_rememberState = false;
 int g_rememberPosMinutes = 0;
+int g_checkpointSeconds = 30;
+int g_songHistoryLimit = 1000;
 bool g_bringToFront = true;
 bool g_minimizeToTray = true;
 bool g_loadFolder = false;
@@ -71,7 +74,7 @@ bool g_trayIconVisible = false;
 
 // File batching
 std::vector<std::wstring> g_pendingFiles;
-DWORD g_startupTime = 0;
+ULONGLONG g_startupTime = 0;
 
 // Recent files
 std::vector<std::wstring> g_recentFiles;
@@ -239,6 +242,17 @@ const int g_updatePeriodCount = sizeof(g_updatePeriods) / sizeof(g_updatePeriods
 // Tempo/pitch algorithm (0=SoundTouch, 1=Speedy, 2=Signalsmith)
 int g_tempoAlgorithm = 0;  // Default to SoundTouch
 
+// Resampler quality (0=BASS built-in, 1=Low, 2=Medium, 3=High)
+int g_resamplerQuality = 2;
+
+// Read-ahead file cache window in seconds (0 = read files directly)
+int g_readAheadSeconds = 30;
+int g_prefetchTracks = 3;                          // Upcoming tracks to prefetch
+int g_prefetchMemoryMB = 64;                       // Memory budget for prefetched tracks
+
+// Media library scanner threads (0 = automatic)
+int g_libraryScanThreads = 0;
+
 // SoundTouch settings
 bool g_stAntiAliasFilter = true;   // Enable anti-alias filter
 int g_stAAFilterLength = 32;       // AA filter length (8-128 taps)
@@ -255,10 +269,14 @@ bool g_speedyNonlinear = true;     // Enable nonlinear speedup (recommended)
 // Signalsmith Stretch settings
 int g_ssPreset = 0;                // 0=Default, 1=Cheaper
 int g_ssTonalityLimit = 0;         // Tonality limit in Hz (0=auto)
+int g_ssThreads = 0;               // Worker threads for multichannel stretching (0=auto)
 
 // Reverb algorithm (0=Off, 1=Freeverb, 2=DX8, 3=I3DL2)
 int g_reverbAlgorithm = 0;
 
+// Surround downmix (off by default so 5.1/7.1 output is unchanged)
+bool g_downmixStereo = false;
+
 // Convolution reverb settings
 std::wstring g_convolutionIRPath;
 
@@ -296,6 +314,10 @@ bool g_speechEffect = true;                         // Speak effect value when a
 // Shuffle and auto-advance
 bool g_shuffle = false;                             // Shuffle playback order
 bool g_autoAdvance = true;                          // Auto-play next track when current ends
+bool g_gapless = true;                              // Pre-roll the next track for gapless joins
+int g_crossfadeMs = 0;                              // Crossfade off by default
+int g_crossfadeCurve = 1;                           // Equal power
+bool g_crossfadeSmart = true;                       // Skip trailing/leading silence when crossfading
 int g_repeatMode = 0;                               // 0 = off, 1 = repeat one, 2 = repeat all
 
 // Chapter support
@@ -1,5 +1,6 @@
 #include "hotkeys.h"
 #include "globals.h"
+#include "config_store.h"
 #include "types.h"
 #include "resource.h"
 #include <commctrl.h>
@@ -68,16 +69,16 @@ void UnregisterGlobalHotkeys() {
 
 // Load hotkeys from INI file
 void LoadHotkeys() {
-    g_hotkeysEnabled = GetPrivateProfileIntW(L"Hotkeys", L"Enabled", 1, g_configPath.c_str()) != 0;
+    g_hotkeysEnabled = ConfigGetInt(L"Hotkeys", L"Enabled", 1) != 0;
     g_hotkeys.clear();
-    int count = GetPrivateProfileIntW(L"Hotkeys", L"Count", 0, g_configPath.c_str());
+    int count = ConfigGetInt(L"Hotkeys", L"Count", 0);
 
     for (int i = 0; i < count; i++) {
         wchar_t key[32];
         wchar_t value[64] = {0};
 
         swprintf(key, 32, L"Hotkey%d", i);
-        GetPrivateProfileStringW(L"Hotkeys", key, L"", value, 64, g_configPath.c_str());
+        ConfigGetString(L"Hotkeys", key, L"", value, 64);
 
         // Parse "modifiers,vk,actionIdx"
         UINT mods = 0, vk = 0;
@@ -99,16 +100,16 @@ void LoadHotkeys() {
 void SaveHotkeys() {
     wchar_t buf[64];
 
-    WritePrivateProfileStringW(L"Hotkeys", L"Enabled", g_hotkeysEnabled ? L"1" : L"0", g_configPath.c_str());
+    ConfigWriteString(L"Hotkeys", L"Enabled", g_hotkeysEnabled ? L"1" : L"0");
 
     swprintf(buf, 64, L"%d", static_cast<int>(g_hotkeys.size()));
-    WritePrivateProfileStringW(L"Hotkeys", L"Count", buf, g_configPath.c_str());
+    ConfigWriteString(L"Hotkeys", L"Count", buf);
 
     for (size_t i = 0; i < g_hotkeys.size(); i++) {
         wchar_t key[32];
         swprintf(key, 32, L"Hotkey%zu", i);
         swprintf(buf, 64, L"%u,%u,%d", g_hotkeys[i].modifiers, g_hotkeys[i].vk, g_hotkeys[i].actionIdx);
-        WritePrivateProfileStringW(L"Hotkeys", key, buf, g_configPath.c_str());
+        ConfigWriteString(L"Hotkeys", key, buf);
     }
 }
 
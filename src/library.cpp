@@ -0,0 +1,349 @@
+#include "library.h"
+#include "globals.h"
+#include "database.h"
+#include "player.h"
+#include "ui.h"
+#include "bass.h"
+#include "bass_aac.h"
+#include "bassalac.h"
+#include "bassape.h"
+#include "bassdsd.h"
+#include "bassflac.h"
+#include "bassmidi.h"
+#include "bassopus.h"
+#include "basswma.h"
+#include "basswv.h"
+#include <vector>
+#include <deque>
+#include <algorithm>
+#include <unordered_set>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <atomic>
+#include <cstdlib>
+#include <cwctype>
+
+// Files listed but not yet read (the walker waits when the readers fall behind)
+static const size_t READ_QUEUE_LIMIT = 256;
+
+// Tracks a reader collects before writing them in one transaction
+static const size_t SAVE_BATCH = 128;
+
+// Same limit as adding a folder to the playlist
+static const int MAX_FOLDER_DEPTH = 32;
+
+static std::mutex g_libraryMutex;
+static std::condition_variable g_readQueued;   // Files queued, or the walk is over
+static std::condition_variable g_readTaken;    // Room in the queue
+static std::deque<LibraryFileStamp> g_readQueue;
+static bool g_walkDone = false;
+static std::vector<std::wstring> g_scanRoots;
+static bool g_scanRunning = false;
+static bool g_rescanRequested = false;
+static std::atomic<bool> g_scanStop(false);
+static std::thread g_scanThread;
+
+static std::wstring GetCodecName(DWORD ctype) {
+    if (ctype & BASS_CTYPE_STREAM_WAV) return L"WAV";
+    switch (ctype) {
+        case BASS_CTYPE_STREAM_MP1: return L"MP1";
+        case BASS_CTYPE_STREAM_MP2: return L"MP2";
+        case BASS_CTYPE_STREAM_MP3: return L"MP3";
+        case BASS_CTYPE_STREAM_OGG: return L"Vorbis";
+        case BASS_CTYPE_STREAM_AIFF: return L"AIFF";
+        case BASS_CTYPE_STREAM_CA: return L"Core Audio";
+        case BASS_CTYPE_STREAM_MF: return L"Media Foundation";
+        case BASS_CTYPE_STREAM_AAC: return L"AAC";
+        case BASS_CTYPE_STREAM_MP4: return L"AAC (MP4)";
+        case BASS_CTYPE_STREAM_ALAC: return L"ALAC";
+        case BASS_CTYPE_STREAM_APE: return L"Monkey's Audio";
+        case BASS_CTYPE_STREAM_DSD: return L"DSD";
+        case BASS_CTYPE_STREAM_FLAC: return L"FLAC";
+        case BASS_CTYPE_STREAM_FLAC_OGG: return L"FLAC (Ogg)";
+        case BASS_CTYPE_STREAM_MIDI: return L"MIDI";
+        case BASS_CTYPE_STREAM_OPUS: return L"Opus";
+        case BASS_CTYPE_STREAM_WMA: return L"WMA";
+        case BASS_CTYPE_STREAM_WMA_MP3: return L"MP3 (WMA)";
+        case BASS_CTYPE_STREAM_WV: return L"WavPack";
+    }
+    return L"";
+}
+
+// Read a file's tags and format. A file BASS can't open is still recorded
+// (without tags) so it isn't read again on every scan.
+static void ReadLibraryFile(const LibraryFileStamp& file, LibraryTrack& track) {
+    track.path = file.path;
+    track.fileSize = file.fileSize;
+    track.modified = file.modified;
+
+    HSTREAM stream = BASS_StreamCreateFile(FALSE, file.path.c_str(), 0, 0, BASS_STREAM_DECODE | BASS_UNICODE);
+    if (!stream) return;
+
+    StreamTags tags;
+    ReadStreamTags(stream, tags);
+    track.title = tags.title;
+    track.artist = tags.artist;
+    track.album = tags.album;
+    track.albumArtist = tags.albumArtist.empty() ? tags.artist : tags.albumArtist;
+    track.genre = tags.genre;
+    track.year = _wtoi(tags.year.c_str());        // "2003-05-01" reads as 2003
+    track.trackNumber = _wtoi(tags.track.c_str());  // "3/12" reads as 3
+    if (!tags.trackGain.empty()) {
+        track.hasTrackGain = true;
+        track.trackGain = static_cast<float>(strtod(tags.trackGain.c_str(), nullptr));
+        track.trackPeak = static_cast<float>(strtod(tags.trackPeak.c_str(), nullptr));
+    }
+    if (!tags.albumGain.empty()) {
+        track.hasAlbumGain = true;
+        track.albumGain = static_cast<float>(strtod(tags.albumGain.c_str(), nullptr));
+        track.albumPeak = static_cast<float>(strtod(tags.albumPeak.c_str(), nullptr));
+    }
+
+    BASS_CHANNELINFO info;
+    if (BASS_ChannelGetInfo(stream, &info)) {
+        track.codec = GetCodecName(info.ctype);
+        track.sampleRate = static_cast<int>(info.freq);
+        track.channels = static_cast<int>(info.chans);
+    }
+    QWORD length = BASS_ChannelGetLength(stream, BASS_POS_BYTE);
+    if (length != static_cast<QWORD>(-1)) {
+        track.duration = BASS_ChannelBytes2Seconds(stream, length);
+    }
+    float bitrate = 0;
+    if (BASS_ChannelGetAttribute(stream, BASS_ATTRIB_BITRATE, &bitrate) && bitrate > 0) {
+        track.bitrate = static_cast<int>(bitrate);
+    }
+
+    BASS_StreamFree(stream);
+}
+
+static void ReaderThread() {
+    SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_BELOW_NORMAL);
+
+    std::vector<LibraryTrack> batch;
+    for (;;) {
+        LibraryFileStamp file;
+        {
+            std::unique_lock<std::mutex> lock(g_libraryMutex);
+            g_readQueued.wait(lock, [] { return g_scanStop || g_walkDone || !g_readQueue.empty(); });
+            if (g_scanStop || g_readQueue.empty()) break;
+            file = std::move(g_readQueue.front());
+            g_readQueue.pop_front();
+        }
+        g_readTaken.notify_one();
+
+        LibraryTrack track;
+        ReadLibraryFile(file, track);
+        batch.push_back(std::move(track));
+        if (batch.size() >= SAVE_BATCH) {
+            SaveLibraryTracksDB(batch);
+            batch.clear();
+        }
+    }
+    // Whatever was read is complete, even when the scan is stopping
+    SaveLibraryTracksDB(batch);
+}
+
+static bool QueueRead(LibraryFileStamp&& file) {
+    std::unique_lock<std::mutex> lock(g_libraryMutex);
+    g_readTaken.wait(lock, [] { return g_scanStop || g_readQueue.size() < READ_QUEUE_LIMIT; });
+    if (g_scanStop) return false;
+    g_readQueue.push_back(std::move(file));
+    lock.unlock();
+    g_readQueued.notify_one();
+    return true;
+}
+
+static bool StampLess(const LibraryFileStamp& a, const LibraryFileStamp& b) {
+    return a.path < b.path;
+}
+
+// Bring one folder's tracks up to date; subfolders are appended to dirs
+static void ScanFolder(const std::wstring& folder, int depth,
+                       std::vector<std::pair<std::wstring, int>>& dirs) {
+    std::vector<LibraryFileStamp> onDisk;
+    WIN32_FIND_DATAW fd;
+    std::wstring searchPath = folder + L"\\*";
+    HANDLE hFind = FindFirstFileExW(searchPath.c_str(), FindExInfoBasic, &fd, FindExSearchNameMatch,
+                                    nullptr, FIND_FIRST_EX_LARGE_FETCH);
+    // A folder that can't be listed keeps its tracks until it's gone for good
+    if (hFind == INVALID_HANDLE_VALUE) return;
+
+    do {
+        if (wcscmp(fd.cFileName, L".") == 0 || wcscmp(fd.cFileName, L"..") == 0) continue;
+
+        // Skip reparse points (junctions, symlinks) to avoid infinite loops
+        if (fd.dwFileAttributes & FILE_ATTRIBUTE_REPARSE_POINT) continue;
+
+        std::wstring fullPath = folder + L"\\" + fd.cFileName;
+        if (fd.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) {
+            if (depth < MAX_FOLDER_DEPTH) dirs.emplace_back(fullPath, depth + 1);
+            continue;
+        }
+
+        const wchar_t* dot = wcsrchr(fd.cFileName, L'.');
+        if (!dot || !IsSupportedAudioExt(dot)) continue;
+
+        LibraryFileStamp file;
+        file.path = fullPath;
+        file.fileSize = (static_cast<int64_t>(fd.nFileSizeHigh) << 32) | fd.nFileSizeLow;
+        file.modified = (static_cast<int64_t>(fd.ftLastWriteTime.dwHighDateTime) << 32) |
+                        fd.ftLastWriteTime.dwLowDateTime;
+        onDisk.push_back(std::move(file));
+    } while (!g_scanStop && FindNextFileW(hFind, &fd));
+    FindClose(hFind);
+    if (g_scanStop) return;
+
+    // Compare with what the library has for this folder
+    std::vector<LibraryFileStamp> known = GetLibraryFolderStampsDB(folder);
+    std::sort(onDisk.begin(), onDisk.end(), StampLess);
+    std::sort(known.begin(), known.end(), StampLess);
+
+    std::vector<std::wstring> removed;
+    size_t k = 0;
+    for (auto& file : onDisk) {
+        while (k < known.size() && known[k].path < file.path) {
+            removed.push_back(known[k++].path);
+        }
+        bool unchanged = k < known.size() && known[k].path == file.path &&
+                         known[k].fileSize == file.fileSize && known[k].modified == file.modified;
+        if (k < known.size() && known[k].path == file.path) k++;
+        if (!unchanged && !QueueRead(std::move(file))) return;
+    }
+    for (; k < known.size(); k++) removed.push_back(known[k].path);
+    RemoveLibraryTracksDB(removed);
+}
+
+static void ScanRoot(const std::wstring& root) {
+    // An unavailable root (unplugged drive, offline share) keeps its tracks
+    DWORD attributes = GetFileAttributesW(root.c_str());
+    if (attributes == INVALID_FILE_ATTRIBUTES || !(attributes & FILE_ATTRIBUTE_DIRECTORY)) return;
+
+    // Folders seen on disk (one entry per folder, not per file)
+    std::unordered_set<std::wstring> seen;
+    std::vector<std::pair<std::wstring, int>> dirs;
+    dirs.emplace_back(root, 0);
+    while (!dirs.empty() && !g_scanStop) {
+        std::pair<std::wstring, int> dir = std::move(dirs.back());
+        dirs.pop_back();
+        ScanFolder(dir.first, dir.second, dirs);
+        seen.insert(std::move(dir.first));
+    }
+    if (g_scanStop) return;
+
+    // Drop folders that have gone from disk
+    for (const auto& folder : GetLibrarySubfoldersDB(root)) {
+        if (!seen.count(folder)) RemoveLibraryFolderTracksDB(folder);
+    }
+}
+
+static void LibraryScanThread(std::vector<std::wstring> roots) {
+    SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_BELOW_NORMAL);
+
+    int readers = g_libraryScanThreads;
+    if (readers <= 0) {
+        readers = static_cast<int>(std::thread::hardware_concurrency()) / 2;
+        readers = std::max(2, std::min(4, readers));
+    }
+
+    for (;;) {
+        {
+            std::lock_guard<std::mutex> lock(g_libraryMutex);
+            g_walkDone = false;
+        }
+        std::vector<std::thread> readerThreads;
+        for (int i = 0; i < readers; i++) readerThreads.emplace_back(ReaderThread);
+
+        for (const auto& root : roots) {
+            if (g_scanStop) break;
+            ScanRoot(root);
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(g_libraryMutex);
+            g_walkDone = true;
+        }
+        g_readQueued.notify_all();
+        for (auto& t : readerThreads) t.join();
+        if (!g_scanStop) PruneLibraryDB();
+
+        std::lock_guard<std::mutex> lock(g_libraryMutex);
+        g_readQueue.clear();
+        if (g_scanStop || !g_rescanRequested) {
+            g_scanRunning = false;
+            return;
+        }
+        g_rescanRequested = false;
+        roots = g_scanRoots;
+    }
+}
+
+static std::wstring NormalizeFolder(const std::wstring& folder) {
+    std::wstring result = folder;
+    while (result.size() > 1 && (result.back() == L'\\' || result.back() == L'/')) result.pop_back();
+    return result;
+}
+
+// Whether path is folder itself or somewhere below it
+static bool IsInFolder(const std::wstring& path, const std::wstring& folder) {
+    if (path.size() < folder.size() || _wcsnicmp(path.c_str(), folder.c_str(), folder.size()) != 0) {
+        return false;
+    }
+    return path.size() == folder.size() || path[folder.size()] == L'\\';
+}
+
+bool AddLibraryFolder(const std::wstring& folder) {
+    std::wstring normalized = NormalizeFolder(folder);
+    if (normalized.empty()) return false;
+
+    bool covered = false;
+    for (const auto& existing : GetLibraryFoldersDB()) {
+        if (IsInFolder(normalized, existing)) covered = true;
+    }
+    bool added = !covered && AddLibraryFolderDB(normalized);
+    StartLibraryScan();
+    return added;
+}
+
+bool RemoveLibraryFolder(const std::wstring& folder) {
+    // The scan may be writing the folder's tracks back as they're removed
+    StopLibraryScan();
+    bool removed = RemoveLibraryFolderDB(NormalizeFolder(folder));
+    StartLibraryScan();
+    return removed;
+}
+
+void StartLibraryScan() {
+    std::vector<std::wstring> roots = GetLibraryFoldersDB();
+    if (roots.empty()) return;
+
+    std::lock_guard<std::mutex> lock(g_libraryMutex);
+    g_scanRoots = roots;
+    if (g_scanRunning) {
+        g_rescanRequested = true;
+        return;
+    }
+    if (g_scanThread.joinable()) g_scanThread.join();  // Finished earlier
+    g_scanRunning = true;
+    g_scanThread = std::thread(LibraryScanThread, roots);
+}
+
+void StopLibraryScan() {
+    {
+        std::lock_guard<std::mutex> lock(g_libraryMutex);
+        g_scanStop = true;
+        g_rescanRequested = false;
+    }
+    g_readQueued.notify_all();
+    g_readTaken.notify_all();
+    if (g_scanThread.joinable()) g_scanThread.join();
+
+    std::lock_guard<std::mutex> lock(g_libraryMutex);
+    g_scanStop = false;
+}
+
+bool IsLibraryScanRunning() {
+    std::lock_guard<std::mutex> lock(g_libraryMutex);
+    return g_scanRunning;
+}
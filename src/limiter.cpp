@@ -0,0 +1,167 @@
+#include "limiter.h"
+#include <cmath>
+#include <algorithm>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE__)
+#include <xmmintrin.h>
+#define LIMITER_SSE
+#endif
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+// 4x oversampling with a 48-tap interpolation filter (12 taps per phase)
+static const int PHASES = 4;
+static const int TAPS_PER_PHASE = 12;
+
+// The interpolated points of a frame lie between the samples this many and
+// one fewer frames back, so the raw peak is taken from here too
+static const int INTERP_DELAY = TAPS_PER_PHASE / 2;
+
+TruePeakLimiter::TruePeakLimiter()
+    : m_sampleRate(0), m_chans(0), m_ceiling(1.0f), m_lookahead(1), m_historyPos(0),
+      m_delayFrames(0), m_delayPos(0), m_minHead(0), m_minCount(0), m_frame(0),
+      m_release(1.0f), m_releaseAlpha(0.0f), m_boxPos(0), m_boxSum(0.0) {
+}
+
+void TruePeakLimiter::Init(int sampleRate, int chans, float ceiling, double lookahead, double release) {
+    m_sampleRate = sampleRate;
+    m_chans = chans;
+    m_ceiling = ceiling;
+    m_lookahead = std::max(1, static_cast<int>(lookahead * sampleRate));
+    m_releaseAlpha = static_cast<float>(1.0 - exp(-1.0 / (release * sampleRate)));
+
+    // Windowed sinc, split into phases; each phase sums to 1 so DC passes unchanged
+    const int taps = PHASES * TAPS_PER_PHASE;
+    const double center = (taps - 1) / 2.0;
+    m_coef.assign(taps, 0.0f);
+    for (int p = 0; p < PHASES; p++) {
+        double sum = 0.0;
+        double h[TAPS_PER_PHASE];
+        for (int k = 0; k < TAPS_PER_PHASE; k++) {
+            int m = k * PHASES + p;
+            double x = (m - center) / PHASES;
+            double sinc = (x == 0.0) ? 1.0 : sin(M_PI * x) / (M_PI * x);
+            double window = 0.42 - 0.5 * cos(2.0 * M_PI * (m + 0.5) / taps) + 0.08 * cos(4.0 * M_PI * (m + 0.5) / taps);
+            h[k] = sinc * window;
+            sum += h[k];
+        }
+        for (int k = 0; k < TAPS_PER_PHASE; k++) {
+            m_coef[k * PHASES + p] = static_cast<float>(h[k] / sum);
+        }
+    }
+
+    // The audio waits for the lookahead plus the interpolation delay
+    m_delayFrames = m_lookahead + INTERP_DELAY - 1;
+    Reset();
+}
+
+void TruePeakLimiter::Reset() {
+    if (m_chans <= 0) return;
+    m_history.assign(static_cast<size_t>(m_chans) * TAPS_PER_PHASE * 2, 0.0f);
+    m_historyPos = 0;
+    m_delay.assign(static_cast<size_t>(m_delayFrames) * m_chans, 0.0f);
+    m_delayPos = 0;
+    m_minValue.assign(m_lookahead + 1, 1.0f);
+    m_minFrame.assign(m_lookahead + 1, 0);
+    m_minHead = 0;
+    m_minCount = 0;
+    m_frame = 0;
+    m_release = 1.0f;
+    m_box.assign(m_lookahead, 1.0f);
+    m_boxPos = 0;
+    m_boxSum = m_lookahead;
+}
+
+// Push a frame into the interpolator and return the gain it needs
+// (ceiling / true peak, at most 1), without branching on the signal
+float TruePeakLimiter::DetectPeak(const float* frame) {
+    m_historyPos = (m_historyPos + TAPS_PER_PHASE - 1) % TAPS_PER_PHASE;
+    const size_t stride = TAPS_PER_PHASE * 2;
+
+#ifdef LIMITER_SSE
+    const __m128 signMask = _mm_set1_ps(-0.0f);
+    __m128 peak = _mm_setzero_ps();
+    for (int c = 0; c < m_chans; c++) {
+        float* h = m_history.data() + c * stride + m_historyPos;
+        h[0] = frame[c];
+        h[TAPS_PER_PHASE] = frame[c];
+
+        // All four phases at once: one multiply-add per tap
+        __m128 acc = _mm_setzero_ps();
+        for (int k = 0; k < TAPS_PER_PHASE; k++) {
+            acc = _mm_add_ps(acc, _mm_mul_ps(_mm_loadu_ps(&m_coef[k * PHASES]), _mm_set1_ps(h[k])));
+        }
+        peak = _mm_max_ps(peak, _mm_andnot_ps(signMask, acc));
+        peak = _mm_max_ps(peak, _mm_andnot_ps(signMask, _mm_set1_ps(h[INTERP_DELAY])));
+    }
+    peak = _mm_max_ps(peak, _mm_shuffle_ps(peak, peak, _MM_SHUFFLE(2, 3, 0, 1)));
+    peak = _mm_max_ps(peak, _mm_shuffle_ps(peak, peak, _MM_SHUFFLE(1, 0, 3, 2)));
+
+    // ceiling / max(peak, ceiling) is 1 below the ceiling
+    __m128 ceiling = _mm_set_ss(m_ceiling);
+    return _mm_cvtss_f32(_mm_div_ss(ceiling, _mm_max_ss(peak, ceiling)));
+#else
+    float peak = 0.0f;
+    for (int c = 0; c < m_chans; c++) {
+        float* h = m_history.data() + c * stride + m_historyPos;
+        h[0] = frame[c];
+        h[TAPS_PER_PHASE] = frame[c];
+        for (int p = 0; p < PHASES; p++) {
+            float acc = 0.0f;
+            for (int k = 0; k < TAPS_PER_PHASE; k++) acc += m_coef[k * PHASES + p] * h[k];
+            peak = std::max(peak, fabsf(acc));
+        }
+        peak = std::max(peak, fabsf(h[INTERP_DELAY]));
+    }
+    return m_ceiling / std::max(peak, m_ceiling);
+#endif
+}
+
+void TruePeakLimiter::Process(float* samples, int frames) {
+    if (m_chans <= 0) return;
+    const int window = m_lookahead + 1;
+
+    for (int f = 0; f < frames; f++) {
+        float* frame = samples + static_cast<size_t>(f) * m_chans;
+        float need = DetectPeak(frame);
+
+        // Sliding minimum of the needed gain over the lookahead (monotonic queue).
+        // The expired head goes first, so the queue has room for this frame even
+        // when the need has risen over every frame in the window.
+        if (m_minCount > 0 && m_minFrame[m_minHead] < m_frame - m_lookahead) {
+            m_minHead = (m_minHead + 1) % window;
+            m_minCount--;
+        }
+        while (m_minCount > 0) {
+            int back = (m_minHead + m_minCount - 1) % window;
+            if (m_minValue[back] < need) break;
+            m_minCount--;
+        }
+        int tail = (m_minHead + m_minCount) % window;
+        m_minValue[tail] = need;
+        m_minFrame[tail] = m_frame;
+        m_minCount++;
+
+        // Recover slowly, but never above what the lookahead requires
+        m_release += (1.0f - m_release) * m_releaseAlpha;
+        m_release = std::min(m_release, m_minValue[m_minHead]);
+
+        // Average across the lookahead, so the gain is fully down by the time the peak plays
+        m_boxSum += m_release - m_box[m_boxPos];
+        m_box[m_boxPos] = m_release;
+        m_boxPos = (m_boxPos + 1) % m_lookahead;
+        float gain = static_cast<float>(m_boxSum / m_lookahead);
+
+        // Swap the frame with the delayed one and apply the gain to that
+        float* slot = m_delay.data() + static_cast<size_t>(m_delayPos) * m_chans;
+        for (int c = 0; c < m_chans; c++) {
+            float delayed = slot[c];
+            slot[c] = frame[c];
+            frame[c] = delayed * gain;
+        }
+        m_delayPos = (m_delayPos + 1) % m_delayFrames;
+        m_frame++;
+    }
+}
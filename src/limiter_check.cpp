@@ -0,0 +1,76 @@
+// Check for TruePeakLimiter: boosted low-frequency sines, whose needed gain
+// keeps falling for far longer than the lookahead, must come out at or under
+// the ceiling. Runs the settings of the output limiter (effects.cpp) and of
+// the live stream leveler's safety limiter (live_leveler.cpp). Exits non-zero
+// if any case goes over.
+//
+// Build and run: build_new.bat check
+
+#include "limiter.h"
+#include <cmath>
+#include <cstdio>
+#include <vector>
+#include <algorithm>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+static const float CEILING = 0.891f;
+static const double LOOKAHEAD = 0.005;
+
+// Worst sample peak over the ceiling (1.0 = at it) for one sine through the limiter
+static double RunSine(int sampleRate, int chans, double release, double freq, double amplitude, int block) {
+    TruePeakLimiter limiter;
+    limiter.Init(sampleRate, chans, CEILING, LOOKAHEAD, release);
+
+    const int frames = sampleRate * 2;
+    std::vector<float> buffer(static_cast<size_t>(block) * chans);
+    double worst = 0.0;
+    for (int start = 0; start < frames; start += block) {
+        int count = std::min(block, frames - start);
+        for (int f = 0; f < count; f++) {
+            float s = static_cast<float>(amplitude * sin(2.0 * M_PI * freq * (start + f) / sampleRate));
+            for (int c = 0; c < chans; c++) buffer[static_cast<size_t>(f) * chans + c] = s;
+        }
+        limiter.Process(buffer.data(), count);
+        for (int i = 0; i < count * chans; i++) {
+            worst = std::max(worst, fabs(buffer[i]) / CEILING);
+        }
+    }
+    return worst;
+}
+
+int main() {
+    const int rates[] = {44100, 48000};
+    const double releases[] = {0.15, 0.1};  // Output limiter, live leveler
+    const double freqs[] = {5.0, 10.0, 20.0, 30.0, 47.0, 100.0};
+    const double amplitudes[] = {1.2, 2.0, 4.0, 8.0};
+    const int blocks[] = {1024, 333};
+
+    int failures = 0;
+    for (int rate : rates) {
+        for (double release : releases) {
+            for (double freq : freqs) {
+                for (double amplitude : amplitudes) {
+                    for (int block : blocks) {
+                        double worst = RunSine(rate, 2, release, freq, amplitude, block);
+                        if (worst > 1.0001) {
+                            printf("FAIL %d Hz, release %.2f s, %.0f Hz sine at %.1f, blocks of %d: "
+                                   "%.3f dB over the ceiling\n",
+                                   rate, release, freq, amplitude, block, 20.0 * log10(worst));
+                            failures++;
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    if (failures) {
+        printf("%d limiter cases went over the ceiling\n", failures);
+        return 1;
+    }
+    printf("Limiter held the ceiling in every case\n");
+    return 0;
+}
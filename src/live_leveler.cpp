@@ -0,0 +1,283 @@
+#include "live_leveler.h"
+#include "globals.h"
+#include "database.h"
+#include "loudness.h"
+#include "limiter.h"
+#include <vector>
+#include <atomic>
+#include <cmath>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+// Loudness is measured in 100 ms blocks over a 3-second window (EBU R128 short-term)
+static const int BLOCKS_PER_SECOND = 10;
+static const int SHORT_TERM_BLOCKS = 30;
+
+// Quieter than this is dead air or a pause in speech: hold the gain
+static const double GATE_LUFS = -45.0;
+
+// The station's loudness follows the short-term loudness with this time
+// constant, so the gain rides programme changes but not every phrase
+static const double LOUDNESS_TIME_CONSTANT = 10.0;
+
+// Gain range and how fast it may move (dB per second)
+static const double MAX_BOOST_DB = 12.0;
+static const double MAX_CUT_DB = 20.0;
+static const double RAISE_DB_PER_SECOND = 1.0;
+static const double LOWER_DB_PER_SECOND = 3.0;
+
+// A station's loudness is remembered once it has been measured this long
+static const int MIN_LEARN_BLOCKS = 20 * BLOCKS_PER_SECOND;
+
+// Limiter: ceiling about -1 dBTP, 5 ms lookahead, 100 ms release
+static const float LIMITER_CEILING = 0.891f;
+static const double LIMITER_LOOKAHEAD = 0.005;
+static const double LIMITER_RELEASE = 0.1;
+
+// Second-order section, transposed direct form II
+struct Biquad {
+    double b0 = 1.0, b1 = 0.0, b2 = 0.0, a1 = 0.0, a2 = 0.0;
+    double z1 = 0.0, z2 = 0.0;
+
+    double Process(double x) {
+        double y = b0 * x + z1;
+        z1 = b1 * x - a1 * y + z2;
+        z2 = b2 * x - a2 * y;
+        return y;
+    }
+};
+
+class LiveLeveler {
+public:
+    // stationLufs is the station's remembered loudness, if known
+    LiveLeveler(int sampleRate, int chans, float targetLufs, float stationLufs, bool known);
+
+    void SetTarget(float lufs) { m_target = lufs; }
+    void Process(float* samples, int frames);
+
+    // Loudness learned this session (false if not measured long enough)
+    bool GetLearnedLoudness(float& lufs) const;
+
+private:
+    void EndBlock();
+
+    int m_chans;
+    std::atomic<float> m_target;
+
+    // Loudness measurement (K-weighting: a high shelf, then a high pass)
+    std::vector<Biquad> m_shelf;
+    std::vector<Biquad> m_highPass;
+    std::vector<double> m_weight;
+    int m_blockFrames;
+    int m_blockPos;
+    double m_blockSum;
+    double m_blocks[SHORT_TERM_BLOCKS];
+    int m_blockCount;
+    int m_blockIndex;
+    double m_loudness;  // Station loudness in LUFS
+    bool m_hasLoudness;
+    int m_learnedBlocks;
+
+    // Gain riding (dB, ramped linearly across each block)
+    double m_gainDb;
+    float m_gain;
+    float m_gainStep;
+
+    TruePeakLimiter m_limiter;
+};
+
+LiveLeveler::LiveLeveler(int sampleRate, int chans, float targetLufs, float stationLufs, bool known)
+    : m_chans(chans), m_target(targetLufs), m_blockPos(0), m_blockSum(0.0),
+      m_blockCount(0), m_blockIndex(0), m_loudness(stationLufs), m_hasLoudness(known),
+      m_learnedBlocks(0), m_gainDb(0.0), m_gain(1.0f), m_gainStep(0.0f) {
+    double fs = static_cast<double>(sampleRate);
+
+    // ITU-R BS.1770 pre-filter, derived for any sample rate
+    Biquad shelf;
+    double k = tan(M_PI * 1681.974450955533 / fs);
+    double q = 0.7071752369554196;
+    double vh = pow(10.0, 3.999843853973347 / 20.0);
+    double vb = pow(vh, 0.4996667741545416);
+    double a0 = 1.0 + k / q + k * k;
+    shelf.b0 = (vh + vb * k / q + k * k) / a0;
+    shelf.b1 = 2.0 * (k * k - vh) / a0;
+    shelf.b2 = (vh - vb * k / q + k * k) / a0;
+    shelf.a1 = 2.0 * (k * k - 1.0) / a0;
+    shelf.a2 = (1.0 - k / q + k * k) / a0;
+
+    // RLB weighting high pass
+    Biquad highPass;
+    k = tan(M_PI * 38.13547087602444 / fs);
+    q = 0.5003270373238773;
+    a0 = 1.0 + k / q + k * k;
+    highPass.b0 = 1.0;
+    highPass.b1 = -2.0;
+    highPass.b2 = 1.0;
+    highPass.a1 = 2.0 * (k * k - 1.0) / a0;
+    highPass.a2 = (1.0 - k / q + k * k) / a0;
+
+    m_shelf.assign(chans, shelf);
+    m_highPass.assign(chans, highPass);
+
+    // 5.1: the LFE doesn't count and the surrounds count extra
+    m_weight.assign(chans, 1.0);
+    if (chans == 6) {
+        m_weight[3] = 0.0;
+        m_weight[4] = 1.41;
+        m_weight[5] = 1.41;
+    }
+
+    m_blockFrames = sampleRate / BLOCKS_PER_SECOND;
+    if (m_blockFrames < 1) m_blockFrames = 1;
+
+    // A remembered station starts at its level straight away
+    if (m_hasLoudness) {
+        m_gainDb = m_target - m_loudness;
+        if (m_gainDb > MAX_BOOST_DB) m_gainDb = MAX_BOOST_DB;
+        if (m_gainDb < -MAX_CUT_DB) m_gainDb = -MAX_CUT_DB;
+        m_gain = static_cast<float>(pow(10.0, m_gainDb / 20.0));
+    }
+
+    m_limiter.Init(sampleRate, chans, LIMITER_CEILING, LIMITER_LOOKAHEAD, LIMITER_RELEASE);
+}
+
+bool LiveLeveler::GetLearnedLoudness(float& lufs) const {
+    if (m_learnedBlocks < MIN_LEARN_BLOCKS) return false;
+    lufs = static_cast<float>(m_loudness);
+    return true;
+}
+
+// Update the short-term loudness and aim the gain for the next block
+void LiveLeveler::EndBlock() {
+    m_blocks[m_blockIndex] = m_blockSum / m_blockFrames;
+    m_blockIndex = (m_blockIndex + 1) % SHORT_TERM_BLOCKS;
+    if (m_blockCount < SHORT_TERM_BLOCKS) m_blockCount++;
+    m_blockSum = 0.0;
+    m_blockPos = 0;
+
+    if (m_blockCount == SHORT_TERM_BLOCKS) {
+        double energy = 0.0;
+        for (int i = 0; i < SHORT_TERM_BLOCKS; i++) energy += m_blocks[i];
+        energy /= SHORT_TERM_BLOCKS;
+        double shortTerm = energy > 0.0 ? -0.691 + 10.0 * log10(energy) : -200.0;
+        if (shortTerm > GATE_LUFS) {
+            if (!m_hasLoudness) {
+                m_loudness = shortTerm;
+                m_hasLoudness = true;
+            } else {
+                m_loudness += (shortTerm - m_loudness) / (LOUDNESS_TIME_CONSTANT * BLOCKS_PER_SECOND);
+            }
+            m_learnedBlocks++;
+        }
+    }
+
+    double wantDb = 0.0;
+    if (m_hasLoudness) {
+        wantDb = m_target - m_loudness;
+        if (wantDb > MAX_BOOST_DB) wantDb = MAX_BOOST_DB;
+        if (wantDb < -MAX_CUT_DB) wantDb = -MAX_CUT_DB;
+    }
+    double raise = RAISE_DB_PER_SECOND / BLOCKS_PER_SECOND;
+    double lower = LOWER_DB_PER_SECOND / BLOCKS_PER_SECOND;
+    if (wantDb > m_gainDb + raise) wantDb = m_gainDb + raise;
+    if (wantDb < m_gainDb - lower) wantDb = m_gainDb - lower;
+    m_gainDb = wantDb;
+
+    float next = static_cast<float>(pow(10.0, m_gainDb / 20.0));
+    m_gainStep = (next - m_gain) / m_blockFrames;
+}
+
+void LiveLeveler::Process(float* samples, int frames) {
+    for (int f = 0; f < frames; f++) {
+        float* frame = samples + static_cast<size_t>(f) * m_chans;
+
+        // Measure the incoming loudness (before any gain)
+        double sum = 0.0;
+        for (int c = 0; c < m_chans; c++) {
+            double y = m_highPass[c].Process(m_shelf[c].Process(frame[c]));
+            sum += m_weight[c] * y * y;
+        }
+        m_blockSum += sum;
+        if (++m_blockPos >= m_blockFrames) EndBlock();
+
+        m_gain += m_gainStep;
+        for (int c = 0; c < m_chans; c++) frame[c] *= m_gain;
+    }
+
+    // Catch the peaks a boost pushes over
+    m_limiter.Process(samples, frames);
+}
+
+// The stream being leveled and its DSP (main thread only)
+static HSTREAM g_levelStream = 0;
+static std::wstring g_levelStation;
+static HDSP g_levelDsp = 0;
+static LiveLeveler* g_leveler = nullptr;
+
+static void CALLBACK LevelerDSPProc(HDSP handle, DWORD channel, void* buffer, DWORD length, void* user) {
+    LiveLeveler* leveler = static_cast<LiveLeveler*>(user);
+    BASS_CHANNELINFO info;
+    if (!BASS_ChannelGetInfo(channel, &info) || info.chans == 0) return;
+    leveler->Process(static_cast<float*>(buffer), static_cast<int>(length / (sizeof(float) * info.chans)));
+}
+
+static float GetTargetLoudness() {
+    return LOUDNESS_REFERENCE_LUFS + g_replayGainPreamp;
+}
+
+static void AttachLeveler() {
+    BASS_CHANNELINFO info;
+    if (!BASS_ChannelGetInfo(g_levelStream, &info) || !(info.flags & BASS_SAMPLE_FLOAT) || info.chans == 0) {
+        return;
+    }
+
+    float stationLufs = 0.0f;
+    bool known = LoadStationLoudnessDB(g_levelStation, stationLufs);
+    LiveLeveler* leveler = new LiveLeveler(static_cast<int>(info.freq), static_cast<int>(info.chans),
+                                           GetTargetLoudness(), stationLufs, known);
+
+    g_levelDsp = BASS_ChannelSetDSP(g_levelStream, LevelerDSPProc, leveler, 0);
+    if (!g_levelDsp) {
+        delete leveler;
+        return;
+    }
+    g_leveler = leveler;
+}
+
+static void DetachLeveler() {
+    if (!g_leveler) return;
+    BASS_ChannelRemoveDSP(g_levelStream, g_levelDsp);
+    float lufs;
+    if (g_leveler->GetLearnedLoudness(lufs)) {
+        SaveStationLoudnessDB(g_levelStation, lufs);
+    }
+    delete g_leveler;
+    g_leveler = nullptr;
+    g_levelDsp = 0;
+}
+
+void StartLiveLeveler(HSTREAM stream, const std::wstring& station) {
+    StopLiveLeveler();
+    g_levelStream = stream;
+    g_levelStation = station;
+    if (g_replayGainMode != 0) AttachLeveler();
+}
+
+void StopLiveLeveler() {
+    DetachLeveler();
+    g_levelStream = 0;
+    g_levelStation.clear();
+}
+
+void RefreshLiveLeveler() {
+    if (!g_levelStream) return;
+    if (g_replayGainMode == 0) {
+        DetachLeveler();
+    } else if (!g_leveler) {
+        AttachLeveler();
+    } else {
+        g_leveler->SetTarget(GetTargetLoudness());
+    }
+}
@@ -0,0 +1,216 @@
+#include "loudness.h"
+#include "globals.h"
+#include "database.h"
+#include "player.h"
+#include "utils.h"
+#include "bass.h"
+#include "bassloud.h"
+#include "bassmidi.h"
+#include <deque>
+#include <algorithm>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+
+// Library tracks fetched per trip to the database
+static const int LIBRARY_BATCH = 32;
+
+// How often idle threads look for newly scanned library tracks
+static const int IDLE_RECHECK_SECONDS = 60;
+
+// Decoded per read (float samples)
+static const DWORD DECODE_CHUNK_BYTES = 256 * 1024;
+
+// Anything quieter is silence (the R128 absolute gate)
+static const float SILENCE_LUFS = -70.0f;
+
+static std::mutex g_analysisMutex;
+static std::condition_variable g_analysisWake;
+static std::vector<std::thread> g_analysisThreads;
+static std::deque<LibraryFileStamp> g_priorityQueue;  // Upcoming playlist tracks
+static std::deque<LibraryFileStamp> g_libraryQueue;
+static std::vector<std::wstring> g_inProgress;       // Taken by a thread, not yet stored
+static bool g_analysisStop = false;
+static std::atomic<bool> g_analysisStopping(false);
+static bool g_analysisPaused = false;
+
+static bool IsInProgress(const std::wstring& path) {
+    return std::find(g_inProgress.begin(), g_inProgress.end(), path) != g_inProgress.end();
+}
+
+// Wait out a pause; returns false if the analyzer is stopping
+static bool WaitWhilePaused() {
+    std::unique_lock<std::mutex> lock(g_analysisMutex);
+    g_analysisWake.wait(lock, [] { return g_analysisStop || !g_analysisPaused; });
+    return !g_analysisStop;
+}
+
+// Measure one file and store the result (also when it can't be measured)
+static void AnalyzeFile(const LibraryFileStamp& file) {
+    HSTREAM stream = BASS_StreamCreateFile(FALSE, file.path.c_str(), 0, 0,
+                                           BASS_STREAM_DECODE | BASS_SAMPLE_FLOAT | BASS_UNICODE);
+    if (!stream) {
+        SaveLoudnessDB(file.path, file.fileSize, file.modified, false, 0.0f, 0.0f);
+        return;
+    }
+
+    // Tagged files use their tags; MIDI depends on the SoundFont of the day
+    BASS_CHANNELINFO info;
+    StreamTags tags;
+    ReadStreamTags(stream, tags);
+    if (!tags.trackGain.empty() || (BASS_ChannelGetInfo(stream, &info) && info.ctype == BASS_CTYPE_STREAM_MIDI)) {
+        BASS_StreamFree(stream);
+        SaveLoudnessDB(file.path, file.fileSize, file.modified, false, 0.0f, 0.0f);
+        return;
+    }
+
+    HLOUDNESS meter = BASS_Loudness_Start(stream, BASS_LOUDNESS_INTEGRATED | BASS_LOUDNESS_TRUEPEAK, 0);
+    if (!meter) {
+        BASS_StreamFree(stream);
+        SaveLoudnessDB(file.path, file.fileSize, file.modified, false, 0.0f, 0.0f);
+        return;
+    }
+
+    std::vector<float> buffer(DECODE_CHUNK_BYTES / sizeof(float));
+    bool complete = false;
+    for (;;) {
+        if (g_analysisStopping || !WaitWhilePaused()) break;
+        DWORD got = BASS_ChannelGetData(stream, buffer.data(), DECODE_CHUNK_BYTES);
+        if (got == static_cast<DWORD>(-1)) {
+            complete = BASS_ErrorGetCode() == BASS_ERROR_ENDED;
+            break;
+        }
+    }
+
+    float integrated = 0.0f, truePeak = 0.0f;
+    bool measured = complete &&
+                    BASS_Loudness_GetLevel(meter, BASS_LOUDNESS_INTEGRATED, &integrated) &&
+                    BASS_Loudness_GetLevel(meter, BASS_LOUDNESS_TRUEPEAK, &truePeak) &&
+                    std::isfinite(integrated) && integrated > SILENCE_LUFS;
+    BASS_Loudness_Stop(meter);
+    BASS_StreamFree(stream);
+
+    // A stopped analysis is simply redone next time
+    if (complete) SaveLoudnessDB(file.path, file.fileSize, file.modified, measured, integrated, truePeak);
+}
+
+static void AnalysisThread() {
+    // Playback and the UI come first
+    SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_LOWEST);
+
+    std::unique_lock<std::mutex> lock(g_analysisMutex);
+    for (;;) {
+        g_analysisWake.wait(lock, [] { return g_analysisStop || !g_analysisPaused; });
+        if (g_analysisStop) return;
+
+        LibraryFileStamp file;
+        bool priority = false;
+        if (!g_priorityQueue.empty()) {
+            file = std::move(g_priorityQueue.front());
+            g_priorityQueue.pop_front();
+            priority = true;
+        } else if (!g_libraryQueue.empty()) {
+            file = std::move(g_libraryQueue.front());
+            g_libraryQueue.pop_front();
+        } else {
+            // Refill from the library; one thread at a time does the query
+            lock.unlock();
+            std::vector<LibraryFileStamp> batch = GetUnanalyzedLibraryTracksDB(LIBRARY_BATCH);
+            lock.lock();
+            bool added = false;
+            for (auto& candidate : batch) {
+                if (IsInProgress(candidate.path)) continue;
+                bool queued = false;
+                for (const auto& q : g_libraryQueue) {
+                    if (q.path == candidate.path) queued = true;
+                }
+                if (!queued) {
+                    g_libraryQueue.push_back(std::move(candidate));
+                    added = true;
+                }
+            }
+            if (!added && g_priorityQueue.empty()) {
+                g_analysisWake.wait_for(lock, std::chrono::seconds(IDLE_RECHECK_SECONDS), [] {
+                    return g_analysisStop || !g_priorityQueue.empty();
+                });
+            }
+            continue;
+        }
+
+        if (IsInProgress(file.path)) continue;
+        g_inProgress.push_back(file.path);
+        lock.unlock();
+
+        // Playlist entries haven't been checked against the database yet
+        if (!priority || !IsLoudnessStoredDB(file.path, file.fileSize, file.modified)) {
+            AnalyzeFile(file);
+        }
+
+        lock.lock();
+        g_inProgress.erase(std::find(g_inProgress.begin(), g_inProgress.end(), file.path));
+    }
+}
+
+void StartLoudnessAnalysis() {
+    std::lock_guard<std::mutex> lock(g_analysisMutex);
+    if (!g_analysisThreads.empty()) return;
+
+    // Leave a core for playback
+    int threads = static_cast<int>(std::thread::hardware_concurrency()) - 1;
+    if (threads < 1) threads = 1;
+    g_analysisStop = false;
+    g_analysisStopping = false;
+    for (int i = 0; i < threads; i++) g_analysisThreads.emplace_back(AnalysisThread);
+}
+
+void StopLoudnessAnalysis() {
+    {
+        std::lock_guard<std::mutex> lock(g_analysisMutex);
+        g_analysisStop = true;
+        g_analysisStopping = true;
+    }
+    g_analysisWake.notify_all();
+    for (auto& t : g_analysisThreads) t.join();
+    g_analysisThreads.clear();
+
+    std::lock_guard<std::mutex> lock(g_analysisMutex);
+    g_priorityQueue.clear();
+    g_libraryQueue.clear();
+    g_inProgress.clear();
+}
+
+void SetLoudnessPriorityList(const std::vector<std::wstring>& paths) {
+    std::deque<LibraryFileStamp> files;
+    for (const auto& path : paths) {
+        LibraryFileStamp file;
+        file.path = path;
+        if (GetFileIdentity(path, file.fileSize, file.modified)) files.push_back(std::move(file));
+    }
+    {
+        std::lock_guard<std::mutex> lock(g_analysisMutex);
+        g_priorityQueue.swap(files);
+    }
+    g_analysisWake.notify_all();
+}
+
+void SetLoudnessAnalysisPaused(bool paused) {
+    {
+        std::lock_guard<std::mutex> lock(g_analysisMutex);
+        if (g_analysisPaused == paused) return;
+        g_analysisPaused = paused;
+    }
+    if (!paused) g_analysisWake.notify_all();
+}
+
+bool GetAnalyzedGain(const std::wstring& path, float& gainDb, float& truePeak) {
+    int64_t size = 0, modified = 0;
+    float integrated = 0.0f;
+    if (!GetFileIdentity(path, size, modified) || !LoadLoudnessDB(path, size, modified, integrated, truePeak)) {
+        return false;
+    }
+    gainDb = LOUDNESS_REFERENCE_LUFS - integrated;
+    return true;
+}
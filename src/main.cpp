@@ -13,12 +13,17 @@
 #include "globals.h"
 #include "player.h"
 #include "settings.h"
+#include "config_store.h"
 #include "hotkeys.h"
 #include "tray.h"
 #include "accessibility.h"
 #include "ui.h"
 #include "effects.h"
 #include "database.h"
+#include "library.h"
+#include "loudness.h"
+#include "live_leveler.h"
+#include "seek_table.h"
 #include "youtube.h"
 #include "download_manager.h"
 #include "updater.h"
@@ -51,7 +56,7 @@ void ParseCommandLine() {
                 if (IsPlaylistFile(path)) {
                     // Parse playlist and add its contents
                     auto entries = ParsePlaylist(path);
-                    g_playlist.insert(g_playlist.end(), entries.begin(), entries.end());
+                    g_playlist.append(entries);
                 } else {
                     g_playlist.push_back(path);
                 }
@@ -78,6 +83,8 @@ LRESULT CALLBACK WndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam) {
             }
 
             InitDatabase();
+            StartLibraryScan();  // Catch up with changes to the library folders
+            StartLoudnessAnalysis();
             InitEffects();
             LoadDSPSettings();
             InitSpeech(hwnd);
@@ -88,13 +95,15 @@ LRESULT CALLBACK WndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam) {
 
             SetTimer(hwnd, IDT_UPDATE_TITLE, UPDATE_INTERVAL, nullptr);
             SetTimer(hwnd, IDT_SCHEDULER, 60000, nullptr);  // Check schedules every minute
-            g_startupTime = GetTickCount();
+            g_startupTime = GetTickCount64();
 
             if (!g_playlist.empty()) {
                 int startIndex = 0;
                 if (g_loadFolder && g_playlist.size() == 1) {
                     std::wstring singleFile = g_playlist[0];
-                    startIndex = ExpandFileToFolder(singleFile, g_playlist);
+                    std::vector<std::wstring> files;
+                    startIndex = ExpandFileToFolder(singleFile, files);
+                    g_playlist = files;
                 }
                 PlayTrack(startIndex);
             }
@@ -120,15 +129,21 @@ LRESULT CALLBACK WndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam) {
         case WM_TIMER:
             if (wParam == IDT_UPDATE_TITLE) {
                 UpdateStatusBar();
+                UpdateGaplessPreroll();
+                UpdatePrefetch();
+                UpdateLoudnessAnalysis();
+                UpdatePositionCheckpoint();
             } else if (wParam == IDT_BATCH_FILES) {
                 KillTimer(hwnd, IDT_BATCH_FILES);
                 if (!g_pendingFiles.empty()) {
                     int startIndex = 0;
                     if (g_loadFolder && g_pendingFiles.size() == 1) {
-                        startIndex = ExpandFileToFolder(g_pendingFiles[0], g_playlist);
+                        std::vector<std::wstring> files;
+                        startIndex = ExpandFileToFolder(g_pendingFiles[0], files);
+                        g_playlist = files;
                         g_pendingFiles.clear();
                     } else {
-                        g_playlist = std::move(g_pendingFiles);
+                        g_playlist = g_pendingFiles;
                         g_pendingFiles.clear();
                     }
                     PlayTrack(startIndex);
@@ -148,6 +163,9 @@ LRESULT CALLBACK WndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam) {
             } else if (wParam == IDT_SCHED_DURATION) {
                 KillTimer(hwnd, IDT_SCHED_DURATION);
                 HandleScheduledDurationEnd();
+            } else if (wParam == IDT_CONFIG_FLUSH) {
+                KillTimer(hwnd, IDT_CONFIG_FLUSH);
+                FlushConfig();
             }
             return 0;
 
@@ -160,6 +178,22 @@ LRESULT CALLBACK WndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam) {
             UpdateWindowTitle();
             return 0;
 
+        case WM_TRACK_LOADED:
+            OnTrackLoaded();
+            return 0;
+
+        case WM_PREROLL_LOADED:
+            OnPrerollLoaded();
+            return 0;
+
+        case WM_SEEK_TABLE_READY:
+            OnSeekTableReady();
+            return 0;
+
+        case WM_PLAYLIST_RESTORE:
+            RestoreSavedPlaylist();
+            return 0;
+
         case WM_USER + 200: {
             // Update check result
             auto* data = reinterpret_cast<std::pair<UpdateInfo, bool>*>(lParam);
@@ -217,12 +251,12 @@ LRESULT CALLBACK WndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam) {
             if (cds && (cds->dwData == 1 || cds->dwData == 2) && cds->lpData) {
                 const wchar_t* filePath = static_cast<const wchar_t*>(cds->lpData);
                 if (GetFileAttributesW(filePath) != INVALID_FILE_ATTRIBUTES) {
-                    DWORD elapsed = GetTickCount() - g_startupTime;
+                    ULONGLONG elapsed = GetTickCount64() - g_startupTime;
                     std::wstring path = filePath;
                     if (!g_disableBatchDelay && elapsed < BATCH_DELAY && !g_playlist.empty()) {
                         if (IsPlaylistFile(path)) {
                             auto entries = ParsePlaylist(path);
-                            g_playlist.insert(g_playlist.end(), entries.begin(), entries.end());
+                            g_playlist.append(entries);
                         } else {
                             g_playlist.push_back(path);
                         }
@@ -323,6 +357,9 @@ LRESULT CALLBACK WndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam) {
                 case IDM_VIEW_SONG_HISTORY:
                     ShowSongHistoryDialog();
                     break;
+                case IDM_FILE_SEARCH:
+                    ShowSearchDialog();
+                    break;
                 case IDM_PLAY_PLAYPAUSE:
                     PlayPause();
                     break;
@@ -626,8 +663,15 @@ LRESULT CALLBACK WndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam) {
             }
             SavePlaybackState();
             SaveSettings();
+            KillTimer(hwnd, IDT_CONFIG_FLUSH);
+            FlushConfig();
             YouTubeCleanup();  // Clean up temp files
+            StopLibraryScan();   // Background writers go before the database
+            StopLoudnessAnalysis();
+            StopSeekScanner();
+            StopLiveLeveler();   // Remembers the station's loudness
             CloseDatabase();
+            LogCheckpointWriteRate();  // Once the last queued saves are counted
             FreeBass();
             FreeSpeech();
             PostQuitMessage(0);
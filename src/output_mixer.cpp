@@ -0,0 +1,125 @@
+#include "output_mixer.h"
+#include "globals.h"
+#include "effects.h"
+#include "player.h"
+#include "bassmix.h"
+#include <vector>
+#include <algorithm>
+#include <mutex>
+
+static DWORD g_outputChans = 0;
+static float g_outputBuffer = 0.0f;
+static std::vector<HSTREAM> g_outputSources;  // Sources we added (current + queued)
+static std::mutex g_outputSourcesMutex;       // A crossfade join queues from the mixing thread
+
+bool EnsureOutputMixer(DWORD chans) {
+    if (chans == 0) return false;
+    if (g_outputStream && chans == g_outputChans) return true;
+
+    bool wasPlaying = false;
+    if (g_outputStream) {
+        // Effects and the encoder belong to the old mixer; move effects across
+        wasPlaying = BASS_ChannelIsActive(g_outputStream) == BASS_ACTIVE_PLAYING;
+        if (g_isRecording) StopRecording();
+        RemoveDSPEffects();
+        BASS_StreamFree(g_outputStream);
+        g_outputStream = 0;
+        std::lock_guard<std::mutex> lock(g_outputSourcesMutex);
+        g_outputSources.clear();
+    }
+
+    // Mix at the device rate so the final output needs no further conversion
+    BASS_INFO deviceInfo;
+    DWORD freq = 44100;
+    if (BASS_GetInfo(&deviceInfo) && deviceInfo.freq > 0) {
+        freq = deviceInfo.freq;
+    }
+
+    // QUEUE plays sources one after another, which is what makes the track joins gapless
+    g_outputStream = BASS_Mixer_StreamCreate(freq, chans, BASS_SAMPLE_FLOAT | BASS_MIXER_QUEUE);
+    if (!g_outputStream) {
+        g_outputChans = 0;
+        return false;
+    }
+    g_outputChans = chans;
+    BASS_ChannelSetAttribute(g_outputStream, BASS_ATTRIB_BUFFER, g_outputBuffer);
+
+    ApplyDSPEffects();
+    if (wasPlaying) BASS_ChannelPlay(g_outputStream, FALSE);
+    return true;
+}
+
+void FreeOutputMixer() {
+    if (g_outputStream) {
+        // Effect handles die with the mixer; reset them so the next mixer gets fresh ones
+        if (g_isRecording) StopRecording();
+        RemoveDSPEffects();
+        BASS_StreamFree(g_outputStream);
+        g_outputStream = 0;
+    }
+    g_outputChans = 0;
+    std::lock_guard<std::mutex> lock(g_outputSourcesMutex);
+    g_outputSources.clear();
+}
+
+DWORD GetOutputChannels() {
+    return g_outputStream ? g_outputChans : 0;
+}
+
+bool AttachToOutput(HSTREAM source) {
+    if (!g_outputStream || !source) return false;
+
+    // Drop the previous track (and anything queued behind it). BASS calls are
+    // made outside the lock so a mixing-thread sync waiting on it can't deadlock.
+    std::vector<HSTREAM> previous;
+    {
+        std::lock_guard<std::mutex> lock(g_outputSourcesMutex);
+        previous.swap(g_outputSources);
+    }
+    for (HSTREAM s : previous) {
+        BASS_Mixer_ChannelRemove(s);
+    }
+
+    if (!BASS_Mixer_StreamAddChannel(g_outputStream, source, 0)) return false;
+    {
+        std::lock_guard<std::mutex> lock(g_outputSourcesMutex);
+        g_outputSources.push_back(source);
+    }
+    FlushOutput();
+    return true;
+}
+
+bool QueueOnOutput(HSTREAM source) {
+    if (!g_outputStream || !source) return false;
+
+    // No ramp-in: the join should be sample-accurate, not faded
+    if (!BASS_Mixer_StreamAddChannel(g_outputStream, source, BASS_MIXER_CHAN_NORAMPIN)) return false;
+    std::lock_guard<std::mutex> lock(g_outputSourcesMutex);
+    g_outputSources.push_back(source);
+    return true;
+}
+
+void DetachFromOutput(HSTREAM source) {
+    if (!source) return;
+    {
+        std::lock_guard<std::mutex> lock(g_outputSourcesMutex);
+        auto it = std::find(g_outputSources.begin(), g_outputSources.end(), source);
+        if (it == g_outputSources.end()) return;
+        g_outputSources.erase(it);
+    }
+    BASS_Mixer_ChannelRemove(source);
+}
+
+void SetOutputBuffer(float seconds) {
+    g_outputBuffer = seconds;
+    if (g_outputStream) {
+        BASS_ChannelSetAttribute(g_outputStream, BASS_ATTRIB_BUFFER, seconds);
+    }
+}
+
+void FlushOutput() {
+    // Setting a mixer's position clears its playback buffer
+    if (g_outputStream && g_outputBuffer > 0.0f) {
+        BASS_ChannelSetPosition(g_outputStream, 0, BASS_POS_BYTE);
+    }
+}
@@ -15,19 +15,43 @@
 #include "bassenc_ogg.h"
 #include "bassenc_flac.h"
 #include "tempo_processor.h"
+#include "resampler.h"
+#include "output_mixer.h"
+#include "crossfade.h"
+#include "url_open.h"
+#include "file_cache.h"
+#include "seek_table.h"
+#include "library.h"
+#include "loudness.h"
+#include "live_leveler.h"
+#include "bassmix.h"
 #include <ctime>
 #include <shlobj.h>
 #include <map>
 #include <algorithm>
 #include <cmath>
 #include <cstdlib>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
 
 // Forward declarations for tag reading helpers (defined later in file)
 static std::string GetMetadataTag(HSTREAM stream, const char* tagName);
-static std::string GetStreamTitle(HSTREAM stream);
-static std::string GetTrimmedTag(const char* data, size_t maxLen);
 static std::string GetID3v2UserText(const unsigned char* tag, const char* desc);
 
+// Parsed tags are kept until the stream or its metadata changes
+static const StreamTags& GetStreamTags(HSTREAM stream);
+static void ForgetStreamTags(HSTREAM stream);
+
+// Forward declarations for gapless pre-roll (defined after the track navigation code)
+static bool AdoptPrerolledTrack(const wchar_t* path);
+static void DiscardPreroll();
+
+// Forward declarations for background track loading (defined with PlayTrack)
+static void CancelTrackLoad(bool wait);
+static void ShutdownTrackLoader();
+
 // Read a ReplayGain tag value by name, trying the standard tag lists first
 // (Vorbis/APE/MP4/WMA) and then ID3v2 TXXX frames (common for MP3).
 static std::string GetReplayGainTag(HSTREAM stream, const char* name) {
@@ -38,46 +62,58 @@ static std::string GetReplayGainTag(HSTREAM stream, const char* name) {
     return "";
 }
 
-// Compute the linear ReplayGain multiplier for a freshly-loaded source stream and
-// store it in g_replayGainScale. Reads REPLAYGAIN_TRACK_GAIN / REPLAYGAIN_ALBUM_GAIN
+// Compute the linear ReplayGain multiplier for a freshly-loaded source stream
+// (the caller stores it in g_replayGainScale). Reads REPLAYGAIN_TRACK_GAIN / REPLAYGAIN_ALBUM_GAIN
 // (and the matching _PEAK tags) which BASS exposes through Vorbis/APE/MP4/WMA/ID3v2
-// comments. Returns 1.0 (no change) when disabled or when the file has no gain tag,
-// so untagged files and live streams play untouched.
-static void ComputeReplayGainScale(HSTREAM stream) {
-    g_replayGainScale = 1.0f;
-    if (g_replayGainMode == 0 || !stream) return;
+// comments. An untagged file falls back to its analyzed loudness (path is the
+// file, empty for URLs). Returns 1.0 (no change) when disabled or when neither
+// is available, so unanalyzed files and live streams play untouched.
+static float ComputeReplayGainScale(HSTREAM stream, const std::wstring& path) {
+    if (g_replayGainMode == 0 || !stream) return 1.0f;
 
+    const StreamTags& tags = GetStreamTags(stream);
     std::string gainStr, peakStr;
     if (g_replayGainMode == 2) {
         // Album mode, falling back to track gain when no album tag is present.
-        gainStr = GetReplayGainTag(stream, "REPLAYGAIN_ALBUM_GAIN");
-        peakStr = GetReplayGainTag(stream, "REPLAYGAIN_ALBUM_PEAK");
+        gainStr = tags.albumGain;
+        peakStr = tags.albumPeak;
         if (gainStr.empty()) {
-            gainStr = GetReplayGainTag(stream, "REPLAYGAIN_TRACK_GAIN");
-            peakStr = GetReplayGainTag(stream, "REPLAYGAIN_TRACK_PEAK");
+            gainStr = tags.trackGain;
+            peakStr = tags.trackPeak;
         }
     } else {
-        gainStr = GetReplayGainTag(stream, "REPLAYGAIN_TRACK_GAIN");
-        peakStr = GetReplayGainTag(stream, "REPLAYGAIN_TRACK_PEAK");
+        gainStr = tags.trackGain;
+        peakStr = tags.trackPeak;
     }
 
-    if (gainStr.empty()) return;  // No ReplayGain info: leave the file untouched.
-
-    // Tag values look like "-6.48 dB"; strtod reads the leading number and stops at the space.
-    float gainDb = static_cast<float>(strtod(gainStr.c_str(), nullptr));
+    float gainDb = 0.0f;
+    float peak = 0.0f;
+    if (!gainStr.empty()) {
+        // Tag values look like "-6.48 dB"; strtod reads the leading number and stops at the space.
+        gainDb = static_cast<float>(strtod(gainStr.c_str(), nullptr));
+        if (!peakStr.empty()) peak = static_cast<float>(strtod(peakStr.c_str(), nullptr));
+    } else if (path.empty() || !GetAnalyzedGain(path, gainDb, peak)) {
+        return 1.0f;  // No ReplayGain info: leave the file untouched.
+    }
     gainDb += g_replayGainPreamp;
 
     float scale = powf(10.0f, gainDb / 20.0f);
 
-    // Avoid clipping by capping the gain so the (tagged) peak stays at or below full scale.
-    if (g_replayGainPreventClip && !peakStr.empty()) {
-        float peak = static_cast<float>(strtod(peakStr.c_str(), nullptr));
-        if (peak > 0.0f && scale * peak > 1.0f) {
-            scale = 1.0f / peak;
-        }
+    // Avoid clipping by capping the gain so the (tagged or measured) peak stays at or below full scale.
+    if (g_replayGainPreventClip && peak > 0.0f && scale * peak > 1.0f) {
+        scale = 1.0f / peak;
     }
 
-    if (scale > 0.0f) g_replayGainScale = scale;
+    return scale > 0.0f ? scale : 1.0f;
+}
+
+// In legacy volume mode the volume and ReplayGain are baked into the output
+// mixer's BASS_ATTRIB_VOL, so push the current values whenever either changes.
+// (In normal mode the volume DSP reads them on the fly.)
+static void ApplyLegacyVolume() {
+    if (!g_legacyVolume || !g_outputStream) return;
+    float curvedVolume = (g_muted ? 0.0f : (g_volume * g_volume)) * g_replayGainScale;
+    BASS_ChannelSetAttribute(g_outputStream, BASS_ATTRIB_VOL, curvedVolume);
 }
 
 // Global SoundFont handle for MIDI playback
@@ -287,6 +323,9 @@ static bool IsMidiFile(const wchar_t* path) {
 
 // Apply MIDI settings (SoundFont, max voices)
 void ApplyMidiSettings() {
+    // A background load may be using the current SoundFont
+    CancelTrackLoad(true);
+
     // Free previous SoundFont if any
     if (g_hSoundFont) {
         BASS_MIDI_FontFree(g_hSoundFont);
@@ -356,6 +395,14 @@ bool InitBass(HWND hwnd) {
 
 // Free BASS resources
 void FreeBass() {
+    ShutdownTrackLoader();
+    ShutdownPrefetch();
+    StopSeekScanner();
+    StopLibraryScan();
+    StopLoudnessAnalysis();
+    DiscardPreroll();
+    StopLiveLeveler();
+    StopUrlOpens();
     if (g_fxStream) {
         BASS_StreamFree(g_fxStream);
         g_fxStream = 0;
@@ -366,6 +413,7 @@ void FreeBass() {
     }
     g_sourceStream = 0;  // Don't free - owned by tempo processor
     g_currentBitrate = 0;
+    FreeOutputMixer();
     BASS_Free();
 }
 
@@ -377,29 +425,49 @@ bool IsURL(const wchar_t* path) {
             _wcsnicmp(path, L"ftp://", 6) == 0);
 }
 
-// Load and play a URL stream
-bool LoadURL(const wchar_t* url) {
-    g_isLoading = true;
-
-    // Free existing streams safely
+// Take the current track's chain out of the output mixer and free it,
+// including the tempo processor. The mixer itself keeps running.
+static void ReleaseCurrentChain() {
+    StopLiveLeveler();
+    // A freed handle may be handed out again for another stream
+    ForgetStreamTags(g_sourceStream ? g_sourceStream : g_fxStream);
     if (g_fxStream) {
+        // Remove sync first to prevent callbacks during cleanup
         if (g_endSync) {
-            BASS_ChannelRemoveSync(g_fxStream, g_endSync);
+            BASS_Mixer_ChannelRemoveSync(g_fxStream, g_endSync);
             g_endSync = 0;
         }
-        RemoveDSPEffects();
-        BASS_ChannelStop(g_fxStream);
+        DetachFromOutput(g_fxStream);
         BASS_StreamFree(g_fxStream);
         g_fxStream = 0;
     }
     if (g_stream) {
         if (g_metaSync) {
             BASS_ChannelRemoveSync(g_stream, g_metaSync);
-            g_metaSync = 0;
         }
         BASS_StreamFree(g_stream);
         g_stream = 0;
     }
+    g_metaSync = 0;
+    g_sourceStream = 0;
+    FreeTempoProcessor();
+}
+
+// Plug a freshly created g_fxStream into the output mixer as the only source
+static bool StartOnOutput() {
+    BASS_CHANNELINFO info;
+    if (!BASS_ChannelGetInfo(g_fxStream, &info)) return false;
+    return EnsureOutputMixer(info.chans) && AttachToOutput(g_fxStream);
+}
+
+// Load and play a URL stream
+bool LoadURL(const wchar_t* url) {
+    CancelTrackLoad(false);  // This load supersedes any in the background
+    g_isLoading = true;
+
+    // Free existing streams safely (effects stay on the output mixer)
+    DiscardPreroll();
+    ReleaseCurrentChain();
 
     // If the URL points at a playlist file (.m3u/.pls/.m3u8), resolve it to a
     // direct stream URL first - BASS can't parse a playlist. This covers saved
@@ -411,23 +479,13 @@ bool LoadURL(const wchar_t* url) {
     // Convert URL to UTF-8 for BASS
     std::string urlUtf8 = WideToUtf8(playUrl);
 
-    // Create URL stream - try without BLOCK first (allows seeking for podcasts);
-    // BLOCK mode is only needed for live streams where seeking isn't expected.
-    // AAC first (handles raw AAC/M4A better), then generic, each in non-BLOCK
-    // then BLOCK mode.
-    auto tryCreateStream = [](const std::string& u) -> HSTREAM {
-        DWORD f = BASS_STREAM_DECODE | BASS_STREAM_STATUS | BASS_SAMPLE_FLOAT;
-        HSTREAM s = BASS_AAC_StreamCreateURL(u.c_str(), 0, f, nullptr, nullptr);
-        if (!s) s = BASS_StreamCreateURL(u.c_str(), 0, f, nullptr, nullptr);
-        if (!s) {
-            f = BASS_STREAM_DECODE | BASS_STREAM_STATUS | BASS_STREAM_BLOCK | BASS_SAMPLE_FLOAT;
-            s = BASS_AAC_StreamCreateURL(u.c_str(), 0, f, nullptr, nullptr);
-            if (!s) s = BASS_StreamCreateURL(u.c_str(), 0, f, nullptr, nullptr);
-        }
-        return s;
-    };
-
-    g_stream = tryCreateStream(urlUtf8);
+    // Create URL stream - all the ways of opening it race each other (see
+    // url_open.h); the one that worked last time for this host goes first.
+    std::wstring host = GetUrlHost(resolvedUrl);
+    int preferred = LoadUrlOpenStrategyDB(host);
+    int strategy = -1;
+    int error = BASS_OK;
+    g_stream = OpenUrlStream(urlUtf8, preferred, &strategy, &error);
 
     // If BASS couldn't open it, the URL may redirect somewhere BASS won't follow
     // (e.g. a podcast enclosure that 302s to a delivery-script URL). Resolve the
@@ -436,13 +494,16 @@ bool LoadURL(const wchar_t* url) {
         std::wstring finalUrl = ResolveHttpRedirects(resolvedUrl);
         if (finalUrl != resolvedUrl) {
             std::string finalUtf8 = WideToUtf8(finalUrl);
-            g_stream = tryCreateStream(finalUtf8);
+            g_stream = OpenUrlStream(finalUtf8, -1, &strategy, &error);
         }
     }
 
+    if (g_stream && strategy >= 0 && strategy != preferred) {
+        SaveUrlOpenStrategyDB(host, strategy);
+    }
+
     if (!g_stream) {
         g_isLoading = false;
-        int error = BASS_ErrorGetCode();
         const wchar_t* errorMsg;
         switch (error) {
             case BASS_ERROR_NONET:    errorMsg = L"No internet connection."; break;
@@ -514,11 +575,12 @@ bool LoadURL(const wchar_t* url) {
     }
     processor->SetPitch(g_pitch);
 
-    // Initialize processor - this creates the output stream
-    g_fxStream = processor->Initialize(g_stream, g_originalFreq);
+    // Initialize processor - this creates the decode stream the output mixer plays
+    g_fxStream = processor->Initialize(g_stream, g_originalFreq, BASS_STREAM_DECODE);
     if (!g_fxStream) {
         BASS_StreamFree(g_stream);
         g_stream = 0;
+        g_sourceStream = 0;
         g_isLoading = false;
         MessageBoxW(GetMessageBoxOwner(), L"Failed to create tempo stream for URL.", APP_NAME, MB_ICONERROR);
         return false;
@@ -529,25 +591,34 @@ bool LoadURL(const wchar_t* url) {
         g_stream = 0;  // Prevent double-free
     }
 
-    // Apply rate using native BASS frequency attribute (skip for live streams)
-    if (g_rate != 1.0f && !g_isLiveStream) {
-        BASS_ChannelSetAttribute(g_fxStream, BASS_ATTRIB_FREQ, g_originalFreq * g_rate);
-    }
-
     // Set larger playback buffer for streams (helps prevent choppiness during long playback)
-    BASS_ChannelSetAttribute(g_fxStream, BASS_ATTRIB_BUFFER, 1.0f);  // 1 second buffer
+    SetOutputBuffer(1.0f);  // 1 second buffer
+    if (!StartOnOutput()) {
+        ReleaseCurrentChain();
+        g_isLoading = false;
+        MessageBoxW(GetMessageBoxOwner(), L"Failed to start audio output.", APP_NAME, MB_ICONERROR);
+        return false;
+    }
 
-    // Compute ReplayGain from tags (live streams normally have none, so this stays 1.0)
-    ComputeReplayGainScale(g_sourceStream ? g_sourceStream : g_fxStream);
+    // Apply rate (skip for live streams). URLs stay on BASS's own resampling:
+    // pulling a network stream from the mix thread would stall on rebuffering.
+    if (g_rate != 1.0f && !g_isLiveStream) {
+        ApplyPlaybackRate();
+    }
 
-    // Apply DSP effects (including volume DSP which handles g_volume/g_muted)
-    ApplyDSPEffects();
+    // Compute ReplayGain from tags (live streams normally have none, so this
+    // stays 1.0 and they are leveled as they play instead)
+    g_replayGainScale = ComputeReplayGainScale(g_sourceStream ? g_sourceStream : g_fxStream, L"");
+    ApplyLegacyVolume();
+    if (g_isLiveStream) {
+        StartLiveLeveler(g_sourceStream, url);
+    }
 
-    // Set up end sync for auto-advance
-    g_endSync = BASS_ChannelSetSync(g_fxStream, BASS_SYNC_END, 0, OnTrackEnd, nullptr);
+    // Set up end sync for auto-advance (fires when the end is heard, not when it's mixed)
+    g_endSync = BASS_Mixer_ChannelSetSync(g_fxStream, BASS_SYNC_END, 0, OnTrackEnd, nullptr);
 
     // Start playback
-    BASS_ChannelPlay(g_fxStream, FALSE);
+    BASS_ChannelPlay(g_outputStream, FALSE);
 
     g_isLoading = false;
     UpdateWindowTitle();
@@ -803,156 +874,258 @@ void ParseChapters(HSTREAM stream) {
     }
 }
 
-// Load and play a file (or URL)
-bool LoadFile(const wchar_t* path) {
-    // Check if this is a URL
-    if (IsURL(path)) {
-        return LoadURL(path);
-    }
-    g_isLoading = true;
-    g_isLiveStream = false;  // Local files are always seekable
+// A track's decode chain: file stream -> tempo processor -> resampler. The
+// output is a decode stream that plays as a source of the output mixer.
+struct TrackChain {
+    HSTREAM source = 0;                   // File decode stream (tags, bitrate)
+    HSTREAM output = 0;                   // What the mixer pulls from
+    TempoProcessor* processor = nullptr;  // Owned by the chain until installed
+    float originalFreq = 44100.0f;
+    int bitrate = 0;
+};
 
-    // Free existing streams safely
-    if (g_fxStream) {
-        // Remove sync first to prevent callbacks during cleanup
-        if (g_endSync) {
-            BASS_ChannelRemoveSync(g_fxStream, g_endSync);
-            g_endSync = 0;
-        }
-        // Remove DSP effects before freeing stream
-        RemoveDSPEffects();
-        // Stop playback before freeing
-        BASS_ChannelStop(g_fxStream);
-        BASS_StreamFree(g_fxStream);
-        g_fxStream = 0;
-    }
-    if (g_stream) {
-        BASS_StreamFree(g_stream);
-        g_stream = 0;
-    }
+// The next track, opened a few seconds before the current one ends (by the
+// track loader, so a slow drive doesn't hold up the UI) and queued on the
+// output mixer, which starts it the moment the current track runs out. With a
+// crossfade it is instead blended into the current track's tail and only
+// reaches the mixer at the join.
+struct PrerolledTrack {
+    int index = -1;
+    std::wstring path;
+    bool opening = false;   // Requested from the loader, chain not here yet
+    TrackChain chain;
+    float replayGainScale = 1.0f;
+    HSYNC joinSync = 0;     // Mixtime sync on the current track's end
+    bool crossfade = false; // Armed on the current track (scheduled from its position)
+    double speed = 1.0;     // Playback speed the crossfade was scheduled at
+};
+static PrerolledTrack g_preroll;
+static std::wstring g_prerollFailedPath;  // Don't retry a file that can't be joined
+
+// The pre-rolled track's ReplayGain, for OnGaplessJoin() on the mixer thread
+// (which never reads g_preroll, as the UI thread replaces it at any time)
+static std::atomic<float> g_joinReplayGainScale(1.0f);
+
+// Settings a chain is built with, captured on the UI thread so a background
+// load doesn't read globals the user may be changing
+struct ChainOptions {
+    TempoAlgorithm algorithm = TempoAlgorithm::SoundTouch;
+    float tempo = 0.0f;
+    float pitch = 0.0f;
+    float rate = 1.0f;
+    ResamplerQuality resamplerQuality = ResamplerQuality::Native;
+    bool midiSincInterp = false;
+    HSOUNDFONT soundFont = 0;
+    int readAheadSeconds = 0;
+};
 
+static ChainOptions CurrentChainOptions() {
+    ChainOptions options;
+    options.algorithm = static_cast<TempoAlgorithm>(g_tempoAlgorithm);
+    options.tempo = g_tempo;
+    options.pitch = g_pitch;
+    options.rate = g_rate;
+    options.resamplerQuality = static_cast<ResamplerQuality>(g_resamplerQuality);
+    options.midiSincInterp = g_midiSincInterp;
+    options.soundFont = g_hSoundFont;
+    options.readAheadSeconds = g_readAheadSeconds;
+    return options;
+}
+
+// Free a chain that never became the current track. Runs on the loader thread
+// too, so it leaves the tag cache (UI thread only) alone: a chain only has
+// cached tags once the UI thread has pre-rolled it, and DiscardPreroll()
+// forgets those.
+static void FreeTrackChain(TrackChain& chain) {
+    DetachFromOutput(chain.output);
+    // A SoundTouch stream frees the source with itself (BASS_FX_FREESOURCE)
+    bool ownsSource = chain.output && chain.processor &&
+                      chain.processor->GetAlgorithm() == TempoAlgorithm::SoundTouch;
+    if (chain.output) {
+        BASS_StreamFree(chain.output);  // The resampler also frees the stream it wraps
+    }
+    if (chain.processor) {
+        chain.processor->Shutdown();
+        delete chain.processor;
+    }
+    if (!ownsSource && chain.source) {
+        BASS_StreamFree(chain.source);
+    }
+    chain = TrackChain();
+}
+
+// Open a file and build its chain without touching the current track.
+// On failure nothing is left allocated and error describes the problem.
+static bool OpenFileChain(const wchar_t* path, const ChainOptions& options, TrackChain& chain, std::wstring& error) {
     // Create source stream (use MIDI-specific function for MIDI files if sinc interp enabled)
-    if (IsMidiFile(path) && g_midiSincInterp) {
+    if (IsMidiFile(path) && options.midiSincInterp) {
         DWORD flags = BASS_UNICODE | BASS_STREAM_DECODE | BASS_SAMPLE_FLOAT | BASS_MIDI_SINCINTER;
-        g_stream = BASS_MIDI_StreamCreateFile(FALSE, path, 0, 0, flags, 0);
+        chain.source = BASS_MIDI_StreamCreateFile(FALSE, path, 0, 0, flags, 0);
         // Apply SoundFont to this specific stream if loaded
-        if (g_stream && g_hSoundFont) {
+        if (chain.source && options.soundFont) {
             BASS_MIDI_FONT font;
-            font.font = g_hSoundFont;
+            font.font = options.soundFont;
             font.preset = -1;
             font.bank = 0;
-            BASS_MIDI_StreamSetFonts(g_stream, &font, 1);
+            BASS_MIDI_StreamSetFonts(chain.source, &font, 1);
         }
     } else {
-        g_stream = BASS_StreamCreateFile(FALSE, path, 0, 0, BASS_UNICODE | BASS_STREAM_DECODE | BASS_SAMPLE_FLOAT);
-    }
-    if (!g_stream) {
-        g_isLoading = false;
-        // Only show error if this is the only file in the playlist
-        if (g_playlist.size() <= 1) {
-            int error = BASS_ErrorGetCode();
-            const wchar_t* errorMsg;
-            switch (error) {
-                case BASS_ERROR_FILEOPEN: errorMsg = L"Could not open the file."; break;
-                case BASS_ERROR_FILEFORM: errorMsg = L"Unsupported file format."; break;
-                case BASS_ERROR_CODEC:    errorMsg = L"Required codec is not available."; break;
-                case BASS_ERROR_FORMAT:   errorMsg = L"Unsupported sample format."; break;
-                case BASS_ERROR_MEM:      errorMsg = L"Out of memory."; break;
-                case BASS_ERROR_NO3D:     errorMsg = L"3D sound is not available."; break;
-                default:                  errorMsg = L"Unknown error."; break;
-            }
-            std::wstring msg = L"Cannot play file:\n";
-            msg += GetFileName(path);
-            msg += L"\n\n";
-            msg += errorMsg;
-            MessageBoxW(GetMessageBoxOwner(), msg.c_str(), APP_NAME, MB_ICONERROR);
+        // Read through the read-ahead cache, or directly if that can't open it
+        // (the direct open also reports the real error)
+        chain.source = CreateCachedFileStream(path, BASS_STREAM_DECODE | BASS_SAMPLE_FLOAT, options.readAheadSeconds);
+        if (!chain.source) {
+            chain.source = BASS_StreamCreateFile(FALSE, path, 0, 0, BASS_UNICODE | BASS_STREAM_DECODE | BASS_SAMPLE_FLOAT);
         }
+    }
+    if (!chain.source) {
+        int errorCode = BASS_ErrorGetCode();
+        const wchar_t* errorMsg;
+        switch (errorCode) {
+            case BASS_ERROR_FILEOPEN: errorMsg = L"Could not open the file."; break;
+            case BASS_ERROR_FILEFORM: errorMsg = L"Unsupported file format."; break;
+            case BASS_ERROR_CODEC:    errorMsg = L"Required codec is not available."; break;
+            case BASS_ERROR_FORMAT:   errorMsg = L"Unsupported sample format."; break;
+            case BASS_ERROR_MEM:      errorMsg = L"Out of memory."; break;
+            case BASS_ERROR_NO3D:     errorMsg = L"3D sound is not available."; break;
+            default:                  errorMsg = L"Unknown error."; break;
+        }
+        error = L"Cannot play file:\n";
+        error += GetFileName(path);
+        error += L"\n\n";
+        error += errorMsg;
         return false;
     }
 
     // Get original sample frequency for rate control
     BASS_CHANNELINFO info;
-    BASS_ChannelGetInfo(g_stream, &info);
-    g_originalFreq = static_cast<float>(info.freq);
-
-    // Store source stream for VBR bitrate queries (not freed separately - owned by tempo processor)
-    g_sourceStream = g_stream;
+    BASS_ChannelGetInfo(chain.source, &info);
+    chain.originalFreq = static_cast<float>(info.freq);
 
     // Capture initial bitrate
     float bitrate = 0;
-    BASS_ChannelGetAttribute(g_stream, BASS_ATTRIB_BITRATE, &bitrate);
-    g_currentBitrate = static_cast<int>(bitrate);
-
-    // Set up tempo processor based on selected algorithm
-    TempoAlgorithm algo = static_cast<TempoAlgorithm>(g_tempoAlgorithm);
-    SetCurrentAlgorithm(algo);
+    BASS_ChannelGetAttribute(chain.source, BASS_ATTRIB_BITRATE, &bitrate);
+    chain.bitrate = static_cast<int>(bitrate);
 
-    // Create or reinitialize tempo processor
-    FreeTempoProcessor();
-    TempoProcessor* processor = GetTempoProcessor();
+    // Set up tempo processor based on selected algorithm (InstallTrackChain()
+    // records which one was actually used)
+    chain.processor = CreateTempoProcessor(options.algorithm);
 
     // Restore tempo/pitch settings to processor before initializing
-    // Note: Rate is handled via BASS_ATTRIB_FREQ below, not through tempo processor
-    processor->SetTempo(g_tempo);
-    processor->SetPitch(g_pitch);
+    // Note: Rate is applied after the processor (ApplyPlaybackRate), not through it
+    chain.processor->SetTempo(options.tempo);
+    chain.processor->SetPitch(options.pitch);
 
-    // Initialize processor - this creates the output stream
-    g_fxStream = processor->Initialize(g_stream, g_originalFreq);
-    if (!g_fxStream) {
+    // Initialize processor - this creates the decode stream the output mixer plays
+    chain.output = chain.processor->Initialize(chain.source, chain.originalFreq, BASS_STREAM_DECODE);
+    if (!chain.output && chain.processor->GetAlgorithm() != TempoAlgorithm::SoundTouch) {
         // Fall back to SoundTouch if selected algorithm fails
-        if (algo != TempoAlgorithm::SoundTouch) {
-            FreeTempoProcessor();
-            SetCurrentAlgorithm(TempoAlgorithm::SoundTouch);
-            processor = GetTempoProcessor();
-            processor->SetTempo(g_tempo);
-            processor->SetPitch(g_pitch);
-            g_fxStream = processor->Initialize(g_stream, g_originalFreq);
-        }
-
-        if (!g_fxStream) {
-            BASS_StreamFree(g_stream);
-            g_stream = 0;
-            g_isLoading = false;
-            if (g_playlist.size() <= 1) {
-                MessageBoxW(GetMessageBoxOwner(), L"Failed to create tempo stream.", APP_NAME, MB_ICONERROR);
-            }
+        chain.processor->Shutdown();
+        delete chain.processor;
+        chain.processor = CreateTempoProcessor(TempoAlgorithm::SoundTouch);
+        chain.processor->SetTempo(options.tempo);
+        chain.processor->SetPitch(options.pitch);
+        chain.output = chain.processor->Initialize(chain.source, chain.originalFreq, BASS_STREAM_DECODE);
+    }
+    if (!chain.output) {
+        error = L"Failed to create tempo stream.";
+        FreeTrackChain(chain);
+        return false;
+    }
+
+    // With the built-in resampler, its stream (which applies Rate and converts to
+    // the device rate) wraps the processor's and frees it when freed itself
+    if (options.resamplerQuality != ResamplerQuality::Native) {
+        HSTREAM resampled = CreateResampledStream(chain.output, options.resamplerQuality, options.rate);
+        if (!resampled) {
+            error = L"Failed to create resampler stream.";
+            FreeTrackChain(chain);
             return false;
         }
+        chain.output = resampled;
     }
+    return true;
+}
 
-    // For SoundTouch, g_stream is now owned by g_fxStream (BASS_FX_FREESOURCE)
-    if (processor->GetAlgorithm() == TempoAlgorithm::SoundTouch) {
-        g_stream = 0;  // Prevent double-free
+// Make a chain the current track: hand its processor to the global instance and
+// point the stream globals at it
+static void InstallTrackChain(TrackChain& chain) {
+    AdoptTempoProcessor(chain.processor);
+    SetCurrentAlgorithm(chain.processor->GetAlgorithm());
+
+    // For SoundTouch, the source is owned by the tempo stream (BASS_FX_FREESOURCE)
+    bool ownsSource = chain.processor->GetAlgorithm() == TempoAlgorithm::SoundTouch;
+    g_stream = ownsSource ? 0 : chain.source;
+
+    // Store source stream for tags and VBR bitrate queries (not freed separately)
+    g_sourceStream = chain.source;
+    g_fxStream = chain.output;
+    g_originalFreq = chain.originalFreq;
+    g_currentBitrate = chain.bitrate;
+    chain = TrackChain();
+    g_prerollFailedPath.clear();
+}
+
+// Apply g_rate to a chain output: through the built-in resampler when it has
+// one, otherwise via the frequency attribute (which the mixer honours)
+static void ApplyRateToChain(HSTREAM output, float originalFreq) {
+    if (!output) return;
+    if (IsResampledStream(output)) {
+        SetResampledStreamRate(output, g_rate);
+    } else {
+        BASS_ChannelSetAttribute(output, BASS_ATTRIB_FREQ, originalFreq * g_rate);
     }
+}
 
-    // Apply rate using native BASS frequency attribute
-    if (g_rate != 1.0f) {
-        BASS_ChannelSetAttribute(g_fxStream, BASS_ATTRIB_FREQ, g_originalFreq * g_rate);
+// Replace the current track with an opened chain and start playing it from
+// savedPos (its saved position, looked up when it was opened, as was its seek table)
+static bool StartLoadedTrack(const wchar_t* path, TrackChain& chain, double savedPos) {
+    g_isLoading = true;
+    g_isLiveStream = false;  // Local files are always seekable
+
+    // Free existing streams safely (effects stay on the output mixer, so a
+    // reverb or echo tail rings on into the new track)
+    DiscardPreroll();
+    ReleaseCurrentChain();
+
+    InstallTrackChain(chain);
+    TempoProcessor* processor = GetTempoProcessor();
+
+    // Tempo/pitch may have changed while the chain was opened in the background
+    if (processor->GetTempo() != g_tempo) processor->SetTempo(g_tempo);
+    if (processor->GetPitch() != g_pitch) processor->SetPitch(g_pitch);
+
+    // Files render on demand so seeks and Rate changes are heard immediately
+    SetOutputBuffer(0.0f);
+    if (!StartOnOutput()) {
+        ReleaseCurrentChain();
+        g_isLoading = false;
+        if (g_playlist.size() <= 1) {
+            MessageBoxW(GetMessageBoxOwner(), L"Failed to start audio output.", APP_NAME, MB_ICONERROR);
+        }
+        return false;
     }
 
-    // Compute ReplayGain from the file's tags before the volume DSP is attached
-    ComputeReplayGainScale(g_sourceStream ? g_sourceStream : g_fxStream);
+    // Apply rate (the resampler already has it; this covers BASS built-in mode)
+    if (g_rate != 1.0f) {
+        ApplyPlaybackRate();
+    }
 
-    // Apply DSP effects (including volume DSP which handles g_volume/g_muted)
-    ApplyDSPEffects();
+    // Compute ReplayGain from the file's tags or analyzed loudness (the volume stage picks it up)
+    g_replayGainScale = ComputeReplayGainScale(g_sourceStream, path);
+    ApplyLegacyVolume();
 
-    // Set up end sync for auto-advance on output stream
-    g_endSync = BASS_ChannelSetSync(g_fxStream, BASS_SYNC_END, 0, OnTrackEnd, nullptr);
+    // Set up end sync for auto-advance (fires when the end is heard, not when it's mixed)
+    g_endSync = BASS_Mixer_ChannelSetSync(g_fxStream, BASS_SYNC_END, 0, OnTrackEnd, nullptr);
 
-    // Restore saved position for this file (if any)
-    double savedPos = LoadFilePosition(path);
     if (savedPos > 0) {
         processor->SetPosition(savedPos);
     }
 
-    // Start playback on output stream
-    BASS_ChannelPlay(g_fxStream, FALSE);
+    // Start playback on the output mixer
+    BASS_ChannelPlay(g_outputStream, FALSE);
 
     // Parse chapters from file (if any)
-    // For SoundTouch, use g_fxStream since it owns g_stream
-    // For push-based processors, use g_stream (original source)
-    HSTREAM chapterStream = g_stream ? g_stream : g_fxStream;
-    ParseChapters(chapterStream);
+    ParseChapters(g_sourceStream);
 
     g_isLoading = false;
     UpdateWindowTitle();
@@ -960,6 +1133,47 @@ bool LoadFile(const wchar_t* path) {
     return true;
 }
 
+// Load and play a file (or URL) on the calling thread
+bool LoadFile(const wchar_t* path) {
+    // Check if this is a URL
+    if (IsURL(path)) {
+        return LoadURL(path);
+    }
+    CancelTrackLoad(false);  // This load supersedes any in the background
+
+    // The track may already be open: pre-rolled and queued behind the current one
+    g_isLoading = true;
+    g_isLiveStream = false;
+    if (AdoptPrerolledTrack(path)) {
+        g_isLoading = false;
+        UpdateWindowTitle();
+        UpdateStatusBar();
+        return true;
+    }
+    g_isLoading = false;
+
+    TrackChain chain;
+    std::wstring error;
+    if (!OpenFileChain(path, CurrentChainOptions(), chain, error)) {
+        // The old track can't continue as if nothing happened
+        DiscardPreroll();
+        ReleaseCurrentChain();
+        // Only show error if this is the only file in the playlist
+        if (g_playlist.size() <= 1) {
+            MessageBoxW(GetMessageBoxOwner(), error.c_str(), APP_NAME, MB_ICONERROR);
+        }
+        return false;
+    }
+
+    // Exact seeking in long VBR files, if they've been scanned before
+    ApplySeekTable(chain.source, path);
+
+    // Restore saved position for this file (if any, or from where it was before a move)
+    RelinkMovedFileDB(path);
+    double savedPos = LoadFilePosition(path, chain.processor->GetLength());
+    return StartLoadedTrack(path, chain, savedPos);
+}
+
 // Sync callback when track ends
 void CALLBACK OnTrackEnd(HSYNC handle, DWORD channel, DWORD data, void* user) {
     // Post message to main thread to advance track
@@ -980,17 +1194,19 @@ void CALLBACK OnMetaChange(HSYNC handle, DWORD channel, DWORD data, void* user)
 
 // Called from main thread when metadata changes - announces new stream track
 void AnnounceStreamMetadata() {
-    HSTREAM stream = g_stream ? g_stream : g_fxStream;
+    HSTREAM stream = g_sourceStream ? g_sourceStream : g_fxStream;
     if (!stream) return;
 
-    std::string streamTitle = GetStreamTitle(stream);
+    // The stream's tags are only re-read when its metadata changes
+    ForgetStreamTags(stream);
+    const std::wstring& streamTitle = GetStreamTags(stream).streamTitle;
     if (streamTitle.empty()) return;
 
     // Record to song history (independent of speech setting)
-    AddSongHistoryEntry(Utf8ToWide(streamTitle));
+    AddSongHistoryEntry(streamTitle, g_songHistoryLimit);
 
     if (g_speechTrackChange) {
-        Speak(streamTitle);
+        SpeakW(streamTitle);
     }
 }
 
@@ -1002,7 +1218,7 @@ void PlayPause() {
         return;
     }
 
-    DWORD state = BASS_ChannelIsActive(g_fxStream);
+    DWORD state = BASS_ChannelIsActive(g_outputStream);
     if (state == BASS_ACTIVE_PLAYING) {
         // For live streams, stop instead of pause
         if (g_isLiveStream) {
@@ -1011,7 +1227,7 @@ void PlayPause() {
             Pause();
         }
     } else {
-        BASS_ChannelPlay(g_fxStream, FALSE);
+        BASS_ChannelPlay(g_outputStream, FALSE);
         UpdateWindowTitle();
         UpdateStatusBar();
     }
@@ -1019,28 +1235,13 @@ void PlayPause() {
 
 // Free current stream (used when stopping live streams)
 void FreeCurrentStream() {
+    DiscardPreroll();
     if (g_fxStream) {
-        if (g_endSync) {
-            BASS_ChannelRemoveSync(g_fxStream, g_endSync);
-            g_endSync = 0;
-        }
-        RemoveDSPEffects();
-        BASS_ChannelStop(g_fxStream);
-        BASS_StreamFree(g_fxStream);
-        g_fxStream = 0;
-    }
-    if (g_stream) {
-        if (g_metaSync) {
-            BASS_ChannelRemoveSync(g_stream, g_metaSync);
-            g_metaSync = 0;
-        }
-        BASS_StreamFree(g_stream);
-        g_stream = 0;
+        BASS_ChannelStop(g_outputStream);
     }
-    g_sourceStream = 0;
+    ReleaseCurrentChain();
     g_isLiveStream = false;
     g_currentBitrate = 0;
-    FreeTempoProcessor();
 }
 
 // Play (restart if playing, resume if paused/stopped)
@@ -1056,7 +1257,7 @@ void Play() {
                 LoadFile(path.c_str());
             }
             if (g_fxStream) {
-                BASS_ChannelPlay(g_fxStream, FALSE);
+                BASS_ChannelPlay(g_outputStream, FALSE);
                 UpdateWindowTitle();
                 UpdateStatusBar();
             }
@@ -1069,15 +1270,18 @@ void Play() {
         return;
     }
 
-    DWORD state = BASS_ChannelIsActive(g_fxStream);
+    DWORD state = BASS_ChannelIsActive(g_outputStream);
     if (state == BASS_ACTIVE_PLAYING) {
         // Already playing - restart from beginning
         TempoProcessor* processor = GetTempoProcessor();
         if (processor && processor->IsActive()) {
             processor->SetPosition(0);
+            ResetResampledStream(g_fxStream);
+            FlushOutput();
+            if (g_preroll.crossfade) DiscardPreroll();
         }
     }
-    BASS_ChannelPlay(g_fxStream, FALSE);
+    BASS_ChannelPlay(g_outputStream, FALSE);
     UpdateWindowTitle();
     UpdateStatusBar();
 }
@@ -1090,7 +1294,7 @@ void Pause() {
             Speak("Cannot pause live stream");
             return;
         }
-        BASS_ChannelPause(g_fxStream);
+        BASS_ChannelPause(g_outputStream);
 
         if (g_rewindOnPauseMs > 0) {
             Seek(-g_rewindOnPauseMs / 1000.0);
@@ -1109,10 +1313,13 @@ void Stop() {
         if (g_isLiveStream) {
             FreeCurrentStream();
         } else {
-            BASS_ChannelStop(g_fxStream);
+            BASS_ChannelStop(g_outputStream);
             TempoProcessor* processor = GetTempoProcessor();
             if (processor && processor->IsActive()) {
                 processor->SetPosition(0);
+                ResetResampledStream(g_fxStream);
+                FlushOutput();
+                if (g_preroll.crossfade) DiscardPreroll();
             }
         }
     }
@@ -1145,6 +1352,9 @@ void Seek(double seconds) {
     if (newPos > length) newPos = length;
 
     processor->SetPosition(newPos);
+    ResetResampledStream(g_fxStream);
+    FlushOutput();
+    if (g_preroll.crossfade) DiscardPreroll();  // Scheduled from the old position
 
     UpdateStatusBar();
 }
@@ -1175,9 +1385,18 @@ void SeekToPosition(double seconds) {
     if (seconds > duration) seconds = duration;
 
     processor->SetPosition(seconds);
+    ResetResampledStream(g_fxStream);
+    FlushOutput();
+    if (g_preroll.crossfade) DiscardPreroll();  // Scheduled from the old position
     UpdateStatusBar();
 }
 
+// Apply g_rate to the current track (and a pre-rolled one, so the join keeps the rate)
+void ApplyPlaybackRate() {
+    ApplyRateToChain(g_fxStream, g_originalFreq);
+    ApplyRateToChain(g_preroll.chain.output, g_preroll.chain.originalFreq);
+}
+
 // Get current playback position in seconds
 double GetCurrentPosition() {
     if (!g_fxStream) return 0.0;
@@ -1284,9 +1503,9 @@ void SetVolume(float vol) {
 
     // In legacy mode, use BASS_ATTRIB_VOL (faster but affects recordings)
     // In normal mode, volume DSP automatically uses updated g_volume
-    if (g_legacyVolume && g_fxStream) {
+    if (g_legacyVolume && g_outputStream) {
         float curvedVolume = vol * vol * g_replayGainScale;  // Apply perceptual curve + ReplayGain
-        BASS_ChannelSetAttribute(g_fxStream, BASS_ATTRIB_VOL, curvedVolume);
+        BASS_ChannelSetAttribute(g_outputStream, BASS_ATTRIB_VOL, curvedVolume);
     }
 
     // Announce volume if setting enabled
@@ -1305,12 +1524,12 @@ void ToggleMute() {
     g_muted = !g_muted;
 
     // In legacy mode, use BASS_ATTRIB_VOL
-    if (g_legacyVolume && g_fxStream) {
+    if (g_legacyVolume && g_outputStream) {
         if (g_muted) {
-            BASS_ChannelSetAttribute(g_fxStream, BASS_ATTRIB_VOL, 0.0f);
+            BASS_ChannelSetAttribute(g_outputStream, BASS_ATTRIB_VOL, 0.0f);
         } else {
             float curvedVolume = g_volume * g_volume * g_replayGainScale;
-            BASS_ChannelSetAttribute(g_fxStream, BASS_ATTRIB_VOL, curvedVolume);
+            BASS_ChannelSetAttribute(g_outputStream, BASS_ATTRIB_VOL, curvedVolume);
         }
     }
     // In normal mode, volume DSP automatically uses updated g_muted
@@ -1322,14 +1541,19 @@ void ToggleMute() {
 // Recompute ReplayGain for the currently playing track and re-apply it immediately,
 // so changing the ReplayGain options takes effect without restarting the track.
 void RefreshReplayGain() {
-    ComputeReplayGainScale(g_sourceStream ? g_sourceStream : g_fxStream);
-
-    // In normal volume mode the volume DSP reads g_replayGainScale on the fly. In legacy
-    // mode the gain is baked into BASS_ATTRIB_VOL, so push the updated value now.
-    if (g_legacyVolume && g_fxStream) {
-        float curvedVolume = (g_muted ? 0.0f : (g_volume * g_volume)) * g_replayGainScale;
-        BASS_ChannelSetAttribute(g_fxStream, BASS_ATTRIB_VOL, curvedVolume);
+    std::wstring path;
+    if (g_currentTrack >= 0 && g_currentTrack < static_cast<int>(g_playlist.size()) &&
+        !IsURL(g_playlist[g_currentTrack].c_str())) {
+        path = g_playlist[g_currentTrack];
+    }
+    g_replayGainScale = ComputeReplayGainScale(g_sourceStream ? g_sourceStream : g_fxStream, path);
+    if (g_preroll.chain.source) {
+        g_preroll.replayGainScale = ComputeReplayGainScale(g_preroll.chain.source, g_preroll.path);
+        g_joinReplayGainScale = g_preroll.replayGainScale;
     }
+    RefreshLiveLeveler();
+
+    ApplyLegacyVolume();
 }
 
 // Speak elapsed time
@@ -1369,49 +1593,60 @@ void SpeakTotal() {
 // Shuffle playback order. Rather than picking a random track on every advance
 // (which makes small playlists replay the same handful of tracks before others
 // have played), we build a fixed random permutation of the playlist and walk it
-// in order, reshuffling only after every track has played once.
-static std::vector<int> g_shuffleOrder;   // permutation of playlist indices
-static int g_shufflePos = -1;             // index of the current track within g_shuffleOrder
+// in order, reshuffling only after every track has played once. The order and
+// its cursor live in the playlist model, which keeps them valid across edits.
 static bool g_shuffleAdvance = false;     // set by Next/PrevTrack so PlayTrack keeps the current order
 
 // Discard the current shuffle order so the next advance builds a fresh one.
 // Called when shuffle is toggled on and when a new playlist/selection loads,
 // so a fresh random order is produced instead of replaying the last one.
 void ResetShuffleOrder() {
-    g_shuffleOrder.clear();
-    g_shufflePos = -1;
+    g_playlist.ClearShuffle();
 }
 
-void PlayTrack(int index, bool autoPlay) {
-    // Consume the advance flag up front so it never leaks past an early return.
-    bool advancing = g_shuffleAdvance;
-    g_shuffleAdvance = false;
-
-    if (g_isBusy) return;  // Prevent re-entrancy
-    if (index < 0 || index >= static_cast<int>(g_playlist.size())) {
-        return;
+// A track change has finished loading: pause if it shouldn't play yet, and
+// tell the playlist dialog, recent files and speech about it
+static void FinishTrackChange(bool autoPlay) {
+    if (!autoPlay && g_fxStream) {
+        BASS_ChannelPause(g_outputStream);
+    }
+    if (g_currentTrack >= 0 && g_currentTrack < static_cast<int>(g_playlist.size())) {
+        AddToRecentFiles(g_playlist[g_currentTrack]);
     }
 
-    // A direct selection or a freshly loaded playlist starts a new shuffle cycle;
-    // only Next/Prev advances keep the existing order.
-    if (!advancing) ResetShuffleOrder();
-
-    g_isBusy = true;
+    // Notify playlist dialog about track change
+    NotifyPlaylistTrackChanged();
 
-    // Save position of current track before switching
-    if (g_fxStream && g_currentTrack >= 0 && g_currentTrack < static_cast<int>(g_playlist.size())) {
-        SaveFilePosition(g_playlist[g_currentTrack]);
+    // Announce track change if setting is enabled
+    if (g_speechTrackChange) {
+        // For streams, announce the stream title; for files, announce title or filename
+        HSTREAM stream = g_sourceStream ? g_sourceStream : g_fxStream;
+        if (stream) {
+            const StreamTags& tags = GetStreamTags(stream);
+            if (!tags.streamTitle.empty()) {
+                SpeakW(tags.streamTitle);
+            } else if (!tags.title.empty() && !tags.artist.empty()) {
+                SpeakW(tags.artist + L" - " + tags.title);
+            } else if (!tags.title.empty()) {
+                SpeakW(tags.title);
+            } else {
+                // Fall back to filename
+                SpeakW(g_playlist.GetName(g_currentTrack));
+            }
+        }
     }
+}
+
+// Load a track on the UI thread, skipping failures (up to maxAttempts files)
+static void PlayTrackNow(int index, bool autoPlay, int maxAttempts) {
+    g_isBusy = true;
 
-    // Try to load tracks, skipping failures (up to 10 attempts to prevent infinite loop)
     int attempts = 0;
     bool loadedSuccessfully = false;
-    while (index < static_cast<int>(g_playlist.size()) && attempts < 10) {
+    while (index < static_cast<int>(g_playlist.size()) && attempts < maxAttempts) {
         g_currentTrack = index;
         if (LoadFile(g_playlist[index].c_str())) {
             loadedSuccessfully = true;
-            // Add to recent files (only for local files, not URLs)
-            AddToRecentFiles(g_playlist[index]);
             break;  // Success
         }
         // Try next track if this one failed and we have multiple files
@@ -1423,132 +1658,431 @@ void PlayTrack(int index, bool autoPlay) {
         }
     }
 
-    // If autoPlay is false, pause immediately after loading
-    if (loadedSuccessfully && !autoPlay && g_fxStream) {
-        BASS_ChannelPause(g_fxStream);
-    }
-
-    // Notify playlist dialog about track change
     if (loadedSuccessfully) {
-        NotifyPlaylistTrackChanged();
+        FinishTrackChange(autoPlay);
     }
+    g_isBusy = false;
+}
 
-    // Announce track change if setting is enabled
-    if (loadedSuccessfully && g_speechTrackChange) {
-        // For streams, announce the stream title; for files, announce title or filename
-        HSTREAM stream = g_stream ? g_stream : g_fxStream;
-        if (stream) {
-            std::string streamTitle = GetStreamTitle(stream);
-            if (!streamTitle.empty()) {
-                Speak(streamTitle);
-            } else {
-                std::string title = GetMetadataTag(stream, "TITLE");
-                std::string artist = GetMetadataTag(stream, "ARTIST");
-
-                // Try ID3v1 if nothing found
-                if (title.empty()) {
-                    const TAG_ID3* id3 = (const TAG_ID3*)BASS_ChannelGetTags(stream, BASS_TAG_ID3);
-                    if (id3) {
-                        title = GetTrimmedTag(id3->title, 30);
-                        if (artist.empty()) artist = GetTrimmedTag(id3->artist, 30);
-                    }
-                }
+// ============================================================================
+// Background track loading
+// ============================================================================
+// Opening a file (source stream, tempo processor priming, resampler) can take
+// seconds on a slow network share, so PlayTrack() hands it to a worker thread
+// and the current track keeps playing meanwhile. Each request bumps a
+// generation; a newer request supersedes an older one, which the worker drops
+// as soon as it notices. The result is posted back as WM_TRACK_LOADED and
+// swapped in on the UI thread.
+//
+// The same worker opens the gapless pre-roll (and runs smart crossfade's scans
+// for silence) when no track load is waiting, posting WM_PREROLL_LOADED.
+
+// Files tried per request before giving up (matches the synchronous path)
+static const int MAX_LOAD_ATTEMPTS = 10;
+
+struct TrackLoadRequest {
+    unsigned generation = 0;
+    std::vector<std::pair<int, std::wstring>> candidates;  // Playlist index + path, tried in order
+    ChainOptions options;
+};
 
-                if (!title.empty() && !artist.empty()) {
-                    Speak(artist + " - " + title);
-                } else if (!title.empty()) {
-                    Speak(title);
-                } else {
-                    // Fall back to filename
-                    std::wstring path = g_playlist[g_currentTrack];
-                    const wchar_t* lastSlash = wcsrchr(path.c_str(), L'\\');
-                    if (!lastSlash) lastSlash = wcsrchr(path.c_str(), L'/');
-                    std::wstring filename = lastSlash ? (lastSlash + 1) : path;
-                    char buf[512];
-                    WideCharToMultiByte(CP_UTF8, 0, filename.c_str(), -1, buf, sizeof(buf), nullptr, nullptr);
-                    Speak(buf);
-                }
-            }
+struct TrackLoadResult {
+    unsigned generation = 0;
+    int index = -1;             // Track that opened, or the URL to load directly
+    TrackChain chain;           // Empty if nothing opened
+    double savedPos = 0.0;      // Saved position to start from (0 for the top)
+    bool needsDirectLoad = false;  // Reached a URL: continue on the UI thread
+    int attempts = 0;
+    std::wstring error;         // Last failure, for single-file playlists
+};
+
+static std::thread g_loadThread;
+static std::mutex g_loadMutex;
+static std::condition_variable g_loadWake;
+static TrackLoadRequest g_loadRequest;
+static bool g_loadRequestReady = false;
+static bool g_loadWorking = false;
+static bool g_loadShutdown = false;
+static TrackLoadResult g_loadResult;
+static bool g_loadResultReady = false;
+static std::atomic<unsigned> g_loadGeneration(0);
+
+// The next track to open ahead of time. With a smart crossfade the worker also
+// finds where the current track goes quiet and where this one starts.
+struct PrerollRequest {
+    unsigned generation = 0;
+    std::wstring path;
+    ChainOptions options;
+    DWORD outputChannels = 0;
+    bool restorePosition = false;  // Start from a saved position (not a repeat of the current track)
+    std::wstring tailPath;         // Current track, if its tail is to be scanned
+    double tailFrom = 0.0;
+    double tailTo = 0.0;
+    double leadTo = 0.0;           // How far into this track to look for its first sound
+};
+
+struct PrerollResult {
+    unsigned generation = 0;
+    TrackChain chain;              // Empty if it can't be opened or joined
+    double savedPos = 0.0;
+    double tailFrom = 0.0;         // The tail scanned (tailTo 0 if it wasn't)
+    double tailTo = 0.0;
+    bool tailFound = false;
+    double tailLast = 0.0;         // End of the current track's last sound
+    bool leadFound = false;
+    double leadFirst = 0.0;        // Start of this track's first sound
+};
+
+static PrerollRequest g_prerollRequest;
+static bool g_prerollRequestReady = false;
+static PrerollResult g_prerollResult;
+static bool g_prerollResultReady = false;
+static std::atomic<unsigned> g_prerollGeneration(0);  // Bumped when a pre-roll is requested or dropped
+
+// UI thread only
+static bool g_loadPending = false;
+static bool g_loadAutoPlay = true;
+
+static void LoadRequestedTrack(const TrackLoadRequest& request) {
+    TrackLoadResult result;
+    result.generation = request.generation;
+    for (const auto& candidate : request.candidates) {
+        if (g_loadGeneration != request.generation) break;  // Superseded
+        if (IsURL(candidate.second.c_str())) {
+            result.index = candidate.first;
+            result.needsDirectLoad = true;
+            break;
+        }
+        result.index = candidate.first;
+        result.attempts++;
+        if (OpenFileChain(candidate.second.c_str(), request.options, result.chain, result.error)) {
+            // Seek table and saved position (if any, or from where it was before a
+            // move; telling a moved file by its contents reads it) are looked up
+            // here rather than on the UI thread
+            ApplySeekTable(result.chain.source, candidate.second);
+            RelinkMovedFileDB(candidate.second);
+            result.savedPos = LoadFilePosition(candidate.second, result.chain.processor->GetLength());
+            break;
         }
     }
 
-    g_isBusy = false;
+    if (g_loadGeneration != request.generation) {
+        FreeTrackChain(result.chain);
+        return;
+    }
+
+    TrackLoadResult unclaimed;
+    {
+        std::lock_guard<std::mutex> lock(g_loadMutex);
+        if (g_loadResultReady) unclaimed = std::move(g_loadResult);
+        g_loadResult = std::move(result);
+        g_loadResultReady = true;
+    }
+    FreeTrackChain(unclaimed.chain);
+    PostMessage(g_hwnd, WM_TRACK_LOADED, request.generation, 0);
 }
 
-// Build a fresh Fisher-Yates shuffle of the current playlist. If startIndex is a
-// valid index it is moved to the front so the currently-playing track stays put.
-static void BuildShuffleOrder(int startIndex) {
-    int n = static_cast<int>(g_playlist.size());
-    g_shuffleOrder.resize(n);
-    for (int i = 0; i < n; i++) g_shuffleOrder[i] = i;
-    for (int i = n - 1; i > 0; i--) {
-        int j = rand() % (i + 1);
-        std::swap(g_shuffleOrder[i], g_shuffleOrder[j]);
+static void OpenRequestedPreroll(const PrerollRequest& request) {
+    if (g_prerollGeneration != request.generation) return;  // Dropped while waiting
+
+    PrerollResult result;
+    result.generation = request.generation;
+    TrackChain& chain = result.chain;
+    std::wstring error;
+    if (OpenFileChain(request.path.c_str(), request.options, chain, error)) {
+        // The mixer's channel count is fixed; a different layout gets a normal load
+        BASS_CHANNELINFO info;
+        if (!BASS_ChannelGetInfo(chain.output, &info) || info.chans != request.outputChannels) {
+            FreeTrackChain(chain);
+        }
     }
-    if (startIndex >= 0 && startIndex < n) {
-        for (int i = 0; i < n; i++) {
-            if (g_shuffleOrder[i] == startIndex) { std::swap(g_shuffleOrder[0], g_shuffleOrder[i]); break; }
+
+    if (chain.output && g_prerollGeneration == request.generation) {
+        ApplySeekTable(chain.source, request.path);
+
+        // Start where a normal load would
+        if (request.restorePosition) {
+            RelinkMovedFileDB(request.path);
+            result.savedPos = LoadFilePosition(request.path, chain.processor->GetLength());
+            if (result.savedPos > 0) chain.processor->SetPosition(result.savedPos);
+        }
+
+        // Each scan decodes several seconds of audio
+        double first, last;
+        if (!request.tailPath.empty() && g_prerollGeneration == request.generation) {
+            result.tailFrom = request.tailFrom;
+            result.tailTo = request.tailTo;
+            result.tailFound = FindAudibleRange(request.tailPath.c_str(), request.tailFrom, request.tailTo,
+                                                &first, &result.tailLast);
+        }
+        if (request.leadTo > 0 && result.savedPos <= 0 && g_prerollGeneration == request.generation) {
+            result.leadFound = FindAudibleRange(request.path.c_str(), 0.0, request.leadTo, &result.leadFirst, &last);
         }
-        g_shufflePos = 0;
-    } else {
-        g_shufflePos = -1;
     }
-}
 
-// Make sure g_shufflePos points at g_currentTrack, rebuilding the order if it's
-// stale (playlist changed) or the user jumped to a track directly.
-static void SyncShufflePos() {
-    int n = static_cast<int>(g_playlist.size());
-    if (static_cast<int>(g_shuffleOrder.size()) != n || g_shufflePos < 0) {
-        BuildShuffleOrder(g_currentTrack);
+    if (g_prerollGeneration != request.generation) {
+        FreeTrackChain(chain);
         return;
     }
-    if (g_shufflePos >= n || g_shuffleOrder[g_shufflePos] != g_currentTrack) {
-        for (int i = 0; i < n; i++) {
-            if (g_shuffleOrder[i] == g_currentTrack) { g_shufflePos = i; return; }
+
+    PrerollResult unclaimed;
+    {
+        std::lock_guard<std::mutex> lock(g_loadMutex);
+        if (g_prerollResultReady) unclaimed = std::move(g_prerollResult);
+        g_prerollResult = std::move(result);
+        g_prerollResultReady = true;
+    }
+    FreeTrackChain(unclaimed.chain);
+    PostMessage(g_hwnd, WM_PREROLL_LOADED, request.generation, 0);
+}
+
+static void TrackLoaderThread() {
+    for (;;) {
+        TrackLoadRequest request;
+        PrerollRequest preroll;
+        bool isPreroll = false;
+        {
+            std::unique_lock<std::mutex> lock(g_loadMutex);
+            g_loadWorking = false;
+            g_loadWake.notify_all();
+            g_loadWake.wait(lock, [] { return g_loadRequestReady || g_prerollRequestReady || g_loadShutdown; });
+            if (g_loadShutdown) return;
+            // The track the user asked for comes before the one after it
+            if (g_loadRequestReady) {
+                request = std::move(g_loadRequest);
+                g_loadRequestReady = false;
+            } else {
+                preroll = std::move(g_prerollRequest);
+                g_prerollRequestReady = false;
+                isPreroll = true;
+            }
+            g_loadWorking = true;
+        }
+
+        if (isPreroll) {
+            OpenRequestedPreroll(preroll);
+        } else {
+            LoadRequestedTrack(request);
         }
-        // Current track not in the order at all - rebuild around it.
-        BuildShuffleOrder(g_currentTrack);
     }
 }
 
-// Play next track
-void NextTrack(bool autoPlay) {
-    if (g_playlist.empty() || g_isBusy) return;
+// Supersede any background load. With wait, also block until the worker is
+// idle (before freeing things it may be using, like BASS or the SoundFont).
+static void CancelTrackLoad(bool wait) {
+    g_loadGeneration++;
+    g_loadPending = false;
 
-    // Repeat one: restart current track
-    if (g_repeatMode == 1 && g_currentTrack >= 0 && g_currentTrack < static_cast<int>(g_playlist.size())) {
-        g_shuffleAdvance = true;
-        PlayTrack(g_currentTrack, autoPlay);
-        return;
-    }
+    // The pre-roll the worker may be opening uses the same things
+    if (wait) DiscardPreroll();
 
-    int next;
-    if (g_shuffle && g_playlist.size() > 1) {
-        int n = static_cast<int>(g_playlist.size());
-        SyncShufflePos();
-        g_shufflePos++;
-        if (g_shufflePos >= n) {
-            // Whole playlist has played - reshuffle for the next cycle.
-            if (g_repeatMode == 2) {
-                int last = g_currentTrack;
-                BuildShuffleOrder(-1);
-                // Avoid repeating the just-played track as the first of the new cycle.
-                if (n > 1 && g_shuffleOrder[0] == last) std::swap(g_shuffleOrder[0], g_shuffleOrder[n - 1]);
-                g_shufflePos = 0;
-            } else {
-                // End of playlist - stop.
-                Stop();
-                return;
+    TrackLoadResult unclaimed;
+    PrerollResult unclaimedPreroll;
+    {
+        std::unique_lock<std::mutex> lock(g_loadMutex);
+        g_loadRequestReady = false;
+        if (wait) {
+            g_prerollRequestReady = false;
+            g_loadWake.wait(lock, [] { return !g_loadWorking; });
+            if (g_prerollResultReady) {
+                unclaimedPreroll = std::move(g_prerollResult);
+                g_prerollResultReady = false;
             }
         }
-        next = g_shuffleOrder[g_shufflePos];
-    } else {
-        next = g_currentTrack + 1;
-        if (next >= static_cast<int>(g_playlist.size())) {
-            // Repeat all: wrap to start
-            if (g_repeatMode == 2) {
-                next = 0;
+        if (g_loadResultReady) {
+            unclaimed = std::move(g_loadResult);
+            g_loadResultReady = false;
+        }
+    }
+    FreeTrackChain(unclaimed.chain);
+    FreeTrackChain(unclaimedPreroll.chain);
+}
+
+static void ShutdownTrackLoader() {
+    CancelTrackLoad(true);
+    if (g_loadThread.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(g_loadMutex);
+            g_loadShutdown = true;
+        }
+        g_loadWake.notify_all();
+        g_loadThread.join();
+    }
+}
+
+// Queue a track (and the ones after it, in case it fails) for the worker
+static void BeginTrackLoad(int index, bool autoPlay) {
+    unsigned generation = ++g_loadGeneration;
+
+    // The current track plays on until the new one is ready, but mustn't
+    // advance by itself or join a pre-rolled track in the meantime
+    DiscardPreroll();
+    if (g_endSync && g_fxStream) {
+        BASS_Mixer_ChannelRemoveSync(g_fxStream, g_endSync);
+        g_endSync = 0;
+    }
+    g_currentTrack = index;
+    g_loadPending = true;
+    g_loadAutoPlay = autoPlay;
+
+    TrackLoadRequest request;
+    request.generation = generation;
+    request.options = CurrentChainOptions();
+    int count = (g_playlist.size() > 1) ? MAX_LOAD_ATTEMPTS : 1;
+    for (int i = index; i < static_cast<int>(g_playlist.size()) && count > 0; i++, count--) {
+        request.candidates.emplace_back(i, g_playlist[i]);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(g_loadMutex);
+        g_loadRequest = std::move(request);
+        g_loadRequestReady = true;
+    }
+    if (!g_loadThread.joinable()) {
+        g_loadThread = std::thread(TrackLoaderThread);
+    }
+    g_loadWake.notify_all();
+    UpdateStatusBar();
+}
+
+// WM_TRACK_LOADED: swap the worker's result in (or drop it if superseded)
+void OnTrackLoaded() {
+    TrackLoadResult result;
+    {
+        std::lock_guard<std::mutex> lock(g_loadMutex);
+        if (!g_loadResultReady) return;
+        result = std::move(g_loadResult);
+        g_loadResultReady = false;
+    }
+    if (!g_loadPending || result.generation != g_loadGeneration ||
+        result.index < 0 || result.index >= static_cast<int>(g_playlist.size())) {
+        FreeTrackChain(result.chain);
+        return;
+    }
+    g_loadPending = false;
+
+    if (result.chain.output) {
+        g_isBusy = true;
+        g_currentTrack = result.index;
+        std::wstring path = g_playlist[result.index];
+        bool started = StartLoadedTrack(path.c_str(), result.chain, result.savedPos);
+        g_isBusy = false;
+        if (started) FinishTrackChange(g_loadAutoPlay);
+        return;
+    }
+
+    if (result.needsDirectLoad) {
+        PlayTrackNow(result.index, g_loadAutoPlay, MAX_LOAD_ATTEMPTS - result.attempts);
+        return;
+    }
+
+    // Nothing in range could be opened: stop the old track, as a direct load would have
+    g_currentTrack = result.index;
+    DiscardPreroll();
+    BASS_ChannelStop(g_outputStream);
+    ReleaseCurrentChain();
+    if (g_playlist.size() <= 1 && !result.error.empty()) {
+        MessageBoxW(GetMessageBoxOwner(), result.error.c_str(), APP_NAME, MB_ICONERROR);
+    }
+    UpdateWindowTitle();
+    UpdateStatusBar();
+}
+
+bool IsTrackLoadPending() {
+    return g_loadPending;
+}
+
+// WM_SEEK_TABLE_READY: the background scan may have been of the playing file
+void OnSeekTableReady() {
+    if (!g_sourceStream || g_isLiveStream || g_loadPending) return;
+    if (g_currentTrack < 0 || g_currentTrack >= static_cast<int>(g_playlist.size())) return;
+    const std::wstring& path = g_playlist[g_currentTrack];
+    if (IsURL(path.c_str())) return;
+    ApplySeekTable(g_sourceStream, path);
+}
+
+void PlayTrack(int index, bool autoPlay) {
+    // Consume the advance flag up front so it never leaks past an early return.
+    bool advancing = g_shuffleAdvance;
+    g_shuffleAdvance = false;
+
+    if (g_isBusy) return;  // Prevent re-entrancy
+    if (index < 0 || index >= static_cast<int>(g_playlist.size())) {
+        return;
+    }
+
+    // A direct selection or a freshly loaded playlist starts a new shuffle cycle;
+    // only Next/Prev advances keep the existing order.
+    if (!advancing) ResetShuffleOrder();
+
+    // Save position of current track before switching (while a load is pending,
+    // g_currentTrack already names the track that isn't playing yet)
+    if (g_fxStream && !g_loadPending && g_currentTrack >= 0 && g_currentTrack < static_cast<int>(g_playlist.size())) {
+        SaveFilePosition(g_playlist[g_currentTrack]);
+    }
+
+    // URLs, and a track that is already open (pre-rolled), switch immediately
+    const std::wstring& path = g_playlist[index];
+    bool prerolled = g_preroll.chain.output && g_preroll.index == index && g_preroll.path == path;
+    if (IsURL(path.c_str()) || prerolled) {
+        CancelTrackLoad(false);
+        PlayTrackNow(index, autoPlay, MAX_LOAD_ATTEMPTS);
+        return;
+    }
+    BeginTrackLoad(index, autoPlay);
+}
+
+// Make sure the shuffle cursor points at g_currentTrack, building a fresh order
+// (with the current track first) if there is none or the user jumped to a
+// track outside it.
+static void SyncShufflePos() {
+    if (!g_playlist.HasShuffle() || g_playlist.GetShuffleCursor() < 0) {
+        g_playlist.Shuffle(g_currentTrack);
+        return;
+    }
+    int pos = g_playlist.GetShufflePos(g_currentTrack);
+    if (pos < 0) {
+        g_playlist.Shuffle(g_currentTrack);
+    } else {
+        g_playlist.SetShuffleCursor(pos);
+    }
+}
+
+// Play next track
+void NextTrack(bool autoPlay) {
+    if (g_playlist.empty() || g_isBusy) return;
+
+    // Repeat one: restart current track
+    if (g_repeatMode == 1 && g_currentTrack >= 0 && g_currentTrack < static_cast<int>(g_playlist.size())) {
+        g_shuffleAdvance = true;
+        PlayTrack(g_currentTrack, autoPlay);
+        return;
+    }
+
+    int next;
+    if (g_shuffle && g_playlist.size() > 1) {
+        SyncShufflePos();
+        int pos = g_playlist.GetShuffleCursor() + 1;
+        if (pos >= g_playlist.GetShuffleLength()) {
+            // Whole playlist has played - reshuffle for the next cycle.
+            if (g_repeatMode == 2) {
+                // Avoid repeating the just-played track as the first of the new cycle.
+                g_playlist.Shuffle(-1, g_currentTrack);
+                pos = 0;
+            } else {
+                // End of playlist - stop.
+                Stop();
+                return;
+            }
+        }
+        g_playlist.SetShuffleCursor(pos);
+        next = g_playlist.GetShuffledIndex(pos);
+    } else {
+        next = g_currentTrack + 1;
+        if (next >= static_cast<int>(g_playlist.size())) {
+            // Repeat all: wrap to start
+            if (g_repeatMode == 2) {
+                next = 0;
             } else {
                 // End of playlist - stop
                 Stop();
@@ -1578,8 +2112,7 @@ void PrevTrack() {
         if (processor && processor->IsActive()) {
             double pos = processor->GetPosition();
             if (pos > 3.0) {
-                processor->SetPosition(0);
-                UpdateStatusBar();
+                SeekToPosition(0);  // Flushes the old position's audio and crossfade too
                 return;
             }
         }
@@ -1589,9 +2122,10 @@ void PrevTrack() {
     if (g_shuffle && g_playlist.size() > 1) {
         // Walk the shuffle order backward so Previous retraces the shuffled path.
         SyncShufflePos();
-        if (g_shufflePos > 0) {
-            g_shufflePos--;
-            prev = g_shuffleOrder[g_shufflePos];
+        int pos = g_playlist.GetShuffleCursor();
+        if (pos > 0) {
+            g_playlist.SetShuffleCursor(pos - 1);
+            prev = g_playlist.GetShuffledIndex(pos - 1);
         } else {
             prev = g_currentTrack;  // already at the start of the cycle
         }
@@ -1603,37 +2137,417 @@ void PrevTrack() {
     PlayTrack(prev);
 }
 
+// ============================================================================
+// Gapless pre-roll
+// ============================================================================
+
+// How far ahead of the end (in real time) the next track is opened
+static const double GAPLESS_PREROLL_SECONDS = 5.0;
+
+// Smart crossfade looks this far back from the end for the last audible sound,
+// and this far into the next track for the first
+static const double CROSSFADE_TAIL_SCAN_SECONDS = 10.0;
+static const double CROSSFADE_LEAD_SCAN_SECONDS = 10.0;
+
+// Current playback speed as heard: tempo and rate both speed up playback
+static double GetPlaybackSpeed() {
+    double speed = (1.0 + g_tempo / 100.0) * g_rate;
+    return speed > 0 ? speed : 1.0;
+}
+
+// The track NextTrack() will play after the current one, without advancing
+// anything. -1 when playback stops there, or when shuffle is about to draw a new
+// cycle (that order doesn't exist until NextTrack() builds it).
+static int PeekNextTrack() {
+    int n = static_cast<int>(g_playlist.size());
+    if (g_currentTrack < 0 || g_currentTrack >= n) return -1;
+
+    if (g_repeatMode == 1) return g_currentTrack;
+
+    if (g_shuffle && n > 1) {
+        SyncShufflePos();
+        return g_playlist.GetShuffledIndex(g_playlist.GetShuffleCursor() + 1);
+    }
+
+    int next = g_currentTrack + 1;
+    if (next >= n) return (g_repeatMode == 2) ? 0 : -1;
+    return next;
+}
+
+// Mixtime sync: the queued track starts within this mix block, so switch the
+// ReplayGain the volume stage uses now rather than when the UI catches up
+static void CALLBACK OnGaplessJoin(HSYNC handle, DWORD channel, DWORD data, void* user) {
+    // A crossfaded track goes on the mixer now and carries on from where the
+    // fade left it, so the join stays sample-accurate
+    HSTREAM incoming = TakeCrossfadeIncoming();
+    if (incoming) QueueOnOutput(incoming);
+
+    g_replayGainScale = g_joinReplayGainScale.load();
+    ApplyLegacyVolume();
+}
+
+static void DiscardPreroll() {
+    g_prerollGeneration++;  // Drop one the loader is still opening
+    if (g_preroll.joinSync && g_fxStream) {
+        BASS_Mixer_ChannelRemoveSync(g_fxStream, g_preroll.joinSync);
+    }
+    if (g_preroll.crossfade) CancelCrossfade();
+    ForgetStreamTags(g_preroll.chain.source);
+    FreeTrackChain(g_preroll.chain);
+    g_preroll = PrerolledTrack();
+}
+
+// Schedule a crossfade from the current track into the pre-rolled one, timed
+// from the current position, with smart mode's scans from the loader. Returns
+// false if the pair can't be blended (the caller falls back to a gapless join).
+static bool StartPrerollCrossfade(const PrerollResult& scans) {
+    TrackChain& chain = g_preroll.chain;
+    TempoProcessor* processor = GetTempoProcessor();
+    if (!processor || !processor->IsActive() || !CanCrossfade(g_fxStream, chain.output)) return false;
+
+    float freq = 0.0f;
+    BASS_ChannelGetAttribute(g_fxStream, BASS_ATTRIB_FREQ, &freq);
+    double speed = GetPlaybackSpeed();
+    double position = processor->GetPosition();
+    double end = processor->GetLength();
+
+    // Smart mode: finish the fade where the current track goes quiet, and start
+    // the next one at its first audible sound, so the overlap is all music
+    if (g_crossfadeSmart && scans.tailTo > 0) {
+        end = scans.tailFound ? scans.tailLast : scans.tailFrom;
+        if (scans.leadFound && scans.leadFirst > 0.05) {
+            chain.processor->SetPosition(scans.leadFirst - 0.01);  // Keep the attack
+        }
+    }
+
+    int64_t endFrame = static_cast<int64_t>((end - position) / speed * freq);
+    int64_t fadeFrames = static_cast<int64_t>(g_crossfadeMs / 1000.0 * freq);
+    if (fadeFrames > endFrame) fadeFrames = endFrame;
+    if (fadeFrames <= 0) return false;
+
+    // The volume stage keeps the current track's ReplayGain until the join, so
+    // the incoming track carries the difference itself
+    float inGain = g_replayGainScale > 0.0f ? g_preroll.replayGainScale / g_replayGainScale : 1.0f;
+    if (!ArmCrossfade(g_fxStream, chain.output, endFrame - fadeFrames, fadeFrames,
+                      static_cast<CrossfadeCurve>(g_crossfadeCurve), inGain)) {
+        return false;
+    }
+    g_preroll.crossfade = true;
+    g_preroll.speed = speed;
+    return true;
+}
+
+// Ask the loader to open the next track; OnPrerollLoaded() queues it behind
+// the current one (or crossfades into it)
+static void PrerollTrack(int index) {
+    const std::wstring& path = g_playlist[index];
+
+    PrerollRequest request;
+    request.generation = ++g_prerollGeneration;
+    request.path = path;
+    request.options = CurrentChainOptions();
+    request.outputChannels = GetOutputChannels();
+    request.restorePosition = index != g_currentTrack;  // Repeat-one always restarts from the top
+
+    // Smart crossfade: scan the end of the current track for its last sound,
+    // and the start of the next one for its first
+    TempoProcessor* processor = GetTempoProcessor();
+    if (g_crossfadeMs > 0 && g_crossfadeSmart && processor && processor->IsActive() &&
+        g_currentTrack >= 0 && g_currentTrack < static_cast<int>(g_playlist.size())) {
+        double end = processor->GetLength();
+        request.tailPath = g_playlist[g_currentTrack];
+        request.tailFrom = (std::max)(processor->GetPosition(), end - CROSSFADE_TAIL_SCAN_SECONDS);
+        request.tailTo = end;
+        request.leadTo = CROSSFADE_LEAD_SCAN_SECONDS;
+    }
+
+    g_preroll.index = index;
+    g_preroll.path = path;
+    g_preroll.opening = true;
+
+    {
+        std::lock_guard<std::mutex> lock(g_loadMutex);
+        g_prerollRequest = std::move(request);
+        g_prerollRequestReady = true;
+    }
+    if (!g_loadThread.joinable()) {
+        g_loadThread = std::thread(TrackLoaderThread);
+    }
+    g_loadWake.notify_all();
+}
+
+// WM_PREROLL_LOADED: queue the opened next track (or drop it if superseded)
+void OnPrerollLoaded() {
+    PrerollResult result;
+    {
+        std::lock_guard<std::mutex> lock(g_loadMutex);
+        if (!g_prerollResultReady) return;
+        result = std::move(g_prerollResult);
+        g_prerollResultReady = false;
+    }
+    if (!g_preroll.opening || result.generation != g_prerollGeneration) {
+        FreeTrackChain(result.chain);
+        return;
+    }
+
+    std::wstring path = g_preroll.path;
+    g_preroll.opening = false;
+    if (!result.chain.output || !g_fxStream) {
+        FreeTrackChain(result.chain);
+        g_preroll = PrerolledTrack();
+        g_prerollFailedPath = path;  // LoadFile() will report it when it gets there
+        return;
+    }
+
+    TrackChain& chain = result.chain;
+    ApplyRateToChain(chain.output, chain.originalFreq);
+    g_preroll.replayGainScale = ComputeReplayGainScale(chain.source, path);
+    g_preroll.chain = chain;
+    chain = TrackChain();
+
+    bool crossfading = g_crossfadeMs > 0 && StartPrerollCrossfade(result);
+    if (!crossfading && !QueueOnOutput(g_preroll.chain.output)) {
+        DiscardPreroll();
+        g_prerollFailedPath = path;
+        return;
+    }
+    g_joinReplayGainScale = g_preroll.replayGainScale;
+    g_preroll.joinSync = BASS_Mixer_ChannelSetSync(g_fxStream, BASS_SYNC_END | BASS_SYNC_MIXTIME, 0, OnGaplessJoin, nullptr);
+}
+
+// Called from LoadFile(): if path is the pre-rolled track, make it current.
+// The mixer has already switched to it (or does so as soon as the finished
+// track is removed), so effects and the output keep running untouched.
+static bool AdoptPrerolledTrack(const wchar_t* path) {
+    if (!g_preroll.chain.output || g_preroll.index != g_currentTrack || g_preroll.path != path) {
+        return false;
+    }
+
+    // Skipping ahead mid-crossfade: the next track isn't on the mixer yet
+    HSTREAM notJoined = 0;
+    if (g_preroll.crossfade) {
+        notJoined = TakeCrossfadeIncoming();
+        CancelCrossfade();
+    }
+
+    g_preroll.joinSync = 0;  // Goes away with the finished track's stream
+    ReleaseCurrentChain();
+    InstallTrackChain(g_preroll.chain);
+    g_replayGainScale = g_preroll.replayGainScale;
+    g_preroll = PrerolledTrack();
+    ApplyLegacyVolume();
+    if (notJoined) AttachToOutput(g_fxStream);
+
+    g_endSync = BASS_Mixer_ChannelSetSync(g_fxStream, BASS_SYNC_END, 0, OnTrackEnd, nullptr);
+    BASS_ChannelPlay(g_outputStream, FALSE);
+    ParseChapters(g_sourceStream);
+    return true;
+}
+
+// Periodic check (UI timer): open the next track shortly before the current one
+// ends, and keep an already pre-rolled one in step with playlist and settings
+void UpdateGaplessPreroll() {
+    if (g_isLoading || g_isBusy || g_loadPending) return;
+
+    bool wanted = (g_gapless || g_crossfadeMs > 0) && (g_autoAdvance || g_repeatMode != 0) &&
+                  g_fxStream && g_outputStream && !g_isLiveStream;
+    int next = wanted ? PeekNextTrack() : -1;
+
+    // Drop a pre-roll that's no longer what plays next (playlist edited,
+    // shuffle/repeat toggled, gapless turned off), or a crossfade whose timing
+    // a tempo/rate change has invalidated
+    if ((g_preroll.chain.output || g_preroll.opening) &&
+        (next < 0 || g_preroll.index != next || g_playlist[next] != g_preroll.path ||
+         (g_preroll.crossfade && g_preroll.speed != GetPlaybackSpeed()))) {
+        DiscardPreroll();
+    }
+    if (next < 0 || g_preroll.opening) return;
+
+    if (g_preroll.chain.output) {
+        // Tempo/pitch changes only reach the current processor
+        TempoProcessor* prerolled = g_preroll.chain.processor;
+        if (prerolled->GetTempo() != g_tempo) prerolled->SetTempo(g_tempo);
+        if (prerolled->GetPitch() != g_pitch) prerolled->SetPitch(g_pitch);
+        return;
+    }
+
+    const std::wstring& nextPath = g_playlist[next];
+    if (IsURL(nextPath.c_str()) || nextPath == g_prerollFailedPath) return;
+
+    TempoProcessor* processor = GetTempoProcessor();
+    if (!processor || !processor->IsActive()) return;
+    double length = processor->GetLength();
+    if (length <= 0) return;
+
+    // A crossfade (and smart mode's search for the last audible sound) starts
+    // further ahead of the end
+    double lead = GAPLESS_PREROLL_SECONDS;
+    if (g_crossfadeMs > 0) {
+        lead += g_crossfadeMs / 1000.0;
+        if (g_crossfadeSmart) lead += CROSSFADE_TAIL_SCAN_SECONDS;
+    }
+
+    // Time left as heard
+    double remaining = (length - processor->GetPosition()) / GetPlaybackSpeed();
+    if (remaining > lead) return;
+
+    PrerollTrack(next);
+}
+
+// Indexes of up to count tracks after the current one, in play order
+static std::vector<int> GetUpcomingTracks(int count) {
+    std::vector<int> order;
+    int n = static_cast<int>(g_playlist.size());
+    if (g_currentTrack < 0 || g_currentTrack >= n) return order;
+    if (g_shuffle && n > 1) {
+        // The next shuffle cycle doesn't exist yet, so stop at this one's end
+        SyncShufflePos();
+        int length = g_playlist.GetShuffleLength();
+        for (int i = g_playlist.GetShuffleCursor() + 1; i < length && static_cast<int>(order.size()) < count; i++) {
+            order.push_back(g_playlist.GetShuffledIndex(i));
+        }
+    } else {
+        for (int i = 1; i < n && static_cast<int>(order.size()) < count; i++) {
+            int index = g_currentTrack + i;
+            if (index >= n) {
+                if (g_repeatMode != 2) break;
+                index -= n;
+            }
+            order.push_back(index);
+        }
+    }
+    return order;
+}
+
+// Periodic check (UI timer): keep the start of the next few tracks in play
+// order in memory, so they open without waiting on a slow drive or share
+void UpdatePrefetch() {
+    static std::vector<std::wstring> s_listed;
+
+    std::vector<std::wstring> upcoming;
+    // Repeat one replays a track that's already open
+    if (g_prefetchTracks > 0 && g_prefetchMemoryMB > 0 && g_readAheadSeconds > 0 && g_repeatMode != 1) {
+        for (int index : GetUpcomingTracks(g_prefetchTracks)) {
+            const std::wstring& path = g_playlist[index];
+            // URLs, and MIDI files opened with sinc interpolation, don't go through the cache
+            if (IsURL(path.c_str()) || (g_midiSincInterp && IsMidiFile(path.c_str()))) continue;
+            upcoming.push_back(path);
+        }
+    }
+
+    if (upcoming == s_listed) return;
+    s_listed = upcoming;
+    SetPrefetchList(upcoming, g_readAheadSeconds, static_cast<size_t>(g_prefetchMemoryMB) * 1024 * 1024);
+}
+
+// Upcoming tracks the loudness analyzer takes before the library backlog
+static const int LOUDNESS_LOOKAHEAD_TRACKS = 20;
+
+// BASS CPU use (percent) above which loudness analysis waits
+static const float LOUDNESS_PAUSE_CPU = 40.0f;
+
+// Periodic check (UI timer): point the loudness analyzer at the tracks coming
+// up, and hold it back while a track loads or the mixer is working hard (or
+// ReplayGain, the only user of its results, is off)
+void UpdateLoudnessAnalysis() {
+    static std::vector<std::wstring> s_listed;
+
+    SetLoudnessAnalysisPaused(g_replayGainMode == 0 || g_loadPending || BASS_GetCPU() > LOUDNESS_PAUSE_CPU);
+
+    std::vector<std::wstring> upcoming;
+    if (g_replayGainMode != 0) {
+        for (int index : GetUpcomingTracks(LOUDNESS_LOOKAHEAD_TRACKS)) {
+            const std::wstring& path = g_playlist[index];
+            if (IsURL(path.c_str()) || IsMidiFile(path.c_str())) continue;
+            upcoming.push_back(path);
+        }
+    }
+
+    if (upcoming == s_listed) return;
+    s_listed = upcoming;
+    SetLoudnessPriorityList(upcoming);
+}
+
+// A checkpoint is skipped unless the position has moved at least this far
+// (seconds) since the last one, so a paused track costs no writes
+static const double CHECKPOINT_MIN_MOVE = 5.0;
+
+// Periodic check (UI timer): save the place in the current track every
+// g_checkpointSeconds, as SaveFilePosition does when switching tracks, so a
+// crash or power cut loses at most that much of a long file. Each save is a
+// single queued row write, replaced in the queue by a later one.
+void UpdatePositionCheckpoint() {
+    static ULONGLONG s_lastCheck = 0;
+    static std::wstring s_savedPath;
+    static double s_savedPosition = 0.0;
+
+    if (g_checkpointSeconds <= 0 || g_rememberPosMinutes == 0) return;
+    ULONGLONG now = GetTickCount64();
+    if (now - s_lastCheck < static_cast<ULONGLONG>(g_checkpointSeconds) * 1000) return;
+    s_lastCheck = now;
+
+    if (!g_fxStream || g_loadPending || g_isLiveStream) return;
+    if (g_currentTrack < 0 || g_currentTrack >= static_cast<int>(g_playlist.size())) return;
+    TempoProcessor* processor = GetTempoProcessor();
+    if (!processor || !processor->IsActive()) return;
+    if (processor->GetLength() < g_rememberPosMinutes * 60.0) return;
+
+    std::wstring path = g_playlist[g_currentTrack];
+    double position = processor->GetPosition();
+    if (path == s_savedPath && fabs(position - s_savedPosition) < CHECKPOINT_MIN_MOVE) return;
+
+    SaveFilePositionDB(path, position);
+    s_savedPath = path;
+    s_savedPosition = position;
+}
+
+double GetCheckpointBytesPerHour() {
+    double hours = (GetTickCount64() - g_startupTime) / 3600000.0;
+    if (hours <= 0.0) return 0.0;
+    return static_cast<double>(GetPositionBytesWrittenDB()) / hours;
+}
+
+void LogCheckpointWriteRate() {
+    wchar_t line[160];
+    swprintf(line, 160, L"[Checkpoint] Position saves wrote %.1f KB to the database (%.1f KB per hour)\n",
+             GetPositionBytesWrittenDB() / 1024.0, GetCheckpointBytesPerHour() / 1024.0);
+    OutputDebugStringW(line);
+}
+
 // Reinitialize BASS with a different device
 bool ReinitBass(int device) {
+    // A background load would be left holding streams from the old device;
+    // the requested track is reloaded below instead
+    bool loadWasPending = g_loadPending;
+    CancelTrackLoad(true);
+    StopSeekScanner();
+    StopLibraryScan();  // Resumed below, once BASS is back
+    StopLoudnessAnalysis();
+    StopUrlOpens();
+
     // Save current state
-    bool wasPlaying = g_fxStream && (BASS_ChannelIsActive(g_fxStream) == BASS_ACTIVE_PLAYING);
-    bool wasPaused = g_fxStream && (BASS_ChannelIsActive(g_fxStream) == BASS_ACTIVE_PAUSED);
+    bool wasPlaying = g_fxStream && (BASS_ChannelIsActive(g_outputStream) == BASS_ACTIVE_PLAYING);
+    bool wasPaused = g_fxStream && (BASS_ChannelIsActive(g_outputStream) == BASS_ACTIVE_PAUSED);
     double position = 0;
     std::wstring currentFile;
 
     if (g_fxStream) {
         // Use tempo processor to get position
         TempoProcessor* processor = GetTempoProcessor();
-        if (processor && processor->IsActive()) {
+        if (processor && processor->IsActive() && !loadWasPending) {
             position = processor->GetPosition();
         }
         if (g_currentTrack >= 0 && g_currentTrack < static_cast<int>(g_playlist.size())) {
             currentFile = g_playlist[g_currentTrack];
         }
-        // Remove DSP effects before freeing stream (resets handles to 0)
-        RemoveDSPEffects();
-        // Free tempo processor before freeing BASS
-        FreeTempoProcessor();
-        if (g_fxStream) {
-            BASS_StreamFree(g_fxStream);
-            g_fxStream = 0;
-        }
-        if (g_stream) {
-            BASS_StreamFree(g_stream);
-            g_stream = 0;
-        }
+        // Free the track (and tempo processor) before freeing BASS
+        DiscardPreroll();
+        ReleaseCurrentChain();
     }
 
+    // The mixer runs at the old device's rate; LoadFile() creates a new one and
+    // re-attaches the effects to it
+    FreeOutputMixer();
     BASS_Free();
 
     if (!BASS_Init(device, 44100, 0, g_hwnd, nullptr)) {
@@ -1650,6 +2564,8 @@ bool ReinitBass(int device) {
     g_selectedDevice = device;
     // Update device name from the actual device
     g_selectedDeviceName = GetDeviceName(device);
+    StartLibraryScan();
+    StartLoudnessAnalysis();
 
     // Restore playback state if we had a file loaded
     if (!currentFile.empty()) {
@@ -1657,16 +2573,16 @@ bool ReinitBass(int device) {
         if (g_fxStream) {
             // Use tempo processor to set position
             TempoProcessor* processor = GetTempoProcessor();
-            if (processor && processor->IsActive()) {
+            if (processor && processor->IsActive() && !loadWasPending) {
                 processor->SetPosition(position);
             }
             // LoadFile() auto-starts playback, so we need to pause/stop if we weren't playing
             if (!wasPlaying) {
                 if (wasPaused) {
-                    BASS_ChannelPause(g_fxStream);
+                    BASS_ChannelPause(g_outputStream);
                 } else {
                     // Was stopped - pause the stream (stop would reset position)
-                    BASS_ChannelPause(g_fxStream);
+                    BASS_ChannelPause(g_outputStream);
                 }
             }
             UpdateWindowTitle();
@@ -1925,6 +2841,7 @@ static const char* GetID3v2FrameId(const char* tagName) {
     if (_stricmp(tagName, "TITLE") == 0) return "TIT2";
     if (_stricmp(tagName, "ARTIST") == 0) return "TPE1";
     if (_stricmp(tagName, "ALBUM") == 0) return "TALB";
+    if (_stricmp(tagName, "ALBUMARTIST") == 0) return "TPE2";
     if (_stricmp(tagName, "YEAR") == 0) return "TYER";
     if (_stricmp(tagName, "DATE") == 0) return "TDRC";
     if (_stricmp(tagName, "TRACK") == 0) return "TRCK";
@@ -2246,54 +3163,111 @@ static int GetStreamBitrate(HSTREAM stream) {
 // Get the underlying stream (before tempo processing) for tag reading
 static HSTREAM GetTagStream() {
     // For tag reading, we need the original stream, not the tempo stream
-    // g_stream is the original file stream, g_fxStream is the tempo-processed one
-    return g_stream ? g_stream : g_fxStream;
+    // g_sourceStream is the original file stream, g_fxStream is the processed output
+    return g_sourceStream ? g_sourceStream : g_fxStream;
 }
 
-// Helper to speak UTF-8 text with proper Unicode support
-static void SpeakUtf8(const std::string& text) {
-    SpeakW(Utf8ToWide(text));
+// Parsed tags of the two most recently queried streams (the playing track and
+// a pre-rolled next track), so queries from the UI don't re-walk the tag blocks.
+// UI thread only, like everything that reads or forgets them.
+static StreamTags g_tagCache[2];
+static int g_tagCacheLast = 0;
+
+// Parse everything the player shows or uses from a stream's tags, in one go
+void ReadStreamTags(HSTREAM stream, StreamTags& tags) {
+    tags = StreamTags();
+    tags.stream = stream;
+    tags.streamTitle = Utf8ToWide(GetStreamTitle(stream));
+    tags.station = Utf8ToWide(GetStationName(stream));
+
+    std::string title = GetMetadataTag(stream, "TITLE");
+    std::string artist = GetMetadataTag(stream, "ARTIST");
+    std::string album = GetMetadataTag(stream, "ALBUM");
+    std::string albumArtist = GetMetadataTag(stream, "ALBUMARTIST");
+    if (albumArtist.empty()) albumArtist = GetMetadataTag(stream, "ALBUM ARTIST");
+    std::string year = GetMetadataTag(stream, "DATE");
+    if (year.empty()) year = GetMetadataTag(stream, "YEAR");
+    std::string track = GetMetadataTag(stream, "TRACKNUMBER");
+    if (track.empty()) track = GetMetadataTag(stream, "TRACK");
+    std::string genre = GetMetadataTag(stream, "GENRE");
+    std::string comment = GetMetadataTag(stream, "COMMENT");
+    if (comment.empty()) comment = GetMetadataTag(stream, "DESCRIPTION");
+
+    // Fill the gaps from ID3v1
+    const TAG_ID3* id3 = (const TAG_ID3*)BASS_ChannelGetTags(stream, BASS_TAG_ID3);
+    if (id3) {
+        // ID3v1.1 stores the track number in the last byte of a 28-char comment
+        bool v11 = id3->comment[28] == '\0' && id3->comment[29] != 0;
+        if (title.empty()) title = GetTrimmedTag(id3->title, 30);
+        if (artist.empty()) artist = GetTrimmedTag(id3->artist, 30);
+        if (album.empty()) album = GetTrimmedTag(id3->album, 30);
+        if (year.empty()) year = GetTrimmedTag(id3->year, 4);
+        if (track.empty() && v11) {
+            int trackNum = (unsigned char)id3->comment[29];
+            if (trackNum > 0) track = std::to_string(trackNum);
+        }
+        if (genre.empty() && id3->genre < g_id3GenreCount) genre = g_id3Genres[id3->genre];
+        if (comment.empty()) comment = GetTrimmedTag(id3->comment, v11 ? 28 : 30);
+    }
+
+    tags.title = Utf8ToWide(title);
+    tags.artist = Utf8ToWide(artist);
+    tags.album = Utf8ToWide(album);
+    tags.albumArtist = Utf8ToWide(albumArtist);
+    tags.year = Utf8ToWide(year);
+    tags.track = Utf8ToWide(track);
+    tags.genre = Utf8ToWide(genre);
+    tags.comment = Utf8ToWide(comment);
+
+    tags.trackGain = GetReplayGainTag(stream, "REPLAYGAIN_TRACK_GAIN");
+    tags.trackPeak = GetReplayGainTag(stream, "REPLAYGAIN_TRACK_PEAK");
+    tags.albumGain = GetReplayGainTag(stream, "REPLAYGAIN_ALBUM_GAIN");
+    tags.albumPeak = GetReplayGainTag(stream, "REPLAYGAIN_ALBUM_PEAK");
 }
 
-void SpeakTagTitle() {
-    HSTREAM stream = GetTagStream();
-    if (!stream) {
-        Speak("Nothing playing");
-        return;
+// Get a stream's parsed tags, parsing them on first use
+static const StreamTags& GetStreamTags(HSTREAM stream) {
+    for (int i = 0; i < 2; i++) {
+        if (g_tagCache[i].stream == stream) {
+            g_tagCacheLast = i;
+            return g_tagCache[i];
+        }
     }
+    // Replace the entry used less recently
+    int slot = 1 - g_tagCacheLast;
+    ReadStreamTags(stream, g_tagCache[slot]);
+    g_tagCacheLast = slot;
+    return g_tagCache[slot];
+}
 
-    // For streams, first check if there's a full stream title (often "Artist - Title")
-    std::string streamTitle = GetStreamTitle(stream);
-    if (!streamTitle.empty()) {
-        SpeakUtf8(streamTitle);
-        return;
+// Drop a stream's parsed tags (its metadata changed)
+static void ForgetStreamTags(HSTREAM stream) {
+    for (int i = 0; i < 2; i++) {
+        if (g_tagCache[i].stream == stream) g_tagCache[i] = StreamTags();
     }
+}
 
-    std::string title = GetMetadataTag(stream, "TITLE");
-    std::string artist = GetMetadataTag(stream, "ARTIST");
+// Display title: the stream title, else "Artist - Title" or whichever is known
+static std::wstring FormatTagTitle(const StreamTags& tags) {
+    if (!tags.streamTitle.empty()) return tags.streamTitle;
+    if (!tags.artist.empty() && !tags.title.empty()) return tags.artist + L" - " + tags.title;
+    if (!tags.title.empty()) return tags.title;
+    return tags.artist;
+}
 
-    // Try ID3v1 if nothing found
-    if (title.empty() || artist.empty()) {
-        const TAG_ID3* id3 = (const TAG_ID3*)BASS_ChannelGetTags(stream, BASS_TAG_ID3);
-        if (id3) {
-            if (title.empty()) {
-                title = GetTrimmedTag(id3->title, 30);
-            }
-            if (artist.empty()) {
-                artist = GetTrimmedTag(id3->artist, 30);
-            }
-        }
+void SpeakTagTitle() {
+    HSTREAM stream = GetTagStream();
+    if (!stream) {
+        Speak("Nothing playing");
+        return;
     }
 
-    if (!artist.empty() && !title.empty()) {
-        SpeakUtf8(artist + " - " + title);
-    } else if (!title.empty()) {
-        SpeakUtf8(title);
-    } else if (!artist.empty()) {
-        SpeakUtf8(artist);
+    std::wstring title = FormatTagTitle(GetStreamTags(stream));
+    if (!title.empty()) {
+        SpeakW(title);
     } else if (g_currentTrack >= 0 && g_currentTrack < static_cast<int>(g_playlist.size())) {
         // No usable metadata - fall back to the filename
-        SpeakW(GetFileName(g_playlist[g_currentTrack]));
+        SpeakW(g_playlist.GetName(g_currentTrack));
     } else {
         Speak("No title");
     }
@@ -2306,18 +3280,9 @@ void SpeakTagArtist() {
         return;
     }
 
-    std::string artist = GetMetadataTag(stream, "ARTIST");
-
-    // Try ID3v1 if nothing found
-    if (artist.empty()) {
-        const TAG_ID3* id3 = (const TAG_ID3*)BASS_ChannelGetTags(stream, BASS_TAG_ID3);
-        if (id3) {
-            artist = GetTrimmedTag(id3->artist, 30);
-        }
-    }
-
-    if (!artist.empty()) {
-        SpeakUtf8("Artist: " + artist);
+    const StreamTags& tags = GetStreamTags(stream);
+    if (!tags.artist.empty()) {
+        SpeakW(L"Artist: " + tags.artist);
     } else {
         Speak("No artist");
     }
@@ -2330,27 +3295,12 @@ void SpeakTagAlbum() {
         return;
     }
 
-    std::string album = GetMetadataTag(stream, "ALBUM");
-
-    // Try ID3v1 if nothing found
-    if (album.empty()) {
-        const TAG_ID3* id3 = (const TAG_ID3*)BASS_ChannelGetTags(stream, BASS_TAG_ID3);
-        if (id3) {
-            album = GetTrimmedTag(id3->album, 30);
-        }
-    }
-
-    // For streams, fall back to station name
-    if (album.empty()) {
-        std::string station = GetStationName(stream);
-        if (!station.empty()) {
-            SpeakUtf8("Station: " + station);
-            return;
-        }
-    }
-
-    if (!album.empty()) {
-        SpeakUtf8("Album: " + album);
+    const StreamTags& tags = GetStreamTags(stream);
+    if (!tags.album.empty()) {
+        SpeakW(L"Album: " + tags.album);
+    } else if (!tags.station.empty()) {
+        // For streams, fall back to station name
+        SpeakW(L"Station: " + tags.station);
     } else {
         Speak("No album");
     }
@@ -2363,19 +3313,9 @@ void SpeakTagYear() {
         return;
     }
 
-    std::string year = GetMetadataTag(stream, "DATE");
-    if (year.empty()) year = GetMetadataTag(stream, "YEAR");
-
-    // Try ID3v1 if nothing found
-    if (year.empty()) {
-        const TAG_ID3* id3 = (const TAG_ID3*)BASS_ChannelGetTags(stream, BASS_TAG_ID3);
-        if (id3) {
-            year = GetTrimmedTag(id3->year, 4);
-        }
-    }
-
-    if (!year.empty()) {
-        SpeakUtf8("Year: " + year);
+    const StreamTags& tags = GetStreamTags(stream);
+    if (!tags.year.empty()) {
+        SpeakW(L"Year: " + tags.year);
     } else {
         Speak("No year");
     }
@@ -2388,23 +3328,9 @@ void SpeakTagTrack() {
         return;
     }
 
-    std::string track = GetMetadataTag(stream, "TRACKNUMBER");
-    if (track.empty()) track = GetMetadataTag(stream, "TRACK");
-
-    // Try ID3v1.1 track number (stored in comment field)
-    if (track.empty()) {
-        const TAG_ID3* id3 = (const TAG_ID3*)BASS_ChannelGetTags(stream, BASS_TAG_ID3);
-        if (id3 && id3->comment[28] == '\0' && id3->comment[29] != 0) {
-            // ID3v1.1 format: comment[28] is 0, comment[29] is track number
-            int trackNum = (unsigned char)id3->comment[29];
-            if (trackNum > 0) {
-                track = std::to_string(trackNum);
-            }
-        }
-    }
-
-    if (!track.empty()) {
-        SpeakUtf8("Track: " + track);
+    const StreamTags& tags = GetStreamTags(stream);
+    if (!tags.track.empty()) {
+        SpeakW(L"Track: " + tags.track);
     } else {
         Speak("No track number");
     }
@@ -2417,18 +3343,9 @@ void SpeakTagGenre() {
         return;
     }
 
-    std::string genre = GetMetadataTag(stream, "GENRE");
-
-    // Try ID3v1 if nothing found
-    if (genre.empty()) {
-        const TAG_ID3* id3 = (const TAG_ID3*)BASS_ChannelGetTags(stream, BASS_TAG_ID3);
-        if (id3 && id3->genre < g_id3GenreCount) {
-            genre = g_id3Genres[id3->genre];
-        }
-    }
-
-    if (!genre.empty()) {
-        SpeakUtf8("Genre: " + genre);
+    const StreamTags& tags = GetStreamTags(stream);
+    if (!tags.genre.empty()) {
+        SpeakW(L"Genre: " + tags.genre);
     } else {
         Speak("No genre");
     }
@@ -2441,24 +3358,9 @@ void SpeakTagComment() {
         return;
     }
 
-    std::string comment = GetMetadataTag(stream, "COMMENT");
-    if (comment.empty()) comment = GetMetadataTag(stream, "DESCRIPTION");
-
-    // Try ID3v1 if nothing found
-    if (comment.empty()) {
-        const TAG_ID3* id3 = (const TAG_ID3*)BASS_ChannelGetTags(stream, BASS_TAG_ID3);
-        if (id3) {
-            // Check for ID3v1.1 (comment is only 28 chars if track is present)
-            if (id3->comment[28] == '\0' && id3->comment[29] != 0) {
-                comment = GetTrimmedTag(id3->comment, 28);
-            } else {
-                comment = GetTrimmedTag(id3->comment, 30);
-            }
-        }
-    }
-
-    if (!comment.empty()) {
-        SpeakUtf8("Comment: " + comment);
+    const StreamTags& tags = GetStreamTags(stream);
+    if (!tags.comment.empty()) {
+        SpeakW(L"Comment: " + tags.comment);
     } else {
         Speak("No comment");
     }
@@ -2476,7 +3378,7 @@ void SpeakTagBitrate() {
         return;
     }
 
-    HSTREAM sourceStream = g_stream ? g_stream : g_fxStream;
+    HSTREAM sourceStream = g_sourceStream ? g_sourceStream : g_fxStream;
 
     // Get bitrate if available (for compressed formats)
     float bitrate = 0;
@@ -2597,122 +3499,58 @@ std::wstring GetTagTitle() {
     HSTREAM stream = GetTagStream();
     if (!stream) return L"Nothing playing";
 
-    std::string streamTitle = GetStreamTitle(stream);
-    if (!streamTitle.empty()) {
-        return Utf8ToWide(streamTitle);
-    }
-
-    std::string title = GetMetadataTag(stream, "TITLE");
-    std::string artist = GetMetadataTag(stream, "ARTIST");
-
-    if (title.empty() || artist.empty()) {
-        const TAG_ID3* id3 = (const TAG_ID3*)BASS_ChannelGetTags(stream, BASS_TAG_ID3);
-        if (id3) {
-            if (title.empty()) title = GetTrimmedTag(id3->title, 30);
-            if (artist.empty()) artist = GetTrimmedTag(id3->artist, 30);
-        }
-    }
-
-    if (!artist.empty() && !title.empty()) {
-        return Utf8ToWide(artist + " - " + title);
-    } else if (!title.empty()) {
-        return Utf8ToWide(title);
-    } else if (!artist.empty()) {
-        return Utf8ToWide(artist);
-    }
-    return L"No title";
+    std::wstring title = FormatTagTitle(GetStreamTags(stream));
+    return title.empty() ? L"No title" : title;
 }
 
 std::wstring GetTagArtist() {
     HSTREAM stream = GetTagStream();
     if (!stream) return L"Nothing playing";
 
-    std::string artist = GetMetadataTag(stream, "ARTIST");
-    if (artist.empty()) {
-        const TAG_ID3* id3 = (const TAG_ID3*)BASS_ChannelGetTags(stream, BASS_TAG_ID3);
-        if (id3) artist = GetTrimmedTag(id3->artist, 30);
-    }
-    return artist.empty() ? L"No artist" : Utf8ToWide(artist);
+    const StreamTags& tags = GetStreamTags(stream);
+    return tags.artist.empty() ? L"No artist" : tags.artist;
 }
 
 std::wstring GetTagAlbum() {
     HSTREAM stream = GetTagStream();
     if (!stream) return L"Nothing playing";
 
-    std::string album = GetMetadataTag(stream, "ALBUM");
-    if (album.empty()) {
-        const TAG_ID3* id3 = (const TAG_ID3*)BASS_ChannelGetTags(stream, BASS_TAG_ID3);
-        if (id3) album = GetTrimmedTag(id3->album, 30);
-    }
-    if (album.empty()) {
-        std::string station = GetStationName(stream);
-        if (!station.empty()) return Utf8ToWide(station);
-    }
-    return album.empty() ? L"No album" : Utf8ToWide(album);
+    const StreamTags& tags = GetStreamTags(stream);
+    if (!tags.album.empty()) return tags.album;
+    if (!tags.station.empty()) return tags.station;
+    return L"No album";
 }
 
 std::wstring GetTagYear() {
     HSTREAM stream = GetTagStream();
     if (!stream) return L"Nothing playing";
 
-    std::string year = GetMetadataTag(stream, "DATE");
-    if (year.empty()) year = GetMetadataTag(stream, "YEAR");
-    if (year.empty()) {
-        const TAG_ID3* id3 = (const TAG_ID3*)BASS_ChannelGetTags(stream, BASS_TAG_ID3);
-        if (id3) year = GetTrimmedTag(id3->year, 4);
-    }
-    return year.empty() ? L"No year" : Utf8ToWide(year);
+    const StreamTags& tags = GetStreamTags(stream);
+    return tags.year.empty() ? L"No year" : tags.year;
 }
 
 std::wstring GetTagTrack() {
     HSTREAM stream = GetTagStream();
     if (!stream) return L"Nothing playing";
 
-    std::string track = GetMetadataTag(stream, "TRACKNUMBER");
-    if (track.empty()) track = GetMetadataTag(stream, "TRACK");
-    if (track.empty()) {
-        // Try ID3v1.1 track number (stored in comment field)
-        const TAG_ID3* id3 = (const TAG_ID3*)BASS_ChannelGetTags(stream, BASS_TAG_ID3);
-        if (id3 && id3->comment[28] == '\0' && id3->comment[29] != 0) {
-            int trackNum = (unsigned char)id3->comment[29];
-            if (trackNum > 0) track = std::to_string(trackNum);
-        }
-    }
-    return track.empty() ? L"No track" : Utf8ToWide(track);
+    const StreamTags& tags = GetStreamTags(stream);
+    return tags.track.empty() ? L"No track" : tags.track;
 }
 
 std::wstring GetTagGenre() {
     HSTREAM stream = GetTagStream();
     if (!stream) return L"Nothing playing";
 
-    std::string genre = GetMetadataTag(stream, "GENRE");
-    if (genre.empty()) {
-        const TAG_ID3* id3 = (const TAG_ID3*)BASS_ChannelGetTags(stream, BASS_TAG_ID3);
-        if (id3 && id3->genre < 192) {
-            // ID3v1 genre lookup (simplified - first few common ones)
-            static const char* genres[] = {
-                "Blues", "Classic Rock", "Country", "Dance", "Disco", "Funk", "Grunge",
-                "Hip-Hop", "Jazz", "Metal", "New Age", "Oldies", "Other", "Pop", "R&B",
-                "Rap", "Reggae", "Rock", "Techno", "Industrial"
-            };
-            if (id3->genre < 20) genre = genres[id3->genre];
-            else genre = std::to_string(id3->genre);
-        }
-    }
-    return genre.empty() ? L"No genre" : Utf8ToWide(genre);
+    const StreamTags& tags = GetStreamTags(stream);
+    return tags.genre.empty() ? L"No genre" : tags.genre;
 }
 
 std::wstring GetTagComment() {
     HSTREAM stream = GetTagStream();
     if (!stream) return L"Nothing playing";
 
-    std::string comment = GetMetadataTag(stream, "COMMENT");
-    if (comment.empty()) comment = GetMetadataTag(stream, "DESCRIPTION");
-    if (comment.empty()) {
-        const TAG_ID3* id3 = (const TAG_ID3*)BASS_ChannelGetTags(stream, BASS_TAG_ID3);
-        if (id3) comment = GetTrimmedTag(id3->comment, 30);
-    }
-    return comment.empty() ? L"No comment" : Utf8ToWide(comment);
+    const StreamTags& tags = GetStreamTags(stream);
+    return tags.comment.empty() ? L"No comment" : tags.comment;
 }
 
 std::wstring GetTagBitrate() {
@@ -2844,7 +3682,7 @@ void ToggleRecording() {
 
     // Get stream info for encoder setup
     BASS_CHANNELINFO info;
-    if (!BASS_ChannelGetInfo(g_fxStream, &info)) {
+    if (!BASS_ChannelGetInfo(g_outputStream, &info)) {
         Speak("Cannot get stream info");
         return;
     }
@@ -2857,14 +3695,14 @@ void ToggleRecording() {
     switch (g_recordFormat) {
         case 0: {
             // WAV - use BASS_Encode_StartPCMFile for direct WAV output
-            g_encoder = BASS_Encode_StartPCMFile(g_fxStream, wavFlags, fullPath.c_str());
+            g_encoder = BASS_Encode_StartPCMFile(g_outputStream, wavFlags, fullPath.c_str());
             break;
         }
         case 1: {
             // MP3 - use bassenc_mp3
             wchar_t options[64];
             swprintf(options, 64, L"--preset cbr %d", g_recordBitrate);
-            g_encoder = BASS_Encode_MP3_StartFile(g_fxStream, options, BASS_ENCODE_AUTOFREE, fullPath.c_str());
+            g_encoder = BASS_Encode_MP3_StartFile(g_outputStream, options, BASS_ENCODE_AUTOFREE, fullPath.c_str());
             if (!g_encoder) {
                 // Fall back to WAV if MP3 encoding fails
                 MessageBoxW(GetMessageBoxOwner(), L"MP3 encoding failed.\nFalling back to WAV format.",
@@ -2872,7 +3710,7 @@ void ToggleRecording() {
                 fullPath = outputPath;
                 if (!fullPath.empty() && fullPath.back() != L'\\') fullPath += L'\\';
                 fullPath += GenerateRecordingFilename();
-                g_encoder = BASS_Encode_StartPCMFile(g_fxStream, wavFlags, fullPath.c_str());
+                g_encoder = BASS_Encode_StartPCMFile(g_outputStream, wavFlags, fullPath.c_str());
             }
             break;
         }
@@ -2880,7 +3718,7 @@ void ToggleRecording() {
             // OGG - use bassenc_ogg
             wchar_t options[64];
             swprintf(options, 64, L"--bitrate %d", g_recordBitrate);
-            g_encoder = BASS_Encode_OGG_StartFile(g_fxStream, options, BASS_ENCODE_AUTOFREE, fullPath.c_str());
+            g_encoder = BASS_Encode_OGG_StartFile(g_outputStream, options, BASS_ENCODE_AUTOFREE, fullPath.c_str());
             if (!g_encoder) {
                 // Fall back to WAV if OGG encoding fails
                 MessageBoxW(GetMessageBoxOwner(), L"OGG encoding failed.\nFalling back to WAV format.",
@@ -2888,13 +3726,13 @@ void ToggleRecording() {
                 fullPath = outputPath;
                 if (!fullPath.empty() && fullPath.back() != L'\\') fullPath += L'\\';
                 fullPath += GenerateRecordingFilename();
-                g_encoder = BASS_Encode_StartPCMFile(g_fxStream, wavFlags, fullPath.c_str());
+                g_encoder = BASS_Encode_StartPCMFile(g_outputStream, wavFlags, fullPath.c_str());
             }
             break;
         }
         case 3: {
             // FLAC - use bassenc_flac (also needs FP conversion)
-            g_encoder = BASS_Encode_FLAC_StartFile(g_fxStream, nullptr, wavFlags, fullPath.c_str());
+            g_encoder = BASS_Encode_FLAC_StartFile(g_outputStream, nullptr, wavFlags, fullPath.c_str());
             if (!g_encoder) {
                 // Fall back to WAV if FLAC encoding fails
                 MessageBoxW(GetMessageBoxOwner(), L"FLAC encoding failed.\nFalling back to WAV format.",
@@ -2902,7 +3740,7 @@ void ToggleRecording() {
                 fullPath = outputPath;
                 if (!fullPath.empty() && fullPath.back() != L'\\') fullPath += L'\\';
                 fullPath += GenerateRecordingFilename();
-                g_encoder = BASS_Encode_StartPCMFile(g_fxStream, wavFlags, fullPath.c_str());
+                g_encoder = BASS_Encode_StartPCMFile(g_outputStream, wavFlags, fullPath.c_str());
             }
             break;
         }
@@ -0,0 +1,377 @@
+#include "playlist.h"
+#include <algorithm>
+
+static const std::wstring g_emptyString;
+
+Playlist::Playlist()
+    : m_root(-1), m_idBase(0), m_random(std::random_device()()), m_revision(0), m_shuffleCursor(-1) {
+}
+
+void Playlist::clear() {
+    m_idBase += static_cast<PlaylistEntryId>(m_nodes.size());
+    m_nodes.clear();
+    m_root = -1;
+    m_folders.clear();
+    m_folderIndex.clear();
+    m_shuffle.clear();
+    m_shuffleCursor = -1;
+    m_revision++;
+}
+
+// Tree maintenance
+
+void Playlist::Update(int node) {
+    Node& n = m_nodes[node];
+    n.size = 1 + NodeSize(n.left) + NodeSize(n.right);
+    if (n.left >= 0) m_nodes[n.left].parent = node;
+    if (n.right >= 0) m_nodes[n.right].parent = node;
+}
+
+// Split a subtree into its first count entries and the rest
+void Playlist::Split(int node, int count, int& left, int& right) {
+    if (node < 0) {
+        left = right = -1;
+        return;
+    }
+    if (NodeSize(m_nodes[node].left) >= count) {
+        int subLeft, subRight;
+        Split(m_nodes[node].left, count, subLeft, subRight);
+        m_nodes[node].left = subRight;
+        Update(node);
+        left = subLeft;
+        right = node;
+    } else {
+        int subLeft, subRight;
+        Split(m_nodes[node].right, count - NodeSize(m_nodes[node].left) - 1, subLeft, subRight);
+        m_nodes[node].right = subLeft;
+        Update(node);
+        left = node;
+        right = subRight;
+    }
+    if (left >= 0) m_nodes[left].parent = -1;
+    if (right >= 0) m_nodes[right].parent = -1;
+}
+
+// Join two subtrees, all of left's entries before right's
+int Playlist::Merge(int left, int right) {
+    if (left < 0) return right;
+    if (right < 0) return left;
+    if (m_nodes[left].priority > m_nodes[right].priority) {
+        int merged = Merge(m_nodes[left].right, right);
+        m_nodes[left].right = merged;
+        Update(left);
+        m_nodes[left].parent = -1;
+        return left;
+    }
+    int merged = Merge(left, m_nodes[right].left);
+    m_nodes[right].left = merged;
+    Update(right);
+    m_nodes[right].parent = -1;
+    return right;
+}
+
+int Playlist::NodeAt(size_t index) const {
+    int node = m_root;
+    while (node >= 0) {
+        size_t leftSize = static_cast<size_t>(NodeSize(m_nodes[node].left));
+        if (index < leftSize) {
+            node = m_nodes[node].left;
+        } else if (index == leftSize) {
+            return node;
+        } else {
+            index -= leftSize + 1;
+            node = m_nodes[node].right;
+        }
+    }
+    return -1;
+}
+
+int Playlist::IndexOfNode(int node) const {
+    int index = NodeSize(m_nodes[node].left);
+    while (m_nodes[node].parent >= 0) {
+        int parent = m_nodes[node].parent;
+        if (m_nodes[parent].right == node) index += NodeSize(m_nodes[parent].left) + 1;
+        node = parent;
+    }
+    return index;
+}
+
+// Build a tree over nodes already in order in linear time (a Cartesian tree
+// on their priorities), so loading a long playlist doesn't pay for n inserts
+int Playlist::BuildTree(int first, int count) {
+    std::vector<int> spine;
+    for (int i = first; i < first + count; i++) {
+        int last = -1;
+        while (!spine.empty() && m_nodes[spine.back()].priority < m_nodes[i].priority) {
+            last = spine.back();
+            spine.pop_back();
+        }
+        m_nodes[i].left = last;
+        if (!spine.empty()) m_nodes[spine.back()].right = i;
+        spine.push_back(i);
+    }
+    if (spine.empty()) return -1;
+    int root = spine[0];
+
+    // Sizes bottom up: reversed preorder visits children before parents
+    std::vector<int> order;
+    order.reserve(count);
+    std::vector<int> pending(1, root);
+    while (!pending.empty()) {
+        int node = pending.back();
+        pending.pop_back();
+        order.push_back(node);
+        if (m_nodes[node].left >= 0) pending.push_back(m_nodes[node].left);
+        if (m_nodes[node].right >= 0) pending.push_back(m_nodes[node].right);
+    }
+    for (auto it = order.rbegin(); it != order.rend(); ++it) Update(*it);
+    m_nodes[root].parent = -1;
+    return root;
+}
+
+// Entry storage
+
+uint32_t Playlist::InternFolder(const std::wstring& folder) {
+    auto found = m_folderIndex.find(folder);
+    if (found != m_folderIndex.end()) return found->second;
+    uint32_t index = static_cast<uint32_t>(m_folders.size());
+    m_folders.push_back(folder);
+    m_folderIndex.emplace(folder, index);
+    return index;
+}
+
+int Playlist::NewNode(const std::wstring& path) {
+    Node node;
+    size_t pos = path.find_last_of(L"\\/");
+    if (pos != std::wstring::npos) {
+        node.folder = InternFolder(path.substr(0, pos + 1));
+        node.name = path.substr(pos + 1);
+    } else {
+        node.folder = InternFolder(std::wstring());
+        node.name = path;
+    }
+    node.priority = static_cast<uint32_t>(m_random());
+    node.alive = true;
+    m_nodes.push_back(std::move(node));
+    return static_cast<int>(m_nodes.size()) - 1;
+}
+
+void Playlist::FreeNode(int node) {
+    Node& n = m_nodes[node];
+    n.alive = false;
+    n.left = n.right = n.parent = -1;
+    std::wstring().swap(n.name);
+}
+
+// Access
+
+std::wstring Playlist::operator[](size_t index) const {
+    int node = NodeAt(index);
+    if (node < 0) return std::wstring();
+    return m_folders[m_nodes[node].folder] + m_nodes[node].name;
+}
+
+const std::wstring& Playlist::GetName(size_t index) const {
+    int node = NodeAt(index);
+    return node < 0 ? g_emptyString : m_nodes[node].name;
+}
+
+const std::wstring& Playlist::GetFolder(size_t index) const {
+    int node = NodeAt(index);
+    return node < 0 ? g_emptyString : m_folders[m_nodes[node].folder];
+}
+
+PlaylistEntryId Playlist::GetId(int index) const {
+    if (index < 0) return 0;
+    int node = NodeAt(static_cast<size_t>(index));
+    return node < 0 ? 0 : m_idBase + static_cast<PlaylistEntryId>(node) + 1;
+}
+
+int Playlist::IndexOf(PlaylistEntryId id) const {
+    if (id <= m_idBase) return -1;
+    size_t node = id - m_idBase - 1;
+    if (node >= m_nodes.size() || !m_nodes[node].alive) return -1;
+    return IndexOfNode(static_cast<int>(node));
+}
+
+bool Playlist::Contains(PlaylistEntryId id) const {
+    if (id <= m_idBase) return false;
+    size_t node = id - m_idBase - 1;
+    return node < m_nodes.size() && m_nodes[node].alive;
+}
+
+const std::wstring& Playlist::GetNameById(PlaylistEntryId id) const {
+    if (!Contains(id)) return g_emptyString;
+    return m_nodes[id - m_idBase - 1].name;
+}
+
+std::wstring Playlist::GetPathById(PlaylistEntryId id) const {
+    if (!Contains(id)) return std::wstring();
+    const Node& n = m_nodes[id - m_idBase - 1];
+    return m_folders[n.folder] + n.name;
+}
+
+std::vector<PlaylistEntryId> Playlist::GetIds() const {
+    std::vector<PlaylistEntryId> ids;
+    ids.reserve(size());
+    std::vector<int> pending;
+    int node = m_root;
+    while (node >= 0 || !pending.empty()) {
+        while (node >= 0) {
+            pending.push_back(node);
+            node = m_nodes[node].left;
+        }
+        node = pending.back();
+        pending.pop_back();
+        ids.push_back(m_idBase + static_cast<PlaylistEntryId>(node) + 1);
+        node = m_nodes[node].right;
+    }
+    return ids;
+}
+
+// Edits
+
+void Playlist::push_back(const std::wstring& path) {
+    insert(size(), path);
+}
+
+void Playlist::insert(size_t index, const std::wstring& path) {
+    index = std::min(index, size());
+    int node = NewNode(path);
+    int left, right;
+    Split(m_root, static_cast<int>(index), left, right);
+    m_root = Merge(Merge(left, node), right);
+    if (HasShuffle()) AddToShuffle(node);
+    m_revision++;
+}
+
+void Playlist::append(const std::vector<std::wstring>& paths) {
+    if (paths.empty()) return;
+    int first = static_cast<int>(m_nodes.size());
+    for (const auto& path : paths) NewNode(path);
+    int count = static_cast<int>(paths.size());
+    m_root = Merge(m_root, BuildTree(first, count));
+    if (HasShuffle()) {
+        for (int node = first; node < first + count; node++) AddToShuffle(node);
+    }
+    m_revision++;
+}
+
+Playlist& Playlist::operator=(const std::vector<std::wstring>& paths) {
+    clear();
+    append(paths);
+    return *this;
+}
+
+void Playlist::erase(size_t index) {
+    if (index >= size()) return;
+    int left, rest, node, right;
+    Split(m_root, static_cast<int>(index), left, rest);
+    Split(rest, 1, node, right);
+    m_root = Merge(left, right);
+    if (m_nodes[node].shufflePos >= 0) RemoveFromShuffle(node);
+    FreeNode(node);
+    m_revision++;
+}
+
+void Playlist::move(size_t from, size_t to) {
+    if (from >= size() || from == to) return;
+    int left, rest, node, right;
+    Split(m_root, static_cast<int>(from), left, rest);
+    Split(rest, 1, node, right);
+    m_root = Merge(left, right);
+
+    to = std::min(to, size());
+    Split(m_root, static_cast<int>(to), left, right);
+    m_root = Merge(Merge(left, node), right);
+    m_revision++;
+}
+
+// Shuffle order
+
+void Playlist::MoveShuffleEntry(int from, int to) {
+    if (from == to) return;
+    m_shuffle[to] = m_shuffle[from];
+    m_nodes[m_shuffle[to]].shufflePos = to;
+}
+
+void Playlist::SwapShuffleEntries(int a, int b) {
+    std::swap(m_shuffle[a], m_shuffle[b]);
+    m_nodes[m_shuffle[a]].shufflePos = a;
+    m_nodes[m_shuffle[b]].shufflePos = b;
+}
+
+// A new entry goes somewhere among those not played yet this cycle
+void Playlist::AddToShuffle(int node) {
+    int last = static_cast<int>(m_shuffle.size());
+    m_shuffle.push_back(node);
+    m_nodes[node].shufflePos = last;
+    int first = m_shuffleCursor + 1;
+    SwapShuffleEntries(last, first + static_cast<int>(m_random() % static_cast<uint32_t>(last - first + 1)));
+}
+
+// Take an entry out, keeping the played part played and the rest in order
+void Playlist::RemoveFromShuffle(int node) {
+    int pos = m_nodes[node].shufflePos;
+    int last = static_cast<int>(m_shuffle.size()) - 1;
+    if (pos <= m_shuffleCursor) {
+        MoveShuffleEntry(m_shuffleCursor, pos);
+        MoveShuffleEntry(last, m_shuffleCursor);
+        m_shuffleCursor--;
+    } else {
+        MoveShuffleEntry(last, pos);
+    }
+    m_shuffle.pop_back();
+    m_nodes[node].shufflePos = -1;
+}
+
+void Playlist::Shuffle(int firstIndex, int notFirstIndex) {
+    ClearShuffle();
+    m_shuffle.reserve(size());
+
+    // In playlist order first, then Fisher-Yates
+    std::vector<int> pending;
+    int node = m_root;
+    while (node >= 0 || !pending.empty()) {
+        while (node >= 0) {
+            pending.push_back(node);
+            node = m_nodes[node].left;
+        }
+        node = pending.back();
+        pending.pop_back();
+        m_shuffle.push_back(node);
+        node = m_nodes[node].right;
+    }
+    int n = static_cast<int>(m_shuffle.size());
+    for (int i = n - 1; i > 0; i--) {
+        int j = static_cast<int>(m_random() % static_cast<uint32_t>(i + 1));
+        std::swap(m_shuffle[i], m_shuffle[j]);
+    }
+    for (int i = 0; i < n; i++) m_nodes[m_shuffle[i]].shufflePos = i;
+
+    int first = (firstIndex >= 0) ? NodeAt(static_cast<size_t>(firstIndex)) : -1;
+    if (first >= 0) {
+        SwapShuffleEntries(0, m_nodes[first].shufflePos);
+        m_shuffleCursor = 0;
+        return;
+    }
+    int notFirst = (notFirstIndex >= 0) ? NodeAt(static_cast<size_t>(notFirstIndex)) : -1;
+    if (n > 1 && notFirst >= 0 && m_shuffle[0] == notFirst) SwapShuffleEntries(0, n - 1);
+}
+
+void Playlist::ClearShuffle() {
+    for (int node : m_shuffle) m_nodes[node].shufflePos = -1;
+    m_shuffle.clear();
+    m_shuffleCursor = -1;
+}
+
+int Playlist::GetShufflePos(int index) const {
+    if (index < 0) return -1;
+    int node = NodeAt(static_cast<size_t>(index));
+    return node < 0 ? -1 : m_nodes[node].shufflePos;
+}
+
+int Playlist::GetShuffledIndex(int pos) const {
+    if (pos < 0 || pos >= static_cast<int>(m_shuffle.size())) return -1;
+    return IndexOfNode(m_shuffle[pos]);
+}
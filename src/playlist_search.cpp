@@ -0,0 +1,244 @@
+#include "playlist_search.h"
+#include "database.h"
+#include <algorithm>
+#include <cwctype>
+
+// Removed entries left in the index before it is worth rebuilding
+static const size_t REBUILD_MIN_REMOVED = 1024;
+
+// Candidates from which a query looks up every entry's place in one walk
+// of the playlist rather than one at a time
+static const size_t SLOT_INDEXES_MIN_CANDIDATES = 2048;
+
+static const uint32_t NO_SLOT = 0xFFFFFFFF;
+
+// A list this many times longer than the candidates so far is binary
+// searched rather than walked
+static const size_t GALLOP_RATIO = 16;
+
+// Match tiers, best first
+enum MatchTier {
+    TIER_NAME_START = 0,
+    TIER_NAME_WORD = 1,
+    TIER_NAME = 2,
+    TIER_TAGS = 3
+};
+
+static std::wstring Fold(const std::wstring& s) {
+    std::wstring folded(s);
+    for (auto& c : folded) c = static_cast<wchar_t>(towlower(c));
+    return folded;
+}
+
+static inline uint64_t Trigram(const wchar_t* p) {
+    return (static_cast<uint64_t>(p[0] & 0x1FFFFF) << 42) |
+           (static_cast<uint64_t>(p[1] & 0x1FFFFF) << 21) |
+           static_cast<uint64_t>(p[2] & 0x1FFFFF);
+}
+
+PlaylistSearch::PlaylistSearch() : m_firstId(0), m_nextId(0), m_slotIndexesRevision(0), m_slotIndexesValid(false) {
+}
+
+void PlaylistSearch::Reset(PlaylistEntryId firstId) {
+    m_firstId = firstId;
+    m_nextId = firstId;
+    m_ids.clear();
+    m_texts.clear();
+    m_nameLengths.clear();
+    m_slotById.clear();
+    m_trigrams.clear();
+    m_slotIndexes.clear();
+    m_slotIndexesValid = false;
+}
+
+void PlaylistSearch::Sync(const Playlist& playlist) {
+    // Nothing from before a clear() is left
+    if (playlist.GetFirstId() != m_firstId) Reset(playlist.GetFirstId());
+
+    PlaylistEntryId next = playlist.GetNextId();
+    if (m_nextId < next) {
+        AddEntries(playlist, m_nextId, next);
+        m_nextId = next;
+    }
+
+    // Every entry still in the playlist is indexed, so the rest are removed ones
+    size_t removed = m_ids.size() - playlist.size();
+    if (removed >= REBUILD_MIN_REMOVED && removed > playlist.size()) {
+        Reset(m_firstId);
+        AddEntries(playlist, m_firstId, next);
+        m_nextId = next;
+    }
+}
+
+void PlaylistSearch::AddEntries(const Playlist& playlist, PlaylistEntryId first, PlaylistEntryId end) {
+    std::vector<PlaylistEntryId> ids;
+    for (PlaylistEntryId id = first; id < end; id++) {
+        if (playlist.Contains(id)) ids.push_back(id);
+    }
+    if (ids.empty()) return;
+
+    std::vector<std::wstring> tags;
+    if (GetLibraryTrackCount() > 0) {
+        std::vector<std::wstring> paths;
+        paths.reserve(ids.size());
+        for (PlaylistEntryId id : ids) paths.push_back(playlist.GetPathById(id));
+        tags = GetLibraryTagTextDB(paths);
+    }
+
+    m_slotById.resize(end - m_firstId, NO_SLOT);
+    m_slotIndexesValid = false;
+    m_ids.reserve(m_ids.size() + ids.size());
+    m_texts.reserve(m_texts.size() + ids.size());
+    m_nameLengths.reserve(m_nameLengths.size() + ids.size());
+    for (size_t i = 0; i < ids.size(); i++) {
+        std::wstring text = Fold(playlist.GetNameById(ids[i]));
+        uint32_t nameLength = static_cast<uint32_t>(text.size());
+        if (i < tags.size() && !tags[i].empty()) {
+            text += L'\n';  // No query word spans it
+            text += Fold(tags[i]);
+        }
+
+        uint32_t slot = static_cast<uint32_t>(m_ids.size());
+        for (size_t pos = 0; pos + 3 <= text.size(); pos++) {
+            std::vector<uint32_t>& slots = m_trigrams[Trigram(text.c_str() + pos)];
+            if (slots.empty() || slots.back() != slot) slots.push_back(slot);
+        }
+        m_slotById[ids[i] - m_firstId] = slot;
+        m_ids.push_back(ids[i]);
+        m_texts.push_back(std::move(text));
+        m_nameLengths.push_back(nameLength);
+    }
+}
+
+// Slots holding every trigram of the words, or all of them if no word is
+// long enough to have one
+std::vector<uint32_t> PlaylistSearch::Candidates(const std::vector<std::wstring>& words) const {
+    std::vector<const std::vector<uint32_t>*> lists;
+    for (const auto& word : words) {
+        for (size_t pos = 0; pos + 3 <= word.size(); pos++) {
+            auto found = m_trigrams.find(Trigram(word.c_str() + pos));
+            if (found == m_trigrams.end()) return std::vector<uint32_t>();
+            lists.push_back(&found->second);
+        }
+    }
+
+    std::vector<uint32_t> candidates;
+    if (lists.empty()) {
+        candidates.resize(m_ids.size());
+        for (uint32_t slot = 0; slot < candidates.size(); slot++) candidates[slot] = slot;
+        return candidates;
+    }
+
+    // Shortest list first, so every step keeps the candidates as few as they can be
+    std::sort(lists.begin(), lists.end(),
+              [](const std::vector<uint32_t>* a, const std::vector<uint32_t>* b) { return a->size() < b->size(); });
+    lists.erase(std::unique(lists.begin(), lists.end()), lists.end());
+    candidates = *lists[0];
+
+    for (size_t i = 1; i < lists.size() && !candidates.empty(); i++) {
+        const std::vector<uint32_t>& list = *lists[i];
+        size_t kept = 0;
+        if (list.size() > candidates.size() * GALLOP_RATIO) {
+            auto from = list.begin();
+            for (uint32_t slot : candidates) {
+                from = std::lower_bound(from, list.end(), slot);
+                if (from == list.end()) break;
+                if (*from == slot) candidates[kept++] = slot;
+            }
+        } else {
+            size_t j = 0;
+            for (uint32_t slot : candidates) {
+                while (j < list.size() && list[j] < slot) j++;
+                if (j == list.size()) break;
+                if (list[j] == slot) candidates[kept++] = slot;
+            }
+        }
+        candidates.resize(kept);
+    }
+    return candidates;
+}
+
+void PlaylistSearch::UpdateSlotIndexes(const Playlist& playlist) {
+    if (m_slotIndexesValid && m_slotIndexesRevision == playlist.GetRevision()) return;
+    m_slotIndexes.assign(m_ids.size(), -1);
+    std::vector<PlaylistEntryId> ids = playlist.GetIds();
+    for (size_t i = 0; i < ids.size(); i++) {
+        size_t offset = ids[i] - m_firstId;
+        if (offset < m_slotById.size() && m_slotById[offset] != NO_SLOT) {
+            m_slotIndexes[m_slotById[offset]] = static_cast<int>(i);
+        }
+    }
+    m_slotIndexesRevision = playlist.GetRevision();
+    m_slotIndexesValid = true;
+}
+
+int PlaylistSearch::Rank(uint32_t slot, const std::vector<std::wstring>& words) const {
+    const std::wstring& text = m_texts[slot];
+    size_t nameLength = m_nameLengths[slot];
+    int rank = 0;
+    for (const auto& word : words) {
+        size_t pos = text.find(word);
+        if (pos == std::wstring::npos) return -1;
+
+        // The best place the word turns up
+        int tier = TIER_TAGS;
+        while (pos != std::wstring::npos && pos + word.size() <= nameLength) {
+            if (pos == 0) {
+                tier = TIER_NAME_START;
+                break;
+            }
+            if (!iswalnum(text[pos - 1])) {
+                tier = TIER_NAME_WORD;
+                break;
+            }
+            tier = TIER_NAME;
+            pos = text.find(word, pos + 1);
+        }
+        rank += tier;
+    }
+    return rank;
+}
+
+std::vector<int> PlaylistSearch::Find(const Playlist& playlist, const std::wstring& query, size_t limit,
+                                      size_t* matchCount) {
+    if (matchCount) *matchCount = 0;
+    Sync(playlist);
+
+    std::vector<std::wstring> words;
+    std::wstring folded = Fold(query);
+    size_t start = 0;
+    while (start < folded.size()) {
+        size_t end = start;
+        while (end < folded.size() && !iswspace(folded[end])) end++;
+        if (end > start) words.push_back(folded.substr(start, end - start));
+        start = end + 1;
+    }
+    if (words.empty()) return std::vector<int>();
+
+    struct Match {
+        int rank;
+        int index;
+        bool operator<(const Match& other) const {
+            return rank != other.rank ? rank < other.rank : index < other.index;
+        }
+    };
+    std::vector<uint32_t> candidates = Candidates(words);
+    bool walk = candidates.size() >= SLOT_INDEXES_MIN_CANDIDATES;
+    if (walk) UpdateSlotIndexes(playlist);
+
+    std::vector<Match> matches;
+    for (uint32_t slot : candidates) {
+        int index = walk ? m_slotIndexes[slot] : playlist.IndexOf(m_ids[slot]);
+        if (index < 0) continue;
+        int rank = Rank(slot, words);
+        if (rank < 0) continue;
+        matches.push_back(Match{rank, index});
+    }
+    if (matchCount) *matchCount = matches.size();
+
+    size_t count = std::min(limit, matches.size());
+    std::partial_sort(matches.begin(), matches.begin() + count, matches.end());
+    std::vector<int> indexes(count);
+    for (size_t i = 0; i < count; i++) indexes[i] = matches[i].index;
+    return indexes;
+}
@@ -0,0 +1,393 @@
+#include "resampler.h"
+#include <cmath>
+#include <map>
+#include <mutex>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE__)
+#include <xmmintrin.h>
+#define RESAMPLER_SSE
+#endif
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+const char* GetResamplerQualityName(ResamplerQuality quality) {
+    switch (quality) {
+        case ResamplerQuality::Native: return "BASS (built-in)";
+        case ResamplerQuality::Low: return "Low (fastest)";
+        case ResamplerQuality::Medium: return "Medium";
+        case ResamplerQuality::High: return "High (best quality)";
+        default: return "";
+    }
+}
+
+// Zeroth-order modified Bessel function (for the Kaiser window)
+static double BesselI0(double x) {
+    double sum = 1.0;
+    double term = 1.0;
+    double halfX = x * 0.5;
+    for (int k = 1; k < 32; k++) {
+        term *= (halfX / k) * (halfX / k);
+        sum += term;
+        if (term < sum * 1e-12) break;
+    }
+    return sum;
+}
+
+// Dot product of the history window with one row of filter coefficients
+static inline float DotProduct(const float* samples, const float* coeffs, int count) {
+#ifdef RESAMPLER_SSE
+    __m128 acc0 = _mm_setzero_ps();
+    __m128 acc1 = _mm_setzero_ps();
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        acc0 = _mm_add_ps(acc0, _mm_mul_ps(_mm_loadu_ps(samples + i), _mm_loadu_ps(coeffs + i)));
+        acc1 = _mm_add_ps(acc1, _mm_mul_ps(_mm_loadu_ps(samples + i + 4), _mm_loadu_ps(coeffs + i + 4)));
+    }
+    for (; i < count; i += 4) {
+        acc0 = _mm_add_ps(acc0, _mm_mul_ps(_mm_loadu_ps(samples + i), _mm_loadu_ps(coeffs + i)));
+    }
+    acc0 = _mm_add_ps(acc0, acc1);
+    // Horizontal sum
+    __m128 shuf = _mm_shuffle_ps(acc0, acc0, _MM_SHUFFLE(2, 3, 0, 1));
+    __m128 sums = _mm_add_ps(acc0, shuf);
+    shuf = _mm_movehl_ps(shuf, sums);
+    sums = _mm_add_ss(sums, shuf);
+    return _mm_cvtss_f32(sums);
+#else
+    float sum = 0.0f;
+    for (int i = 0; i < count; i++) {
+        sum += samples[i] * coeffs[i];
+    }
+    return sum;
+#endif
+}
+
+PolyphaseResampler::PolyphaseResampler()
+    : m_initialized(false)
+    , m_quality(ResamplerQuality::Medium)
+    , m_channels(2)
+    , m_taps(24)
+    , m_paddedTaps(24)
+    , m_phases(128)
+    , m_kaiserBeta(7.0)
+    , m_cutoff(0.0)
+    , m_ratio(1.0)
+    , m_pos(0.0)
+{
+}
+
+bool PolyphaseResampler::Init(int channels, ResamplerQuality quality) {
+    if (channels <= 0) return false;
+
+    m_channels = channels;
+    m_quality = quality;
+    switch (quality) {
+        case ResamplerQuality::High:
+            m_taps = 64;
+            m_phases = 256;
+            m_kaiserBeta = 9.0;
+            break;
+        case ResamplerQuality::Medium:
+            m_taps = 24;
+            m_phases = 128;
+            m_kaiserBeta = 7.0;
+            break;
+        default:
+            m_quality = ResamplerQuality::Low;
+            m_taps = 8;
+            m_phases = 64;
+            m_kaiserBeta = 5.0;
+            break;
+    }
+    m_paddedTaps = (m_taps + 3) & ~3;
+    m_cutoff = 0.0;  // Force a table build
+    m_history.assign(channels, std::vector<float>());
+    m_initialized = true;
+
+    SetRatio(m_ratio);
+    Reset();
+    return true;
+}
+
+void PolyphaseResampler::Reset() {
+    // Prime with half a filter of silence so the first input frame lands in the
+    // middle of the filter rather than at its edge
+    int lead = m_taps / 2 - 1;
+    for (auto& h : m_history) {
+        h.assign(lead, 0.0f);
+    }
+    m_pos = lead;
+}
+
+void PolyphaseResampler::SetRatio(double ratio) {
+    if (ratio < 0.05) ratio = 0.05;
+    if (ratio > 20.0) ratio = 20.0;
+    m_ratio = ratio;
+    if (!m_initialized) return;
+
+    // Downsampling (ratio > 1) needs the cutoff lowered to the output Nyquist.
+    // Leave a little transition band; higher tiers can afford a steeper one.
+    double bandwidth = (m_quality == ResamplerQuality::High) ? 0.97 :
+                       (m_quality == ResamplerQuality::Medium) ? 0.94 : 0.90;
+    double cutoff = (ratio > 1.0 ? 1.0 / ratio : 1.0) * bandwidth;
+
+    // Rebuilding costs taps * phases sinc evaluations, so skip tiny changes
+    if (m_cutoff > 0.0 && std::fabs(cutoff - m_cutoff) < m_cutoff * 0.005) return;
+    BuildTable(cutoff);
+}
+
+void PolyphaseResampler::BuildTable(double cutoff) {
+    m_cutoff = cutoff;
+    m_table.assign(static_cast<size_t>(m_phases + 1) * m_paddedTaps, 0.0f);
+
+    int half = m_taps / 2;
+    double i0Beta = BesselI0(m_kaiserBeta);
+
+    for (int phase = 0; phase <= m_phases; phase++) {
+        double frac = static_cast<double>(phase) / m_phases;
+        float* row = &m_table[static_cast<size_t>(phase) * m_paddedTaps];
+        double sum = 0.0;
+
+        for (int k = 0; k < m_taps; k++) {
+            // Distance from the output position to this tap's input sample
+            double t = (k - (half - 1)) - frac;
+            double x = t / half;
+            double window = (std::fabs(x) < 1.0) ? BesselI0(m_kaiserBeta * std::sqrt(1.0 - x * x)) / i0Beta : 0.0;
+            double arg = M_PI * cutoff * t;
+            double sinc = (std::fabs(arg) < 1e-9) ? 1.0 : std::sin(arg) / arg;
+            double h = cutoff * sinc * window;
+            row[k] = static_cast<float>(h);
+            sum += h;
+        }
+
+        // Normalize each row to unity DC gain
+        if (sum != 0.0) {
+            for (int k = 0; k < m_taps; k++) {
+                row[k] = static_cast<float>(row[k] / sum);
+            }
+        }
+    }
+}
+
+void PolyphaseResampler::Push(const float* input, size_t frames) {
+    if (!m_initialized || frames == 0) return;
+
+    for (int ch = 0; ch < m_channels; ch++) {
+        std::vector<float>& h = m_history[ch];
+        size_t start = h.size();
+        h.resize(start + frames);
+        float* dst = h.data() + start;
+        for (size_t i = 0; i < frames; i++) {
+            dst[i] = input[i * m_channels + ch];
+        }
+    }
+}
+
+void PolyphaseResampler::Flush() {
+    if (!m_initialized) return;
+    // Enough silence for the last real frame to pass the filter center
+    size_t pad = m_paddedTaps;
+    for (auto& h : m_history) {
+        h.resize(h.size() + pad, 0.0f);
+    }
+}
+
+void PolyphaseResampler::Compact() {
+    // Drop history the filter can no longer reach
+    int lead = m_taps / 2 - 1;
+    size_t drop = static_cast<size_t>(m_pos) > static_cast<size_t>(lead) ? static_cast<size_t>(m_pos) - lead : 0;
+    if (drop < 4096) return;
+
+    for (auto& h : m_history) {
+        h.erase(h.begin(), h.begin() + drop);
+    }
+    m_pos -= static_cast<double>(drop);
+}
+
+size_t PolyphaseResampler::Pull(float* output, size_t maxFrames) {
+    if (!m_initialized || m_history.empty()) return 0;
+
+    int lead = m_taps / 2 - 1;
+    size_t available = m_history[0].size();
+    bool passthrough = (m_ratio == 1.0);
+    bool nearestPhase = (m_quality == ResamplerQuality::Low);
+    size_t produced = 0;
+
+    while (produced < maxFrames) {
+        size_t index = static_cast<size_t>(m_pos);
+        double frac = m_pos - static_cast<double>(index);
+        size_t base = index - lead;
+        if (base + m_paddedTaps > available) break;
+
+        float* out = output + produced * m_channels;
+
+        if (passthrough && frac == 0.0) {
+            // Same rate, aligned: straight copy
+            for (int ch = 0; ch < m_channels; ch++) {
+                out[ch] = m_history[ch][index];
+            }
+        } else if (nearestPhase) {
+            int phase = static_cast<int>(frac * m_phases + 0.5);
+            const float* row = &m_table[static_cast<size_t>(phase) * m_paddedTaps];
+            for (int ch = 0; ch < m_channels; ch++) {
+                out[ch] = DotProduct(&m_history[ch][base], row, m_paddedTaps);
+            }
+        } else {
+            // Interpolate between the two nearest table phases
+            double phasePos = frac * m_phases;
+            int phase = static_cast<int>(phasePos);
+            float weight = static_cast<float>(phasePos - phase);
+            const float* row0 = &m_table[static_cast<size_t>(phase) * m_paddedTaps];
+            const float* row1 = row0 + m_paddedTaps;
+            for (int ch = 0; ch < m_channels; ch++) {
+                const float* samples = &m_history[ch][base];
+                float a = DotProduct(samples, row0, m_paddedTaps);
+                float b = DotProduct(samples, row1, m_paddedTaps);
+                out[ch] = a + (b - a) * weight;
+            }
+        }
+
+        produced++;
+        m_pos += m_ratio;
+    }
+
+    Compact();
+    return produced;
+}
+
+// ============================================================================
+// Resampled decode stream
+// ============================================================================
+
+struct ResampledStream {
+    HSTREAM decodeStream = 0;
+    HSTREAM outputStream = 0;
+    PolyphaseResampler resampler;
+    float sourceRate = 44100.0f;
+    float outputRate = 44100.0f;
+    float rate = 1.0f;
+    int channels = 2;
+    bool sourceEnded = false;
+    std::vector<float> block;
+    std::mutex mutex;
+
+    void UpdateRatio() {
+        resampler.SetRatio(static_cast<double>(sourceRate) * rate / outputRate);
+    }
+};
+
+static std::mutex g_resampledMutex;
+static std::map<HSTREAM, ResampledStream*> g_resampledStreams;
+
+static const DWORD RESAMPLE_BLOCK_FRAMES = 1024;
+
+static ResampledStream* FindResampledStream(HSTREAM stream) {
+    std::lock_guard<std::mutex> lock(g_resampledMutex);
+    auto it = g_resampledStreams.find(stream);
+    return it != g_resampledStreams.end() ? it->second : nullptr;
+}
+
+static DWORD CALLBACK ResampleStreamProc(HSTREAM handle, void* buffer, DWORD length, void* user) {
+    ResampledStream* rs = static_cast<ResampledStream*>(user);
+    if (!rs) return BASS_STREAMPROC_END;
+
+    std::lock_guard<std::mutex> lock(rs->mutex);
+
+    float* out = static_cast<float*>(buffer);
+    size_t framesNeeded = length / (sizeof(float) * rs->channels);
+    size_t produced = 0;
+
+    while (produced < framesNeeded) {
+        produced += rs->resampler.Pull(out + produced * rs->channels, framesNeeded - produced);
+        if (produced >= framesNeeded || rs->sourceEnded) break;
+
+        // Need more input from the decode stream
+        rs->block.resize(RESAMPLE_BLOCK_FRAMES * rs->channels);
+        DWORD got = BASS_ChannelGetData(rs->decodeStream, rs->block.data(),
+            static_cast<DWORD>(rs->block.size() * sizeof(float)) | BASS_DATA_FLOAT);
+        if (got == (DWORD)-1 || got == 0) {
+            rs->sourceEnded = true;
+            rs->resampler.Flush();
+            continue;  // Drain the tail
+        }
+        rs->resampler.Push(rs->block.data(), got / (sizeof(float) * rs->channels));
+    }
+
+    DWORD bytes = static_cast<DWORD>(produced * rs->channels * sizeof(float));
+    if (rs->sourceEnded && produced < framesNeeded) {
+        return bytes | BASS_STREAMPROC_END;
+    }
+    return bytes;
+}
+
+static void CALLBACK OnResampledStreamFree(HSYNC handle, DWORD channel, DWORD data, void* user) {
+    ResampledStream* rs = static_cast<ResampledStream*>(user);
+    {
+        std::lock_guard<std::mutex> lock(g_resampledMutex);
+        g_resampledStreams.erase(channel);
+    }
+    if (rs) {
+        BASS_StreamFree(rs->decodeStream);
+        delete rs;
+    }
+}
+
+HSTREAM CreateResampledStream(HSTREAM decodeStream, ResamplerQuality quality, float rate) {
+    if (!decodeStream || quality == ResamplerQuality::Native) return 0;
+
+    BASS_CHANNELINFO info;
+    if (!BASS_ChannelGetInfo(decodeStream, &info) || !(info.flags & BASS_STREAM_DECODE)) return 0;
+
+    // Output at the device's mix rate so BASS doesn't resample a second time
+    BASS_INFO deviceInfo;
+    DWORD outputRate = info.freq;
+    if (BASS_GetInfo(&deviceInfo) && deviceInfo.freq > 0) {
+        outputRate = deviceInfo.freq;
+    }
+
+    ResampledStream* rs = new ResampledStream();
+    rs->decodeStream = decodeStream;
+    rs->sourceRate = static_cast<float>(info.freq);
+    rs->outputRate = static_cast<float>(outputRate);
+    rs->rate = rate;
+    rs->channels = static_cast<int>(info.chans);
+    rs->resampler.Init(rs->channels, quality);
+    rs->UpdateRatio();
+
+    // A decode stream too: the output mixer pulls from it
+    rs->outputStream = BASS_StreamCreate(outputRate, info.chans, BASS_SAMPLE_FLOAT | BASS_STREAM_DECODE,
+                                         ResampleStreamProc, rs);
+    if (!rs->outputStream) {
+        delete rs;
+        return 0;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(g_resampledMutex);
+        g_resampledStreams[rs->outputStream] = rs;
+    }
+    BASS_ChannelSetSync(rs->outputStream, BASS_SYNC_FREE, 0, OnResampledStreamFree, rs);
+    return rs->outputStream;
+}
+
+bool IsResampledStream(HSTREAM stream) {
+    return FindResampledStream(stream) != nullptr;
+}
+
+void SetResampledStreamRate(HSTREAM stream, float rate) {
+    ResampledStream* rs = FindResampledStream(stream);
+    if (!rs) return;
+    std::lock_guard<std::mutex> lock(rs->mutex);
+    rs->rate = rate;
+    rs->UpdateRatio();
+}
+
+void ResetResampledStream(HSTREAM stream) {
+    ResampledStream* rs = FindResampledStream(stream);
+    if (!rs) return;
+    std::lock_guard<std::mutex> lock(rs->mutex);
+    rs->resampler.Reset();
+    rs->sourceEnded = false;
+}
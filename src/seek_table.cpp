@@ -0,0 +1,171 @@
+#include "seek_table.h"
+#include "globals.h"
+#include "database.h"
+#include "utils.h"
+#include "resource.h"
+#include <vector>
+#include <deque>
+#include <algorithm>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <atomic>
+#include <cstdint>
+
+// Shorter files seek quickly and closely enough without a table
+static const double MIN_SCAN_SECONDS = 600.0;
+
+static std::mutex g_scanMutex;
+static std::condition_variable g_scanWake;
+static std::thread g_scanThread;
+static std::deque<std::wstring> g_scanQueue;
+static std::vector<std::wstring> g_scanAttempted;  // Queued this session (not queued again)
+static bool g_scanStop = false;
+static std::atomic<bool> g_scanCancel(false);
+
+static bool IsMpegStream(HSTREAM stream) {
+    BASS_CHANNELINFO info;
+    if (!BASS_ChannelGetInfo(stream, &info)) return false;
+    return info.ctype == BASS_CTYPE_STREAM_MP1 || info.ctype == BASS_CTYPE_STREAM_MP2 ||
+           info.ctype == BASS_CTYPE_STREAM_MP3;
+}
+
+// File access for the scan, so it can be abandoned part way (the reads just stop)
+struct ScanSource {
+    HANDLE file;
+    QWORD size;
+    bool failed;
+};
+
+static void CALLBACK ScanClose(void* user) {
+    // The scanner closes the file itself once the stream is gone
+}
+
+static QWORD CALLBACK ScanLength(void* user) {
+    return static_cast<ScanSource*>(user)->size;
+}
+
+static DWORD CALLBACK ScanRead(void* buffer, DWORD length, void* user) {
+    ScanSource* source = static_cast<ScanSource*>(user);
+    if (g_scanCancel) {
+        source->failed = true;
+        return 0;
+    }
+    DWORD got = 0;
+    if (!ReadFile(source->file, buffer, length, &got, nullptr)) {
+        source->failed = true;
+        return 0;
+    }
+    return got;
+}
+
+static BOOL CALLBACK ScanSeek(QWORD offset, void* user) {
+    LARGE_INTEGER pos;
+    pos.QuadPart = static_cast<LONGLONG>(offset);
+    return SetFilePointerEx(static_cast<ScanSource*>(user)->file, pos, nullptr, FILE_BEGIN);
+}
+
+static const BASS_FILEPROCS g_scanProcs = {ScanClose, ScanLength, ScanRead, ScanSeek};
+
+// Prescan a file and store its seek info
+static void ScanFile(const std::wstring& path) {
+    int64_t size = 0, modified = 0;
+    if (!GetFileIdentity(path, size, modified)) return;
+
+    ScanSource source;
+    source.file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                              nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (source.file == INVALID_HANDLE_VALUE) return;
+    source.size = static_cast<QWORD>(size);
+    source.failed = false;
+
+    HSTREAM stream = BASS_StreamCreateFileUser(STREAMFILE_NOBUFFER, BASS_STREAM_DECODE | BASS_STREAM_PRESCAN,
+                                               &g_scanProcs, &source);
+    if (stream) {
+        // A scan cut short would store a truncated table
+        if (!source.failed) {
+            DWORD bytes = BASS_ChannelGetAttributeEx(stream, BASS_ATTRIB_SCANINFO, nullptr, 0);
+            std::vector<unsigned char> scanInfo(bytes);
+            if (bytes > 0 &&
+                BASS_ChannelGetAttributeEx(stream, BASS_ATTRIB_SCANINFO, scanInfo.data(), bytes) == bytes) {
+                SaveSeekTableDB(path, size, modified, scanInfo);
+                PostMessage(g_hwnd, WM_SEEK_TABLE_READY, 0, 0);
+            }
+        }
+        BASS_StreamFree(stream);
+    }
+    CloseHandle(source.file);
+}
+
+static void SeekScannerThread() {
+    // Reading a whole file matters less than playback
+    SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_BELOW_NORMAL);
+
+    std::unique_lock<std::mutex> lock(g_scanMutex);
+    for (;;) {
+        g_scanWake.wait(lock, [] { return g_scanStop || !g_scanQueue.empty(); });
+        if (g_scanStop) return;
+        std::wstring path = g_scanQueue.front();
+        g_scanQueue.pop_front();
+        lock.unlock();
+        ScanFile(path);
+        lock.lock();
+        if (g_scanCancel) {
+            // Cut short: it may be queued again later
+            g_scanAttempted.erase(std::remove(g_scanAttempted.begin(), g_scanAttempted.end(), path),
+                                  g_scanAttempted.end());
+        }
+    }
+}
+
+bool ApplySeekTable(HSTREAM source, const std::wstring& path) {
+    if (!source || !IsMpegStream(source)) return false;
+
+    int64_t size = 0, modified = 0;
+    if (!GetFileIdentity(path, size, modified)) return false;
+
+    std::vector<unsigned char> scanInfo;
+    if (LoadSeekTableDB(path, size, modified, scanInfo)) {
+        return BASS_ChannelSetAttributeEx(source, BASS_ATTRIB_SCANINFO, scanInfo.data(),
+                                          static_cast<DWORD>(scanInfo.size())) != FALSE;
+    }
+
+    QWORD length = BASS_ChannelGetLength(source, BASS_POS_BYTE);
+    if (length == static_cast<QWORD>(-1) || BASS_ChannelBytes2Seconds(source, length) < MIN_SCAN_SECONDS) {
+        return false;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(g_scanMutex);
+        for (const auto& attempted : g_scanAttempted) {
+            if (_wcsicmp(attempted.c_str(), path.c_str()) == 0) return false;
+        }
+        g_scanAttempted.push_back(path);
+        g_scanQueue.push_back(path);
+        if (!g_scanThread.joinable()) {
+            g_scanThread = std::thread(SeekScannerThread);
+        }
+    }
+    g_scanWake.notify_all();
+    return false;
+}
+
+void StopSeekScanner() {
+    {
+        std::lock_guard<std::mutex> lock(g_scanMutex);
+        g_scanStop = true;
+        g_scanCancel = true;
+        // Unscanned files may be queued again later
+        for (const auto& path : g_scanQueue) {
+            g_scanAttempted.erase(std::remove(g_scanAttempted.begin(), g_scanAttempted.end(), path),
+                                  g_scanAttempted.end());
+        }
+        g_scanQueue.clear();
+    }
+    g_scanWake.notify_all();
+    if (g_scanThread.joinable()) g_scanThread.join();
+
+    std::lock_guard<std::mutex> lock(g_scanMutex);
+    g_scanStop = false;
+    g_scanCancel = false;
+}
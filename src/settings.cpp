@@ -4,11 +4,14 @@
 #include "effects.h"
 #include "convolution.h"
 #include "database.h"
+#include "config_store.h"
 #include "accessibility.h"
 #include "tempo_processor.h"
+#include "resampler.h"
 #include "updater.h"
 #include "resource.h"
 #include <cstdio>
+#include <algorithm>
 #include <shlobj.h>
 
 // Initialize config file path
@@ -51,34 +54,35 @@ void InitConfigPath() {
 // Load settings from INI file
 void LoadSettings() {
     InitConfigPath();
+    LoadConfig(g_configPath);
 
     // Load device name (empty means default device)
     wchar_t deviceName[256] = {0};
-    GetPrivateProfileStringW(L"Playback", L"DeviceName", L"", deviceName, 256, g_configPath.c_str());
+    ConfigGetString(L"Playback", L"DeviceName", L"", deviceName, 256);
     g_selectedDeviceName = deviceName;
     g_selectedDevice = -1;  // Will be resolved by name in InitBass
 
-    g_rewindOnPauseMs = GetPrivateProfileIntW(L"Playback", L"RewindOnPauseMs", 0, g_configPath.c_str());
+    g_rewindOnPauseMs = ConfigGetInt(L"Playback", L"RewindOnPauseMs", 0);
     if (g_rewindOnPauseMs < 0) g_rewindOnPauseMs = 0;
 
-    g_allowAmplify = GetPrivateProfileIntW(L"Playback", L"AllowAmplify", 0, g_configPath.c_str()) != 0;
-    g_rememberState = GetPrivateProfileIntW(L"Playback", L"RememberState", 0, g_configPath.c_str()) != 0;
-    g_rememberPosMinutes = GetPrivateProfileIntW(L"Playback", L"RememberPosMinutes", 0, g_configPath.c_str());
-    g_bringToFront = GetPrivateProfileIntW(L"Playback", L"BringToFront", 1, g_configPath.c_str()) != 0;
-    g_minimizeToTray = GetPrivateProfileIntW(L"Playback", L"MinimizeToTray", 1, g_configPath.c_str()) != 0;
-    g_loadFolder = GetPrivateProfileIntW(L"Playback", L"LoadFolder", 0, g_configPath.c_str()) != 0;
-    g_registerFileTypes = GetPrivateProfileIntW(L"Playback", L"RegisterFileTypes", 0, g_configPath.c_str()) != 0;
-    g_volumeStep = GetPrivateProfileIntW(L"Playback", L"VolumeStep", 2, g_configPath.c_str()) / 100.0f;
+    g_allowAmplify = ConfigGetInt(L"Playback", L"AllowAmplify", 0) != 0;
+    g_rememberState = ConfigGetInt(L"Playback", L"RememberState", 0) != 0;
+    g_rememberPosMinutes = ConfigGetInt(L"Playback", L"RememberPosMinutes", 0);
+    g_bringToFront = ConfigGetInt(L"Playback", L"BringToFront", 1) != 0;
+    g_minimizeToTray = ConfigGetInt(L"Playback", L"MinimizeToTray", 1) != 0;
+    g_loadFolder = ConfigGetInt(L"Playback", L"LoadFolder", 0) != 0;
+    g_registerFileTypes = ConfigGetInt(L"Playback", L"RegisterFileTypes", 0) != 0;
+    g_volumeStep = ConfigGetInt(L"Playback", L"VolumeStep", 2) / 100.0f;
     if (g_volumeStep < 0.01f) g_volumeStep = 0.01f;
     if (g_volumeStep > 0.25f) g_volumeStep = 0.25f;
-    g_replayGainMode = GetPrivateProfileIntW(L"Playback", L"ReplayGainMode", 0, g_configPath.c_str());
+    g_replayGainMode = ConfigGetInt(L"Playback", L"ReplayGainMode", 0);
     if (g_replayGainMode < 0 || g_replayGainMode > 2) g_replayGainMode = 0;
-    g_replayGainPreamp = GetPrivateProfileIntW(L"Playback", L"ReplayGainPreamp", 0, g_configPath.c_str()) / 100.0f;
+    g_replayGainPreamp = ConfigGetInt(L"Playback", L"ReplayGainPreamp", 0) / 100.0f;
     if (g_replayGainPreamp < -15.0f) g_replayGainPreamp = -15.0f;
     if (g_replayGainPreamp > 15.0f) g_replayGainPreamp = 15.0f;
-    g_replayGainPreventClip = GetPrivateProfileIntW(L"Playback", L"ReplayGainPreventClip", 1, g_configPath.c_str()) != 0;
-    g_showTitleInWindow = GetPrivateProfileIntW(L"Playback", L"ShowTitleInWindow", 1, g_configPath.c_str()) != 0;
-    g_volume = GetPrivateProfileIntW(L"Playback", L"Volume", 100, g_configPath.c_str()) / 100.0f;
+    g_replayGainPreventClip = ConfigGetInt(L"Playback", L"ReplayGainPreventClip", 1) != 0;
+    g_showTitleInWindow = ConfigGetInt(L"Playback", L"ShowTitleInWindow", 1) != 0;
+    g_volume = ConfigGetInt(L"Playback", L"Volume", 100) / 100.0f;
 
     // Clamp volume
     float maxVol = g_allowAmplify ? MAX_VOLUME_AMPLIFY : MAX_VOLUME_NORMAL;
@@ -87,144 +91,178 @@ void LoadSettings() {
 
     // Load stream effect values (pitch, tempo, rate)
     wchar_t buf[32] = {0};
-    GetPrivateProfileStringW(L"Playback", L"Pitch", L"0", buf, 32, g_configPath.c_str());
+    ConfigGetString(L"Playback", L"Pitch", L"0", buf, 32);
     g_pitch = static_cast<float>(_wtof(buf));
     if (g_pitch < -12.0f) g_pitch = -12.0f;
     if (g_pitch > 12.0f) g_pitch = 12.0f;
 
-    GetPrivateProfileStringW(L"Playback", L"Tempo", L"0", buf, 32, g_configPath.c_str());
+    ConfigGetString(L"Playback", L"Tempo", L"0", buf, 32);
     g_tempo = static_cast<float>(_wtof(buf));
     if (g_tempo < -75.0f) g_tempo = -75.0f;
     if (g_tempo > 200.0f) g_tempo = 200.0f;
 
-    GetPrivateProfileStringW(L"Playback", L"Rate", L"1.0", buf, 32, g_configPath.c_str());
+    ConfigGetString(L"Playback", L"Rate", L"1.0", buf, 32);
     g_rate = static_cast<float>(_wtof(buf));
     if (g_rate < 0.25f) g_rate = 0.25f;
     if (g_rate > 4.0f) g_rate = 4.0f;
 
     // Load advanced settings (buffer)
-    g_bufferSize = GetPrivateProfileIntW(L"Advanced", L"BufferSize", 500, g_configPath.c_str());
+    g_bufferSize = ConfigGetInt(L"Advanced", L"BufferSize", 500);
     if (g_bufferSize < 100) g_bufferSize = 100;
     if (g_bufferSize > 5000) g_bufferSize = 5000;
 
-    g_updatePeriod = GetPrivateProfileIntW(L"Advanced", L"UpdatePeriod", 100, g_configPath.c_str());
+    g_updatePeriod = ConfigGetInt(L"Advanced", L"UpdatePeriod", 100);
     if (g_updatePeriod < 5) g_updatePeriod = 5;
     if (g_updatePeriod > 500) g_updatePeriod = 500;
 
-    g_tempoAlgorithm = GetPrivateProfileIntW(L"Advanced", L"TempoAlgorithm", 0, g_configPath.c_str());
+    g_tempoAlgorithm = ConfigGetInt(L"Advanced", L"TempoAlgorithm", 0);
     if (g_tempoAlgorithm < 0) g_tempoAlgorithm = 0;
     if (g_tempoAlgorithm >= static_cast<int>(TempoAlgorithm::COUNT)) g_tempoAlgorithm = 0;
 
-    g_legacyVolume = GetPrivateProfileIntW(L"Advanced", L"LegacyVolume", 0, g_configPath.c_str()) != 0;
-    g_disableBatchDelay = GetPrivateProfileIntW(L"Advanced", L"DisableBatchDelay", 0, g_configPath.c_str()) != 0;
+    g_resamplerQuality = ConfigGetInt(L"Advanced", L"ResamplerQuality", 2);
+    if (g_resamplerQuality < 0) g_resamplerQuality = 0;
+    if (g_resamplerQuality >= static_cast<int>(ResamplerQuality::COUNT)) g_resamplerQuality = 2;
+
+    g_readAheadSeconds = ConfigGetInt(L"Advanced", L"ReadAheadSeconds", 30);
+    if (g_readAheadSeconds < 0) g_readAheadSeconds = 0;
+    if (g_readAheadSeconds > 300) g_readAheadSeconds = 300;
+    g_prefetchTracks = ConfigGetInt(L"Advanced", L"PrefetchTracks", 3);
+    if (g_prefetchTracks < 0) g_prefetchTracks = 0;
+    if (g_prefetchTracks > 20) g_prefetchTracks = 20;
+    g_prefetchMemoryMB = ConfigGetInt(L"Advanced", L"PrefetchMemoryMB", 64);
+    if (g_prefetchMemoryMB < 0) g_prefetchMemoryMB = 0;
+    if (g_prefetchMemoryMB > 1024) g_prefetchMemoryMB = 1024;
+    g_libraryScanThreads = ConfigGetInt(L"Advanced", L"LibraryScanThreads", 0);
+    if (g_libraryScanThreads < 0) g_libraryScanThreads = 0;
+    if (g_libraryScanThreads > 16) g_libraryScanThreads = 16;
+    g_checkpointSeconds = ConfigGetInt(L"Advanced", L"CheckpointSeconds", 30);
+    if (g_checkpointSeconds < 0) g_checkpointSeconds = 0;
+    if (g_checkpointSeconds > 3600) g_checkpointSeconds = 3600;
+    g_songHistoryLimit = ConfigGetInt(L"Advanced", L"SongHistoryLimit", 1000);
+    if (g_songHistoryLimit < 10) g_songHistoryLimit = 10;
+    if (g_songHistoryLimit > 10000000) g_songHistoryLimit = 10000000;
+
+    g_legacyVolume = ConfigGetInt(L"Advanced", L"LegacyVolume", 0) != 0;
+    g_disableBatchDelay = ConfigGetInt(L"Advanced", L"DisableBatchDelay", 0) != 0;
 
     // Load SoundTouch settings
-    g_stAntiAliasFilter = GetPrivateProfileIntW(L"SoundTouch", L"AntiAliasFilter", 1, g_configPath.c_str()) != 0;
-    g_stAAFilterLength = GetPrivateProfileIntW(L"SoundTouch", L"AAFilterLength", 32, g_configPath.c_str());
+    g_stAntiAliasFilter = ConfigGetInt(L"SoundTouch", L"AntiAliasFilter", 1) != 0;
+    g_stAAFilterLength = ConfigGetInt(L"SoundTouch", L"AAFilterLength", 32);
     if (g_stAAFilterLength < 8) g_stAAFilterLength = 8;
     if (g_stAAFilterLength > 128) g_stAAFilterLength = 128;
-    g_stQuickAlgorithm = GetPrivateProfileIntW(L"SoundTouch", L"QuickAlgorithm", 0, g_configPath.c_str()) != 0;
-    g_stSequenceMs = GetPrivateProfileIntW(L"SoundTouch", L"SequenceMs", 82, g_configPath.c_str());
+    g_stQuickAlgorithm = ConfigGetInt(L"SoundTouch", L"QuickAlgorithm", 0) != 0;
+    g_stSequenceMs = ConfigGetInt(L"SoundTouch", L"SequenceMs", 82);
     if (g_stSequenceMs < 0) g_stSequenceMs = 0;
     if (g_stSequenceMs > 200) g_stSequenceMs = 200;
-    g_stSeekWindowMs = GetPrivateProfileIntW(L"SoundTouch", L"SeekWindowMs", 28, g_configPath.c_str());
+    g_stSeekWindowMs = ConfigGetInt(L"SoundTouch", L"SeekWindowMs", 28);
     if (g_stSeekWindowMs < 0) g_stSeekWindowMs = 0;
     if (g_stSeekWindowMs > 100) g_stSeekWindowMs = 100;
-    g_stOverlapMs = GetPrivateProfileIntW(L"SoundTouch", L"OverlapMs", 8, g_configPath.c_str());
+    g_stOverlapMs = ConfigGetInt(L"SoundTouch", L"OverlapMs", 8);
     if (g_stOverlapMs < 0) g_stOverlapMs = 0;
     if (g_stOverlapMs > 50) g_stOverlapMs = 50;
-    g_stPreventClick = GetPrivateProfileIntW(L"SoundTouch", L"PreventClick", 0, g_configPath.c_str()) != 0;
-    g_stAlgorithm = GetPrivateProfileIntW(L"SoundTouch", L"Algorithm", 1, g_configPath.c_str());
+    g_stPreventClick = ConfigGetInt(L"SoundTouch", L"PreventClick", 0) != 0;
+    g_stAlgorithm = ConfigGetInt(L"SoundTouch", L"Algorithm", 1);
     if (g_stAlgorithm < 0) g_stAlgorithm = 0;
     if (g_stAlgorithm > 2) g_stAlgorithm = 2;
 
     // Load Speedy settings
-    g_speedyNonlinear = GetPrivateProfileIntW(L"Speedy", L"NonlinearSpeedup", 1, g_configPath.c_str()) != 0;
+    g_speedyNonlinear = ConfigGetInt(L"Speedy", L"NonlinearSpeedup", 1) != 0;
 
     // Load Signalsmith Stretch settings
-    g_ssPreset = GetPrivateProfileIntW(L"Signalsmith", L"Preset", 0, g_configPath.c_str());
+    g_ssPreset = ConfigGetInt(L"Signalsmith", L"Preset", 0);
     if (g_ssPreset < 0) g_ssPreset = 0;
     if (g_ssPreset > 1) g_ssPreset = 1;
-    g_ssTonalityLimit = GetPrivateProfileIntW(L"Signalsmith", L"TonalityLimit", 0, g_configPath.c_str());
+    g_ssTonalityLimit = ConfigGetInt(L"Signalsmith", L"TonalityLimit", 0);
     if (g_ssTonalityLimit < 0) g_ssTonalityLimit = 0;
     if (g_ssTonalityLimit > 20000) g_ssTonalityLimit = 20000;
+    g_ssThreads = ConfigGetInt(L"Signalsmith", L"Threads", 0);
+    if (g_ssThreads < 0) g_ssThreads = 0;
+    if (g_ssThreads > 8) g_ssThreads = 8;
 
     // Load reverb algorithm (0=Off, 1=Freeverb, 2=DX8, 3=I3DL2)
-    g_reverbAlgorithm = GetPrivateProfileIntW(L"Effects", L"ReverbAlgorithm", 0, g_configPath.c_str());
+    g_reverbAlgorithm = ConfigGetInt(L"Effects", L"ReverbAlgorithm", 0);
     if (g_reverbAlgorithm < 0) g_reverbAlgorithm = 0;
     if (g_reverbAlgorithm > 3) g_reverbAlgorithm = 3;
+    g_downmixStereo = ConfigGetInt(L"Effects", L"DownmixStereo", 0) != 0;
 
     // Load MIDI settings
     wchar_t midiBuf[MAX_PATH] = {0};
-    GetPrivateProfileStringW(L"MIDI", L"SoundFont", L"", midiBuf, MAX_PATH, g_configPath.c_str());
+    ConfigGetString(L"MIDI", L"SoundFont", L"", midiBuf, MAX_PATH);
     g_midiSoundFont = midiBuf;
-    g_midiMaxVoices = GetPrivateProfileIntW(L"MIDI", L"MaxVoices", 128, g_configPath.c_str());
+    g_midiMaxVoices = ConfigGetInt(L"MIDI", L"MaxVoices", 128);
     if (g_midiMaxVoices < 1) g_midiMaxVoices = 1;
     if (g_midiMaxVoices > 1000) g_midiMaxVoices = 1000;
-    g_midiSincInterp = GetPrivateProfileIntW(L"MIDI", L"SincInterp", 0, g_configPath.c_str()) != 0;
+    g_midiSincInterp = ConfigGetInt(L"MIDI", L"SincInterp", 0) != 0;
 
-    // EQ frequencies loaded using string conversion (GetPrivateProfileFloatW defined later)
+    // EQ frequencies loaded using string conversion
     wchar_t eqBuf[32];
-    GetPrivateProfileStringW(L"Advanced", L"EQBassFreq", L"50", eqBuf, 32, g_configPath.c_str());
+    ConfigGetString(L"Advanced", L"EQBassFreq", L"50", eqBuf, 32);
     g_eqBassFreq = static_cast<float>(_wtof(eqBuf));
-    GetPrivateProfileStringW(L"Advanced", L"EQMidFreq", L"1000", eqBuf, 32, g_configPath.c_str());
+    ConfigGetString(L"Advanced", L"EQMidFreq", L"1000", eqBuf, 32);
     g_eqMidFreq = static_cast<float>(_wtof(eqBuf));
-    GetPrivateProfileStringW(L"Advanced", L"EQTrebleFreq", L"12000", eqBuf, 32, g_configPath.c_str());
+    ConfigGetString(L"Advanced", L"EQTrebleFreq", L"12000", eqBuf, 32);
     g_eqTrebleFreq = static_cast<float>(_wtof(eqBuf));
 
     // Load YouTube settings
     wchar_t ytBuf[512] = {0};
-    GetPrivateProfileStringW(L"YouTube", L"YtdlpPath", L"", ytBuf, 512, g_configPath.c_str());
+    ConfigGetString(L"YouTube", L"YtdlpPath", L"", ytBuf, 512);
     g_ytdlpPath = ytBuf;
-    GetPrivateProfileStringW(L"YouTube", L"ApiKey", L"", ytBuf, 512, g_configPath.c_str());
+    ConfigGetString(L"YouTube", L"ApiKey", L"", ytBuf, 512);
     g_ytApiKey = ytBuf;
 
     // Load downloads settings
     wchar_t dlBuf[512] = {0};
-    GetPrivateProfileStringW(L"Downloads", L"Path", L"", dlBuf, 512, g_configPath.c_str());
+    ConfigGetString(L"Downloads", L"Path", L"", dlBuf, 512);
     g_downloadPath = dlBuf;
-    g_downloadOrganizeByFeed = GetPrivateProfileIntW(L"Downloads", L"OrganizeByFeed", 0, g_configPath.c_str()) != 0;
+    g_downloadOrganizeByFeed = ConfigGetInt(L"Downloads", L"OrganizeByFeed", 0) != 0;
 
     // Load recording settings
     wchar_t recBuf[512] = {0};
-    GetPrivateProfileStringW(L"Recording", L"Path", L"", recBuf, 512, g_configPath.c_str());
+    ConfigGetString(L"Recording", L"Path", L"", recBuf, 512);
     g_recordPath = recBuf;
-    GetPrivateProfileStringW(L"Recording", L"Template", L"%Y-%m-%d_%H-%M-%S", recBuf, 512, g_configPath.c_str());
+    ConfigGetString(L"Recording", L"Template", L"%Y-%m-%d_%H-%M-%S", recBuf, 512);
     g_recordTemplate = recBuf;
-    g_recordFormat = GetPrivateProfileIntW(L"Recording", L"Format", 0, g_configPath.c_str());
+    g_recordFormat = ConfigGetInt(L"Recording", L"Format", 0);
     if (g_recordFormat < 0) g_recordFormat = 0;
     if (g_recordFormat > 3) g_recordFormat = 3;
-    g_recordBitrate = GetPrivateProfileIntW(L"Recording", L"Bitrate", 192, g_configPath.c_str());
+    g_recordBitrate = ConfigGetInt(L"Recording", L"Bitrate", 192);
 
     // Load speech settings
-    g_speechTrackChange = GetPrivateProfileIntW(L"Speech", L"TrackChange", 0, g_configPath.c_str()) != 0;
-    g_speechVolume = GetPrivateProfileIntW(L"Speech", L"Volume", 1, g_configPath.c_str()) != 0;
-    g_speechEffect = GetPrivateProfileIntW(L"Speech", L"Effect", 1, g_configPath.c_str()) != 0;
+    g_speechTrackChange = ConfigGetInt(L"Speech", L"TrackChange", 0) != 0;
+    g_speechVolume = ConfigGetInt(L"Speech", L"Volume", 1) != 0;
+    g_speechEffect = ConfigGetInt(L"Speech", L"Effect", 1) != 0;
 
     // Load shuffle and auto-advance settings
-    g_shuffle = GetPrivateProfileIntW(L"Playback", L"Shuffle", 0, g_configPath.c_str()) != 0;
-    g_autoAdvance = GetPrivateProfileIntW(L"Playback", L"AutoAdvance", 1, g_configPath.c_str()) != 0;
-    g_repeatMode = GetPrivateProfileIntW(L"Playback", L"RepeatMode", 0, g_configPath.c_str());
+    g_shuffle = ConfigGetInt(L"Playback", L"Shuffle", 0) != 0;
+    g_autoAdvance = ConfigGetInt(L"Playback", L"AutoAdvance", 1) != 0;
+    g_gapless = ConfigGetInt(L"Playback", L"Gapless", 1) != 0;
+    g_crossfadeMs = ConfigGetInt(L"Playback", L"CrossfadeMs", 0);
+    if (g_crossfadeMs < 0) g_crossfadeMs = 0;
+    if (g_crossfadeMs > 12000) g_crossfadeMs = 12000;
+    g_crossfadeCurve = ConfigGetInt(L"Playback", L"CrossfadeCurve", 1);
+    if (g_crossfadeCurve < 0 || g_crossfadeCurve > 2) g_crossfadeCurve = 1;
+    g_crossfadeSmart = ConfigGetInt(L"Playback", L"CrossfadeSmart", 1) != 0;
+    g_repeatMode = ConfigGetInt(L"Playback", L"RepeatMode", 0);
     if (g_repeatMode < 0 || g_repeatMode > 2) g_repeatMode = 0;
-    g_playlistFollowPlayback = GetPrivateProfileIntW(L"Playback", L"PlaylistFollow", 1, g_configPath.c_str()) != 0;
-    g_checkForUpdates = GetPrivateProfileIntW(L"Playback", L"CheckForUpdates", 1, g_configPath.c_str()) != 0;
-    g_allowMultipleInstances = GetPrivateProfileIntW(L"Playback", L"AllowMultipleInstances", 0, g_configPath.c_str()) != 0;
+    g_playlistFollowPlayback = ConfigGetInt(L"Playback", L"PlaylistFollow", 1) != 0;
+    g_checkForUpdates = ConfigGetInt(L"Playback", L"CheckForUpdates", 1) != 0;
+    g_allowMultipleInstances = ConfigGetInt(L"Playback", L"AllowMultipleInstances", 0) != 0;
 
     // Load seek settings
-    g_seekEnabled[0] = GetPrivateProfileIntW(L"Movement", L"Seek1s", 0, g_configPath.c_str()) != 0;
-    g_seekEnabled[1] = GetPrivateProfileIntW(L"Movement", L"Seek5s", 1, g_configPath.c_str()) != 0;
-    g_seekEnabled[2] = GetPrivateProfileIntW(L"Movement", L"Seek10s", 0, g_configPath.c_str()) != 0;
-    g_seekEnabled[3] = GetPrivateProfileIntW(L"Movement", L"Seek30s", 0, g_configPath.c_str()) != 0;
-    g_seekEnabled[4] = GetPrivateProfileIntW(L"Movement", L"Seek1m", 0, g_configPath.c_str()) != 0;
-    g_seekEnabled[5] = GetPrivateProfileIntW(L"Movement", L"Seek5m", 0, g_configPath.c_str()) != 0;
-    g_seekEnabled[6] = GetPrivateProfileIntW(L"Movement", L"Seek10m", 0, g_configPath.c_str()) != 0;
-    g_seekEnabled[7] = GetPrivateProfileIntW(L"Movement", L"Seek30m", 0, g_configPath.c_str()) != 0;
-    g_seekEnabled[8] = GetPrivateProfileIntW(L"Movement", L"Seek1h", 0, g_configPath.c_str()) != 0;
-    g_seekEnabled[9] = GetPrivateProfileIntW(L"Movement", L"Seek1t", 0, g_configPath.c_str()) != 0;
-    g_seekEnabled[10] = GetPrivateProfileIntW(L"Movement", L"Seek5t", 0, g_configPath.c_str()) != 0;
-    g_seekEnabled[11] = GetPrivateProfileIntW(L"Movement", L"Seek10t", 0, g_configPath.c_str()) != 0;
-    g_chapterSeekEnabled = GetPrivateProfileIntW(L"Movement", L"ChapterSeek", 1, g_configPath.c_str()) != 0;
-    g_currentSeekIndex = GetPrivateProfileIntW(L"Movement", L"CurrentSeek", 1, g_configPath.c_str());
+    g_seekEnabled[0] = ConfigGetInt(L"Movement", L"Seek1s", 0) != 0;
+    g_seekEnabled[1] = ConfigGetInt(L"Movement", L"Seek5s", 1) != 0;
+    g_seekEnabled[2] = ConfigGetInt(L"Movement", L"Seek10s", 0) != 0;
+    g_seekEnabled[3] = ConfigGetInt(L"Movement", L"Seek30s", 0) != 0;
+    g_seekEnabled[4] = ConfigGetInt(L"Movement", L"Seek1m", 0) != 0;
+    g_seekEnabled[5] = ConfigGetInt(L"Movement", L"Seek5m", 0) != 0;
+    g_seekEnabled[6] = ConfigGetInt(L"Movement", L"Seek10m", 0) != 0;
+    g_seekEnabled[7] = ConfigGetInt(L"Movement", L"Seek30m", 0) != 0;
+    g_seekEnabled[8] = ConfigGetInt(L"Movement", L"Seek1h", 0) != 0;
+    g_seekEnabled[9] = ConfigGetInt(L"Movement", L"Seek1t", 0) != 0;
+    g_seekEnabled[10] = ConfigGetInt(L"Movement", L"Seek5t", 0) != 0;
+    g_seekEnabled[11] = ConfigGetInt(L"Movement", L"Seek10t", 0) != 0;
+    g_chapterSeekEnabled = ConfigGetInt(L"Movement", L"ChapterSeek", 1) != 0;
+    g_currentSeekIndex = ConfigGetInt(L"Movement", L"CurrentSeek", 1);
 
     // Validate current seek index
     if (g_currentSeekIndex < 0 || g_currentSeekIndex >= g_seekAmountCount || !g_seekEnabled[g_currentSeekIndex]) {
@@ -239,12 +277,12 @@ void LoadSettings() {
     }
 
     // Load effect settings
-    g_effectEnabled[0] = GetPrivateProfileIntW(L"Effects", L"Volume", 1, g_configPath.c_str()) != 0;  // Volume enabled by default
-    g_effectEnabled[1] = GetPrivateProfileIntW(L"Effects", L"Pitch", 0, g_configPath.c_str()) != 0;
-    g_effectEnabled[2] = GetPrivateProfileIntW(L"Effects", L"Tempo", 0, g_configPath.c_str()) != 0;
-    g_effectEnabled[3] = GetPrivateProfileIntW(L"Effects", L"Rate", 0, g_configPath.c_str()) != 0;
-    g_currentEffectIndex = GetPrivateProfileIntW(L"Effects", L"CurrentEffect", 0, g_configPath.c_str());
-    g_rateStepMode = GetPrivateProfileIntW(L"Effects", L"RateStepMode", 0, g_configPath.c_str());
+    g_effectEnabled[0] = ConfigGetInt(L"Effects", L"Volume", 1) != 0;  // Volume enabled by default
+    g_effectEnabled[1] = ConfigGetInt(L"Effects", L"Pitch", 0) != 0;
+    g_effectEnabled[2] = ConfigGetInt(L"Effects", L"Tempo", 0) != 0;
+    g_effectEnabled[3] = ConfigGetInt(L"Effects", L"Rate", 0) != 0;
+    g_currentEffectIndex = ConfigGetInt(L"Effects", L"CurrentEffect", 0);
+    g_rateStepMode = ConfigGetInt(L"Effects", L"RateStepMode", 0);
     if (g_rateStepMode < 0 || g_rateStepMode > 1) g_rateStepMode = 0;
 
     // Validate current effect index
@@ -262,30 +300,22 @@ void LoadSettings() {
     // Note: DSP effect enabled states are loaded in LoadDSPSettings() after InitEffects()
 }
 
-// Helper to read float from INI with default
-static float GetPrivateProfileFloatW(const wchar_t* section, const wchar_t* key, float defaultVal, const wchar_t* path) {
-    wchar_t buf[32] = {0};
-    GetPrivateProfileStringW(section, key, L"", buf, 32, path);
-    if (buf[0] == L'\0') return defaultVal;
-    return static_cast<float>(_wtof(buf));
-}
-
 // Load DSP effect settings (call after InitEffects)
 void LoadDSPSettings() {
     // Load DSP effect enabled states
-    EnableDSPEffect(DSPEffectType::Reverb, GetPrivateProfileIntW(L"DSPEffects", L"Reverb", 0, g_configPath.c_str()) != 0);
-    EnableDSPEffect(DSPEffectType::Echo, GetPrivateProfileIntW(L"DSPEffects", L"Echo", 0, g_configPath.c_str()) != 0);
-    EnableDSPEffect(DSPEffectType::EQ, GetPrivateProfileIntW(L"DSPEffects", L"EQ", 0, g_configPath.c_str()) != 0);
-    EnableDSPEffect(DSPEffectType::Compressor, GetPrivateProfileIntW(L"DSPEffects", L"Compressor", 0, g_configPath.c_str()) != 0);
-    EnableDSPEffect(DSPEffectType::StereoWidth, GetPrivateProfileIntW(L"DSPEffects", L"StereoWidth", 0, g_configPath.c_str()) != 0);
-    EnableDSPEffect(DSPEffectType::CenterCancel, GetPrivateProfileIntW(L"DSPEffects", L"CenterCancel", 0, g_configPath.c_str()) != 0);
-    EnableDSPEffect(DSPEffectType::Convolution, GetPrivateProfileIntW(L"DSPEffects", L"Convolution", 0, g_configPath.c_str()) != 0);
-    EnableDSPEffect(DSPEffectType::SpatialAudio, GetPrivateProfileIntW(L"DSPEffects", L"SpatialAudio", 0, g_configPath.c_str()) != 0);
+    EnableDSPEffect(DSPEffectType::Reverb, ConfigGetInt(L"DSPEffects", L"Reverb", 0) != 0);
+    EnableDSPEffect(DSPEffectType::Echo, ConfigGetInt(L"DSPEffects", L"Echo", 0) != 0);
+    EnableDSPEffect(DSPEffectType::EQ, ConfigGetInt(L"DSPEffects", L"EQ", 0) != 0);
+    EnableDSPEffect(DSPEffectType::Compressor, ConfigGetInt(L"DSPEffects", L"Compressor", 0) != 0);
+    EnableDSPEffect(DSPEffectType::StereoWidth, ConfigGetInt(L"DSPEffects", L"StereoWidth", 0) != 0);
+    EnableDSPEffect(DSPEffectType::CenterCancel, ConfigGetInt(L"DSPEffects", L"CenterCancel", 0) != 0);
+    EnableDSPEffect(DSPEffectType::Convolution, ConfigGetInt(L"DSPEffects", L"Convolution", 0) != 0);
+    EnableDSPEffect(DSPEffectType::SpatialAudio, ConfigGetInt(L"DSPEffects", L"SpatialAudio", 0) != 0);
 
     // Load convolution IR path
     {
         wchar_t irPath[MAX_PATH] = {0};
-        GetPrivateProfileStringW(L"DSPEffects", L"ConvolutionIR", L"", irPath, MAX_PATH, g_configPath.c_str());
+        ConfigGetString(L"DSPEffects", L"ConvolutionIR", L"", irPath, MAX_PATH);
         g_convolutionIRPath = irPath;
         if (!g_convolutionIRPath.empty()) {
             ConvolutionReverb* conv = GetConvolutionReverb();
@@ -299,84 +329,84 @@ void LoadDSPSettings() {
     const ParamDef* def;
 
     def = GetParamDef(ParamId::ReverbMix);
-    SetParamValue(ParamId::ReverbMix, GetPrivateProfileFloatW(L"DSPParams", L"ReverbMix", def->defaultValue, g_configPath.c_str()));
+    SetParamValue(ParamId::ReverbMix, ConfigGetFloat(L"DSPParams", L"ReverbMix", def->defaultValue));
     def = GetParamDef(ParamId::ReverbRoom);
-    SetParamValue(ParamId::ReverbRoom, GetPrivateProfileFloatW(L"DSPParams", L"ReverbRoom", def->defaultValue, g_configPath.c_str()));
+    SetParamValue(ParamId::ReverbRoom, ConfigGetFloat(L"DSPParams", L"ReverbRoom", def->defaultValue));
     def = GetParamDef(ParamId::ReverbDamp);
-    SetParamValue(ParamId::ReverbDamp, GetPrivateProfileFloatW(L"DSPParams", L"ReverbDamp", def->defaultValue, g_configPath.c_str()));
+    SetParamValue(ParamId::ReverbDamp, ConfigGetFloat(L"DSPParams", L"ReverbDamp", def->defaultValue));
 
     // DX8 Reverb parameters
     def = GetParamDef(ParamId::DX8ReverbTime);
-    SetParamValue(ParamId::DX8ReverbTime, GetPrivateProfileFloatW(L"DSPParams", L"DX8ReverbTime", def->defaultValue, g_configPath.c_str()));
+    SetParamValue(ParamId::DX8ReverbTime, ConfigGetFloat(L"DSPParams", L"DX8ReverbTime", def->defaultValue));
     def = GetParamDef(ParamId::DX8ReverbHFRatio);
-    SetParamValue(ParamId::DX8ReverbHFRatio, GetPrivateProfileFloatW(L"DSPParams", L"DX8ReverbHFRatio", def->defaultValue, g_configPath.c_str()));
+    SetParamValue(ParamId::DX8ReverbHFRatio, ConfigGetFloat(L"DSPParams", L"DX8ReverbHFRatio", def->defaultValue));
     def = GetParamDef(ParamId::DX8ReverbMix);
-    SetParamValue(ParamId::DX8ReverbMix, GetPrivateProfileFloatW(L"DSPParams", L"DX8ReverbMix", def->defaultValue, g_configPath.c_str()));
+    SetParamValue(ParamId::DX8ReverbMix, ConfigGetFloat(L"DSPParams", L"DX8ReverbMix", def->defaultValue));
 
     // I3DL2 Reverb parameters
     def = GetParamDef(ParamId::I3DL2Room);
-    SetParamValue(ParamId::I3DL2Room, GetPrivateProfileFloatW(L"DSPParams", L"I3DL2Room", def->defaultValue, g_configPath.c_str()));
+    SetParamValue(ParamId::I3DL2Room, ConfigGetFloat(L"DSPParams", L"I3DL2Room", def->defaultValue));
     def = GetParamDef(ParamId::I3DL2DecayTime);
-    SetParamValue(ParamId::I3DL2DecayTime, GetPrivateProfileFloatW(L"DSPParams", L"I3DL2DecayTime", def->defaultValue, g_configPath.c_str()));
+    SetParamValue(ParamId::I3DL2DecayTime, ConfigGetFloat(L"DSPParams", L"I3DL2DecayTime", def->defaultValue));
     def = GetParamDef(ParamId::I3DL2Diffusion);
-    SetParamValue(ParamId::I3DL2Diffusion, GetPrivateProfileFloatW(L"DSPParams", L"I3DL2Diffusion", def->defaultValue, g_configPath.c_str()));
+    SetParamValue(ParamId::I3DL2Diffusion, ConfigGetFloat(L"DSPParams", L"I3DL2Diffusion", def->defaultValue));
     def = GetParamDef(ParamId::I3DL2Density);
-    SetParamValue(ParamId::I3DL2Density, GetPrivateProfileFloatW(L"DSPParams", L"I3DL2Density", def->defaultValue, g_configPath.c_str()));
+    SetParamValue(ParamId::I3DL2Density, ConfigGetFloat(L"DSPParams", L"I3DL2Density", def->defaultValue));
 
     def = GetParamDef(ParamId::EchoDelay);
-    SetParamValue(ParamId::EchoDelay, GetPrivateProfileFloatW(L"DSPParams", L"EchoDelay", def->defaultValue, g_configPath.c_str()));
+    SetParamValue(ParamId::EchoDelay, ConfigGetFloat(L"DSPParams", L"EchoDelay", def->defaultValue));
     def = GetParamDef(ParamId::EchoFeedback);
-    SetParamValue(ParamId::EchoFeedback, GetPrivateProfileFloatW(L"DSPParams", L"EchoFeedback", def->defaultValue, g_configPath.c_str()));
+    SetParamValue(ParamId::EchoFeedback, ConfigGetFloat(L"DSPParams", L"EchoFeedback", def->defaultValue));
     def = GetParamDef(ParamId::EchoMix);
-    SetParamValue(ParamId::EchoMix, GetPrivateProfileFloatW(L"DSPParams", L"EchoMix", def->defaultValue, g_configPath.c_str()));
+    SetParamValue(ParamId::EchoMix, ConfigGetFloat(L"DSPParams", L"EchoMix", def->defaultValue));
 
     def = GetParamDef(ParamId::EQPreamp);
-    SetParamValue(ParamId::EQPreamp, GetPrivateProfileFloatW(L"DSPParams", L"EQPreamp", def->defaultValue, g_configPath.c_str()));
+    SetParamValue(ParamId::EQPreamp, ConfigGetFloat(L"DSPParams", L"EQPreamp", def->defaultValue));
     def = GetParamDef(ParamId::EQBass);
-    SetParamValue(ParamId::EQBass, GetPrivateProfileFloatW(L"DSPParams", L"EQBass", def->defaultValue, g_configPath.c_str()));
+    SetParamValue(ParamId::EQBass, ConfigGetFloat(L"DSPParams", L"EQBass", def->defaultValue));
     def = GetParamDef(ParamId::EQMid);
-    SetParamValue(ParamId::EQMid, GetPrivateProfileFloatW(L"DSPParams", L"EQMid", def->defaultValue, g_configPath.c_str()));
+    SetParamValue(ParamId::EQMid, ConfigGetFloat(L"DSPParams", L"EQMid", def->defaultValue));
     def = GetParamDef(ParamId::EQTreble);
-    SetParamValue(ParamId::EQTreble, GetPrivateProfileFloatW(L"DSPParams", L"EQTreble", def->defaultValue, g_configPath.c_str()));
+    SetParamValue(ParamId::EQTreble, ConfigGetFloat(L"DSPParams", L"EQTreble", def->defaultValue));
 
     def = GetParamDef(ParamId::CompThreshold);
-    SetParamValue(ParamId::CompThreshold, GetPrivateProfileFloatW(L"DSPParams", L"CompThreshold", def->defaultValue, g_configPath.c_str()));
+    SetParamValue(ParamId::CompThreshold, ConfigGetFloat(L"DSPParams", L"CompThreshold", def->defaultValue));
     def = GetParamDef(ParamId::CompRatio);
-    SetParamValue(ParamId::CompRatio, GetPrivateProfileFloatW(L"DSPParams", L"CompRatio", def->defaultValue, g_configPath.c_str()));
+    SetParamValue(ParamId::CompRatio, ConfigGetFloat(L"DSPParams", L"CompRatio", def->defaultValue));
     def = GetParamDef(ParamId::CompAttack);
-    SetParamValue(ParamId::CompAttack, GetPrivateProfileFloatW(L"DSPParams", L"CompAttack", def->defaultValue, g_configPath.c_str()));
+    SetParamValue(ParamId::CompAttack, ConfigGetFloat(L"DSPParams", L"CompAttack", def->defaultValue));
     def = GetParamDef(ParamId::CompRelease);
-    SetParamValue(ParamId::CompRelease, GetPrivateProfileFloatW(L"DSPParams", L"CompRelease", def->defaultValue, g_configPath.c_str()));
+    SetParamValue(ParamId::CompRelease, ConfigGetFloat(L"DSPParams", L"CompRelease", def->defaultValue));
     def = GetParamDef(ParamId::CompGain);
-    SetParamValue(ParamId::CompGain, GetPrivateProfileFloatW(L"DSPParams", L"CompGain", def->defaultValue, g_configPath.c_str()));
+    SetParamValue(ParamId::CompGain, ConfigGetFloat(L"DSPParams", L"CompGain", def->defaultValue));
 
     def = GetParamDef(ParamId::StereoWidth);
-    SetParamValue(ParamId::StereoWidth, GetPrivateProfileFloatW(L"DSPParams", L"StereoWidth", def->defaultValue, g_configPath.c_str()));
+    SetParamValue(ParamId::StereoWidth, ConfigGetFloat(L"DSPParams", L"StereoWidth", def->defaultValue));
 
     def = GetParamDef(ParamId::CenterCancel);
-    SetParamValue(ParamId::CenterCancel, GetPrivateProfileFloatW(L"DSPParams", L"CenterCancel", def->defaultValue, g_configPath.c_str()));
+    SetParamValue(ParamId::CenterCancel, ConfigGetFloat(L"DSPParams", L"CenterCancel", def->defaultValue));
 
     def = GetParamDef(ParamId::ConvolutionMix);
-    SetParamValue(ParamId::ConvolutionMix, GetPrivateProfileFloatW(L"DSPParams", L"ConvolutionMix", def->defaultValue, g_configPath.c_str()));
+    SetParamValue(ParamId::ConvolutionMix, ConfigGetFloat(L"DSPParams", L"ConvolutionMix", def->defaultValue));
     def = GetParamDef(ParamId::ConvolutionGain);
-    SetParamValue(ParamId::ConvolutionGain, GetPrivateProfileFloatW(L"DSPParams", L"ConvolutionGain", def->defaultValue, g_configPath.c_str()));
+    SetParamValue(ParamId::ConvolutionGain, ConfigGetFloat(L"DSPParams", L"ConvolutionGain", def->defaultValue));
 
     def = GetParamDef(ParamId::SpatialBlend);
-    SetParamValue(ParamId::SpatialBlend, GetPrivateProfileFloatW(L"DSPParams", L"SpatialBlend", def->defaultValue, g_configPath.c_str()));
+    SetParamValue(ParamId::SpatialBlend, ConfigGetFloat(L"DSPParams", L"SpatialBlend", def->defaultValue));
     def = GetParamDef(ParamId::SpatialWidth);
-    SetParamValue(ParamId::SpatialWidth, GetPrivateProfileFloatW(L"DSPParams", L"SpatialWidth", def->defaultValue, g_configPath.c_str()));
+    SetParamValue(ParamId::SpatialWidth, ConfigGetFloat(L"DSPParams", L"SpatialWidth", def->defaultValue));
     def = GetParamDef(ParamId::SpatialRotation);
-    SetParamValue(ParamId::SpatialRotation, GetPrivateProfileFloatW(L"DSPParams", L"SpatialRotation", def->defaultValue, g_configPath.c_str()));
+    SetParamValue(ParamId::SpatialRotation, ConfigGetFloat(L"DSPParams", L"SpatialRotation", def->defaultValue));
     def = GetParamDef(ParamId::SpatialMode);
-    SetParamValue(ParamId::SpatialMode, GetPrivateProfileFloatW(L"DSPParams", L"SpatialMode", def->defaultValue, g_configPath.c_str()));
+    SetParamValue(ParamId::SpatialMode, ConfigGetFloat(L"DSPParams", L"SpatialMode", def->defaultValue));
     def = GetParamDef(ParamId::SpatialRearCenter);
-    SetParamValue(ParamId::SpatialRearCenter, GetPrivateProfileFloatW(L"DSPParams", L"SpatialRearCenter", def->defaultValue, g_configPath.c_str()));
+    SetParamValue(ParamId::SpatialRearCenter, ConfigGetFloat(L"DSPParams", L"SpatialRearCenter", def->defaultValue));
     def = GetParamDef(ParamId::SpatialX);
-    SetParamValue(ParamId::SpatialX, GetPrivateProfileFloatW(L"DSPParams", L"SpatialX", def->defaultValue, g_configPath.c_str()));
+    SetParamValue(ParamId::SpatialX, ConfigGetFloat(L"DSPParams", L"SpatialX", def->defaultValue));
     def = GetParamDef(ParamId::SpatialY);
-    SetParamValue(ParamId::SpatialY, GetPrivateProfileFloatW(L"DSPParams", L"SpatialY", def->defaultValue, g_configPath.c_str()));
+    SetParamValue(ParamId::SpatialY, ConfigGetFloat(L"DSPParams", L"SpatialY", def->defaultValue));
     def = GetParamDef(ParamId::SpatialZ);
-    SetParamValue(ParamId::SpatialZ, GetPrivateProfileFloatW(L"DSPParams", L"SpatialZ", def->defaultValue, g_configPath.c_str()));
+    SetParamValue(ParamId::SpatialZ, ConfigGetFloat(L"DSPParams", L"SpatialZ", def->defaultValue));
 
     // Load recent files
     g_recentFiles.clear();
@@ -384,7 +414,7 @@ void LoadDSPSettings() {
         wchar_t key[32];
         swprintf(key, 32, L"File%d", i);
         wchar_t path[MAX_PATH] = {0};
-        GetPrivateProfileStringW(L"RecentFiles", key, L"", path, MAX_PATH, g_configPath.c_str());
+        ConfigGetString(L"RecentFiles", key, L"", path, MAX_PATH);
         if (path[0] != L'\0') {
             g_recentFiles.push_back(path);
         }
@@ -396,293 +426,379 @@ void SaveSettings() {
     wchar_t buf[32];
 
     // Save device name (empty for default device)
-    WritePrivateProfileStringW(L"Playback", L"DeviceName", g_selectedDeviceName.c_str(), g_configPath.c_str());
+    ConfigWriteString(L"Playback", L"DeviceName", g_selectedDeviceName.c_str());
 
     swprintf(buf, 32, L"%d", g_rewindOnPauseMs);
-    WritePrivateProfileStringW(L"Playback", L"RewindOnPauseMs", buf, g_configPath.c_str());
+    ConfigWriteString(L"Playback", L"RewindOnPauseMs", buf);
 
-    WritePrivateProfileStringW(L"Playback", L"AllowAmplify", g_allowAmplify ? L"1" : L"0", g_configPath.c_str());
-    WritePrivateProfileStringW(L"Playback", L"RememberState", g_rememberState ? L"1" : L"0", g_configPath.c_str());
+    ConfigWriteString(L"Playback", L"AllowAmplify", g_allowAmplify ? L"1" : L"0");
+    ConfigWriteString(L"Playback", L"RememberState", g_rememberState ? L"1" : L"0");
 
     swprintf(buf, 32, L"%d", g_rememberPosMinutes);
-    WritePrivateProfileStringW(L"Playback", L"RememberPosMinutes", buf, g_configPath.c_str());
+    ConfigWriteString(L"Playback", L"RememberPosMinutes", buf);
 
-    WritePrivateProfileStringW(L"Playback", L"BringToFront", g_bringToFront ? L"1" : L"0", g_configPath.c_str());
-    WritePrivateProfileStringW(L"Playback", L"MinimizeToTray", g_minimizeToTray ? L"1" : L"0", g_configPath.c_str());
-    WritePrivateProfileStringW(L"Playback", L"LoadFolder", g_loadFolder ? L"1" : L"0", g_configPath.c_str());
-    WritePrivateProfileStringW(L"Playback", L"RegisterFileTypes", g_registerFileTypes ? L"1" : L"0", g_configPath.c_str());
+    ConfigWriteString(L"Playback", L"BringToFront", g_bringToFront ? L"1" : L"0");
+    ConfigWriteString(L"Playback", L"MinimizeToTray", g_minimizeToTray ? L"1" : L"0");
+    ConfigWriteString(L"Playback", L"LoadFolder", g_loadFolder ? L"1" : L"0");
+    ConfigWriteString(L"Playback", L"RegisterFileTypes", g_registerFileTypes ? L"1" : L"0");
 
     swprintf(buf, 32, L"%d", static_cast<int>(g_volumeStep * 100 + 0.5f));
-    WritePrivateProfileStringW(L"Playback", L"VolumeStep", buf, g_configPath.c_str());
-    WritePrivateProfileStringW(L"Playback", L"ShowTitleInWindow", g_showTitleInWindow ? L"1" : L"0", g_configPath.c_str());
+    ConfigWriteString(L"Playback", L"VolumeStep", buf);
+    ConfigWriteString(L"Playback", L"ShowTitleInWindow", g_showTitleInWindow ? L"1" : L"0");
 
     swprintf(buf, 32, L"%d", g_replayGainMode);
-    WritePrivateProfileStringW(L"Playback", L"ReplayGainMode", buf, g_configPath.c_str());
+    ConfigWriteString(L"Playback", L"ReplayGainMode", buf);
     swprintf(buf, 32, L"%d", static_cast<int>(g_replayGainPreamp * 100 + (g_replayGainPreamp >= 0 ? 0.5f : -0.5f)));
-    WritePrivateProfileStringW(L"Playback", L"ReplayGainPreamp", buf, g_configPath.c_str());
-    WritePrivateProfileStringW(L"Playback", L"ReplayGainPreventClip", g_replayGainPreventClip ? L"1" : L"0", g_configPath.c_str());
+    ConfigWriteString(L"Playback", L"ReplayGainPreamp", buf);
+    ConfigWriteString(L"Playback", L"ReplayGainPreventClip", g_replayGainPreventClip ? L"1" : L"0");
 
     swprintf(buf, 32, L"%d", static_cast<int>(g_volume * 100 + 0.5f));
-    WritePrivateProfileStringW(L"Playback", L"Volume", buf, g_configPath.c_str());
+    ConfigWriteString(L"Playback", L"Volume", buf);
 
     // Save stream effect values (pitch, tempo, rate)
     swprintf(buf, 32, L"%.1f", g_pitch);
-    WritePrivateProfileStringW(L"Playback", L"Pitch", buf, g_configPath.c_str());
+    ConfigWriteString(L"Playback", L"Pitch", buf);
     swprintf(buf, 32, L"%.1f", g_tempo);
-    WritePrivateProfileStringW(L"Playback", L"Tempo", buf, g_configPath.c_str());
+    ConfigWriteString(L"Playback", L"Tempo", buf);
     swprintf(buf, 32, L"%.2f", g_rate);
-    WritePrivateProfileStringW(L"Playback", L"Rate", buf, g_configPath.c_str());
+    ConfigWriteString(L"Playback", L"Rate", buf);
 
     // Save advanced settings (buffer)
     swprintf(buf, 32, L"%d", g_bufferSize);
-    WritePrivateProfileStringW(L"Advanced", L"BufferSize", buf, g_configPath.c_str());
+    ConfigWriteString(L"Advanced", L"BufferSize", buf);
     swprintf(buf, 32, L"%d", g_updatePeriod);
-    WritePrivateProfileStringW(L"Advanced", L"UpdatePeriod", buf, g_configPath.c_str());
+    ConfigWriteString(L"Advanced", L"UpdatePeriod", buf);
     swprintf(buf, 32, L"%d", g_tempoAlgorithm);
-    WritePrivateProfileStringW(L"Advanced", L"TempoAlgorithm", buf, g_configPath.c_str());
-    WritePrivateProfileStringW(L"Advanced", L"LegacyVolume", g_legacyVolume ? L"1" : L"0", g_configPath.c_str());
-    WritePrivateProfileStringW(L"Advanced", L"DisableBatchDelay", g_disableBatchDelay ? L"1" : L"0", g_configPath.c_str());
+    ConfigWriteString(L"Advanced", L"TempoAlgorithm", buf);
+    swprintf(buf, 32, L"%d", g_resamplerQuality);
+    ConfigWriteString(L"Advanced", L"ResamplerQuality", buf);
+    swprintf(buf, 32, L"%d", g_readAheadSeconds);
+    ConfigWriteString(L"Advanced", L"ReadAheadSeconds", buf);
+    swprintf(buf, 32, L"%d", g_prefetchTracks);
+    ConfigWriteString(L"Advanced", L"PrefetchTracks", buf);
+    swprintf(buf, 32, L"%d", g_prefetchMemoryMB);
+    ConfigWriteString(L"Advanced", L"PrefetchMemoryMB", buf);
+    swprintf(buf, 32, L"%d", g_libraryScanThreads);
+    ConfigWriteString(L"Advanced", L"LibraryScanThreads", buf);
+    swprintf(buf, 32, L"%d", g_checkpointSeconds);
+    ConfigWriteString(L"Advanced", L"CheckpointSeconds", buf);
+    swprintf(buf, 32, L"%d", g_songHistoryLimit);
+    ConfigWriteString(L"Advanced", L"SongHistoryLimit", buf);
+    ConfigWriteString(L"Advanced", L"LegacyVolume", g_legacyVolume ? L"1" : L"0");
+    ConfigWriteString(L"Advanced", L"DisableBatchDelay", g_disableBatchDelay ? L"1" : L"0");
 
     // Save SoundTouch settings
-    WritePrivateProfileStringW(L"SoundTouch", L"AntiAliasFilter", g_stAntiAliasFilter ? L"1" : L"0", g_configPath.c_str());
+    ConfigWriteString(L"SoundTouch", L"AntiAliasFilter", g_stAntiAliasFilter ? L"1" : L"0");
     swprintf(buf, 32, L"%d", g_stAAFilterLength);
-    WritePrivateProfileStringW(L"SoundTouch", L"AAFilterLength", buf, g_configPath.c_str());
-    WritePrivateProfileStringW(L"SoundTouch", L"QuickAlgorithm", g_stQuickAlgorithm ? L"1" : L"0", g_configPath.c_str());
+    ConfigWriteString(L"SoundTouch", L"AAFilterLength", buf);
+    ConfigWriteString(L"SoundTouch", L"QuickAlgorithm", g_stQuickAlgorithm ? L"1" : L"0");
     swprintf(buf, 32, L"%d", g_stSequenceMs);
-    WritePrivateProfileStringW(L"SoundTouch", L"SequenceMs", buf, g_configPath.c_str());
+    ConfigWriteString(L"SoundTouch", L"SequenceMs", buf);
     swprintf(buf, 32, L"%d", g_stSeekWindowMs);
-    WritePrivateProfileStringW(L"SoundTouch", L"SeekWindowMs", buf, g_configPath.c_str());
+    ConfigWriteString(L"SoundTouch", L"SeekWindowMs", buf);
     swprintf(buf, 32, L"%d", g_stOverlapMs);
-    WritePrivateProfileStringW(L"SoundTouch", L"OverlapMs", buf, g_configPath.c_str());
-    WritePrivateProfileStringW(L"SoundTouch", L"PreventClick", g_stPreventClick ? L"1" : L"0", g_configPath.c_str());
+    ConfigWriteString(L"SoundTouch", L"OverlapMs", buf);
+    ConfigWriteString(L"SoundTouch", L"PreventClick", g_stPreventClick ? L"1" : L"0");
     swprintf(buf, 32, L"%d", g_stAlgorithm);
-    WritePrivateProfileStringW(L"SoundTouch", L"Algorithm", buf, g_configPath.c_str());
+    ConfigWriteString(L"SoundTouch", L"Algorithm", buf);
 
     // Save Speedy settings
-    WritePrivateProfileStringW(L"Speedy", L"NonlinearSpeedup", g_speedyNonlinear ? L"1" : L"0", g_configPath.c_str());
+    ConfigWriteString(L"Speedy", L"NonlinearSpeedup", g_speedyNonlinear ? L"1" : L"0");
 
     // Save Signalsmith Stretch settings
     swprintf(buf, 32, L"%d", g_ssPreset);
-    WritePrivateProfileStringW(L"Signalsmith", L"Preset", buf, g_configPath.c_str());
+    ConfigWriteString(L"Signalsmith", L"Preset", buf);
     swprintf(buf, 32, L"%d", g_ssTonalityLimit);
-    WritePrivateProfileStringW(L"Signalsmith", L"TonalityLimit", buf, g_configPath.c_str());
+    ConfigWriteString(L"Signalsmith", L"TonalityLimit", buf);
+    swprintf(buf, 32, L"%d", g_ssThreads);
+    ConfigWriteString(L"Signalsmith", L"Threads", buf);
 
     // Save reverb algorithm
     swprintf(buf, 32, L"%d", g_reverbAlgorithm);
-    WritePrivateProfileStringW(L"Effects", L"ReverbAlgorithm", buf, g_configPath.c_str());
+    ConfigWriteString(L"Effects", L"ReverbAlgorithm", buf);
+    ConfigWriteString(L"Effects", L"DownmixStereo", g_downmixStereo ? L"1" : L"0");
 
     // Save MIDI settings
-    WritePrivateProfileStringW(L"MIDI", L"SoundFont", g_midiSoundFont.c_str(), g_configPath.c_str());
+    ConfigWriteString(L"MIDI", L"SoundFont", g_midiSoundFont.c_str());
     swprintf(buf, 32, L"%d", g_midiMaxVoices);
-    WritePrivateProfileStringW(L"MIDI", L"MaxVoices", buf, g_configPath.c_str());
-    WritePrivateProfileStringW(L"MIDI", L"SincInterp", g_midiSincInterp ? L"1" : L"0", g_configPath.c_str());
+    ConfigWriteString(L"MIDI", L"MaxVoices", buf);
+    ConfigWriteString(L"MIDI", L"SincInterp", g_midiSincInterp ? L"1" : L"0");
 
     swprintf(buf, 32, L"%.1f", g_eqBassFreq);
-    WritePrivateProfileStringW(L"Advanced", L"EQBassFreq", buf, g_configPath.c_str());
+    ConfigWriteString(L"Advanced", L"EQBassFreq", buf);
     swprintf(buf, 32, L"%.1f", g_eqMidFreq);
-    WritePrivateProfileStringW(L"Advanced", L"EQMidFreq", buf, g_configPath.c_str());
+    ConfigWriteString(L"Advanced", L"EQMidFreq", buf);
     swprintf(buf, 32, L"%.1f", g_eqTrebleFreq);
-    WritePrivateProfileStringW(L"Advanced", L"EQTrebleFreq", buf, g_configPath.c_str());
+    ConfigWriteString(L"Advanced", L"EQTrebleFreq", buf);
 
     // Save YouTube settings
-    WritePrivateProfileStringW(L"YouTube", L"YtdlpPath", g_ytdlpPath.c_str(), g_configPath.c_str());
-    WritePrivateProfileStringW(L"YouTube", L"ApiKey", g_ytApiKey.c_str(), g_configPath.c_str());
+    ConfigWriteString(L"YouTube", L"YtdlpPath", g_ytdlpPath.c_str());
+    ConfigWriteString(L"YouTube", L"ApiKey", g_ytApiKey.c_str());
 
     // Save downloads settings
-    WritePrivateProfileStringW(L"Downloads", L"Path", g_downloadPath.c_str(), g_configPath.c_str());
-    WritePrivateProfileStringW(L"Downloads", L"OrganizeByFeed", g_downloadOrganizeByFeed ? L"1" : L"0", g_configPath.c_str());
+    ConfigWriteString(L"Downloads", L"Path", g_downloadPath.c_str());
+    ConfigWriteString(L"Downloads", L"OrganizeByFeed", g_downloadOrganizeByFeed ? L"1" : L"0");
 
     // Save recording settings
-    WritePrivateProfileStringW(L"Recording", L"Path", g_recordPath.c_str(), g_configPath.c_str());
-    WritePrivateProfileStringW(L"Recording", L"Template", g_recordTemplate.c_str(), g_configPath.c_str());
+    ConfigWriteString(L"Recording", L"Path", g_recordPath.c_str());
+    ConfigWriteString(L"Recording", L"Template", g_recordTemplate.c_str());
     swprintf(buf, 32, L"%d", g_recordFormat);
-    WritePrivateProfileStringW(L"Recording", L"Format", buf, g_configPath.c_str());
+    ConfigWriteString(L"Recording", L"Format", buf);
     swprintf(buf, 32, L"%d", g_recordBitrate);
-    WritePrivateProfileStringW(L"Recording", L"Bitrate", buf, g_configPath.c_str());
+    ConfigWriteString(L"Recording", L"Bitrate", buf);
 
     // Save speech settings
-    WritePrivateProfileStringW(L"Speech", L"TrackChange", g_speechTrackChange ? L"1" : L"0", g_configPath.c_str());
-    WritePrivateProfileStringW(L"Speech", L"Volume", g_speechVolume ? L"1" : L"0", g_configPath.c_str());
-    WritePrivateProfileStringW(L"Speech", L"Effect", g_speechEffect ? L"1" : L"0", g_configPath.c_str());
+    ConfigWriteString(L"Speech", L"TrackChange", g_speechTrackChange ? L"1" : L"0");
+    ConfigWriteString(L"Speech", L"Volume", g_speechVolume ? L"1" : L"0");
+    ConfigWriteString(L"Speech", L"Effect", g_speechEffect ? L"1" : L"0");
 
     // Save shuffle and auto-advance settings
-    WritePrivateProfileStringW(L"Playback", L"Shuffle", g_shuffle ? L"1" : L"0", g_configPath.c_str());
-    WritePrivateProfileStringW(L"Playback", L"AutoAdvance", g_autoAdvance ? L"1" : L"0", g_configPath.c_str());
+    ConfigWriteString(L"Playback", L"Shuffle", g_shuffle ? L"1" : L"0");
+    ConfigWriteString(L"Playback", L"AutoAdvance", g_autoAdvance ? L"1" : L"0");
+    ConfigWriteString(L"Playback", L"Gapless", g_gapless ? L"1" : L"0");
+    swprintf(buf, 32, L"%d", g_crossfadeMs);
+    ConfigWriteString(L"Playback", L"CrossfadeMs", buf);
+    swprintf(buf, 32, L"%d", g_crossfadeCurve);
+    ConfigWriteString(L"Playback", L"CrossfadeCurve", buf);
+    ConfigWriteString(L"Playback", L"CrossfadeSmart", g_crossfadeSmart ? L"1" : L"0");
     swprintf(buf, 32, L"%d", g_repeatMode);
-    WritePrivateProfileStringW(L"Playback", L"RepeatMode", buf, g_configPath.c_str());
-    WritePrivateProfileStringW(L"Playback", L"PlaylistFollow", g_playlistFollowPlayback ? L"1" : L"0", g_configPath.c_str());
-    WritePrivateProfileStringW(L"Playback", L"CheckForUpdates", g_checkForUpdates ? L"1" : L"0", g_configPath.c_str());
-    WritePrivateProfileStringW(L"Playback", L"AllowMultipleInstances", g_allowMultipleInstances ? L"1" : L"0", g_configPath.c_str());
+    ConfigWriteString(L"Playback", L"RepeatMode", buf);
+    ConfigWriteString(L"Playback", L"PlaylistFollow", g_playlistFollowPlayback ? L"1" : L"0");
+    ConfigWriteString(L"Playback", L"CheckForUpdates", g_checkForUpdates ? L"1" : L"0");
+    ConfigWriteString(L"Playback", L"AllowMultipleInstances", g_allowMultipleInstances ? L"1" : L"0");
 
     // Save seek settings
-    WritePrivateProfileStringW(L"Movement", L"Seek1s", g_seekEnabled[0] ? L"1" : L"0", g_configPath.c_str());
-    WritePrivateProfileStringW(L"Movement", L"Seek5s", g_seekEnabled[1] ? L"1" : L"0", g_configPath.c_str());
-    WritePrivateProfileStringW(L"Movement", L"Seek10s", g_seekEnabled[2] ? L"1" : L"0", g_configPath.c_str());
-    WritePrivateProfileStringW(L"Movement", L"Seek30s", g_seekEnabled[3] ? L"1" : L"0", g_configPath.c_str());
-    WritePrivateProfileStringW(L"Movement", L"Seek1m", g_seekEnabled[4] ? L"1" : L"0", g_configPath.c_str());
-    WritePrivateProfileStringW(L"Movement", L"Seek5m", g_seekEnabled[5] ? L"1" : L"0", g_configPath.c_str());
-    WritePrivateProfileStringW(L"Movement", L"Seek10m", g_seekEnabled[6] ? L"1" : L"0", g_configPath.c_str());
-    WritePrivateProfileStringW(L"Movement", L"Seek30m", g_seekEnabled[7] ? L"1" : L"0", g_configPath.c_str());
-    WritePrivateProfileStringW(L"Movement", L"Seek1h", g_seekEnabled[8] ? L"1" : L"0", g_configPath.c_str());
-    WritePrivateProfileStringW(L"Movement", L"Seek1t", g_seekEnabled[9] ? L"1" : L"0", g_configPath.c_str());
-    WritePrivateProfileStringW(L"Movement", L"Seek5t", g_seekEnabled[10] ? L"1" : L"0", g_configPath.c_str());
-    WritePrivateProfileStringW(L"Movement", L"Seek10t", g_seekEnabled[11] ? L"1" : L"0", g_configPath.c_str());
-    WritePrivateProfileStringW(L"Movement", L"ChapterSeek", g_chapterSeekEnabled ? L"1" : L"0", g_configPath.c_str());
+    ConfigWriteString(L"Movement", L"Seek1s", g_seekEnabled[0] ? L"1" : L"0");
+    ConfigWriteString(L"Movement", L"Seek5s", g_seekEnabled[1] ? L"1" : L"0");
+    ConfigWriteString(L"Movement", L"Seek10s", g_seekEnabled[2] ? L"1" : L"0");
+    ConfigWriteString(L"Movement", L"Seek30s", g_seekEnabled[3] ? L"1" : L"0");
+    ConfigWriteString(L"Movement", L"Seek1m", g_seekEnabled[4] ? L"1" : L"0");
+    ConfigWriteString(L"Movement", L"Seek5m", g_seekEnabled[5] ? L"1" : L"0");
+    ConfigWriteString(L"Movement", L"Seek10m", g_seekEnabled[6] ? L"1" : L"0");
+    ConfigWriteString(L"Movement", L"Seek30m", g_seekEnabled[7] ? L"1" : L"0");
+    ConfigWriteString(L"Movement", L"Seek1h", g_seekEnabled[8] ? L"1" : L"0");
+    ConfigWriteString(L"Movement", L"Seek1t", g_seekEnabled[9] ? L"1" : L"0");
+    ConfigWriteString(L"Movement", L"Seek5t", g_seekEnabled[10] ? L"1" : L"0");
+    ConfigWriteString(L"Movement", L"Seek10t", g_seekEnabled[11] ? L"1" : L"0");
+    ConfigWriteString(L"Movement", L"ChapterSeek", g_chapterSeekEnabled ? L"1" : L"0");
 
     swprintf(buf, 32, L"%d", g_currentSeekIndex);
-    WritePrivateProfileStringW(L"Movement", L"CurrentSeek", buf, g_configPath.c_str());
+    ConfigWriteString(L"Movement", L"CurrentSeek", buf);
 
     // Save effect settings
-    WritePrivateProfileStringW(L"Effects", L"Volume", g_effectEnabled[0] ? L"1" : L"0", g_configPath.c_str());
-    WritePrivateProfileStringW(L"Effects", L"Pitch", g_effectEnabled[1] ? L"1" : L"0", g_configPath.c_str());
-    WritePrivateProfileStringW(L"Effects", L"Tempo", g_effectEnabled[2] ? L"1" : L"0", g_configPath.c_str());
-    WritePrivateProfileStringW(L"Effects", L"Rate", g_effectEnabled[3] ? L"1" : L"0", g_configPath.c_str());
+    ConfigWriteString(L"Effects", L"Volume", g_effectEnabled[0] ? L"1" : L"0");
+    ConfigWriteString(L"Effects", L"Pitch", g_effectEnabled[1] ? L"1" : L"0");
+    ConfigWriteString(L"Effects", L"Tempo", g_effectEnabled[2] ? L"1" : L"0");
+    ConfigWriteString(L"Effects", L"Rate", g_effectEnabled[3] ? L"1" : L"0");
     swprintf(buf, 32, L"%d", g_currentEffectIndex);
-    WritePrivateProfileStringW(L"Effects", L"CurrentEffect", buf, g_configPath.c_str());
+    ConfigWriteString(L"Effects", L"CurrentEffect", buf);
     swprintf(buf, 32, L"%d", g_rateStepMode);
-    WritePrivateProfileStringW(L"Effects", L"RateStepMode", buf, g_configPath.c_str());
+    ConfigWriteString(L"Effects", L"RateStepMode", buf);
 
     // Save DSP effect settings
-    WritePrivateProfileStringW(L"DSPEffects", L"Reverb", IsDSPEffectEnabled(DSPEffectType::Reverb) ? L"1" : L"0", g_configPath.c_str());
-    WritePrivateProfileStringW(L"DSPEffects", L"Echo", IsDSPEffectEnabled(DSPEffectType::Echo) ? L"1" : L"0", g_configPath.c_str());
-    WritePrivateProfileStringW(L"DSPEffects", L"EQ", IsDSPEffectEnabled(DSPEffectType::EQ) ? L"1" : L"0", g_configPath.c_str());
-    WritePrivateProfileStringW(L"DSPEffects", L"Compressor", IsDSPEffectEnabled(DSPEffectType::Compressor) ? L"1" : L"0", g_configPath.c_str());
-    WritePrivateProfileStringW(L"DSPEffects", L"StereoWidth", IsDSPEffectEnabled(DSPEffectType::StereoWidth) ? L"1" : L"0", g_configPath.c_str());
-    WritePrivateProfileStringW(L"DSPEffects", L"CenterCancel", IsDSPEffectEnabled(DSPEffectType::CenterCancel) ? L"1" : L"0", g_configPath.c_str());
-    WritePrivateProfileStringW(L"DSPEffects", L"Convolution", IsDSPEffectEnabled(DSPEffectType::Convolution) ? L"1" : L"0", g_configPath.c_str());
-    WritePrivateProfileStringW(L"DSPEffects", L"ConvolutionIR", g_convolutionIRPath.c_str(), g_configPath.c_str());
-    WritePrivateProfileStringW(L"DSPEffects", L"SpatialAudio", IsDSPEffectEnabled(DSPEffectType::SpatialAudio) ? L"1" : L"0", g_configPath.c_str());
+    ConfigWriteString(L"DSPEffects", L"Reverb", IsDSPEffectEnabled(DSPEffectType::Reverb) ? L"1" : L"0");
+    ConfigWriteString(L"DSPEffects", L"Echo", IsDSPEffectEnabled(DSPEffectType::Echo) ? L"1" : L"0");
+    ConfigWriteString(L"DSPEffects", L"EQ", IsDSPEffectEnabled(DSPEffectType::EQ) ? L"1" : L"0");
+    ConfigWriteString(L"DSPEffects", L"Compressor", IsDSPEffectEnabled(DSPEffectType::Compressor) ? L"1" : L"0");
+    ConfigWriteString(L"DSPEffects", L"StereoWidth", IsDSPEffectEnabled(DSPEffectType::StereoWidth) ? L"1" : L"0");
+    ConfigWriteString(L"DSPEffects", L"CenterCancel", IsDSPEffectEnabled(DSPEffectType::CenterCancel) ? L"1" : L"0");
+    ConfigWriteString(L"DSPEffects", L"Convolution", IsDSPEffectEnabled(DSPEffectType::Convolution) ? L"1" : L"0");
+    ConfigWriteString(L"DSPEffects", L"ConvolutionIR", g_convolutionIRPath.c_str());
+    ConfigWriteString(L"DSPEffects", L"SpatialAudio", IsDSPEffectEnabled(DSPEffectType::SpatialAudio) ? L"1" : L"0");
 
     // Save DSP effect parameter values
     swprintf(buf, 32, L"%.2f", GetParamValue(ParamId::ReverbMix));
-    WritePrivateProfileStringW(L"DSPParams", L"ReverbMix", buf, g_configPath.c_str());
+    ConfigWriteString(L"DSPParams", L"ReverbMix", buf);
     swprintf(buf, 32, L"%.2f", GetParamValue(ParamId::ReverbRoom));
-    WritePrivateProfileStringW(L"DSPParams", L"ReverbRoom", buf, g_configPath.c_str());
+    ConfigWriteString(L"DSPParams", L"ReverbRoom", buf);
     swprintf(buf, 32, L"%.2f", GetParamValue(ParamId::ReverbDamp));
-    WritePrivateProfileStringW(L"DSPParams", L"ReverbDamp", buf, g_configPath.c_str());
+    ConfigWriteString(L"DSPParams", L"ReverbDamp", buf);
 
     // DX8 Reverb parameters
     swprintf(buf, 32, L"%.2f", GetParamValue(ParamId::DX8ReverbTime));
-    WritePrivateProfileStringW(L"DSPParams", L"DX8ReverbTime", buf, g_configPath.c_str());
+    ConfigWriteString(L"DSPParams", L"DX8ReverbTime", buf);
     swprintf(buf, 32, L"%.3f", GetParamValue(ParamId::DX8ReverbHFRatio));
-    WritePrivateProfileStringW(L"DSPParams", L"DX8ReverbHFRatio", buf, g_configPath.c_str());
+    ConfigWriteString(L"DSPParams", L"DX8ReverbHFRatio", buf);
     swprintf(buf, 32, L"%.2f", GetParamValue(ParamId::DX8ReverbMix));
-    WritePrivateProfileStringW(L"DSPParams", L"DX8ReverbMix", buf, g_configPath.c_str());
+    ConfigWriteString(L"DSPParams", L"DX8ReverbMix", buf);
 
     // I3DL2 Reverb parameters
     swprintf(buf, 32, L"%.2f", GetParamValue(ParamId::I3DL2Room));
-    WritePrivateProfileStringW(L"DSPParams", L"I3DL2Room", buf, g_configPath.c_str());
+    ConfigWriteString(L"DSPParams", L"I3DL2Room", buf);
     swprintf(buf, 32, L"%.2f", GetParamValue(ParamId::I3DL2DecayTime));
-    WritePrivateProfileStringW(L"DSPParams", L"I3DL2DecayTime", buf, g_configPath.c_str());
+    ConfigWriteString(L"DSPParams", L"I3DL2DecayTime", buf);
     swprintf(buf, 32, L"%.2f", GetParamValue(ParamId::I3DL2Diffusion));
-    WritePrivateProfileStringW(L"DSPParams", L"I3DL2Diffusion", buf, g_configPath.c_str());
+    ConfigWriteString(L"DSPParams", L"I3DL2Diffusion", buf);
     swprintf(buf, 32, L"%.2f", GetParamValue(ParamId::I3DL2Density));
-    WritePrivateProfileStringW(L"DSPParams", L"I3DL2Density", buf, g_configPath.c_str());
+    ConfigWriteString(L"DSPParams", L"I3DL2Density", buf);
 
     swprintf(buf, 32, L"%.2f", GetParamValue(ParamId::EchoDelay));
-    WritePrivateProfileStringW(L"DSPParams", L"EchoDelay", buf, g_configPath.c_str());
+    ConfigWriteString(L"DSPParams", L"EchoDelay", buf);
     swprintf(buf, 32, L"%.2f", GetParamValue(ParamId::EchoFeedback));
-    WritePrivateProfileStringW(L"DSPParams", L"EchoFeedback", buf, g_configPath.c_str());
+    ConfigWriteString(L"DSPParams", L"EchoFeedback", buf);
     swprintf(buf, 32, L"%.2f", GetParamValue(ParamId::EchoMix));
-    WritePrivateProfileStringW(L"DSPParams", L"EchoMix", buf, g_configPath.c_str());
+    ConfigWriteString(L"DSPParams", L"EchoMix", buf);
 
     swprintf(buf, 32, L"%.2f", GetParamValue(ParamId::EQPreamp));
-    WritePrivateProfileStringW(L"DSPParams", L"EQPreamp", buf, g_configPath.c_str());
+    ConfigWriteString(L"DSPParams", L"EQPreamp", buf);
     swprintf(buf, 32, L"%.2f", GetParamValue(ParamId::EQBass));
-    WritePrivateProfileStringW(L"DSPParams", L"EQBass", buf, g_configPath.c_str());
+    ConfigWriteString(L"DSPParams", L"EQBass", buf);
     swprintf(buf, 32, L"%.2f", GetParamValue(ParamId::EQMid));
-    WritePrivateProfileStringW(L"DSPParams", L"EQMid", buf, g_configPath.c_str());
+    ConfigWriteString(L"DSPParams", L"EQMid", buf);
     swprintf(buf, 32, L"%.2f", GetParamValue(ParamId::EQTreble));
-    WritePrivateProfileStringW(L"DSPParams", L"EQTreble", buf, g_configPath.c_str());
+    ConfigWriteString(L"DSPParams", L"EQTreble", buf);
 
     swprintf(buf, 32, L"%.2f", GetParamValue(ParamId::CompThreshold));
-    WritePrivateProfileStringW(L"DSPParams", L"CompThreshold", buf, g_configPath.c_str());
+    ConfigWriteString(L"DSPParams", L"CompThreshold", buf);
     swprintf(buf, 32, L"%.2f", GetParamValue(ParamId::CompRatio));
-    WritePrivateProfileStringW(L"DSPParams", L"CompRatio", buf, g_configPath.c_str());
+    ConfigWriteString(L"DSPParams", L"CompRatio", buf);
     swprintf(buf, 32, L"%.2f", GetParamValue(ParamId::CompAttack));
-    WritePrivateProfileStringW(L"DSPParams", L"CompAttack", buf, g_configPath.c_str());
+    ConfigWriteString(L"DSPParams", L"CompAttack", buf);
     swprintf(buf, 32, L"%.2f", GetParamValue(ParamId::CompRelease));
-    WritePrivateProfileStringW(L"DSPParams", L"CompRelease", buf, g_configPath.c_str());
+    ConfigWriteString(L"DSPParams", L"CompRelease", buf);
     swprintf(buf, 32, L"%.2f", GetParamValue(ParamId::CompGain));
-    WritePrivateProfileStringW(L"DSPParams", L"CompGain", buf, g_configPath.c_str());
+    ConfigWriteString(L"DSPParams", L"CompGain", buf);
 
     swprintf(buf, 32, L"%.2f", GetParamValue(ParamId::StereoWidth));
-    WritePrivateProfileStringW(L"DSPParams", L"StereoWidth", buf, g_configPath.c_str());
+    ConfigWriteString(L"DSPParams", L"StereoWidth", buf);
 
     swprintf(buf, 32, L"%.2f", GetParamValue(ParamId::CenterCancel));
-    WritePrivateProfileStringW(L"DSPParams", L"CenterCancel", buf, g_configPath.c_str());
+    ConfigWriteString(L"DSPParams", L"CenterCancel", buf);
 
     swprintf(buf, 32, L"%.2f", GetParamValue(ParamId::ConvolutionMix));
-    WritePrivateProfileStringW(L"DSPParams", L"ConvolutionMix", buf, g_configPath.c_str());
+    ConfigWriteString(L"DSPParams", L"ConvolutionMix", buf);
     swprintf(buf, 32, L"%.2f", GetParamValue(ParamId::ConvolutionGain));
-    WritePrivateProfileStringW(L"DSPParams", L"ConvolutionGain", buf, g_configPath.c_str());
+    ConfigWriteString(L"DSPParams", L"ConvolutionGain", buf);
 
     swprintf(buf, 32, L"%.2f", GetParamValue(ParamId::SpatialBlend));
-    WritePrivateProfileStringW(L"DSPParams", L"SpatialBlend", buf, g_configPath.c_str());
+    ConfigWriteString(L"DSPParams", L"SpatialBlend", buf);
     swprintf(buf, 32, L"%.2f", GetParamValue(ParamId::SpatialWidth));
-    WritePrivateProfileStringW(L"DSPParams", L"SpatialWidth", buf, g_configPath.c_str());
+    ConfigWriteString(L"DSPParams", L"SpatialWidth", buf);
     swprintf(buf, 32, L"%.2f", GetParamValue(ParamId::SpatialRotation));
-    WritePrivateProfileStringW(L"DSPParams", L"SpatialRotation", buf, g_configPath.c_str());
+    ConfigWriteString(L"DSPParams", L"SpatialRotation", buf);
     swprintf(buf, 32, L"%.2f", GetParamValue(ParamId::SpatialMode));
-    WritePrivateProfileStringW(L"DSPParams", L"SpatialMode", buf, g_configPath.c_str());
+    ConfigWriteString(L"DSPParams", L"SpatialMode", buf);
     swprintf(buf, 32, L"%.2f", GetParamValue(ParamId::SpatialRearCenter));
-    WritePrivateProfileStringW(L"DSPParams", L"SpatialRearCenter", buf, g_configPath.c_str());
+    ConfigWriteString(L"DSPParams", L"SpatialRearCenter", buf);
     swprintf(buf, 32, L"%.2f", GetParamValue(ParamId::SpatialX));
-    WritePrivateProfileStringW(L"DSPParams", L"SpatialX", buf, g_configPath.c_str());
+    ConfigWriteString(L"DSPParams", L"SpatialX", buf);
     swprintf(buf, 32, L"%.2f", GetParamValue(ParamId::SpatialY));
-    WritePrivateProfileStringW(L"DSPParams", L"SpatialY", buf, g_configPath.c_str());
+    ConfigWriteString(L"DSPParams", L"SpatialY", buf);
     swprintf(buf, 32, L"%.2f", GetParamValue(ParamId::SpatialZ));
-    WritePrivateProfileStringW(L"DSPParams", L"SpatialZ", buf, g_configPath.c_str());
+    ConfigWriteString(L"DSPParams", L"SpatialZ", buf);
 
     // Save recent files
     // First clear the section
-    WritePrivateProfileSectionW(L"RecentFiles", L"", g_configPath.c_str());
+    ConfigClearSection(L"RecentFiles");
     for (size_t i = 0; i < g_recentFiles.size() && i < MAX_RECENT_FILES; i++) {
         wchar_t key[32];
         swprintf(key, 32, L"File%d", static_cast<int>(i));
-        WritePrivateProfileStringW(L"RecentFiles", key, g_recentFiles[i].c_str(), g_configPath.c_str());
+        ConfigWriteString(L"RecentFiles", key, g_recentFiles[i].c_str());
+    }
+}
+
+// The playlist as last saved to (or restored from) the database, so a save
+// only writes the entries that changed since
+static std::vector<PlaylistEntryId> g_savedPlaylistIds;
+static uint64_t g_savedPlaylistRevision = 0;
+static bool g_savedPlaylistKnown = false;
+
+// The entry standing in for the saved playlist until it has been read in
+static PlaylistEntryId g_restorePlaceholder = 0;
+static int g_restoreIndex = 0;
+
+// Write the playlist to the database. Entry IDs survive edits, so the entries
+// the saved playlist and this one have in common at each end are skipped and
+// only the run between them is replaced.
+static void SavePlaylist() {
+    if (g_savedPlaylistKnown && g_playlist.GetRevision() == g_savedPlaylistRevision) return;
+
+    std::vector<PlaylistEntryId> ids = g_playlist.GetIds();
+    int newCount = static_cast<int>(ids.size());
+    int oldCount;
+    int prefix = 0;
+    int suffix = 0;
+    if (g_savedPlaylistKnown) {
+        oldCount = static_cast<int>(g_savedPlaylistIds.size());
+        int common = std::min(oldCount, newCount);
+        while (prefix < common && ids[prefix] == g_savedPlaylistIds[prefix]) prefix++;
+        while (suffix < common - prefix &&
+               ids[newCount - 1 - suffix] == g_savedPlaylistIds[oldCount - 1 - suffix]) {
+            suffix++;
+        }
+    } else {
+        oldCount = GetPlaylistCountDB();
+    }
+
+    std::vector<std::wstring> paths;
+    paths.reserve(newCount - prefix - suffix);
+    for (int i = prefix; i < newCount - suffix; i++) {
+        paths.push_back(g_playlist[i]);
+    }
+
+    if (ReplacePlaylistRangeDB(prefix, oldCount - prefix - suffix, paths)) {
+        g_savedPlaylistIds.swap(ids);
+        g_savedPlaylistRevision = g_playlist.GetRevision();
+        g_savedPlaylistKnown = true;
+    } else {
+        g_savedPlaylistKnown = false;
+    }
+}
+
+// Load a track and go back to where it was left (not for live streams)
+static void ResumeSavedTrack(const std::wstring& path) {
+    // LoadFile handles both files and URLs
+    if (!LoadFile(path.c_str()) || g_isLiveStream) return;
+
+    // LoadFile went to the file's own saved place, which is checkpointed as it
+    // plays and so is newer than LastPosition if the app didn't exit cleanly
+    if (LoadFilePosition(path) > 0) return;
+
+    wchar_t posBuf[32] = {0};
+    ConfigGetString(L"State", L"LastPosition", L"0", posBuf, 32);
+    double position = _wtof(posBuf);
+    if (position > 0) {
+        SeekToPosition(position);
     }
 }
 
 // Save current playback state (file and position)
 void SavePlaybackState() {
-    // Clear old playlist entries
-    WritePrivateProfileSectionW(L"Playlist", L"", g_configPath.c_str());
+    // Don't save the stand-in for a playlist that hasn't been read in yet
+    if (g_restorePlaceholder) RestoreSavedPlaylist();
+
+    // Clear the playlist from versions that kept it in the INI
+    ConfigClearSection(L"Playlist");
+    ConfigWriteString(L"State", L"TrackCount", nullptr);
 
     if (!g_rememberState) {
-        WritePrivateProfileStringW(L"State", L"LastFile", L"", g_configPath.c_str());
-        WritePrivateProfileStringW(L"State", L"LastPosition", L"0", g_configPath.c_str());
-        WritePrivateProfileStringW(L"State", L"TrackCount", L"0", g_configPath.c_str());
-        WritePrivateProfileStringW(L"State", L"CurrentTrack", L"0", g_configPath.c_str());
+        ConfigWriteString(L"State", L"LastFile", L"");
+        ConfigWriteString(L"State", L"LastPosition", L"0");
+        ConfigWriteString(L"State", L"CurrentTrack", L"0");
+        ReplacePlaylistRangeDB(0, GetPlaylistCountDB(), std::vector<std::wstring>());
+        g_savedPlaylistKnown = false;
         return;
     }
 
     // Save playlist
-    wchar_t buf[32];
-    swprintf(buf, 32, L"%d", static_cast<int>(g_playlist.size()));
-    WritePrivateProfileStringW(L"State", L"TrackCount", buf, g_configPath.c_str());
-
-    for (size_t i = 0; i < g_playlist.size(); i++) {
-        wchar_t key[32];
-        swprintf(key, 32, L"Track%zu", i);
-        WritePrivateProfileStringW(L"Playlist", key, g_playlist[i].c_str(), g_configPath.c_str());
-    }
+    SavePlaylist();
 
     // Save current track index
+    wchar_t buf[32];
     swprintf(buf, 32, L"%d", g_currentTrack);
-    WritePrivateProfileStringW(L"State", L"CurrentTrack", buf, g_configPath.c_str());
+    ConfigWriteString(L"State", L"CurrentTrack", buf);
 
     // Save current file (for backwards compatibility) and position
     if (g_currentTrack >= 0 && g_currentTrack < static_cast<int>(g_playlist.size())) {
-        WritePrivateProfileStringW(L"State", L"LastFile", g_playlist[g_currentTrack].c_str(), g_configPath.c_str());
+        ConfigWriteString(L"State", L"LastFile", g_playlist[g_currentTrack].c_str());
 
         // Always save position with playback state (use GetCurrentPosition for tempo processor compatibility)
         double position = GetCurrentPosition();
         swprintf(buf, 32, L"%.2f", position);
-        WritePrivateProfileStringW(L"State", L"LastPosition", buf, g_configPath.c_str());
+        ConfigWriteString(L"State", L"LastPosition", buf);
     } else {
-        WritePrivateProfileStringW(L"State", L"LastFile", L"", g_configPath.c_str());
-        WritePrivateProfileStringW(L"State", L"LastPosition", L"0", g_configPath.c_str());
+        ConfigWriteString(L"State", L"LastFile", L"");
+        ConfigWriteString(L"State", L"LastPosition", L"0");
     }
 }
 
@@ -690,25 +806,47 @@ void SavePlaybackState() {
 void LoadPlaybackState() {
     if (!g_rememberState) return;
 
-    // Try to load full playlist first
-    int trackCount = GetPrivateProfileIntW(L"State", L"TrackCount", 0, g_configPath.c_str());
-    int currentTrack = GetPrivateProfileIntW(L"State", L"CurrentTrack", 0, g_configPath.c_str());
+    int currentTrack = ConfigGetInt(L"State", L"CurrentTrack", 0);
 
     g_playlist.clear();
 
+    // Start the current track on its own, and read in the rest once the
+    // window is up (a long playlist shouldn't hold up playback)
+    int savedCount = GetPlaylistCountDB();
+    if (savedCount > 0) {
+        if (currentTrack < 0 || currentTrack >= savedCount) {
+            currentTrack = 0;
+        }
+        std::wstring path = GetPlaylistEntryDB(currentTrack);
+        if (!path.empty()) {
+            g_playlist.push_back(path);
+            g_currentTrack = 0;
+            g_restorePlaceholder = g_playlist.GetId(0);
+            g_restoreIndex = currentTrack;
+            PostMessage(g_hwnd, WM_PLAYLIST_RESTORE, 0, 0);
+            ResumeSavedTrack(path);
+            return;
+        }
+    }
+
+    // Playlist saved by an older version in the [Playlist] section; it
+    // moves to the database on the next save
+    int trackCount = ConfigGetInt(L"State", L"TrackCount", 0);
     if (trackCount > 0) {
-        // Load playlist from [Playlist] section
+        std::vector<std::wstring> paths;
+        paths.reserve(trackCount);
         for (int i = 0; i < trackCount; i++) {
             wchar_t key[32];
             swprintf(key, 32, L"Track%d", i);
             wchar_t filePath[2048] = {0};  // Larger buffer for URLs
-            GetPrivateProfileStringW(L"Playlist", key, L"", filePath, 2048, g_configPath.c_str());
+            ConfigGetString(L"Playlist", key, L"", filePath, 2048);
 
             // Add to playlist if non-empty (trust save code - don't validate files/URLs here)
             if (filePath[0] != L'\0') {
-                g_playlist.push_back(filePath);
+                paths.push_back(filePath);
             }
         }
+        g_playlist = paths;
 
         // Adjust current track if some files were missing
         if (!g_playlist.empty()) {
@@ -716,49 +854,43 @@ void LoadPlaybackState() {
                 currentTrack = 0;
             }
             g_currentTrack = currentTrack;
-
-            // LoadFile handles both files and URLs
-            if (LoadFile(g_playlist[g_currentTrack].c_str())) {
-                // Restore position for seekable streams only (not live streams)
-                if (!g_isLiveStream) {
-                    wchar_t posBuf[32] = {0};
-                    GetPrivateProfileStringW(L"State", L"LastPosition", L"0", posBuf, 32, g_configPath.c_str());
-                    double position = _wtof(posBuf);
-
-                    if (position > 0) {
-                        SeekToPosition(position);
-                    }
-                }
-            }
+            ResumeSavedTrack(g_playlist[g_currentTrack]);
             return;
         }
     }
 
     // Fall back to single file (backwards compatibility)
     wchar_t lastFile[2048] = {0};  // Larger buffer for URLs
-    GetPrivateProfileStringW(L"State", L"LastFile", L"", lastFile, 2048, g_configPath.c_str());
+    ConfigGetString(L"State", L"LastFile", L"", lastFile, 2048);
 
     // Trust save code - don't validate files/URLs here
     if (lastFile[0] != L'\0') {
         g_playlist.push_back(lastFile);
         g_currentTrack = 0;
-
-        // LoadFile handles both files and URLs
-        if (LoadFile(lastFile)) {
-            // Restore position for seekable streams only (not live streams)
-            if (!g_isLiveStream) {
-                wchar_t posBuf[32] = {0};
-                GetPrivateProfileStringW(L"State", L"LastPosition", L"0", posBuf, 32, g_configPath.c_str());
-                double position = _wtof(posBuf);
-
-                if (position > 0) {
-                    SeekToPosition(position);
-                }
-            }
-        }
+        ResumeSavedTrack(lastFile);
     }
 }
 
+// Read in the rest of the playlist LoadPlaybackState started with one entry
+// of. Does nothing if the playlist has been replaced since.
+void RestoreSavedPlaylist() {
+    PlaylistEntryId placeholder = g_restorePlaceholder;
+    g_restorePlaceholder = 0;
+    if (!placeholder || g_playlist.size() != 1 || g_playlist.GetId(0) != placeholder) return;
+
+    std::vector<std::wstring> paths = LoadPlaylistDB();
+    if (g_restoreIndex >= static_cast<int>(paths.size())) return;
+
+    bool current = (g_currentTrack == 0);
+    g_playlist = paths;
+    if (current) g_currentTrack = g_restoreIndex;
+
+    // This is what the database now holds
+    g_savedPlaylistIds = g_playlist.GetIds();
+    g_savedPlaylistRevision = g_playlist.GetRevision();
+    g_savedPlaylistKnown = true;
+}
+
 // Save position for a specific file (if it's long enough)
 void SaveFilePosition(const std::wstring& filePath) {
     if (g_rememberPosMinutes == 0 || !g_fxStream) return;
@@ -785,7 +917,12 @@ double LoadFilePosition(const std::wstring& filePath) {
     TempoProcessor* processor = GetTempoProcessor();
     if (!processor || !processor->IsActive()) return 0.0;
 
-    double length = processor->GetLength();
+    return LoadFilePosition(filePath, processor->GetLength());
+}
+
+// Load saved position for a file of known length (a track opened ahead of time)
+double LoadFilePosition(const std::wstring& filePath, double length) {
+    if (g_rememberPosMinutes == 0) return 0.0;
 
     // Only load if file is longer than threshold
     if (length < g_rememberPosMinutes * 60.0) return 0.0;
@@ -1,11 +1,16 @@
 #include "tempo_processor.h"
 #include "globals.h"
+#include "effects.h"
 #include "bass_fx.h"
 #include <cmath>
 #include <memory>
 #include <vector>
 #include <mutex>
 #include <deque>
+#include <thread>
+#include <atomic>
+#include <functional>
+#include <condition_variable>
 
 // Include Speedy/Sonic
 #ifdef USE_SPEEDY
@@ -63,12 +68,12 @@ public:
         Shutdown();
     }
 
-    HSTREAM Initialize(HSTREAM sourceStream, float sampleRate) override {
+    HSTREAM Initialize(HSTREAM sourceStream, float sampleRate, DWORD flags) override {
         m_sourceStream = sourceStream;
         m_sampleRate = sampleRate;
 
         // Create tempo stream wrapping the source (use float for DSP effects)
-        m_fxStream = BASS_FX_TempoCreate(sourceStream, BASS_FX_FREESOURCE | BASS_SAMPLE_FLOAT);
+        m_fxStream = BASS_FX_TempoCreate(sourceStream, BASS_FX_FREESOURCE | BASS_SAMPLE_FLOAT | flags);
         if (!m_fxStream) {
             return 0;
         }
@@ -279,7 +284,7 @@ public:
         Shutdown();
     }
 
-    HSTREAM Initialize(HSTREAM sourceStream, float sampleRate) override {
+    HSTREAM Initialize(HSTREAM sourceStream, float sampleRate, DWORD flags) override {
         std::lock_guard<std::mutex> lock(m_mutex);
 
         m_sourceStream = sourceStream;
@@ -313,7 +318,7 @@ public:
         m_outputStream = BASS_StreamCreate(
             static_cast<DWORD>(m_sampleRate),
             m_channels,
-            BASS_SAMPLE_FLOAT,
+            BASS_SAMPLE_FLOAT | flags,
             StreamProc,
             this
         );
@@ -437,13 +442,126 @@ private:
 // ============================================================================
 #ifdef USE_SIGNALSMITH
 
+// Small fixed pool that runs one job per channel group and waits for all of
+// them. The calling (BASS mixer) thread takes jobs too, so a pool with no
+// workers just runs everything inline.
+class ChannelGroupPool {
+private:
+    std::vector<std::thread> m_threads;
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    std::condition_variable m_finished;
+    const std::function<void(int)>* m_job = nullptr;
+    int m_count = 0;
+    std::atomic<int> m_next{0};
+    int m_done = 0;
+    int m_active = 0;
+    unsigned m_generation = 0;
+    bool m_stop = false;
+
+    void Work() {
+        for (;;) {
+            int index = m_next.fetch_add(1);
+            if (index >= m_count) break;
+            (*m_job)(index);
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (++m_done == m_count) m_finished.notify_one();
+        }
+    }
+
+    void ThreadMain() {
+        unsigned seen;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            seen = m_generation;
+        }
+        for (;;) {
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_wake.wait(lock, [&] { return m_stop || m_generation != seen; });
+                if (m_stop) return;
+                seen = m_generation;
+                m_active++;
+            }
+            Work();
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (--m_active == 0) m_finished.notify_one();
+        }
+    }
+
+public:
+    ~ChannelGroupPool() {
+        Stop();
+    }
+
+    void Start(int workers) {
+        Stop();
+        m_stop = false;
+        for (int i = 0; i < workers; i++) {
+            m_threads.emplace_back(&ChannelGroupPool::ThreadMain, this);
+        }
+    }
+
+    void Stop() {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stop = true;
+        }
+        m_wake.notify_all();
+        for (auto& t : m_threads) {
+            if (t.joinable()) t.join();
+        }
+        m_threads.clear();
+    }
+
+    // Run job(0..count-1) and return once every job (and every worker) is done
+    void Run(int count, const std::function<void(int)>& job) {
+        if (m_threads.empty() || count <= 1) {
+            for (int i = 0; i < count; i++) job(i);
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_job = &job;
+            m_count = count;
+            m_done = 0;
+            m_next = 0;
+            m_generation++;
+        }
+        m_wake.notify_all();
+        Work();
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_finished.wait(lock, [&] { return m_done == m_count && m_active == 0; });
+        m_job = nullptr;
+        m_count = 0;
+    }
+};
+
 class SignalsmithProcessor : public TempoProcessor {
 private:
+    // Channels are stretched in groups of up to two (L/R, C/LFE, SL/SR...) so
+    // each pair keeps its phase coherence while groups run in parallel
+    struct ChannelGroup {
+        signalsmith::stretch::SignalsmithStretch<float> stretcher;
+        int firstChannel = 0;
+        int channelCount = 0;
+        std::vector<std::vector<float>> in;
+        std::vector<std::vector<float>> out;
+        std::vector<float*> inPtrs;
+        std::vector<float*> outPtrs;
+    };
+    static constexpr int MAX_GROUP_CHANNELS = 2;
+
     HSTREAM m_sourceStream = 0;
     HSTREAM m_outputStream = 0;
-    signalsmith::stretch::SignalsmithStretch<float> m_stretcher;
+    std::vector<std::unique_ptr<ChannelGroup>> m_groups;
+    ChannelGroupPool m_pool;
     float m_sampleRate = 44100.0f;
-    int m_channels = 2;
+    int m_sourceChannels = 2;   // Channels decoded from the source
+    int m_channels = 2;         // Channels stretched and output (2 when downmixing)
+    bool m_downmix = false;
+    float m_downmixL[8] = {0};
+    float m_downmixR[8] = {0};
     float m_tempo = 0.0f;   // percentage
     float m_pitch = 0.0f;   // semitones
     float m_rate = 1.0f;    // multiplier
@@ -453,10 +571,6 @@ private:
 
     // Buffers
     std::vector<float> m_decodeBuffer;
-    std::vector<float*> m_inputChannels;
-    std::vector<float*> m_outputChannels;
-    std::vector<std::vector<float>> m_channelIn;
-    std::vector<std::vector<float>> m_channelOut;
     std::deque<float> m_outputQueue;
 
     static constexpr size_t DECODE_BLOCK_SIZE = 1024;
@@ -466,11 +580,96 @@ private:
         return (100.0 + m_tempo) / 100.0 * m_rate;
     }
 
+    float GetTonalityLimit() const {
+        return g_ssTonalityLimit > 0 ? static_cast<float>(g_ssTonalityLimit) / m_sampleRate : 0.0f;
+    }
+
+    void SetupGroups() {
+        m_groups.clear();
+        for (int first = 0; first < m_channels; first += MAX_GROUP_CHANNELS) {
+            auto group = std::make_unique<ChannelGroup>();
+            group->firstChannel = first;
+            group->channelCount = (m_channels - first < MAX_GROUP_CHANNELS) ? m_channels - first : MAX_GROUP_CHANNELS;
+            if (g_ssPreset == 1) {
+                group->stretcher.presetCheaper(group->channelCount, (int)m_sampleRate);
+            } else {
+                group->stretcher.presetDefault(group->channelCount, (int)m_sampleRate);
+            }
+            group->stretcher.setTransposeSemitones(m_pitch, GetTonalityLimit());
+            group->stretcher.reset();
+            group->in.resize(group->channelCount);
+            group->out.resize(group->channelCount);
+            group->inPtrs.resize(group->channelCount);
+            group->outPtrs.resize(group->channelCount);
+            m_groups.push_back(std::move(group));
+        }
+
+        // One job per group; the calling thread handles one of them itself
+        int workers = static_cast<int>(m_groups.size()) - 1;
+        int limit = g_ssThreads > 0 ? g_ssThreads : static_cast<int>(std::thread::hardware_concurrency());
+        if (workers > limit - 1) workers = limit - 1;
+        m_pool.Start(workers > 0 ? workers : 0);
+    }
+
+    // Deinterleave decoded audio into each group's input buffers, folding
+    // surround down to stereo first when downmixing is enabled
+    void Deinterleave(const float* decoded, size_t frames) {
+        for (auto& group : m_groups) {
+            for (int c = 0; c < group->channelCount; c++) {
+                group->in[c].resize(frames);
+                group->inPtrs[c] = group->in[c].data();
+            }
+        }
+
+        if (m_downmix) {
+            float* left = m_groups[0]->in[0].data();
+            float* right = m_groups[0]->in[1].data();
+            for (size_t i = 0; i < frames; i++) {
+                const float* frame = decoded + i * m_sourceChannels;
+                float l = 0.0f, r = 0.0f;
+                for (int ch = 0; ch < m_sourceChannels; ch++) {
+                    l += frame[ch] * m_downmixL[ch];
+                    r += frame[ch] * m_downmixR[ch];
+                }
+                left[i] = l;
+                right[i] = r;
+            }
+            return;
+        }
+
+        for (auto& group : m_groups) {
+            for (int c = 0; c < group->channelCount; c++) {
+                float* dst = group->in[c].data();
+                int ch = group->firstChannel + c;
+                for (size_t i = 0; i < frames; i++) {
+                    dst[i] = decoded[i * m_channels + ch];
+                }
+            }
+        }
+    }
+
+    // Stretch every group in parallel
+    void ProcessGroups(size_t inputFrames, size_t outputFrames) {
+        for (auto& group : m_groups) {
+            for (int c = 0; c < group->channelCount; c++) {
+                group->out[c].resize(outputFrames);
+                group->outPtrs[c] = group->out[c].data();
+            }
+        }
+
+        std::function<void(int)> job = [&](int index) {
+            ChannelGroup& group = *m_groups[index];
+            group.stretcher.process(group.inPtrs.data(), (int)inputFrames,
+                                    group.outPtrs.data(), (int)outputFrames);
+        };
+        m_pool.Run(static_cast<int>(m_groups.size()), job);
+    }
+
     bool ProcessMoreAudio() {
-        if (m_sourceEnded || m_channels == 0) return false;
+        if (m_sourceEnded || m_channels == 0 || m_groups.empty()) return false;
 
-        DWORD bytesNeeded = DECODE_BLOCK_SIZE * m_channels * sizeof(float);
-        m_decodeBuffer.resize(DECODE_BLOCK_SIZE * m_channels);
+        DWORD bytesNeeded = DECODE_BLOCK_SIZE * m_sourceChannels * sizeof(float);
+        m_decodeBuffer.resize(DECODE_BLOCK_SIZE * m_sourceChannels);
 
         DWORD bytesRead = BASS_ChannelGetData(m_sourceStream, m_decodeBuffer.data(),
             bytesNeeded | BASS_DATA_FLOAT);
@@ -480,16 +679,8 @@ private:
             return false;
         }
 
-        size_t samplesDecoded = bytesRead / sizeof(float) / m_channels;
-
-        // Deinterleave input
-        for (int ch = 0; ch < m_channels; ch++) {
-            m_channelIn[ch].resize(samplesDecoded);
-            for (size_t i = 0; i < samplesDecoded; i++) {
-                m_channelIn[ch][i] = m_decodeBuffer[i * m_channels + ch];
-            }
-            m_inputChannels[ch] = m_channelIn[ch].data();
-        }
+        size_t samplesDecoded = bytesRead / sizeof(float) / m_sourceChannels;
+        Deinterleave(m_decodeBuffer.data(), samplesDecoded);
 
         // Calculate output size based on speed
         double speed = GetSpeedMultiplier();
@@ -498,20 +689,15 @@ private:
         size_t outputSamples = static_cast<size_t>(samplesDecoded / speed + 0.5);
         if (outputSamples < 1) outputSamples = 1;
 
-        // Resize output buffers
-        for (int ch = 0; ch < m_channels; ch++) {
-            m_channelOut[ch].resize(outputSamples);
-            m_outputChannels[ch] = m_channelOut[ch].data();
-        }
-
         // Process through Signalsmith
-        m_stretcher.process(m_inputChannels.data(), (int)samplesDecoded,
-                           m_outputChannels.data(), (int)outputSamples);
+        ProcessGroups(samplesDecoded, outputSamples);
 
         // Interleave output to queue
         for (size_t i = 0; i < outputSamples; i++) {
-            for (int ch = 0; ch < m_channels; ch++) {
-                m_outputQueue.push_back(m_channelOut[ch][i]);
+            for (auto& group : m_groups) {
+                for (int c = 0; c < group->channelCount; c++) {
+                    m_outputQueue.push_back(group->out[c][i]);
+                }
             }
         }
 
@@ -564,7 +750,7 @@ public:
         Shutdown();
     }
 
-    HSTREAM Initialize(HSTREAM sourceStream, float sampleRate) override {
+    HSTREAM Initialize(HSTREAM sourceStream, float sampleRate, DWORD flags) override {
         std::lock_guard<std::mutex> lock(m_mutex);
 
         m_sourceStream = sourceStream;
@@ -577,59 +763,40 @@ public:
         if (!BASS_ChannelGetInfo(sourceStream, &info)) {
             return 0;
         }
-        m_channels = info.chans;
+        m_sourceChannels = info.chans;
+        m_channels = m_sourceChannels;
 
-        // Configure Signalsmith based on global settings
-        if (g_ssPreset == 1) {
-            m_stretcher.presetCheaper(m_channels, (int)sampleRate);
-        } else {
-            m_stretcher.presetDefault(m_channels, (int)sampleRate);
+        // Fold surround down before stretching so only one pair has to be processed
+        m_downmix = g_downmixStereo && GetDownmixGains(m_sourceChannels, m_downmixL, m_downmixR);
+        if (m_downmix) {
+            m_channels = 2;
         }
 
-        // Set tonality limit if specified (0 = auto)
-        float tonalityLimit = g_ssTonalityLimit > 0 ? static_cast<float>(g_ssTonalityLimit) / sampleRate : 0.0f;
-        m_stretcher.setTransposeSemitones(m_pitch, tonalityLimit);
-        m_stretcher.reset();
-
-        // Allocate buffers
-        m_channelIn.resize(m_channels);
-        m_channelOut.resize(m_channels);
-        m_inputChannels.resize(m_channels);
-        m_outputChannels.resize(m_channels);
+        // Configure one stretcher per channel group based on global settings
+        SetupGroups();
 
         // Pre-fill the stretcher to handle latency
         // Process some initial audio to prime the internal buffers
-        int latencySamples = m_stretcher.inputLatency() + m_stretcher.outputLatency();
+        int latencySamples = m_groups[0]->stretcher.inputLatency() + m_groups[0]->stretcher.outputLatency();
         if (latencySamples > 0) {
-            std::vector<float> primeBuffer(latencySamples * m_channels, 0.0f);
+            std::vector<float> primeBuffer(latencySamples * m_sourceChannels, 0.0f);
             DWORD bytesRead = BASS_ChannelGetData(sourceStream, primeBuffer.data(),
-                latencySamples * m_channels * sizeof(float) | BASS_DATA_FLOAT);
+                latencySamples * m_sourceChannels * sizeof(float) | BASS_DATA_FLOAT);
 
             if (bytesRead > 0 && bytesRead != (DWORD)-1) {
-                size_t primeSamples = bytesRead / sizeof(float) / m_channels;
-
-                // Deinterleave and process
-                for (int ch = 0; ch < m_channels; ch++) {
-                    m_channelIn[ch].resize(primeSamples);
-                    for (size_t i = 0; i < primeSamples; i++) {
-                        m_channelIn[ch][i] = primeBuffer[i * m_channels + ch];
-                    }
-                    m_inputChannels[ch] = m_channelIn[ch].data();
-                    m_channelOut[ch].resize(primeSamples);
-                    m_outputChannels[ch] = m_channelOut[ch].data();
-                }
+                size_t primeSamples = bytesRead / sizeof(float) / m_sourceChannels;
 
-                // Process to prime the stretcher (discard output)
-                m_stretcher.process(m_inputChannels.data(), (int)primeSamples,
-                                   m_outputChannels.data(), (int)primeSamples);
+                // Deinterleave and process to prime the stretchers (discard output)
+                Deinterleave(primeBuffer.data(), primeSamples);
+                ProcessGroups(primeSamples, primeSamples);
             }
         }
 
-        // Create output stream (no DECODE flag - this is the playback stream)
+        // Create output stream (a decode stream for the resampler or output mixer)
         m_outputStream = BASS_StreamCreate(
             (DWORD)sampleRate,
             m_channels,
-            BASS_SAMPLE_FLOAT,
+            BASS_SAMPLE_FLOAT | flags,
             StreamProc,
             this
         );
@@ -648,12 +815,10 @@ public:
             BASS_StreamFree(m_outputStream);
             m_outputStream = 0;
         }
+        m_pool.Stop();
         m_sourceStream = 0;
         m_outputQueue.clear();
-        m_channelIn.clear();
-        m_channelOut.clear();
-        m_inputChannels.clear();
-        m_outputChannels.clear();
+        m_groups.clear();
     }
 
     void SetTempo(float tempoPercent) override {
@@ -665,8 +830,9 @@ public:
     void SetPitch(float semitones) override {
         std::lock_guard<std::mutex> lock(m_mutex);
         m_pitch = semitones;
-        float tonalityLimit = g_ssTonalityLimit > 0 ? static_cast<float>(g_ssTonalityLimit) / m_sampleRate : 0.0f;
-        m_stretcher.setTransposeSemitones(semitones, tonalityLimit);
+        for (auto& group : m_groups) {
+            group->stretcher.setTransposeSemitones(semitones, GetTonalityLimit());
+        }
     }
 
     void SetRate(float rate) override {
@@ -720,9 +886,11 @@ public:
         QWORD pos = BASS_ChannelSeconds2Bytes(m_sourceStream, seconds);
         BASS_ChannelSetPosition(m_sourceStream, pos, BASS_POS_BYTE);
 
-        // Reset stretcher and clear output
-        m_stretcher.reset();
-        m_stretcher.setTransposeSemitones(m_pitch);
+        // Reset stretchers and clear output
+        for (auto& group : m_groups) {
+            group->stretcher.reset();
+            group->stretcher.setTransposeSemitones(m_pitch);
+        }
         m_outputQueue.clear();
         m_sourceEnded = false;
     }
@@ -806,3 +974,8 @@ TempoProcessor* GetTempoProcessor() {
     }
     return g_tempoProcessor.get();
 }
+
+void AdoptTempoProcessor(TempoProcessor* processor) {
+    FreeTempoProcessor();
+    g_tempoProcessor.reset(processor);
+}
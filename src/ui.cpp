@@ -8,8 +8,13 @@
 #include "accessibility.h"
 #include "effects.h"
 #include "tempo_processor.h"
+#include "resampler.h"
+#include "crossfade.h"
 #include "convolution.h"
 #include "database.h"
+#include "library.h"
+#include "playlist_search.h"
+#include "folder_scan.h"
 #include "download_manager.h"
 #include "resource.h"
 #include <commdlg.h>
@@ -22,12 +27,14 @@
 #include <sstream>
 #include <iomanip>
 #include <set>
+#include <unordered_set>
+#include <cwctype>
 
 // External globals (defined in globals.cpp)
 extern HWND g_hwnd;
 extern HWND g_statusBar;
 extern HSTREAM g_fxStream;
-extern std::vector<std::wstring> g_playlist;
+extern Playlist g_playlist;
 extern int g_currentTrack;
 extern float g_volume;
 extern bool g_isLoading;
@@ -100,7 +107,7 @@ void UpdateWindowTitle() {
             title += tagTitle;
         } else {
             // Fall back to filename
-            title += GetFileName(g_playlist[g_currentTrack]);
+            title += g_playlist.GetName(g_currentTrack);
         }
     }
 
@@ -126,13 +133,14 @@ void UpdateStatusBar() {
             }
         }
 
-        DWORD state = BASS_ChannelIsActive(g_fxStream);
+        DWORD state = BASS_ChannelIsActive(g_outputStream);
         switch (state) {
             case BASS_ACTIVE_PLAYING: stateText = L"Playing"; break;
             case BASS_ACTIVE_PAUSED:  stateText = L"Paused"; break;
             case BASS_ACTIVE_STOPPED: stateText = L"Stopped"; break;
             default: stateText = L""; break;
         }
+        if (IsTrackLoadPending()) stateText = L"Loading";
 
         // Add bitrate if available
         int bitrate = GetCurrentBitrate();
@@ -187,18 +195,38 @@ void CreateStatusBar(HWND hwnd, HINSTANCE hInstance) {
     }
 }
 
+// Pack a file extension (".mp3") into an integer, one lowercase ASCII byte per
+// letter after the dot (0 if it isn't one that fits)
+static uint64_t PackAudioExt(const wchar_t* ext) {
+    if (!ext || ext[0] != L'.' || !ext[1]) return 0;
+    uint64_t key = 0;
+    int length = 0;
+    for (const wchar_t* p = ext + 1; *p; p++) {
+        wchar_t c = *p;
+        if (c >= L'A' && c <= L'Z') c = static_cast<wchar_t>(c + (L'a' - L'A'));
+        if (c >= 0x80 || ++length > 8) return 0;
+        key = (key << 8) | static_cast<uint64_t>(c);
+    }
+    return key;
+}
+
 // Check if a file extension is a supported audio format
+bool IsSupportedAudioExt(const wchar_t* ext) {
+    static const std::unordered_set<uint64_t> exts = [] {
+        static const wchar_t* names[] = {
+            L".mp3", L".wav", L".ogg", L".oga", L".flac", L".m4a", L".m4b", L".wma", L".aac",
+            L".opus", L".aiff", L".ape", L".wv", L".mid", L".midi", L".dff", L".dsf"
+        };
+        std::unordered_set<uint64_t> packed;
+        for (const auto& name : names) packed.insert(PackAudioExt(name));
+        return packed;
+    }();
+    uint64_t key = PackAudioExt(ext);
+    return key != 0 && exts.count(key) != 0;
+}
+
 bool IsSupportedAudioExt(const std::wstring& ext) {
-    static const wchar_t* exts[] = {
-        L".mp3", L".wav", L".ogg", L".oga", L".flac", L".m4a", L".m4b", L".wma", L".aac",
-        L".opus", L".aiff", L".ape", L".wv", L".mid", L".midi", L".dff", L".dsf"
-    };
-    std::wstring lowerExt = ext;
-    for (auto& c : lowerExt) c = towlower(c);
-    for (const auto& e : exts) {
-        if (lowerExt == e) return true;
-    }
-    return false;
+    return IsSupportedAudioExt(ext.c_str());
 }
 
 // Expand a single file to all audio files in its folder
@@ -216,29 +244,13 @@ int ExpandFileToFolder(const std::wstring& filePath, std::vector<std::wstring>&
     std::wstring dir = filePath.substr(0, lastSlash + 1);
     std::wstring targetFile = filePath.substr(lastSlash + 1);
 
-    // Find all audio files in the directory
-    WIN32_FIND_DATAW fd;
-    HANDLE hFind = FindFirstFileW((dir + L"*").c_str(), &fd);
-    if (hFind == INVALID_HANDLE_VALUE) {
+    // Find all audio files in the directory, in natural order
+    std::vector<std::wstring> files = GetFolderAudioFiles(dir);
+    if (files.empty()) {
         outFiles.push_back(filePath);
         return 0;
     }
 
-    std::vector<std::wstring> files;
-    do {
-        if (!(fd.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)) {
-            std::wstring name = fd.cFileName;
-            size_t dotPos = name.find_last_of(L'.');
-            if (dotPos != std::wstring::npos) {
-                std::wstring ext = name.substr(dotPos);
-                if (IsSupportedAudioExt(ext)) {
-                    files.push_back(dir + name);
-                }
-            }
-        }
-    } while (FindNextFileW(hFind, &fd));
-    FindClose(hFind);
-
     // Find the index of the original file
     int targetIndex = 0;
     for (size_t i = 0; i < files.size(); i++) {
@@ -369,7 +381,9 @@ void ShowOpenDialog() {
                 g_playlist = ParsePlaylist(dir);
             } else if (g_loadFolder) {
                 // Expand to folder if option enabled
-                startIndex = ExpandFileToFolder(dir, g_playlist);
+                std::vector<std::wstring> files;
+                startIndex = ExpandFileToFolder(dir, files);
+                g_playlist = files;
             } else {
                 g_playlist.push_back(dir);
             }
@@ -380,7 +394,7 @@ void ShowOpenDialog() {
                 // Check if it's a playlist file
                 if (IsPlaylistFile(fullPath)) {
                     auto entries = ParsePlaylist(fullPath);
-                    g_playlist.insert(g_playlist.end(), entries.begin(), entries.end());
+                    g_playlist.append(entries);
                 } else {
                     g_playlist.push_back(fullPath);
                 }
@@ -395,47 +409,6 @@ void ShowOpenDialog() {
     }
 }
 
-// Recursively add audio files from a folder
-static void AddFilesFromFolderRecursive(const std::wstring& folder, std::vector<std::wstring>& files, int depth) {
-    // Limit recursion depth to prevent stack overflow
-    if (depth > 32) return;
-
-    WIN32_FIND_DATAW fd;
-    std::wstring searchPath = folder + L"\\*";
-    HANDLE hFind = FindFirstFileW(searchPath.c_str(), &fd);
-
-    if (hFind == INVALID_HANDLE_VALUE) return;
-
-    do {
-        if (wcscmp(fd.cFileName, L".") == 0 || wcscmp(fd.cFileName, L"..") == 0) continue;
-
-        // Skip reparse points (junctions, symlinks) to avoid infinite loops
-        if (fd.dwFileAttributes & FILE_ATTRIBUTE_REPARSE_POINT) continue;
-
-        std::wstring fullPath = folder + L"\\" + fd.cFileName;
-
-        if (fd.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) {
-            // Recurse into subdirectory
-            AddFilesFromFolderRecursive(fullPath, files, depth + 1);
-        } else {
-            // Check if it's a supported audio file
-            size_t dotPos = fullPath.rfind(L'.');
-            if (dotPos != std::wstring::npos) {
-                std::wstring ext = fullPath.substr(dotPos);
-                if (IsSupportedAudioExt(ext)) {
-                    files.push_back(fullPath);
-                }
-            }
-        }
-    } while (FindNextFileW(hFind, &fd));
-
-    FindClose(hFind);
-}
-
-static void AddFilesFromFolder(const std::wstring& folder, std::vector<std::wstring>& files) {
-    AddFilesFromFolderRecursive(folder, files, 0);
-}
-
 // Show folder browser dialog and add all audio files
 void ShowAddFolderDialog() {
     BROWSEINFOW bi = {0};
@@ -449,10 +422,7 @@ void ShowAddFolderDialog() {
         if (SHGetPathFromIDListW(pidl, folderPath)) {
             // Collect all audio files recursively
             std::vector<std::wstring> newFiles;
-            AddFilesFromFolder(folderPath, newFiles);
-
-            // Sort files alphabetically
-            std::sort(newFiles.begin(), newFiles.end());
+            AddAudioFilesFromFolder(folderPath, newFiles);
 
             if (!newFiles.empty()) {
                 // Replace playlist with new files
@@ -465,6 +435,9 @@ void ShowAddFolderDialog() {
                 // Start playing from the beginning
                 PlayTrack(0);
 
+                // Folders added this way make up the media library
+                AddLibraryFolder(folderPath);
+
                 Speak(std::to_string(newFiles.size()) + " files loaded");
             } else {
                 Speak("No audio files found");
@@ -499,7 +472,7 @@ static std::vector<std::wstring> GetFilesFromClipboard() {
                     if (attrs != INVALID_FILE_ATTRIBUTES) {
                         if (attrs & FILE_ATTRIBUTE_DIRECTORY) {
                             // Recursively add folder contents
-                            AddFilesFromFolder(path, files);
+                            AddAudioFilesFromFolder(path, files);
                         } else {
                             // Check if it's a supported audio file
                             size_t dotPos = path.rfind(L'.');
@@ -546,7 +519,7 @@ static std::vector<std::wstring> GetFilesFromClipboard() {
                             DWORD attrs = GetFileAttributesW(line.c_str());
                             if (attrs != INVALID_FILE_ATTRIBUTES) {
                                 if (attrs & FILE_ATTRIBUTE_DIRECTORY) {
-                                    AddFilesFromFolder(line, files);
+                                    AddAudioFilesFromFolder(line, files);
                                 } else {
                                     std::wstring ext = line;
                                     size_t dotPos = ext.rfind(L'.');
@@ -573,28 +546,63 @@ static std::vector<std::wstring> GetFilesFromClipboard() {
     return files;
 }
 
-// Helper to rebuild playlist listbox
+// Subclassed listbox data for playlist manager
+static WNDPROC g_playlistOrigProc = nullptr;
+static HWND g_playlistDlg = nullptr;
+
+// Playlist manager filter: with text in the Find box the list shows only the
+// best matches, and g_playlistView holds the playlist index of each row
+static PlaylistSearch g_playlistSearch;
+static std::vector<int> g_playlistView;
+static bool g_playlistFiltered = false;
+
+// Matches listed for a filter
+static const size_t PLAYLIST_FILTER_LIMIT = 1000;
+
+static int PlaylistRowToIndex(int row) {
+    if (!g_playlistFiltered) return row;
+    return (row >= 0 && row < (int)g_playlistView.size()) ? g_playlistView[row] : -1;
+}
+
+static int PlaylistIndexToRow(int index) {
+    if (!g_playlistFiltered) return index;
+    auto found = std::find(g_playlistView.begin(), g_playlistView.end(), index);
+    return found == g_playlistView.end() ? -1 : (int)(found - g_playlistView.begin());
+}
+
+// Helper to rebuild playlist listbox (the whole playlist, or what matches the filter)
 static void RebuildPlaylistList(HWND hList, int selectIndex = -1) {
+    wchar_t filter[256] = {0};
+    if (g_playlistDlg) GetDlgItemTextW(g_playlistDlg, IDC_PLAYLIST_FILTER, filter, 256);
+    g_playlistFiltered = false;
+    for (const wchar_t* p = filter; *p; p++) {
+        if (!iswspace(*p)) g_playlistFiltered = true;
+    }
+    g_playlistView.clear();
+    if (g_playlistFiltered) {
+        g_playlistView = g_playlistSearch.Find(g_playlist, filter, PLAYLIST_FILTER_LIMIT);
+    }
+    size_t rows = g_playlistFiltered ? g_playlistView.size() : g_playlist.size();
+
+    // Fill without repainting, with room reserved up front (long playlists)
+    SendMessageW(hList, WM_SETREDRAW, FALSE, 0);
     SendMessageW(hList, LB_RESETCONTENT, 0, 0);
-    for (size_t i = 0; i < g_playlist.size(); i++) {
-        std::wstring filename = g_playlist[i];
-        size_t pos = filename.find_last_of(L"\\/");
-        if (pos != std::wstring::npos) {
-            filename = filename.substr(pos + 1);
-        }
+    SendMessageW(hList, LB_INITSTORAGE, rows, rows * 64 * sizeof(wchar_t));
+    for (size_t row = 0; row < rows; row++) {
+        int index = PlaylistRowToIndex((int)row);
         wchar_t buf[512];
-        swprintf(buf, 512, L"%d. %s", (int)(i + 1), filename.c_str());
+        swprintf(buf, 512, L"%d. %s", index + 1, g_playlist.GetName(index).c_str());
         SendMessageW(hList, LB_ADDSTRING, 0, reinterpret_cast<LPARAM>(buf));
     }
-    if (selectIndex >= 0 && selectIndex < (int)g_playlist.size()) {
-        SendMessageW(hList, LB_SETCURSEL, selectIndex, 0);
+    int selectRow = PlaylistIndexToRow(selectIndex);
+    if (selectRow < 0 && g_playlistFiltered && rows > 0) selectRow = 0;
+    if (selectRow >= 0 && selectRow < (int)rows) {
+        SendMessageW(hList, LB_SETCURSEL, selectRow, 0);
     }
+    SendMessageW(hList, WM_SETREDRAW, TRUE, 0);
+    InvalidateRect(hList, nullptr, TRUE);
 }
 
-// Subclassed listbox data for playlist manager
-static WNDPROC g_playlistOrigProc = nullptr;
-static HWND g_playlistDlg = nullptr;
-
 // Helper to get selected indices from multi-select listbox
 static std::vector<int> GetSelectedIndices(HWND hwnd) {
     std::vector<int> indices;
@@ -617,8 +625,9 @@ static LRESULT CALLBACK PlaylistListProc(HWND hwnd, UINT msg, WPARAM wParam, LPA
             return 0;
         }
 
-        if (wParam == VK_RETURN && sel >= 0 && sel < (int)g_playlist.size()) {
-            PlayTrack(sel);
+        int selIndex = PlaylistRowToIndex(sel);
+        if (wParam == VK_RETURN && selIndex >= 0 && selIndex < (int)g_playlist.size()) {
+            PlayTrack(selIndex);
             EndDialog(g_playlistDlg, IDOK);
             return 0;
         }
@@ -626,21 +635,23 @@ static LRESULT CALLBACK PlaylistListProc(HWND hwnd, UINT msg, WPARAM wParam, LPA
         if (wParam == VK_DELETE) {
             std::vector<int> selected = GetSelectedIndices(hwnd);
             if (!selected.empty()) {
-                // Remove from end to preserve indices
-                for (int i = (int)selected.size() - 1; i >= 0; i--) {
-                    int idx = selected[i];
+                // Remove from end to preserve indices; the current track is
+                // found again by its ID (gone if it was removed)
+                std::vector<int> indices;
+                for (int row : selected) indices.push_back(PlaylistRowToIndex(row));
+                std::sort(indices.begin(), indices.end());
+                PlaylistEntryId current = g_playlist.GetId(g_currentTrack);
+                for (int i = (int)indices.size() - 1; i >= 0; i--) {
+                    int idx = indices[i];
                     if (idx >= 0 && idx < (int)g_playlist.size()) {
-                        g_playlist.erase(g_playlist.begin() + idx);
-                        if (g_currentTrack > idx) {
-                            g_currentTrack--;
-                        } else if (g_currentTrack == idx) {
-                            g_currentTrack = -1;
-                        }
+                        g_playlist.erase(idx);
                     }
                 }
-                int newSel = selected[0];
-                if (newSel >= (int)g_playlist.size()) newSel = (int)g_playlist.size() - 1;
-                RebuildPlaylistList(hwnd, newSel);
+                g_currentTrack = g_playlist.IndexOf(current);
+                RebuildPlaylistList(hwnd);
+                int rows = (int)SendMessageW(hwnd, LB_GETCOUNT, 0, 0);
+                int newSel = selected[0] < rows ? selected[0] : rows - 1;
+                if (newSel >= 0) SendMessageW(hwnd, LB_SETCURSEL, newSel, 0);
                 Speak(std::to_string(selected.size()) + " removed");
                 return 0;
             }
@@ -657,13 +668,12 @@ static LRESULT CALLBACK PlaylistListProc(HWND hwnd, UINT msg, WPARAM wParam, LPA
             try {
                 std::vector<std::wstring> newFiles = GetFilesFromClipboard();
                 if (!newFiles.empty()) {
-                    int insertPos = (sel >= 0 && sel < (int)g_playlist.size()) ? sel + 1 : (int)g_playlist.size();
+                    int insertPos = (selIndex >= 0 && selIndex < (int)g_playlist.size()) ? selIndex + 1 : (int)g_playlist.size();
+                    PlaylistEntryId current = g_playlist.GetId(g_currentTrack);
                     for (size_t i = 0; i < newFiles.size(); i++) {
-                        g_playlist.insert(g_playlist.begin() + insertPos + i, newFiles[i]);
-                    }
-                    if (g_currentTrack >= insertPos) {
-                        g_currentTrack += (int)newFiles.size();
+                        g_playlist.insert(insertPos + i, newFiles[i]);
                     }
+                    if (current) g_currentTrack = g_playlist.IndexOf(current);
                     RebuildPlaylistList(hwnd, insertPos);
                     Speak(std::to_string(newFiles.size()) + " files pasted");
                 }
@@ -678,14 +688,20 @@ static LRESULT CALLBACK PlaylistListProc(HWND hwnd, UINT msg, WPARAM wParam, LPA
         std::vector<int> selected = GetSelectedIndices(hwnd);
         if (selected.empty()) return CallWindowProcW(g_playlistOrigProc, hwnd, msg, wParam, lParam);
 
+        // Moving needs the neighbours in view
+        if (g_playlistFiltered && (wParam == VK_UP || wParam == VK_DOWN)) {
+            Speak("Clear the filter to move tracks");
+            return 0;
+        }
+
         // Alt+Up: Move selected items up
         if (wParam == VK_UP && selected[0] > 0) {
             // Move items up one by one from the top
+            PlaylistEntryId current = g_playlist.GetId(g_currentTrack);
             for (int idx : selected) {
-                std::swap(g_playlist[idx], g_playlist[idx - 1]);
-                if (g_currentTrack == idx) g_currentTrack--;
-                else if (g_currentTrack == idx - 1) g_currentTrack++;
+                g_playlist.move(idx, idx - 1);
             }
+            if (current) g_currentTrack = g_playlist.IndexOf(current);
             // Rebuild and reselect
             RebuildPlaylistList(hwnd, selected[0] - 1);
             // Reselect all moved items
@@ -699,12 +715,12 @@ static LRESULT CALLBACK PlaylistListProc(HWND hwnd, UINT msg, WPARAM wParam, LPA
         int lastIdx = selected[selected.size() - 1];
         if (wParam == VK_DOWN && lastIdx < (int)g_playlist.size() - 1) {
             // Move items down one by one from the bottom
+            PlaylistEntryId current = g_playlist.GetId(g_currentTrack);
             for (int i = (int)selected.size() - 1; i >= 0; i--) {
                 int idx = selected[i];
-                std::swap(g_playlist[idx], g_playlist[idx + 1]);
-                if (g_currentTrack == idx) g_currentTrack++;
-                else if (g_currentTrack == idx + 1) g_currentTrack--;
+                g_playlist.move(idx, idx + 1);
             }
+            if (current) g_currentTrack = g_playlist.IndexOf(current);
             // Rebuild and reselect
             RebuildPlaylistList(hwnd, selected[0] + 1);
             // Reselect all moved items
@@ -749,6 +765,20 @@ static INT_PTR CALLBACK PlaylistDlgProc(HWND hwnd, UINT msg, WPARAM wParam, LPAR
                 EndDialog(hwnd, IDCANCEL);
                 return TRUE;
             }
+            // Filter as the Find box changes
+            if (LOWORD(wParam) == IDC_PLAYLIST_FILTER && HIWORD(wParam) == EN_CHANGE) {
+                RebuildPlaylistList(hList, g_currentTrack);
+                return TRUE;
+            }
+            // Enter in the Find box moves to the matches
+            if (LOWORD(wParam) == IDOK) {
+                if (SendMessageW(hList, LB_GETCOUNT, 0, 0) > 0) {
+                    SetFocus(hList);
+                } else {
+                    Speak("No matches");
+                }
+                return TRUE;
+            }
             // Handle Save button
             if (LOWORD(wParam) == IDC_PLAYLIST_SAVE) {
                 if (g_playlist.empty()) {
@@ -770,8 +800,8 @@ static INT_PTR CALLBACK PlaylistDlgProc(HWND hwnd, UINT msg, WPARAM wParam, LPAR
                     FILE* f = _wfopen(filePath, L"w, ccs=UTF-8");
                     if (f) {
                         fwprintf(f, L"#EXTM3U\n");
-                        for (const auto& path : g_playlist) {
-                            fwprintf(f, L"%s\n", path.c_str());
+                        for (size_t i = 0; i < g_playlist.size(); i++) {
+                            fwprintf(f, L"%s\n", g_playlist[i].c_str());
                         }
                         fclose(f);
                         Speak("Playlist saved");
@@ -783,7 +813,7 @@ static INT_PTR CALLBACK PlaylistDlgProc(HWND hwnd, UINT msg, WPARAM wParam, LPAR
             }
             // Handle double-click on listbox
             if (LOWORD(wParam) == IDC_PLAYLIST_LIST && HIWORD(wParam) == LBN_DBLCLK) {
-                int sel = (int)SendMessageW(hList, LB_GETCURSEL, 0, 0);
+                int sel = PlaylistRowToIndex((int)SendMessageW(hList, LB_GETCURSEL, 0, 0));
                 if (sel >= 0 && sel < (int)g_playlist.size()) {
                     PlayTrack(sel);
                     EndDialog(hwnd, IDOK);
@@ -793,9 +823,10 @@ static INT_PTR CALLBACK PlaylistDlgProc(HWND hwnd, UINT msg, WPARAM wParam, LPAR
             break;
 
         case WM_PLAYLIST_TRACK_CHANGED:
-            // Update selection to follow current track
+            // Update selection to follow current track (if it's listed)
             if (g_playlistFollowPlayback && hList && g_currentTrack >= 0) {
-                SendMessageW(hList, LB_SETCURSEL, g_currentTrack, 0);
+                int row = PlaylistIndexToRow(g_currentTrack);
+                if (row >= 0) SendMessageW(hList, LB_SETCURSEL, row, 0);
             }
             return TRUE;
 
@@ -806,6 +837,8 @@ static INT_PTR CALLBACK PlaylistDlgProc(HWND hwnd, UINT msg, WPARAM wParam, LPAR
                 g_playlistOrigProc = nullptr;
             }
             g_playlistDlg = nullptr;
+            g_playlistView.clear();
+            g_playlistFiltered = false;
             break;
 
         case WM_CLOSE:
@@ -833,7 +866,7 @@ void ShowTabControls(HWND hwnd, int tab) {
     //              6=Effects, 7=Advanced, 8=YouTube, 9=SoundTouch, 10=Speedy, 11=Signalsmith, 12=MIDI
 
     // Playback tab controls (tab 0)
-    int playbackCtrls[] = {IDC_SOUNDCARD, IDC_ALLOW_AMPLIFY, IDC_REMEMBER_STATE, IDC_REMEMBER_POS, IDC_BRING_TO_FRONT, IDC_LOAD_FOLDER, IDC_MINIMIZE_TO_TRAY, IDC_VOLUME_STEP, IDC_SHOW_TITLE, IDC_AUTO_ADVANCE, IDC_PLAYLIST_FOLLOW, IDC_CHECK_UPDATES, IDC_MULTI_INSTANCE, IDC_REGISTER_FILE_TYPES, IDC_DOWNLOAD_PATH, IDC_DOWNLOAD_BROWSE, IDC_REWIND_ON_PAUSE, IDC_REWIND_LABEL, IDC_REPLAYGAIN_MODE, IDC_REPLAYGAIN_MODE_LABEL, IDC_REPLAYGAIN_PREAMP, IDC_REPLAYGAIN_PREAMP_LABEL, IDC_REPLAYGAIN_CLIP};
+    int playbackCtrls[] = {IDC_SOUNDCARD, IDC_ALLOW_AMPLIFY, IDC_REMEMBER_STATE, IDC_REMEMBER_POS, IDC_BRING_TO_FRONT, IDC_LOAD_FOLDER, IDC_MINIMIZE_TO_TRAY, IDC_VOLUME_STEP, IDC_SHOW_TITLE, IDC_AUTO_ADVANCE, IDC_GAPLESS, IDC_CROSSFADE, IDC_CROSSFADE_LABEL, IDC_CROSSFADE_CURVE, IDC_CROSSFADE_CURVE_LABEL, IDC_CROSSFADE_SMART, IDC_PLAYLIST_FOLLOW, IDC_CHECK_UPDATES, IDC_MULTI_INSTANCE, IDC_REGISTER_FILE_TYPES, IDC_DOWNLOAD_PATH, IDC_DOWNLOAD_BROWSE, IDC_REWIND_ON_PAUSE, IDC_REWIND_LABEL, IDC_REPLAYGAIN_MODE, IDC_REPLAYGAIN_MODE_LABEL, IDC_REPLAYGAIN_PREAMP, IDC_REPLAYGAIN_PREAMP_LABEL, IDC_REPLAYGAIN_CLIP};
     // Recording tab controls (tab 1)
     int recordingCtrls[] = {IDC_REC_PATH, IDC_REC_BROWSE, IDC_REC_TEMPLATE, IDC_REC_FORMAT, IDC_REC_BITRATE};
     // Downloads tab controls (tab 2)
@@ -848,9 +881,10 @@ void ShowTabControls(HWND hwnd, int tab) {
     // Effects tab controls (tab 7)
     int effectCtrls[] = {IDC_EFFECT_VOLUME, IDC_EFFECT_PITCH, IDC_EFFECT_TEMPO, IDC_EFFECT_RATE, IDC_RATE_STEP_MODE,
                          IDC_DSP_REVERB, IDC_DSP_ECHO, IDC_DSP_EQ, IDC_DSP_COMPRESSOR, IDC_DSP_STEREOWIDTH,
-                         IDC_DSP_CENTERCANCEL, IDC_DSP_SPATIAL, IDC_DSP_CONVOLUTION, IDC_CONV_IR, IDC_CONV_BROWSE};
+                         IDC_DSP_CENTERCANCEL, IDC_DSP_SPATIAL, IDC_DSP_CONVOLUTION, IDC_CONV_IR, IDC_CONV_BROWSE,
+                         IDC_DSP_DOWNMIX};
     // Advanced tab controls (tab 8)
-    int advancedCtrls[] = {IDC_BUFFER_SIZE, IDC_UPDATE_PERIOD, IDC_TEMPO_ALGORITHM,
+    int advancedCtrls[] = {IDC_BUFFER_SIZE, IDC_UPDATE_PERIOD, IDC_RESAMPLER_QUALITY, IDC_READ_AHEAD, IDC_READ_AHEAD_LABEL, IDC_TEMPO_ALGORITHM,
                            IDC_EQ_BASS_FREQ, IDC_EQ_MID_FREQ, IDC_EQ_TREBLE_FREQ,
                            IDC_LEGACY_VOLUME, IDC_DISABLE_BATCH, IDC_RESET_LIST_ORDER};
     // YouTube tab controls (tab 9)
@@ -1016,12 +1050,25 @@ INT_PTR CALLBACK OptionsDlgProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lPara
             CheckDlgButton(hwnd, IDC_MINIMIZE_TO_TRAY, g_minimizeToTray ? BST_CHECKED : BST_UNCHECKED);
             CheckDlgButton(hwnd, IDC_SHOW_TITLE, g_showTitleInWindow ? BST_CHECKED : BST_UNCHECKED);
             CheckDlgButton(hwnd, IDC_AUTO_ADVANCE, g_autoAdvance ? BST_CHECKED : BST_UNCHECKED);
+            CheckDlgButton(hwnd, IDC_GAPLESS, g_gapless ? BST_CHECKED : BST_UNCHECKED);
             CheckDlgButton(hwnd, IDC_PLAYLIST_FOLLOW, g_playlistFollowPlayback ? BST_CHECKED : BST_UNCHECKED);
             CheckDlgButton(hwnd, IDC_CHECK_UPDATES, g_checkForUpdates ? BST_CHECKED : BST_UNCHECKED);
             CheckDlgButton(hwnd, IDC_MULTI_INSTANCE, g_allowMultipleInstances ? BST_CHECKED : BST_UNCHECKED);
 
             SetDlgItemInt(hwnd, IDC_REWIND_ON_PAUSE, g_rewindOnPauseMs, FALSE);
 
+            // Populate crossfade controls
+            {
+                SetDlgItemInt(hwnd, IDC_CROSSFADE, g_crossfadeMs, FALSE);
+                HWND hCurveCombo = GetDlgItem(hwnd, IDC_CROSSFADE_CURVE);
+                for (int i = 0; i < static_cast<int>(CrossfadeCurve::COUNT); i++) {
+                    std::wstring name = Utf8ToWide(GetCrossfadeCurveName(static_cast<CrossfadeCurve>(i)));
+                    SendMessageW(hCurveCombo, CB_ADDSTRING, 0, reinterpret_cast<LPARAM>(name.c_str()));
+                }
+                SendMessageW(hCurveCombo, CB_SETCURSEL, g_crossfadeCurve, 0);
+                CheckDlgButton(hwnd, IDC_CROSSFADE_SMART, g_crossfadeSmart ? BST_CHECKED : BST_UNCHECKED);
+            }
+
             // Set download path and organize checkbox
             SetDlgItemTextW(hwnd, IDC_DOWNLOAD_PATH, g_downloadPath.c_str());
             CheckDlgButton(hwnd, IDC_DOWNLOAD_ORGANIZE, g_downloadOrganizeByFeed ? BST_CHECKED : BST_UNCHECKED);
@@ -1120,6 +1167,7 @@ INT_PTR CALLBACK OptionsDlgProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lPara
             CheckDlgButton(hwnd, IDC_DSP_CENTERCANCEL, IsDSPEffectEnabled(DSPEffectType::CenterCancel) ? BST_CHECKED : BST_UNCHECKED);
             CheckDlgButton(hwnd, IDC_DSP_CONVOLUTION, IsDSPEffectEnabled(DSPEffectType::Convolution) ? BST_CHECKED : BST_UNCHECKED);
             CheckDlgButton(hwnd, IDC_DSP_SPATIAL, IsDSPEffectEnabled(DSPEffectType::SpatialAudio) ? BST_CHECKED : BST_UNCHECKED);
+            CheckDlgButton(hwnd, IDC_DSP_DOWNMIX, g_downmixStereo ? BST_CHECKED : BST_UNCHECKED);
 
             // Display current IR file path (just filename)
             if (!g_convolutionIRPath.empty()) {
@@ -1161,6 +1209,17 @@ INT_PTR CALLBACK OptionsDlgProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lPara
                 SendMessageW(hUpdateCombo, CB_SETCURSEL, updateIndex, 0);
             }
 
+            // Populate resampler quality combo box
+            {
+                HWND hResamplerCombo = GetDlgItem(hwnd, IDC_RESAMPLER_QUALITY);
+                for (int i = 0; i < static_cast<int>(ResamplerQuality::COUNT); i++) {
+                    std::wstring label = Utf8ToWide(GetResamplerQualityName(static_cast<ResamplerQuality>(i)));
+                    SendMessageW(hResamplerCombo, CB_ADDSTRING, 0, reinterpret_cast<LPARAM>(label.c_str()));
+                }
+                SendMessageW(hResamplerCombo, CB_SETCURSEL, g_resamplerQuality, 0);
+            }
+            SetDlgItemInt(hwnd, IDC_READ_AHEAD, g_readAheadSeconds, FALSE);
+
             // Populate tempo algorithm combo box
             {
                 HWND hAlgoCombo = GetDlgItem(hwnd, IDC_TEMPO_ALGORITHM);
@@ -1341,6 +1400,7 @@ INT_PTR CALLBACK OptionsDlgProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lPara
                     g_minimizeToTray = (IsDlgButtonChecked(hwnd, IDC_MINIMIZE_TO_TRAY) == BST_CHECKED);
                     g_showTitleInWindow = (IsDlgButtonChecked(hwnd, IDC_SHOW_TITLE) == BST_CHECKED);
                     g_autoAdvance = (IsDlgButtonChecked(hwnd, IDC_AUTO_ADVANCE) == BST_CHECKED);
+                    g_gapless = (IsDlgButtonChecked(hwnd, IDC_GAPLESS) == BST_CHECKED);
                     g_playlistFollowPlayback = (IsDlgButtonChecked(hwnd, IDC_PLAYLIST_FOLLOW) == BST_CHECKED);
                     g_checkForUpdates = (IsDlgButtonChecked(hwnd, IDC_CHECK_UPDATES) == BST_CHECKED);
                     g_allowMultipleInstances = (IsDlgButtonChecked(hwnd, IDC_MULTI_INSTANCE) == BST_CHECKED);
@@ -1349,6 +1409,15 @@ INT_PTR CALLBACK OptionsDlgProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lPara
                     g_rewindOnPauseMs = GetDlgItemInt(hwnd, IDC_REWIND_ON_PAUSE, nullptr, FALSE);
                     if (g_rewindOnPauseMs < 0) g_rewindOnPauseMs = 0;
 
+                    // Get crossfade settings (used from the next track change)
+                    {
+                        g_crossfadeMs = GetDlgItemInt(hwnd, IDC_CROSSFADE, nullptr, FALSE);
+                        if (g_crossfadeMs > 12000) g_crossfadeMs = 12000;
+                        int curveSel = static_cast<int>(SendMessageW(GetDlgItem(hwnd, IDC_CROSSFADE_CURVE), CB_GETCURSEL, 0, 0));
+                        if (curveSel >= 0 && curveSel < static_cast<int>(CrossfadeCurve::COUNT)) g_crossfadeCurve = curveSel;
+                        g_crossfadeSmart = (IsDlgButtonChecked(hwnd, IDC_CROSSFADE_SMART) == BST_CHECKED);
+                    }
+
                     // Get download settings
                     {
                         wchar_t dlPath[MAX_PATH];
@@ -1486,6 +1555,10 @@ INT_PTR CALLBACK OptionsDlgProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lPara
                     EnableDSPEffect(DSPEffectType::Convolution, IsDlgButtonChecked(hwnd, IDC_DSP_CONVOLUTION) == BST_CHECKED);
                     EnableDSPEffect(DSPEffectType::SpatialAudio, IsDlgButtonChecked(hwnd, IDC_DSP_SPATIAL) == BST_CHECKED);
 
+                    // Surround downmix (the DSP is only attached to multichannel streams)
+                    g_downmixStereo = (IsDlgButtonChecked(hwnd, IDC_DSP_DOWNMIX) == BST_CHECKED);
+                    if (g_downmixStereo) ApplyDSPEffects();
+
                     // Get buffer settings
                     {
                         HWND hBufferCombo = GetDlgItem(hwnd, IDC_BUFFER_SIZE);
@@ -1502,6 +1575,17 @@ INT_PTR CALLBACK OptionsDlgProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lPara
                             BASS_SetConfig(BASS_CONFIG_UPDATEPERIOD, g_updatePeriod);
                         }
 
+                        // Resampler quality (applies on next file load)
+                        HWND hResamplerCombo = GetDlgItem(hwnd, IDC_RESAMPLER_QUALITY);
+                        int resamplerSel = static_cast<int>(SendMessageW(hResamplerCombo, CB_GETCURSEL, 0, 0));
+                        if (resamplerSel >= 0 && resamplerSel < static_cast<int>(ResamplerQuality::COUNT)) {
+                            g_resamplerQuality = resamplerSel;
+                        }
+
+                        // Read-ahead window (applies on next file load)
+                        g_readAheadSeconds = GetDlgItemInt(hwnd, IDC_READ_AHEAD, nullptr, FALSE);
+                        if (g_readAheadSeconds > 300) g_readAheadSeconds = 300;
+
                         HWND hAlgoCombo = GetDlgItem(hwnd, IDC_TEMPO_ALGORITHM);
                         int algoSel = static_cast<int>(SendMessageW(hAlgoCombo, CB_GETCURSEL, 0, 0));
                         if (algoSel >= 0 && algoSel < static_cast<int>(TempoAlgorithm::COUNT)) {
@@ -1530,14 +1614,14 @@ INT_PTR CALLBACK OptionsDlgProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lPara
                         g_disableBatchDelay = (IsDlgButtonChecked(hwnd, IDC_DISABLE_BATCH) == BST_CHECKED);
 
                         // Handle mode switch
-                        if (wasLegacy != g_legacyVolume && g_fxStream) {
+                        if (wasLegacy != g_legacyVolume && g_outputStream) {
                             if (g_legacyVolume) {
                                 // Switching TO legacy: apply volume via BASS_ATTRIB_VOL
                                 float curvedVolume = g_muted ? 0.0f : (g_volume * g_volume);
-                                BASS_ChannelSetAttribute(g_fxStream, BASS_ATTRIB_VOL, curvedVolume);
+                                BASS_ChannelSetAttribute(g_outputStream, BASS_ATTRIB_VOL, curvedVolume);
                             } else {
                                 // Switching FROM legacy: reset BASS_ATTRIB_VOL to 1.0 so DSP works
-                                BASS_ChannelSetAttribute(g_fxStream, BASS_ATTRIB_VOL, 1.0f);
+                                BASS_ChannelSetAttribute(g_outputStream, BASS_ATTRIB_VOL, 1.0f);
                                 // Ensure volume DSP is set up
                                 ApplyDSPEffects();
                             }
@@ -1985,7 +2069,7 @@ static std::vector<std::wstring> ParseM3U(const std::wstring& playlistPath) {
         DWORD attrs = GetFileAttributesW(fullPath.c_str());
         if (attrs != INVALID_FILE_ATTRIBUTES && (attrs & FILE_ATTRIBUTE_DIRECTORY)) {
             // Recursively add folder contents
-            AddFilesFromFolder(fullPath, entries);
+            AddAudioFilesFromFolder(fullPath, entries);
         } else {
             entries.push_back(fullPath);
         }
@@ -2030,7 +2114,7 @@ static std::vector<std::wstring> ParsePLS(const std::wstring& playlistPath) {
         DWORD attrs = GetFileAttributesW(fullPath.c_str());
         if (attrs != INVALID_FILE_ATTRIBUTES && (attrs & FILE_ATTRIBUTE_DIRECTORY)) {
             // Recursively add folder contents
-            AddFilesFromFolder(fullPath, entries);
+            AddAudioFilesFromFolder(fullPath, entries);
         } else {
             entries.push_back(fullPath);
         }
@@ -2560,6 +2644,130 @@ void ShowSongHistoryDialog() {
     DialogBoxW(GetModuleHandle(nullptr), MAKEINTRESOURCEW(IDD_SONG_HISTORY), g_hwnd, SongHistoryDlgProc);
 }
 
+// ============================================================================
+// Search Dialog
+// ============================================================================
+
+// Results of each kind listed per query (the indexes make each one quick)
+static const int SEARCH_RESULTS_PER_KIND = 50;
+
+static std::vector<SearchResult> g_searchResults;
+
+static void RefreshSearchResults(HWND hwnd) {
+    HWND hList = GetDlgItem(hwnd, IDC_SEARCH_RESULTS);
+    SendMessageW(hList, WM_SETREDRAW, FALSE, 0);
+    SendMessageW(hList, LB_RESETCONTENT, 0, 0);
+
+    wchar_t query[256] = {0};
+    GetDlgItemTextW(hwnd, IDC_SEARCH_EDIT, query, 256);
+    g_searchResults = SearchDB(query, SEARCH_RESULTS_PER_KIND);
+
+    for (const auto& result : g_searchResults) {
+        std::wstring line;
+        switch (result.kind) {
+            case SearchKind::Song:
+                line = L"Song: " + result.title + L"\t" + FormatHistoryTimestamp(result.timestamp);
+                break;
+            case SearchKind::Bookmark:
+                line = L"Bookmark: " + result.title + L" at " + FormatTime(result.position) + L"\t" + result.detail;
+                break;
+            case SearchKind::Station:
+                line = L"Station: " + result.title + L"\t" + result.detail;
+                break;
+            case SearchKind::Episode:
+                line = L"Episode: " + result.title + L"\t" + result.detail;
+                break;
+        }
+        SendMessageW(hList, LB_ADDSTRING, 0, reinterpret_cast<LPARAM>(line.c_str()));
+    }
+    if (!g_searchResults.empty()) {
+        SendMessageW(hList, LB_SETCURSEL, 0, 0);
+    }
+    SendMessageW(hList, WM_SETREDRAW, TRUE, 0);
+    InvalidateRect(hList, nullptr, TRUE);
+}
+
+// Copy a song, jump to a bookmark or play a station or episode.
+// Returns true if the dialog should close.
+static bool OpenSearchResult(HWND hwnd, const SearchResult& result) {
+    switch (result.kind) {
+        case SearchKind::Song:
+            CopyHistoryEntryToClipboard(hwnd, result.title);
+            return false;
+        case SearchKind::Bookmark: {
+            Bookmark bm = {result.id, result.target, result.position, result.title, 0};
+            JumpToBookmark(bm);
+            return true;
+        }
+        case SearchKind::Station:
+        case SearchKind::Episode:
+            g_playlist.clear();
+            g_playlist.push_back(result.target);
+            g_currentTrack = -1;
+            PlayTrack(0);
+            return true;
+    }
+    return false;
+}
+
+static INT_PTR CALLBACK SearchDlgProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam) {
+    switch (msg) {
+        case WM_INITDIALOG: {
+            HWND hList = GetDlgItem(hwnd, IDC_SEARCH_RESULTS);
+            int tabStops[1] = {260};
+            SendMessageW(hList, LB_SETTABSTOPS, 1, reinterpret_cast<LPARAM>(tabStops));
+            g_searchResults.clear();
+            SetFocus(GetDlgItem(hwnd, IDC_SEARCH_EDIT));
+            return FALSE;
+        }
+
+        case WM_COMMAND:
+            switch (LOWORD(wParam)) {
+                case IDC_SEARCH_EDIT:
+                    if (HIWORD(wParam) == EN_CHANGE) {
+                        RefreshSearchResults(hwnd);
+                    }
+                    return TRUE;
+                case IDC_SEARCH_RESULTS:
+                    if (HIWORD(wParam) != LBN_DBLCLK) break;
+                    // Fall through
+                case IDOK: {
+                    // Enter in the search box moves to the results
+                    HWND hList = GetDlgItem(hwnd, IDC_SEARCH_RESULTS);
+                    if (GetFocus() != hList) {
+                        if (g_searchResults.empty()) {
+                            Speak("No results");
+                        } else {
+                            SetFocus(hList);
+                        }
+                        return TRUE;
+                    }
+                    int sel = static_cast<int>(SendMessageW(hList, LB_GETCURSEL, 0, 0));
+                    if (sel >= 0 && sel < static_cast<int>(g_searchResults.size())) {
+                        SearchResult result = g_searchResults[sel];
+                        if (OpenSearchResult(hwnd, result)) {
+                            EndDialog(hwnd, IDOK);
+                        }
+                    }
+                    return TRUE;
+                }
+                case IDCANCEL:
+                    EndDialog(hwnd, IDCANCEL);
+                    return TRUE;
+            }
+            break;
+
+        case WM_DESTROY:
+            g_searchResults.clear();
+            break;
+    }
+    return FALSE;
+}
+
+void ShowSearchDialog() {
+    DialogBoxW(GetModuleHandle(nullptr), MAKEINTRESOURCEW(IDD_SEARCH), g_hwnd, SearchDlgProc);
+}
+
 // ============================================================================
 // Radio Dialog
 // ============================================================================
@@ -5183,6 +5391,7 @@ static void LoadPodcastEpisodes(HWND hwnd, const std::wstring& feedUrl,
     std::wstring title;
     PodcastFetchDiag diag;
     if (ParsePodcastFeed(feedUrl, title, g_podcastEpisodes, username, password, &diag)) {
+        SavePodcastEpisodesDB(feedUrl, title, g_podcastEpisodes);  // For searching
         for (const auto& ep : g_podcastEpisodes) {
             std::wstring display = ep.title;
             if (!ep.pubDate.empty()) {
@@ -5823,6 +6032,7 @@ static INT_PTR CALLBACK PodcastDlgProc(HWND hwnd, UINT msg, WPARAM wParam, LPARA
                         if (ParsePodcastFeed(addData.url, title, eps, addData.username, addData.password, &addDiag)) {
                             if (title.empty()) title = L"Unknown Podcast";
                             if (AddPodcastSubscription(title, addData.url, L"", addData.username, addData.password) > 0) {
+                                SavePodcastEpisodesDB(addData.url, title, eps);
                                 RefreshPodcastSubsList(hwnd);
                                 Speak("Podcast added");
                             } else if (UpdatePodcastAuth(addData.url, addData.username, addData.password)) {
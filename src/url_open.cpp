@@ -0,0 +1,216 @@
+#include "url_open.h"
+#include "bass_aac.h"
+#include <memory>
+#include <vector>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <chrono>
+#include <cwctype>
+
+static const int STRATEGY_COUNT = static_cast<int>(UrlOpenStrategy::COUNT);
+
+// Head start for the strategy remembered for a host before the others join in
+static const int PREFERRED_HEAD_START_MS = 1500;
+
+// How long a less preferred stream that connected first waits for a better one
+static const int PREFERENCE_GRACE_MS = 300;
+
+// Shared by the caller and the racer threads (whichever finishes last frees it)
+struct UrlRace {
+    std::mutex mutex;
+    std::condition_variable changed;
+    std::string url;
+    bool decided = false;        // The caller has taken a winner or given up
+    bool cancelled = false;      // BASS is being freed; racers still waiting don't start
+    int connecting = 0;          // Racers connecting now
+    bool headStartOver = false;  // All of them failed, so the delayed racers go now
+    bool finished[STRATEGY_COUNT] = {};
+    HSTREAM stream[STRATEGY_COUNT] = {};
+    int error[STRATEGY_COUNT] = {};
+};
+
+// Racer threads not yet joined. Finished ones are joined by the next open,
+// the rest by StopUrlOpens().
+struct RacerThread {
+    std::thread thread;
+    std::shared_ptr<UrlRace> race;
+    int strategy;
+};
+static std::mutex g_racersMutex;
+static std::vector<RacerThread> g_racers;
+
+static HSTREAM CreateWithStrategy(const std::string& url, UrlOpenStrategy strategy) {
+    DWORD flags = BASS_STREAM_DECODE | BASS_STREAM_STATUS | BASS_SAMPLE_FLOAT;
+    if (strategy == UrlOpenStrategy::AacBlock || strategy == UrlOpenStrategy::GenericBlock) {
+        flags |= BASS_STREAM_BLOCK;
+    }
+    if (strategy == UrlOpenStrategy::AacSeekable || strategy == UrlOpenStrategy::AacBlock) {
+        return BASS_AAC_StreamCreateURL(url.c_str(), 0, flags, nullptr, nullptr);
+    }
+    return BASS_StreamCreateURL(url.c_str(), 0, flags, nullptr, nullptr);
+}
+
+static void RunRacer(std::shared_ptr<UrlRace> race, int strategy, int delayMs) {
+    if (delayMs > 0) {
+        // Wait out the head start, unless everything connecting fails first
+        std::unique_lock<std::mutex> lock(race->mutex);
+        race->changed.wait_for(lock, std::chrono::milliseconds(delayMs),
+                               [&] { return race->decided || race->cancelled || race->headStartOver; });
+        if (race->decided || race->cancelled) {
+            race->finished[strategy] = true;
+            lock.unlock();
+            race->changed.notify_all();
+            return;
+        }
+        race->connecting++;
+    }
+
+    // BASS can't abort a connect in progress; a loser is freed once it returns
+    HSTREAM stream = CreateWithStrategy(race->url, static_cast<UrlOpenStrategy>(strategy));
+    int error = stream ? BASS_OK : BASS_ErrorGetCode();  // Error codes are per thread
+    bool lost;
+    {
+        std::lock_guard<std::mutex> lock(race->mutex);
+        lost = race->decided;
+        if (!lost) race->stream[strategy] = stream;
+        race->error[strategy] = error;
+        race->finished[strategy] = true;
+        if (--race->connecting == 0 && !stream) race->headStartOver = true;
+    }
+    // Wakes the caller, and the delayed racers if the head start is over
+    race->changed.notify_all();
+    if (lost && stream) BASS_StreamFree(stream);
+}
+
+// Join the racers that are done (call with g_racersMutex held)
+static void JoinFinishedRacers() {
+    for (auto it = g_racers.begin(); it != g_racers.end();) {
+        bool finished;
+        {
+            std::lock_guard<std::mutex> lock(it->race->mutex);
+            finished = it->race->finished[it->strategy];
+        }
+        if (finished) {
+            it->thread.join();  // At most a loser's BASS_StreamFree away
+            it = g_racers.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+HSTREAM OpenUrlStream(const std::string& urlUtf8, int preferred, int* winner, int* error) {
+    auto race = std::make_shared<UrlRace>();
+    race->url = urlUtf8;
+
+    // Rank the strategies: the remembered one first, then the usual preference
+    bool hinted = preferred >= 0 && preferred < STRATEGY_COUNT;
+    int order[STRATEGY_COUNT];
+    int count = 0;
+    if (hinted) order[count++] = preferred;
+    for (int i = 0; i < STRATEGY_COUNT; i++) {
+        if (!hinted || i != preferred) order[count++] = i;
+    }
+
+    race->connecting = hinted ? 1 : STRATEGY_COUNT;
+    {
+        std::lock_guard<std::mutex> lock(g_racersMutex);
+        JoinFinishedRacers();
+        for (int i = 0; i < STRATEGY_COUNT; i++) {
+            int delay = (hinted && order[i] != preferred) ? PREFERRED_HEAD_START_MS : 0;
+            g_racers.push_back(RacerThread{std::thread(RunRacer, race, order[i], delay), race, order[i]});
+        }
+    }
+
+    int pick = -1;
+    bool graceStarted = false;
+    std::chrono::steady_clock::time_point graceEnd;
+    std::unique_lock<std::mutex> lock(race->mutex);
+    for (;;) {
+        // Best stream so far, and whether a better ranked one is still connecting
+        int best = -1;
+        bool betterPending = false;
+        bool allFinished = true;
+        for (int i = 0; i < STRATEGY_COUNT; i++) {
+            int s = order[i];
+            if (!race->finished[s]) {
+                allFinished = false;
+                if (best < 0) betterPending = true;
+            } else if (best < 0 && race->stream[s]) {
+                best = i;
+            }
+        }
+
+        if (best >= 0) {
+            if (!graceStarted) {
+                graceStarted = true;
+                graceEnd = std::chrono::steady_clock::now() + std::chrono::milliseconds(PREFERENCE_GRACE_MS);
+            }
+            if (!betterPending || std::chrono::steady_clock::now() >= graceEnd) {
+                pick = order[best];
+                break;
+            }
+            race->changed.wait_until(lock, graceEnd);
+        } else {
+            if (allFinished) break;
+            race->changed.wait(lock);
+        }
+    }
+
+    // Claim the winner; anything else that already connected is freed here,
+    // and racers still connecting free their own stream when they return
+    race->decided = true;
+    HSTREAM result = (pick >= 0) ? race->stream[pick] : 0;
+    std::vector<HSTREAM> losers;
+    for (int i = 0; i < STRATEGY_COUNT; i++) {
+        if (i != pick && race->stream[i]) losers.push_back(race->stream[i]);
+        race->stream[i] = 0;
+    }
+    // Report the generic BLOCK open's error on failure (the last one tried
+    // before racing); the AAC opener only knows "not AAC"
+    int lastError = race->error[static_cast<int>(UrlOpenStrategy::GenericBlock)];
+    lock.unlock();
+    race->changed.notify_all();
+    for (HSTREAM s : losers) BASS_StreamFree(s);
+
+    if (winner) *winner = pick;
+    if (error) *error = result ? BASS_OK : (lastError ? lastError : BASS_ERROR_FILEOPEN);
+    return result;
+}
+
+void StopUrlOpens() {
+    std::vector<RacerThread> racers;
+    {
+        std::lock_guard<std::mutex> lock(g_racersMutex);
+        racers.swap(g_racers);
+    }
+    for (auto& racer : racers) {
+        {
+            std::lock_guard<std::mutex> lock(racer.race->mutex);
+            racer.race->cancelled = true;
+        }
+        racer.race->changed.notify_all();
+    }
+    for (auto& racer : racers) {
+        racer.thread.join();
+    }
+}
+
+std::wstring GetUrlHost(const std::wstring& url) {
+    size_t start = url.find(L"://");
+    start = (start == std::wstring::npos) ? 0 : start + 3;
+    size_t end = url.find_first_of(L"/?#", start);
+    std::wstring host = url.substr(start, (end == std::wstring::npos) ? std::wstring::npos : end - start);
+
+    // Drop credentials and the port
+    size_t at = host.rfind(L'@');
+    if (at != std::wstring::npos) host.erase(0, at + 1);
+    size_t colon = host.rfind(L':');
+    if (colon != std::wstring::npos && host.find(L']', colon) == std::wstring::npos) {
+        host.erase(colon);
+    }
+
+    for (wchar_t& c : host) c = static_cast<wchar_t>(std::towlower(c));
+    return host;
+}
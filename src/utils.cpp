@@ -43,3 +43,12 @@ std::wstring FormatTime(double seconds) {
     }
     return buf;
 }
+
+bool GetFileIdentity(const std::wstring& path, int64_t& size, int64_t& modified) {
+    WIN32_FILE_ATTRIBUTE_DATA data;
+    if (!GetFileAttributesExW(path.c_str(), GetFileExInfoStandard, &data)) return false;
+    size = (static_cast<int64_t>(data.nFileSizeHigh) << 32) | data.nFileSizeLow;
+    modified = (static_cast<int64_t>(data.ftLastWriteTime.dwHighDateTime) << 32) |
+               data.ftLastWriteTime.dwLowDateTime;
+    return true;
+}